@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define APPLICATIONLAYERBASE_H
 
 #include <QObject>
+#include <QFuture>
+#include <QVariant>
+#include <QVector>
 class Register;
 class Cpu;
 
@@ -34,6 +37,23 @@ public:
     explicit ApplicationLayerBase(QObject* parent = nullptr) :
         QObject(parent){}
 
+    /**
+     * @brief Query the current value of a Register and wait for it with the returned future.
+     * The Register is updated with the value as well.
+     * @param Register you want to query
+     * @return future with the value, canceled when the Cpu did not respond or its response could not be decoded.
+     */
+    virtual QFuture<QVariant> queryRegisterAsync(Register& registerToRead) = 0;
+
+    /**
+     * @brief Write a value to a Register and wait for the acknowledgement with the returned future.
+     * @param Register you want to write, its value is not changed
+     * @param value to write
+     * @return future that is true when the value is written, false when the Cpu reported an error
+     * and canceled when the Cpu did not respond.
+     */
+    virtual QFuture<bool> writeRegisterAsync(Register& registerToWrite, const QVariant& value) = 0;
+
 public slots:
 
     /**
@@ -47,12 +67,25 @@ public slots:
      */
     virtual void queryRegister(const Register& registerToRead) = 0;
 
+    /**
+     * @brief Query the current value of a Register as a periodic poll, with a lower priority than queryRegister
+     * @param Register you want to poll
+     */
+    virtual void pollRegister(const Register& registerToPoll) = 0;
+
     /**
      * @brief Write the Register with a new value
      * @param Register you want to write
      */
     virtual void writeRegister(const Register& registerToWrite) = 0;
 
+    /**
+     * @brief Write a value to a Register, used for values that were held back by the WriteCoalescer
+     * @param Register you want to write
+     * @param value to write, the Register value may have changed since
+     */
+    virtual void writeRegisterValue(const Register& registerToWrite, const QVariant& value) = 0;
+
     /**
      * @brief Reset the time of the CPU
      * @param Cpu you want to reset the time.
@@ -60,10 +93,12 @@ public slots:
     virtual void resetTime(const Cpu& cpu) = 0;
 
     /**
-     * @brief Config debug channel for a Register.
-     * @param Register you want to config the debug channel for.
+     * @brief Config a debug channel of a Cpu.
+     * @param Cpu of which you want to config the debug channel.
+     * @param channel number of the debug channel.
+     * @param Register to stream on the channel, nullptr to switch the channel off.
      */
-    virtual void configDebugChannel(Register& registerToConfigDebugChannel) = 0;
+    virtual void configDebugChannel(const Cpu& cpu, int channel, const Register* channelRegister) = 0;
 
     /**
      * @brief Get the decimation of the cpu
@@ -76,6 +111,19 @@ public slots:
      * @param Cpu of which you want to set the decimation.
      */
     virtual void setDecimation(const Cpu& cpu) = 0;
+
+    /**
+     * @brief The response to an asynchronous request was received
+     * @param requestId of the request
+     * @param messageVector the protocol command of the response
+     */
+    virtual void requestCompleted(quint32 requestId, QVector<uint8_t> messageVector) = 0;
+
+    /**
+     * @brief An asynchronous request got no response
+     * @param requestId of the request
+     */
+    virtual void requestFailed(quint32 requestId) = 0;
 };
 
 #endif // APPLICATIONLAYERBASE_H
@@ -0,0 +1,343 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CommandQueue.h"
+#include "TransportLayerBase.h"
+#include <cmath>
+
+static const double burstTime = 0.1;    /**< s of the rate limit that may be sent at once */
+static const int frameOverhead = 5;     /**< STX, uC id, msg id, CRC and ETX around a protocol command */
+
+CommandQueue::CommandQueue(TransportLayerBase &transportLayer, QObject *parent) :
+    QObject(parent),
+    m_transportLayer(transportLayer)
+{
+    m_clock.start();
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, &QTimer::timeout, this, &CommandQueue::dispatch);
+    connect(&m_transportLayer, &TransportLayerBase::windowAvailable, this, &CommandQueue::dispatch);
+    connect(&m_transportLayer, &TransportLayerBase::retransmissionsDue, this, &CommandQueue::dispatch);
+
+    //Batches of asynchronous requests may not take the whole link
+    setLaneRateLimit(CommandLane::Bulk, 500.0);
+}
+
+void CommandQueue::setLaneRateLimit(CommandLane lane, double framesPerSecond)
+{
+    m_lanes[static_cast<int>(lane)].frames.setRate(framesPerSecond, 1.0, m_clock.elapsed());
+    dispatch();
+}
+
+int CommandQueue::queued(CommandLane lane) const
+{
+    int count = 0;
+    for (const auto& queue : m_lanes[static_cast<int>(lane)].queues)
+    {
+        count += queue.size();
+    }
+    return count;
+}
+
+void CommandQueue::setCpuRateLimit(uint8_t uCId, double bytesPerSecond, double framesPerSecond)
+{
+    CpuLimit& limit = m_cpuLimits[uCId];
+    limit.custom = true;
+    limit.bytes.setRate(bytesPerSecond, 64.0, m_clock.elapsed());
+    limit.frames.setRate(framesPerSecond, 1.0, m_clock.elapsed());
+    dispatch();
+}
+
+void CommandQueue::setDefaultCpuRateLimit(double bytesPerSecond, double framesPerSecond)
+{
+    m_defaultBytesPerSecond = qMax(0.0, bytesPerSecond);
+    m_defaultFramesPerSecond = qMax(0.0, framesPerSecond);
+    for (auto& limit : m_cpuLimits)
+    {
+        if (!limit.custom)
+        {
+            limit.bytes.setRate(m_defaultBytesPerSecond, 64.0, m_clock.elapsed());
+            limit.frames.setRate(m_defaultFramesPerSecond, 1.0, m_clock.elapsed());
+        }
+    }
+    dispatch();
+}
+
+qint64 CommandQueue::throttledTime(uint8_t uCId) const
+{
+    auto limit = m_cpuLimits.constFind(uCId);
+    if (limit == m_cpuLimits.constEnd())
+    {
+        return 0;
+    }
+    return limit->throttledTime + (limit->throttledSince >= 0 ? m_clock.elapsed() - limit->throttledSince : 0);
+}
+
+qint64 CommandQueue::throttledTime() const
+{
+    qint64 throttled = 0;
+    for (auto it = m_cpuLimits.constBegin(); it != m_cpuLimits.constEnd(); ++it)
+    {
+        throttled += throttledTime(it.key());
+    }
+    return throttled;
+}
+
+qint64 CommandQueue::backpressureTime() const
+{
+    return m_backpressureTime + (m_backpressure ? m_clock.elapsed() - m_backpressureSince : 0);
+}
+
+void CommandQueue::enqueue(uint8_t uCId, QVector<uint8_t> protocolCommand, CommandLane lane, quint32 requestId)
+{
+    m_lanes[static_cast<int>(lane)].queues[uCId].enqueue({protocolCommand, requestId});
+    if (m_batchDepth == 0)
+    {
+        dispatch();
+    }
+}
+
+void CommandQueue::endBatch()
+{
+    if (m_batchDepth > 0 && --m_batchDepth == 0)
+    {
+        dispatch();
+    }
+}
+
+void CommandQueue::dispatch()
+{
+    if (m_dispatching)
+    {
+        //Called again from a slot of a command that is being sent, the running dispatch handles it
+        m_redispatch = true;
+        return;
+    }
+    if (m_backpressure || m_batchDepth > 0)
+    {
+        return;
+    }
+
+    m_dispatching = true;
+    m_transportLayer.beginBatch();
+    do
+    {
+        m_redispatch = false;
+        qint64 now = m_clock.elapsed();
+
+        //Retransmissions are already in flight and go first, but they take the tokens of their Cpu like any frame
+        const QList<uint8_t> retransmissionCpus = m_transportLayer.retransmissionCpus();
+        for (uint8_t uCId : retransmissionCpus)
+        {
+            int size = m_transportLayer.nextRetransmissionSize(uCId);
+            while (!m_backpressure && size > 0 && takeCpuTokens(uCId, size, now))
+            {
+                m_transportLayer.sendRetransmission(uCId);
+                size = m_transportLayer.nextRetransmissionSize(uCId);
+            }
+        }
+
+        for (int laneIndex = 0; laneIndex < NbrOfLanes && !m_backpressure; laneIndex++)
+        {
+            Lane& lane = m_lanes[laneIndex];
+            int reserved = laneIndex >= static_cast<int>(CommandLane::Poll) ? ReservedWindow : 0;
+            bool burst = laneIndex == static_cast<int>(CommandLane::ChannelConfig);
+            bool laneLimited = false;
+
+            //Keys are copied, sending can queue new commands
+            const QList<uint8_t> cpus = lane.queues.keys();
+            for (uint8_t uCId : cpus)
+            {
+                while (!laneLimited && !m_backpressure && !lane.queues[uCId].isEmpty() && m_transportLayer.availableWindow(uCId, burst) > reserved)
+                {
+                    if (!lane.frames.canTake(1.0, now))
+                    {
+                        laneLimited = true;
+                        scheduleRetry(lane.frames.waitTime(1.0));
+                        break;
+                    }
+                    int size = frameSize(lane.queues[uCId].head());
+                    if (!takeCpuTokens(uCId, size, now))
+                    {
+                        break;
+                    }
+                    lane.frames.take(1.0);
+
+                    Command command = lane.queues[uCId].dequeue();
+                    lane.sent++;
+                    m_transportLayer.sendDebugProtocolRequest(uCId, command.protocolCommand, command.requestId, burst);
+                }
+                if (lane.queues[uCId].isEmpty())
+                {
+                    lane.queues.remove(uCId);
+                }
+            }
+        }
+    } while (m_redispatch && !m_backpressure);
+    m_transportLayer.endBatch();
+    m_dispatching = false;
+
+    //A Cpu without queued commands is not throttled
+    qint64 now = m_clock.elapsed();
+    for (auto limit = m_cpuLimits.begin(); limit != m_cpuLimits.end(); ++limit)
+    {
+        if (limit->throttledSince < 0)
+        {
+            continue;
+        }
+        bool queued = m_transportLayer.nextRetransmissionSize(limit.key()) > 0;
+        for (const auto& lane : m_lanes)
+        {
+            queued = queued || lane.queues.contains(limit.key());
+        }
+        if (!queued)
+        {
+            limit->throttledTime += now - limit->throttledSince;
+            limit->throttledSince = -1;
+        }
+    }
+}
+
+void CommandQueue::clear()
+{
+    for (auto& lane : m_lanes)
+    {
+        lane.queues.clear();
+    }
+    m_retryTimer.stop();
+
+    qint64 now = m_clock.elapsed();
+    for (auto& limit : m_cpuLimits)
+    {
+        if (limit.throttledSince >= 0)
+        {
+            limit.throttledTime += now - limit.throttledSince;
+            limit.throttledSince = -1;
+        }
+    }
+}
+
+void CommandQueue::setBackpressure(bool backpressure)
+{
+    if (m_backpressure == backpressure)
+    {
+        return;
+    }
+
+    m_backpressure = backpressure;
+    qint64 now = m_clock.elapsed();
+    if (m_backpressure)
+    {
+        m_backpressureSince = now;
+    }
+    else
+    {
+        m_backpressureTime += now - m_backpressureSince;
+    }
+    emit backpressureChanged(m_backpressure);
+
+    if (!m_backpressure)
+    {
+        dispatch();
+    }
+}
+
+CommandQueue::CpuLimit &CommandQueue::cpuLimit(uint8_t uCId)
+{
+    auto limit = m_cpuLimits.find(uCId);
+    if (limit == m_cpuLimits.end())
+    {
+        limit = m_cpuLimits.insert(uCId, CpuLimit());
+        limit->bytes.setRate(m_defaultBytesPerSecond, 64.0, m_clock.elapsed());
+        limit->frames.setRate(m_defaultFramesPerSecond, 1.0, m_clock.elapsed());
+    }
+    return *limit;
+}
+
+bool CommandQueue::takeCpuTokens(uint8_t uCId, int frameSize, qint64 now)
+{
+    if (uCId == 0xFF)
+    {
+        //Broadcasts are not limited
+        return true;
+    }
+
+    CpuLimit& limit = cpuLimit(uCId);
+    if (!limit.bytes.canTake(frameSize, now) || !limit.frames.canTake(1.0, now))
+    {
+        if (limit.throttledSince < 0)
+        {
+            limit.throttledSince = now;
+        }
+        scheduleRetry(qMax(limit.bytes.waitTime(frameSize), limit.frames.waitTime(1.0)));
+        return false;
+    }
+
+    if (limit.throttledSince >= 0)
+    {
+        limit.throttledTime += now - limit.throttledSince;
+        limit.throttledSince = -1;
+    }
+    limit.bytes.take(frameSize);
+    limit.frames.take(1.0);
+    return true;
+}
+
+void CommandQueue::scheduleRetry(int wait)
+{
+    wait = qMax(1, wait);
+    if (!m_retryTimer.isActive() || m_retryTimer.remainingTime() > wait)
+    {
+        m_retryTimer.start(wait);
+    }
+}
+
+int CommandQueue::frameSize(const CommandQueue::Command &command)
+{
+    return command.protocolCommand.size() + frameOverhead;
+}
+
+void CommandQueue::TokenBucket::setRate(double newRate, double minimumCapacity, qint64 now)
+{
+    rate = qMax(0.0, newRate);
+    capacity = qMax(minimumCapacity, rate * burstTime);
+    tokens = capacity;
+    lastRefill = now;
+}
+
+bool CommandQueue::TokenBucket::canTake(double amount, qint64 now)
+{
+    if (rate <= 0.0)
+    {
+        return true;
+    }
+
+    tokens = qMin(capacity, tokens + (now - lastRefill) / 1000.0 * rate);
+    lastRefill = now;
+    //A frame larger than the bucket is sent once the bucket is full
+    return tokens >= qMin(amount, capacity);
+}
+
+int CommandQueue::TokenBucket::waitTime(double amount) const
+{
+    if (rate <= 0.0)
+    {
+        return 0;
+    }
+    double missing = qMin(amount, capacity) - tokens;
+    return missing > 0.0 ? static_cast<int>(std::ceil(missing / rate * 1000.0)) : 0;
+}
@@ -0,0 +1,189 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+#include <QVector>
+class TransportLayerBase;
+
+/**
+ * @brief Lane of an outgoing protocol command, a lower value has a higher priority
+ */
+enum class CommandLane
+{
+    Interactive = 0,    /**< Writes and queries the user is waiting for */
+    ChannelConfig,      /**< Debug channel, decimation and time configuration */
+    Poll,               /**< Periodic queries of the PollScheduler */
+    Bulk                /**< Batches of asynchronous requests */
+};
+Q_DECLARE_METATYPE(CommandLane)
+
+/**
+ * @brief Prioritized send queues in front of the transport layer.
+ *
+ * Every outgoing protocol command is queued in the lane it belongs to. A command is handed to the
+ * transport layer when the in flight window of its Cpu has room, lanes are served in priority order
+ * so a queued interactive write always goes before queued polls. Poll and Bulk commands leave a
+ * few places of the window free, so an interactive command never has to wait for a full window of
+ * bulk requests. Each lane can be limited to a number of frames per second, the Bulk lane is limited
+ * to 500 frames/s by default.
+ *
+ * Small targets drop frames when they receive faster than they can process, so the commands to each
+ * Cpu can be limited in bytes/s and frames/s as well. When the write buffer of the medium fills up,
+ * the medium turns on backpressure: nothing is sent until it drained and backpressureChanged() tells
+ * the producers to pause. The time spent throttled is counted. Retransmissions of the transport
+ * layer are sent from here as well, ahead of the lanes, so they count against the same limits.
+ *
+ * All frames sent by one dispatch are written to the medium at once. Between beginBatch() and
+ * endBatch() queued commands are held, so a burst of commands, like the configuration of all debug
+ * channels, goes out in a single write. ChannelConfig commands may use the burst window of the
+ * transport layer beyond the normal window, so a full window of polls does not split the burst.
+ */
+class CommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    static const int NbrOfLanes = 4;
+    static const int ReservedWindow = 2;   /**< Window places that only Interactive and ChannelConfig commands use */
+
+    explicit CommandQueue(TransportLayerBase& transportLayer, QObject* parent = nullptr);
+
+    /**
+     * @brief Limit the rate of a lane
+     * @param framesPerSecond maximum rate, 0 for no limit.
+     */
+    void setLaneRateLimit(CommandLane lane, double framesPerSecond);
+    double laneRateLimit(CommandLane lane) const {return m_lanes[static_cast<int>(lane)].frames.rate;}
+    int queued(CommandLane lane) const;
+    quint64 sent(CommandLane lane) const {return m_lanes[static_cast<int>(lane)].sent;}
+
+    /**
+     * @brief Limit the commands to a Cpu, on top of the lane limits
+     * @param bytesPerSecond maximum frame bytes per second, 0 for no limit.
+     * @param framesPerSecond maximum frames per second, 0 for no limit.
+     */
+    void setCpuRateLimit(uint8_t uCId, double bytesPerSecond, double framesPerSecond);
+
+    /**
+     * @brief Limit used for Cpu`s without their own limit
+     */
+    void setDefaultCpuRateLimit(double bytesPerSecond, double framesPerSecond);
+
+    bool isBackpressure() const {return m_backpressure;}
+    qint64 throttledTime(uint8_t uCId) const;    /**< ms that commands to the Cpu waited for its rate limit */
+    qint64 throttledTime() const;                /**< Sum of the throttled time of all Cpu`s */
+    qint64 backpressureTime() const;             /**< ms that nothing was sent because of backpressure */
+
+public slots:
+    /**
+     * @brief Queue a protocol command
+     * @param requestId passed to TransportLayerBase::sendDebugProtocolRequest, 0 if nobody waits for the response.
+     */
+    void enqueue(uint8_t uCId, QVector<uint8_t> protocolCommand, CommandLane lane, quint32 requestId);
+
+    /**
+     * @brief Send as many queued commands as the windows and rate limits allow
+     */
+    void dispatch();
+
+    /**
+     * @brief Drop all queued commands
+     */
+    void clear();
+
+    /**
+     * @brief Hold queued commands until the matching endBatch(), batches can be nested
+     */
+    void beginBatch() {m_batchDepth++;}
+    void endBatch();
+
+    /**
+     * @brief Pause or resume sending, used by the medium when its write buffer is too full
+     */
+    void setBackpressure(bool backpressure);
+
+signals:
+    void backpressureChanged(bool backpressure);
+
+private:
+    struct Command
+    {
+        QVector<uint8_t> protocolCommand;
+        quint32 requestId;
+    };
+
+    /**
+     * @brief Token bucket that holds up to burstTime of its rate
+     */
+    struct TokenBucket
+    {
+        double rate = 0.0;          /**< Tokens per second, 0 for no limit */
+        double tokens = 0.0;
+        double capacity = 1.0;
+        qint64 lastRefill = 0;
+
+        void setRate(double newRate, double minimumCapacity, qint64 now);
+        bool canTake(double amount, qint64 now);
+        void take(double amount) {tokens -= qMin(amount, capacity);}
+        int waitTime(double amount) const;  /**< ms until amount tokens are available */
+    };
+
+    struct Lane
+    {
+        QHash<uint8_t, QQueue<Command>> queues;     /**< Per Cpu, so a full window does not block other Cpu`s */
+        TokenBucket frames;
+        quint64 sent = 0;
+    };
+
+    struct CpuLimit
+    {
+        TokenBucket bytes;
+        TokenBucket frames;
+        bool custom = false;        /**< Set with setCpuRateLimit, else the default limit is used */
+        qint64 throttledSince = -1;
+        qint64 throttledTime = 0;
+    };
+
+    CpuLimit& cpuLimit(uint8_t uCId);
+    bool takeCpuTokens(uint8_t uCId, int frameSize, qint64 now);
+    void scheduleRetry(int wait);
+    static int frameSize(const Command& command);
+
+private:
+    TransportLayerBase& m_transportLayer;
+    Lane m_lanes[NbrOfLanes];
+    QTimer m_retryTimer;
+    QElapsedTimer m_clock;
+    QHash<uint8_t, CpuLimit> m_cpuLimits;
+    double m_defaultBytesPerSecond = 0.0;
+    double m_defaultFramesPerSecond = 0.0;
+    bool m_backpressure = false;
+    qint64 m_backpressureSince = 0;
+    qint64 m_backpressureTime = 0;
+    int m_batchDepth = 0;
+    bool m_dispatching = false;
+    bool m_redispatch = false;
+};
+
+#endif // COMMANDQUEUE_H
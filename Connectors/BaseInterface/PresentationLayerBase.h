@@ -23,8 +23,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QVector>
 #include <QVariant>
 class Cpu;
+class SampleSink;
 #include "Medium/CPU/CpuListModel.h"
 #include "../BaseInterface/Common.h"
+#include "../BaseInterface/CommandQueue.h"
 
 class PresentationLayerBase : public QObject
 {
@@ -36,6 +38,17 @@ public:
         m_cpuListModel(cpuListModel),
         m_registerListModel(registerListModel){}
 
+    /**
+     * @brief Also append the decoded channel data to a sink that is shared with other connections
+     * @param sink for the samples, nullptr for none.
+     * @param source that is put in the samples to tell the connections apart.
+     */
+    void setSampleSink(SampleSink* sink, quint16 source)
+    {
+        m_sampleSink = sink;
+        m_sampleSource = source;
+    }
+
 signals:
 
     /**
@@ -44,12 +57,29 @@ signals:
      */
     void newCpuFound(Cpu* newCpu);
 
+    /**
+     * @brief Signal that is emitted when a known Cpu answers a scan with the same identity, for
+     * instance after a reconnect. The Cpu and its Registers are kept, its configuration has to be restored.
+     * @param Cpu that is found again.
+     */
+    void cpuRestored(Cpu* knownCpu);
+
+    /**
+     * @brief Signal that is emitted when a Cpu answers a scan with another name, serial number or
+     * version than the known Cpu with the same id. Afterwards the Cpu is reported with newCpuFound()
+     * if the known Cpu was removed from the CpuListModel.
+     * @param Cpu that is not the same target anymore.
+     */
+    void cpuIdentityChanged(Cpu* knownCpu);
+
     /**
      * @brief Signal that is emitted when a new debug protocol command needs to be send
      * @param uCId id of the Cpu where the message came from.
      * @param protocolCommand QVector containing the data of the protocol
+     * @param lane of the CommandQueue the command is send with.
+     * @param requestId to recognize the response, see TransportLayerBase::sendDebugProtocolRequest, 0 if nobody waits for it.
      */
-    void newDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> protocolCommand);
+    void newDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> protocolCommand, CommandLane lane, quint32 requestId);
 
 public slots:
 
@@ -60,9 +90,17 @@ public slots:
      */
     virtual void receivedDebugProtocolCommand(uint8_t uCID, QVector<uint8_t> protocolCommand) = 0;
 
+    /**
+     * @brief Channel data that the transport layer did not check, see TransportLayerBase::setChannelDataUnchecked()
+     * @param frame the bytes between STX and ETX as received.
+     */
+    virtual void receivedChannelDataFrame(uint8_t uCId, QByteArray frame) {Q_UNUSED(uCId); Q_UNUSED(frame);}
+
 protected:
     CpuListModel& m_cpuListModel; /**< Reference to CpuListModel contains all Cpu`s from this medium */
     RegisterListModel& m_registerListModel; /**< Reference to RegisterListModel containing all Registers from this medium */
+    SampleSink* m_sampleSink = nullptr;
+    quint16 m_sampleSource = 0;
 };
 
 #endif // PRESENTATIONLAYERBASE_H
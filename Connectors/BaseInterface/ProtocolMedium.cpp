@@ -0,0 +1,398 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ProtocolMedium.h"
+#include "CommandQueue.h"
+#include <QDebug>
+#include <QIODevice>
+
+#include "../DebugProtocolV0/ApplicationLayerV0.h"
+#include "../DebugProtocolV0/PresentationLayerV0.h"
+#include "../DebugProtocolV0/TransportLayerV0.h"
+#include "../DebugProtocolV0/DebugProtocolV0Enums.h"
+
+static const int scanInterval = 1000;
+
+ProtocolMedium::ProtocolMedium(QObject *parent) :
+    Medium(parent),
+    m_decodeWorkers(ChannelDataDecoder::defaultWorkers())
+{
+    m_availableProtocols.append("DebugProtocol V0");
+
+    QObject::connect(&m_scanTimer, &QTimer::timeout, this, [&]()
+    {
+        if (m_cpuListModel.rowCount(QModelIndex()) == 0)
+        {
+            scanForCpu();
+        }
+        else
+        {
+            m_scanTimer.stop();
+        }
+    });
+
+    QObject::connect(&m_cpuListModel,&CpuListModel::newRegistersFound,this,[&](const QVector<Register*>& newRegisters)
+    {
+       for (auto newRegister : newRegisters)
+       {
+           connectRegister(newRegister);
+           QObject::connect(newRegister,&Register::writeRegister,&m_writeCoalescer,&WriteCoalescer::writeRequested);
+           QObject::connect(newRegister,&QObject::destroyed,&m_writeCoalescer,&WriteCoalescer::removeRegister);
+           QObject::connect(newRegister,&Register::pollRateChanged,&m_pollScheduler,&PollScheduler::updateRegister);
+           QObject::connect(newRegister,&Register::queryResponseReceived,&m_pollScheduler,&PollScheduler::receivedQueryResponse);
+           QObject::connect(newRegister,&QObject::destroyed,&m_pollScheduler,&PollScheduler::removeRegister);
+           QObject::connect(newRegister,&Register::subscriptionChanged,&m_subscriptionManager,&SubscriptionManager::subscriptionChanged);
+           QObject::connect(newRegister,&QObject::destroyed,&m_subscriptionManager,&SubscriptionManager::removeRegister);
+           m_subscriptionManager.addRegister(*newRegister);
+       }
+       m_registerListModel.append(newRegisters);
+    });
+}
+
+void ProtocolMedium::setProtocolVersion(int availableProtocolVersionIndex)
+{
+    if(availableProtocolVersionIndex < m_availableProtocols.size())
+    {
+        m_selectedProtocolVersion = availableProtocolVersionIndex;
+    }
+}
+
+void ProtocolMedium::setSampleSink(SampleSink *sink, quint16 source)
+{
+    m_sampleSink = sink;
+    m_sampleSource = source;
+    if (m_presentationLayer != nullptr)
+    {
+        m_presentationLayer->setSampleSink(sink, source);
+    }
+}
+
+void ProtocolMedium::setDecodeWorkers(int workers)
+{
+    workers = qMax(0, workers);
+    if (workers == m_decodeWorkers)
+    {
+        return;
+    }
+    m_decodeWorkers = workers;
+    if (m_ownDecoder != nullptr)
+    {
+        //Frames that are still queued on the previous workers are dropped
+        ChannelDataDecoder* previousDecoder = m_ownDecoder;
+        m_ownDecoder = nullptr;
+        applyChannelDataDecoder();
+        delete previousDecoder;
+    }
+    else
+    {
+        applyChannelDataDecoder();
+    }
+}
+
+int ProtocolMedium::decodeWorkers() const
+{
+    ChannelDataDecoder* decoder = channelDataDecoder();
+    return decoder != nullptr ? decoder->workers() : m_decodeWorkers;
+}
+
+void ProtocolMedium::setCpuRateLimit(double bytesPerSecond, double framesPerSecond)
+{
+    m_cpuBytesPerSecond = qMax(0.0, bytesPerSecond);
+    m_cpuFramesPerSecond = qMax(0.0, framesPerSecond);
+    if (m_commandQueue != nullptr)
+    {
+        m_commandQueue->setDefaultCpuRateLimit(m_cpuBytesPerSecond, m_cpuFramesPerSecond);
+    }
+}
+
+qint64 ProtocolMedium::throttledTime() const
+{
+    return m_throttledTime + (m_commandQueue != nullptr ? m_commandQueue->throttledTime() : 0);
+}
+
+void ProtocolMedium::setChannelDataDecoder(ChannelDataDecoder *decoder)
+{
+    m_sharedDecoder = decoder;
+    if (m_sharedDecoder != nullptr && m_ownDecoder != nullptr)
+    {
+        ChannelDataDecoder* previousDecoder = m_ownDecoder;
+        m_ownDecoder = nullptr;
+        applyChannelDataDecoder();
+        delete previousDecoder;
+    }
+    else
+    {
+        applyChannelDataDecoder();
+    }
+}
+
+ChannelDataDecoder *ProtocolMedium::channelDataDecoder() const
+{
+    return m_sharedDecoder != nullptr ? m_sharedDecoder.data() : m_ownDecoder;
+}
+
+void ProtocolMedium::applyChannelDataDecoder()
+{
+    if (m_presentationLayer == nullptr)
+    {
+        return;
+    }
+    if (m_sharedDecoder == nullptr && m_ownDecoder == nullptr && m_decodeWorkers > 0)
+    {
+        m_ownDecoder = new ChannelDataDecoder(m_decodeWorkers, this);
+    }
+    ChannelDataDecoder* decoder = channelDataDecoder();
+    static_cast<PresentationLayerV0*>(m_presentationLayer)->setChannelDataDecoder(decoder);
+    //The decode workers also check the CRC of the channel data
+    m_transportLayer->setChannelDataUnchecked(decoder != nullptr);
+}
+
+void ProtocolMedium::createProtocolLayers()
+{
+    switch(m_selectedProtocolVersion)
+    {
+        case 0:  createDebugProtocolV0Layers(); break;
+    }
+
+    connectLayers();
+}
+
+void ProtocolMedium::createDebugProtocolV0Layers()
+{
+    destroyProtocolLayers();
+    m_transportLayer = new TransportLayerV0(this);
+    m_presentationLayer = new PresentationLayerV0(m_cpuListModel,m_registerListModel,this);
+    m_presentationLayer->setSampleSink(m_sampleSink, m_sampleSource);
+    applyChannelDataDecoder();
+    m_applicationLayer = new ApplicationLayerV0(static_cast<PresentationLayerV0&>(*m_presentationLayer),this);
+    m_commandQueue = new CommandQueue(*m_transportLayer,this);
+    m_commandQueue->setDefaultCpuRateLimit(m_cpuBytesPerSecond, m_cpuFramesPerSecond);
+}
+
+void ProtocolMedium::connectLayers()
+{
+    QObject::connect(m_transportLayer,&TransportLayerBase::receivedDebugProtocolCommand,
+                     m_presentationLayer,&PresentationLayerBase::receivedDebugProtocolCommand);
+    QObject::connect(m_transportLayer,&TransportLayerBase::receivedChannelDataFrame,
+                     m_presentationLayer,&PresentationLayerBase::receivedChannelDataFrame);
+    QObject::connect(m_transportLayer,&TransportLayerBase::write, this, [&](const QByteArray& message)
+    {
+        writeData(message);
+    });
+    QObject::connect(m_commandQueue,&CommandQueue::backpressureChanged,this,&ProtocolMedium::backpressureChanged);
+    QObject::connect(m_transportLayer,&TransportLayerBase::frameReceived,
+                     &m_bandwidthEstimator,&BandwidthEstimator::receivedFrame);
+    QObject::connect(m_presentationLayer,&PresentationLayerBase::newDebugProtocolCommand,
+                     m_commandQueue,&CommandQueue::enqueue);
+    QObject::connect(&m_writeCoalescer,&WriteCoalescer::writeRegister,
+                     m_applicationLayer,&ApplicationLayerBase::writeRegisterValue);
+    QObject::connect(m_transportLayer,&TransportLayerBase::requestCompleted,
+                     m_applicationLayer,&ApplicationLayerBase::requestCompleted);
+    QObject::connect(m_transportLayer,&TransportLayerBase::requestFailed,
+                     m_applicationLayer,&ApplicationLayerBase::requestFailed);
+    QObject::connect(m_transportLayer,&TransportLayerBase::requestTimedOut,this,&ProtocolMedium::requestTimedOut);
+    QObject::connect(m_presentationLayer,&PresentationLayerBase::newCpuFound,this, [&](Cpu* newCpu)
+    {
+        if (!m_cpuListModel.contains(newCpu->id()))
+        {
+            connectCpu(newCpu);
+            m_cpuListModel.append(newCpu);
+            m_bandwidthEstimator.addCpu(*newCpu);
+        }
+    });
+    QObject::connect(m_presentationLayer,&PresentationLayerBase::cpuRestored,this,&ProtocolMedium::restoreCpu);
+    QObject::connect(m_presentationLayer,&PresentationLayerBase::cpuIdentityChanged,this, [&]()
+    {
+        //The Registers of the known Cpu`s do not apply anymore, find all Cpu`s again
+        clearModels();
+        scanForCpu();
+    });
+}
+
+void ProtocolMedium::connectRegister(Register *newRegister)
+{
+    if (m_applicationLayer != nullptr)
+    {
+        //Unique, a Register that is restored can still be connected to the same layers
+        QObject::connect(newRegister,QOverload<Register&>::of(&Register::queryRegister),m_applicationLayer,&ApplicationLayerBase::queryRegister,Qt::UniqueConnection);
+        QObject::connect(newRegister,&Register::pollRegister,m_applicationLayer,&ApplicationLayerBase::pollRegister,Qt::UniqueConnection);
+    }
+}
+
+void ProtocolMedium::connectCpu(Cpu *cpu)
+{
+    QObject::connect(cpu,&Cpu::resetTime,m_applicationLayer,&ApplicationLayerBase::resetTime,Qt::UniqueConnection);
+    QObject::connect(cpu,QOverload<Cpu&>::of(&Cpu::setDecimation),m_applicationLayer,&ApplicationLayerBase::setDecimation,Qt::UniqueConnection);
+    QObject::connect(&cpu->channelMultiplexer(),&ChannelMultiplexer::configChannel,m_applicationLayer,&ApplicationLayerBase::configDebugChannel,Qt::UniqueConnection);
+    QObject::connect(&cpu->channelMultiplexer(),&ChannelMultiplexer::burstStarted,m_commandQueue,&CommandQueue::beginBatch,Qt::UniqueConnection);
+    QObject::connect(&cpu->channelMultiplexer(),&ChannelMultiplexer::burstFinished,m_commandQueue,&CommandQueue::endBatch,Qt::UniqueConnection);
+}
+
+void ProtocolMedium::restoreCpu(Cpu *cpu)
+{
+    connectCpu(cpu);
+    m_bandwidthEstimator.addCpu(*cpu);
+    for (auto cpuRegister : m_registerListModel)
+    {
+        if (&cpuRegister->cpu() == cpu)
+        {
+            connectRegister(cpuRegister);
+            if (cpuRegister->isPolled())
+            {
+                m_pollScheduler.updateRegister(*cpuRegister);
+            }
+        }
+    }
+
+    //The decimation and all debug channels in one write
+    m_commandQueue->beginBatch();
+    if (cpu->decimation() > 0)
+    {
+        cpu->setDecimation(cpu->decimation());
+    }
+    cpu->channelMultiplexer().synchronize();
+    m_commandQueue->endBatch();
+
+    //The Cpu is the same one, the writes that were kept during the reconnect apply to it
+    m_writeCoalescer.resume();
+}
+
+void ProtocolMedium::requestTimedOut(uint8_t uCId, uint8_t msgId, QVector<uint8_t> messageVector)
+{
+    Q_UNUSED(msgId)
+    if (messageVector.size() < 5 || messageVector.first() != DebugProtocolV0Enums::WriteRegister)
+    {
+        return;
+    }
+
+    uint32_t offset = static_cast<uint32_t>(messageVector.at(1)) |
+                      static_cast<uint32_t>(messageVector.at(2)) << 8 |
+                      static_cast<uint32_t>(messageVector.at(3)) << 16 |
+                      static_cast<uint32_t>(messageVector.at(4)) << 24;
+    Register* writtenRegister = m_registerListModel.getRegisterByCpuIdAndOffset(uCId, static_cast<int32_t>(offset));
+    if (writtenRegister != nullptr)
+    {
+        m_writeCoalescer.retry(*writtenRegister);
+    }
+}
+
+void ProtocolMedium::receivedData(const QByteArray &data)
+{
+    if (m_transportLayer != nullptr)
+    {
+        m_transportLayer->receivedData(data);
+    }
+}
+
+void ProtocolMedium::connectionOpened()
+{
+    if(m_presentationLayer != nullptr)
+    {
+        scanForCpu();
+        m_scanTimer.start(scanInterval);
+        setConnected(true);
+    }
+}
+
+void ProtocolMedium::scanForCpu()
+{
+    if (m_presentationLayer != nullptr)
+    {
+        static_cast<PresentationLayerV0*>(m_presentationLayer)->scanForCpu();
+    }
+}
+
+void ProtocolMedium::writeToDevice(QIODevice &device, const QByteArray &data)
+{
+    device.write(data);
+    if (device.bytesToWrite() > m_writeBufferThreshold && m_commandQueue != nullptr)
+    {
+        m_commandQueue->setBackpressure(true);
+    }
+}
+
+void ProtocolMedium::deviceBytesWritten(QIODevice &device)
+{
+    if (m_commandQueue != nullptr && m_commandQueue->isBackpressure() &&
+        device.bytesToWrite() < m_writeBufferThreshold / 2)
+    {
+        m_commandQueue->setBackpressure(false);
+    }
+}
+
+void ProtocolMedium::connectionClosed()
+{
+    m_scanTimer.stop();
+    setConnected(false);
+    m_reconnectScheduler.connectionLost();
+}
+
+void ProtocolMedium::connectionError(const QString &error)
+{
+    m_scanTimer.stop();
+    emit errorOccured(error);
+    qDebug() << error;
+    m_reconnectScheduler.connectionLost();
+}
+
+void ProtocolMedium::clearPendingCommands()
+{
+    m_pollScheduler.clear();
+    m_writeCoalescer.hold();
+}
+
+void ProtocolMedium::clearModels()
+{
+    m_pollScheduler.clear();
+    m_writeCoalescer.clear();
+    m_subscriptionManager.clear();
+    m_bandwidthEstimator.clear();
+    m_cpuListModel.clear();
+    m_registerListModel.clear();
+}
+
+void ProtocolMedium::destroyProtocolLayers()
+{
+    m_scanTimer.stop();
+    if (m_commandQueue != nullptr)
+    {
+        if (m_commandQueue->isBackpressure())
+        {
+            emit backpressureChanged(false);
+        }
+        m_throttledTime += m_commandQueue->throttledTime();
+        m_commandQueue->deleteLater();
+        m_commandQueue = nullptr;
+    }
+    if (m_applicationLayer != nullptr)
+    {
+        m_applicationLayer->deleteLater();
+        m_applicationLayer = nullptr;
+    }
+    if (m_presentationLayer != nullptr)
+    {
+        m_presentationLayer->deleteLater();
+        m_presentationLayer = nullptr;
+    }
+    if (m_transportLayer != nullptr)
+    {
+        m_transportLayer->deleteLater();
+        m_transportLayer = nullptr;
+    }
+}
@@ -0,0 +1,183 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROTOCOLMEDIUM_H
+#define PROTOCOLMEDIUM_H
+
+#include <QStringList>
+#include <QTimer>
+#include <QPointer>
+#include "../../EmbeddedDebugger/Medium/Medium.h"
+
+class ApplicationLayerBase;
+class PresentationLayerBase;
+class TransportLayerBase;
+class CommandQueue;
+class SampleSink;
+class ChannelDataDecoder;
+
+/**
+ * @brief Medium that runs the debug protocol layers over a byte oriented connection.
+ *
+ * Creates and connects the transport, presentation and application layers and the CommandQueue,
+ * and wires the Cpu`s and Registers that are found to them. A derived medium only opens its
+ * connection, passes the received bytes to receivedData() and writes the frames of writeData().
+ * It reports the state of the connection with connectionOpened(), connectionClosed() and connectionError().
+ *
+ * The broadcast scan for Cpu`s is not retransmitted by the transport layer, so it is repeated until a
+ * Cpu answers. A medium that writes to a buffered QIODevice uses writeToDevice() and deviceBytesWritten()
+ * to pause the CommandQueue while the write buffer is full.
+ *
+ * The channel data is decoded on a pool of ChannelDataDecoder workers that the medium owns, with
+ * ChannelDataDecoder::defaultWorkers() threads unless told otherwise. The workers also feed the
+ * Register histories and the trigger engines, so the thread of the medium only applies the values.
+ */
+class ProtocolMedium : public Medium
+{
+    Q_OBJECT
+public:
+    explicit ProtocolMedium(QObject* parent = nullptr);
+
+    QStringList availableProtocolVersions() {return m_availableProtocols;}
+    TransportLayerBase* transportLayer() const {return m_transportLayer;}
+    ApplicationLayerBase* applicationLayer() const {return m_applicationLayer;}    /**< For the asynchronous requests, nullptr when not connected */
+    CommandQueue* commandQueue() const {return m_commandQueue;}
+
+    /**
+     * @brief Set the number of unwritten bytes above which sending is paused
+     * Sending resumes when less than half of it is left.
+     */
+    void setWriteBufferThreshold(qint64 bytes) {m_writeBufferThreshold = qMax<qint64>(1, bytes);}
+    qint64 writeBufferThreshold() const {return m_writeBufferThreshold;}
+
+    /**
+     * @brief Also append the decoded channel data to a sink that is shared with other media
+     * @param sink for the samples, nullptr for none, also applied to the connected layers.
+     * @param source that tells the samples of this medium apart in the sink.
+     */
+    void setSampleSink(SampleSink* sink, quint16 source);
+
+    /**
+     * @brief Decode the channel data of the Cpu`s on worker threads of the medium, sharded by Cpu id
+     * @param workers number of worker threads, 0 to decode on the thread of the medium.
+     */
+    void setDecodeWorkers(int workers);
+    int decodeWorkers() const;
+
+    /**
+     * @brief Decode on the workers of a decoder that is shared with other media instead of its own
+     * @param decoder that is not owned, nullptr to use the own workers again.
+     */
+    void setChannelDataDecoder(ChannelDataDecoder* decoder);
+    ChannelDataDecoder* channelDataDecoder() const;
+
+    /**
+     * @brief Default rate limit of the CommandQueue for every Cpu, kept when the layers are created again
+     */
+    void setCpuRateLimit(double bytesPerSecond, double framesPerSecond) override;
+    qint64 throttledTime() const override;
+
+public slots:
+    void setProtocolVersion(int availableProtocolVersionIndex);
+
+protected:
+    /**
+     * @brief Write bytes from the transport layer to the connection, a batch can hold several frames
+     */
+    virtual void writeData(const QByteArray& data) = 0;
+
+    /**
+     * @brief Write to a buffered device and pause sending when its write buffer is too full
+     */
+    void writeToDevice(QIODevice& device, const QByteArray& data);
+
+    /**
+     * @brief Connected to bytesWritten() of the device, resumes sending when the write buffer emptied
+     */
+    void deviceBytesWritten(QIODevice& device);
+
+    /**
+     * @brief Create the layers of the selected protocol version, the previous layers are destroyed
+     */
+    void createProtocolLayers();
+    void destroyProtocolLayers();
+
+    /**
+     * @brief Pass bytes that were read from the connection to the transport layer
+     */
+    void receivedData(const QByteArray& data);
+
+    /**
+     * @brief The connection is open, scans for the Cpu`s
+     */
+    void connectionOpened();
+
+    /**
+     * @brief The connection was closed or lost
+     */
+    void connectionClosed();
+
+    /**
+     * @brief The connection failed, also for a failed reconnect attempt
+     */
+    void connectionError(const QString& error);
+
+    /**
+     * @brief Send a broadcast GetVersion to find the Cpu`s
+     */
+    void scanForCpu();
+
+    /**
+     * @brief Drop the pending polls before a reconnect, the models are kept
+     * Writes are kept until a Cpu is restored on the new connection.
+     */
+    void clearPendingCommands();
+    void clearModels();
+
+private:
+    void createDebugProtocolV0Layers();
+    void applyChannelDataDecoder();
+    void connectLayers();
+    void connectRegister(Register* newRegister);
+    void connectCpu(Cpu* cpu);
+    void restoreCpu(Cpu* cpu);
+    void requestTimedOut(uint8_t uCId, uint8_t msgId, QVector<uint8_t> messageVector);
+
+protected:
+    ApplicationLayerBase* m_applicationLayer = nullptr;
+    PresentationLayerBase* m_presentationLayer = nullptr;
+    TransportLayerBase* m_transportLayer = nullptr;
+    CommandQueue* m_commandQueue = nullptr;         /**< Prioritized queues between the presentation and transport layer */
+    QStringList m_availableProtocols;
+    int m_selectedProtocolVersion = 0;
+
+private:
+    QTimer m_scanTimer;
+    SampleSink* m_sampleSink = nullptr;
+    quint16 m_sampleSource = 0;
+    int m_decodeWorkers;
+    ChannelDataDecoder* m_ownDecoder = nullptr;     /**< Started with the protocol layers */
+    QPointer<ChannelDataDecoder> m_sharedDecoder;
+    qint64 m_writeBufferThreshold = 64 * 1024;
+    double m_cpuBytesPerSecond = 0.0;
+    double m_cpuFramesPerSecond = 0.0;
+    qint64 m_throttledTime = 0;                     /**< Of the command queues of previous connections */
+};
+
+#endif // PROTOCOLMEDIUM_H
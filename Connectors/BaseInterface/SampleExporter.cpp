@@ -0,0 +1,123 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SampleExporter.h"
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+static const char fileMagic[] = "EDSMP";
+static const char fileVersion = 1;
+static const int sampleRecordSize = 1 + 2 + 1 + 1 + 4 + 4 + 8;
+
+SampleExporter::SampleExporter(SampleSink &sink, QObject *parent) :
+    QObject(parent),
+    m_sink(sink)
+{
+
+}
+
+SampleExporter::~SampleExporter()
+{
+    stop();
+}
+
+bool SampleExporter::start(const QString &fileName)
+{
+    stop();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Could not export samples to" << fileName << ":" << m_file.errorString();
+        return false;
+    }
+    m_file.write(fileMagic, static_cast<qint64>(strlen(fileMagic)));
+    m_file.write(&fileVersion, 1);
+    m_exportedSamples.storeRelease(0);
+    m_droppedSamples.storeRelease(0);
+
+    m_context = new QObject();
+    m_context->moveToThread(&m_thread);
+    connect(&m_sink, &SampleSink::samplesAvailable, m_context, [this]()
+    {
+        drain();
+    }, Qt::QueuedConnection);
+    m_thread.start();
+    //Samples that were appended before the connection was made
+    QMetaObject::invokeMethod(m_context, [this]()
+    {
+        drain();
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SampleExporter::stop()
+{
+    if (m_context == nullptr)
+    {
+        return;
+    }
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+    m_context = nullptr;
+
+    //The export thread is done, the rest is written here
+    drain();
+    m_file.close();
+}
+
+void SampleExporter::drain()
+{
+    quint64 dropped = 0;
+    QVector<DecodedSample> samples = m_sink.takeSamples(&dropped);
+    if (samples.isEmpty() && dropped == 0)
+    {
+        return;
+    }
+
+    QByteArray records(samples.size() * sampleRecordSize + (dropped > 0 ? 9 : 0), Qt::Uninitialized);
+    uchar* record = reinterpret_cast<uchar*>(records.data());
+    for (const auto& sample : qAsConst(samples))
+    {
+        quint64 valueBits;
+        std::memcpy(&valueBits, &sample.value, sizeof(valueBits));
+        record[0] = SampleRecord;
+        qToLittleEndian<quint16>(sample.source, record + 1);
+        record[3] = sample.cpuId;
+        record[4] = sample.channel;
+        qToLittleEndian<quint32>(sample.registerId, record + 5);
+        qToLittleEndian<quint32>(sample.timeStamp, record + 9);
+        qToLittleEndian<quint64>(valueBits, record + 13);
+        record += sampleRecordSize;
+    }
+    if (dropped > 0)
+    {
+        //The dropped samples came after the samples that were taken with them
+        record[0] = GapRecord;
+        qToLittleEndian<quint64>(dropped, record + 1);
+    }
+    m_file.write(records);
+
+    m_exportedSamples.fetchAndAddRelease(static_cast<quint64>(samples.size()));
+    if (dropped > 0)
+    {
+        m_droppedSamples.fetchAndAddRelease(dropped);
+        emit samplesDropped(dropped);
+    }
+}
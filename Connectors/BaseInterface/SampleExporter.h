@@ -0,0 +1,86 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLEEXPORTER_H
+#define SAMPLEEXPORTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QThread>
+#include <QAtomicInteger>
+#include "SampleSink.h"
+
+/**
+ * @brief Writes the samples of a SampleSink to a binary file on its own thread.
+ *
+ * The sink is drained on the export thread every time it has samples, so the decode workers that
+ * fill it never wait for the disk. Samples that the sink dropped because the export fell behind are
+ * written as a gap record after the samples that were taken before them, and reported with
+ * samplesDropped().
+ *
+ * File layout: "EDSMP" followed by a version byte, then records of [type (1 byte), payload].
+ * Sample payload: [source (2 bytes LE), Cpu id, channel, register id (4 bytes LE),
+ * time stamp (4 bytes LE), value (8 bytes, IEEE 754 double LE)].
+ * Gap payload: [number of dropped samples (8 bytes LE)].
+ */
+class SampleExporter : public QObject
+{
+    Q_OBJECT
+public:
+    enum RecordType{
+        SampleRecord = 'S',
+        GapRecord = 'G'
+    };
+
+    explicit SampleExporter(SampleSink& sink, QObject* parent = nullptr);
+    virtual ~SampleExporter();
+
+    /**
+     * @brief Start exporting to a file, an existing file is overwritten.
+     * @return false if the file could not be opened.
+     */
+    bool start(const QString& fileName);
+
+    /**
+     * @brief Write the samples that are still in the sink and close the file.
+     */
+    void stop();
+
+    bool isExporting() const {return m_thread.isRunning();}
+    quint64 exportedSamples() const {return m_exportedSamples.loadAcquire();}
+    quint64 droppedSamples() const {return m_droppedSamples.loadAcquire();}
+
+signals:
+    /**
+     * @brief Emitted from the export thread when the sink dropped samples
+     */
+    void samplesDropped(quint64 dropped);
+
+private:
+    void drain();
+
+private:
+    SampleSink& m_sink;
+    QThread m_thread;
+    QObject* m_context = nullptr;       /**< Lives in the export thread, runs drain() */
+    QFile m_file;                       /**< Only used by the export thread while it runs */
+    QAtomicInteger<quint64> m_exportedSamples;
+    QAtomicInteger<quint64> m_droppedSamples;
+};
+
+#endif // SAMPLEEXPORTER_H
@@ -0,0 +1,81 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SampleSink.h"
+#include <QMutexLocker>
+
+SampleSink::SampleSink(int capacity, QObject *parent) :
+    QObject(parent),
+    m_capacity(capacity)
+{
+
+}
+
+void SampleSink::append(const QVector<DecodedSample> &samples)
+{
+    bool wasEmpty;
+    {
+        QMutexLocker locker(&m_mutex);
+        wasEmpty = m_samples.isEmpty();
+        int accepted = qMin(samples.size(), m_capacity - m_samples.size());
+        if (accepted == samples.size())
+        {
+            m_samples.append(samples);
+        }
+        else if (accepted > 0)
+        {
+            m_samples.append(samples.mid(0, accepted));
+        }
+        accepted = qMax(0, accepted);
+        auto dropped = static_cast<quint64>(samples.size() - accepted);
+        m_appendedSamples += static_cast<quint64>(accepted);
+        m_droppedSamples += dropped;
+        m_droppedSinceTake += dropped;
+    }
+    if (wasEmpty && !samples.isEmpty())
+    {
+        emit samplesAvailable();
+    }
+}
+
+QVector<DecodedSample> SampleSink::takeSamples(quint64 *dropped)
+{
+    QVector<DecodedSample> samples;
+    QMutexLocker locker(&m_mutex);
+    samples.swap(m_samples);
+    //Samples are only dropped while the sink is full, so they came after all samples that are taken
+    if (dropped != nullptr)
+    {
+        *dropped = m_droppedSinceTake;
+    }
+    m_droppedSinceTake = 0;
+    return samples;
+}
+
+quint64 SampleSink::appendedSamples() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_appendedSamples;
+}
+
+quint64 SampleSink::droppedSamples() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedSamples;
+}
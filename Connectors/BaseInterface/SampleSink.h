@@ -0,0 +1,88 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SAMPLESINK_H
+#define SAMPLESINK_H
+
+#include <QObject>
+#include <QMutex>
+#include <QVector>
+class Register;
+
+/**
+ * @brief A channel data sample after decoding.
+ */
+struct DecodedSample
+{
+    Register* sampleRegister;   /**< Only to be used on the thread that owns the Register */
+    uint registerId;            /**< Id of the Register on its Cpu, for consumers on other threads */
+    uint timeStamp;
+    double value;
+    quint16 source;             /**< Connection the sample came from, see ProtocolMedium::setSampleSink() */
+    uint8_t cpuId;
+    uint8_t channel;
+};
+Q_DECLARE_TYPEINFO(DecodedSample, Q_PRIMITIVE_TYPE);
+
+/**
+ * @brief Shared output for the decoded channel data of several connections.
+ *
+ * The presentation layers append the samples of a frame at once, from any thread. A consumer takes
+ * all pending samples when samplesAvailable() is emitted, which happens once until they are taken,
+ * so a burst of frames costs one notification. When the consumer falls behind by more than the
+ * capacity, new samples are dropped and counted instead of growing without bound. The consumer is
+ * told how many samples were dropped after the samples it takes, so it can mark the gap.
+ */
+class SampleSink : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SampleSink(int capacity = 1 << 20, QObject* parent = nullptr);
+
+    /**
+     * @brief Append samples, thread safe
+     */
+    void append(const QVector<DecodedSample>& samples);
+
+    /**
+     * @brief Take all pending samples, thread safe
+     * @param dropped if not nullptr, set to the number of samples that were dropped after the
+     * taken samples, since the previous take.
+     */
+    QVector<DecodedSample> takeSamples(quint64* dropped = nullptr);
+
+    quint64 appendedSamples() const;
+    quint64 droppedSamples() const;
+
+signals:
+    /**
+     * @brief Emitted from the appending thread when samples are pending
+     */
+    void samplesAvailable();
+
+private:
+    mutable QMutex m_mutex;
+    QVector<DecodedSample> m_samples;
+    int m_capacity;
+    quint64 m_appendedSamples = 0;
+    quint64 m_droppedSamples = 0;
+    quint64 m_droppedSinceTake = 0;
+};
+
+#endif // SAMPLESINK_H
@@ -20,6 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TRANSPORTLAYERBASE_H
 
 #include <QObject>
+#include <QVector>
+#include <QByteArray>
+#include <QList>
+#include <limits>
 
 class TransportLayerBase : public QObject
 {
@@ -28,14 +32,144 @@ public:
     explicit TransportLayerBase(QObject* parent = nullptr) :
         QObject(parent){}
 
+    quint64 receivedBytes() const {return m_receivedBytes;}
+    quint64 receivedFrames() const {return m_receivedFrames;}     /**< Including channel data that is handed on unchecked */
+    quint64 invalidFrames() const {return m_invalidFrames;}
+    quint64 sentFrames() const {return m_sentFrames;}
+    quint64 retransmittedFrames() const {return m_retransmittedFrames;}
+    quint64 timedOutRequests() const {return m_timedOutRequests;}
+    quint64 duplicateFrames() const {return m_duplicateFrames;}
+
+    /**
+     * @brief Number of requests to a Cpu that can be sent before they have to wait for responses
+     * @param burst true for the commands of a configuration burst, they may use places beyond the window.
+     */
+    virtual int availableWindow(uint8_t uCId, bool burst = false) const {Q_UNUSED(uCId); Q_UNUSED(burst); return std::numeric_limits<int>::max();}
+
+    /**
+     * @brief Cpus with retransmissions that wait for sendRetransmission()
+     * Retransmissions are not written by the transport layer itself, so they pass the same rate
+     * limits and backpressure as new commands.
+     */
+    virtual QList<uint8_t> retransmissionCpus() const {return QList<uint8_t>();}
+
+    /**
+     * @brief Size in bytes of the next retransmission to a Cpu, 0 when there is none
+     */
+    virtual int nextRetransmissionSize(uint8_t uCId) {Q_UNUSED(uCId); return 0;}
+
+    /**
+     * @brief Write the next retransmission to a Cpu
+     */
+    virtual void sendRetransmission(uint8_t uCId) {Q_UNUSED(uCId);}
+
+    /**
+     * @brief Hand channel data on unchecked with receivedChannelDataFrame()
+     * Removing the escape characters and checking the CRC is then left to the receiver, which can
+     * do it on worker threads.
+     */
+    void setChannelDataUnchecked(bool unchecked) {m_channelDataUnchecked = unchecked;}
+    bool isChannelDataUnchecked() const {return m_channelDataUnchecked;}
+
+    /**
+     * @brief Collect the frames that are sent until the matching endBatch() into a single write()
+     * Batches can be nested.
+     */
+    void beginBatch() {m_batchDepth++;}
+    void endBatch()
+    {
+        if (m_batchDepth > 0 && --m_batchDepth == 0 && !m_batch.isEmpty())
+        {
+            QByteArray batch;
+            batch.swap(m_batch);
+            emit write(batch);
+        }
+    }
+
 signals:
     void receivedDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> messageVector);
+
+    /**
+     * @brief Emitted instead of receivedDebugProtocolCommand() for channel data when setChannelDataUnchecked() is set
+     * @param frame the bytes between STX and ETX as received, with escape characters and CRC.
+     */
+    void receivedChannelDataFrame(uint8_t uCId, QByteArray frame);
     void write(const QByteArray& message);
 
+    /**
+     * @brief Emitted for every received frame, used to measure the link usage per Cpu
+     * @param frameSize in bytes on the medium, including framing and escape characters.
+     * @param valid false if the CRC was incorrect, the uC id may then be corrupted as well.
+     */
+    void frameReceived(uint8_t uCId, int frameSize, bool valid);
+
+    /**
+     * @brief Emitted when a request got no response after all retransmissions
+     * @param messageVector the protocol command that was sent.
+     */
+    void requestTimedOut(uint8_t uCId, uint8_t msgId, QVector<uint8_t> messageVector);
+
+    /**
+     * @brief Emitted after the response to a request sent with sendDebugProtocolRequest() was handled
+     * @param messageVector the protocol command of the response.
+     */
+    void requestCompleted(quint32 requestId, QVector<uint8_t> messageVector);
+
+    /**
+     * @brief Emitted when a request sent with sendDebugProtocolRequest() got no response
+     */
+    void requestFailed(quint32 requestId);
+
+    /**
+     * @brief Emitted when a request to a Cpu finished, so its window has room again
+     */
+    void windowAvailable(uint8_t uCId);
+
+    /**
+     * @brief Emitted when requests timed out and wait for sendRetransmission()
+     */
+    void retransmissionsDue();
+
 public slots:
     virtual void sendDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> messageVector) = 0;
+
+    /**
+     * @brief Send a command that needs a response, its outcome is reported with requestCompleted() or requestFailed()
+     * @param requestId chosen by the caller to recognize the response, not 0.
+     * @param burst true for the commands of a configuration burst, see availableWindow().
+     */
+    virtual void sendDebugProtocolRequest(uint8_t uCId, QVector<uint8_t> messageVector, quint32 requestId, bool burst = false) = 0;
     virtual void receivedData(QByteArray message) = 0;
 
+protected:
+    /**
+     * @brief Write a frame to the medium, or add it to the current batch
+     */
+    void writeFrame(const QByteArray& frame)
+    {
+        if (m_batchDepth > 0)
+        {
+            m_batch.append(frame);
+        }
+        else
+        {
+            emit write(frame);
+        }
+    }
+
+protected:
+    quint64 m_receivedBytes = 0;    /**< Bytes received from the medium */
+    quint64 m_receivedFrames = 0;   /**< Frames with a correct CRC */
+    quint64 m_invalidFrames = 0;    /**< Frames that were dropped because of a CRC error */
+    quint64 m_sentFrames = 0;
+    quint64 m_retransmittedFrames = 0;
+    quint64 m_timedOutRequests = 0;     /**< Requests that got no response after all retransmissions */
+    quint64 m_duplicateFrames = 0;      /**< Responses to a request that was already answered */
+    bool m_channelDataUnchecked = false;
+
+private:
+    QByteArray m_batch;
+    int m_batchDepth = 0;
 };
 
 
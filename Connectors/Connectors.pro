@@ -1,2 +1,9 @@
 TEMPLATE    = subdirs
-SUBDIRS	= TCP
\ No newline at end of file
+SUBDIRS	= ProtocolCore \
+    TCP \
+    UDP \
+    Serial \
+    Loopback
+
+# The multi target medium uses epoll
+linux: SUBDIRS += MultiTarget
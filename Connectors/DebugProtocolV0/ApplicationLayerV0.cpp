@@ -24,6 +24,45 @@ ApplicationLayerV0::ApplicationLayerV0(PresentationLayerV0& presentationLayerV0,
 {
 }
 
+ApplicationLayerV0::~ApplicationLayerV0()
+{
+    //Nobody may wait forever for a response that can not arrive anymore
+    for (auto& query : m_pendingQueries)
+    {
+        query.future.reportCanceled();
+        query.future.reportFinished();
+    }
+    for (auto& write : m_pendingWrites)
+    {
+        write.reportCanceled();
+        write.reportFinished();
+    }
+}
+
+QFuture<QVariant> ApplicationLayerV0::queryRegisterAsync(Register &registerToRead)
+{
+    quint32 requestId = nextRequestId();
+    PendingQuery& query = m_pendingQueries[requestId];
+    query.queryRegister = &registerToRead;
+    query.future.reportStarted();
+    QFuture<QVariant> future = query.future.future();
+
+    //Registered before sending, the outcome can be reported before this returns
+    m_presentationLayer.queryRegister(registerToRead, CommandLane::Bulk, requestId);
+    return future;
+}
+
+QFuture<bool> ApplicationLayerV0::writeRegisterAsync(Register &registerToWrite, const QVariant &value)
+{
+    quint32 requestId = nextRequestId();
+    QFutureInterface<bool>& write = m_pendingWrites[requestId];
+    write.reportStarted();
+    QFuture<bool> future = write.future();
+
+    m_presentationLayer.writeRegister(registerToWrite, value, CommandLane::Bulk, requestId);
+    return future;
+}
+
 void ApplicationLayerV0::scanForCpu()
 {
     m_presentationLayer.scanForCpu();
@@ -34,19 +73,29 @@ void ApplicationLayerV0::queryRegister(const Register &registerToRead)
     m_presentationLayer.queryRegister(registerToRead);
 }
 
+void ApplicationLayerV0::pollRegister(const Register &registerToPoll)
+{
+    m_presentationLayer.queryRegister(registerToPoll, CommandLane::Poll);
+}
+
 void ApplicationLayerV0::writeRegister(const Register &registerToWrite)
 {
     m_presentationLayer.writeRegister(registerToWrite);
 }
 
+void ApplicationLayerV0::writeRegisterValue(const Register &registerToWrite, const QVariant &value)
+{
+    m_presentationLayer.writeRegister(registerToWrite, value, CommandLane::Interactive, 0);
+}
+
 void ApplicationLayerV0::resetTime(const Cpu& cpu)
 {
     m_presentationLayer.resetTime(cpu.id());
 }
 
-void ApplicationLayerV0::configDebugChannel(Register &registerToConfigDebugChannel)
+void ApplicationLayerV0::configDebugChannel(const Cpu& cpu, int channel, const Register* channelRegister)
 {
-    m_presentationLayer.configDebugChannel(registerToConfigDebugChannel);
+    m_presentationLayer.configDebugChannel(cpu.id(), static_cast<uint8_t>(channel), channelRegister);
 }
 
 void ApplicationLayerV0::getDecimation(const Cpu& cpu)
@@ -58,3 +107,67 @@ void ApplicationLayerV0::setDecimation(const Cpu& cpu)
 {
     m_presentationLayer.setDecimation(cpu.id(),cpu.decimation());
 }
+
+void ApplicationLayerV0::requestCompleted(quint32 requestId, QVector<uint8_t> messageVector)
+{
+    auto query = m_pendingQueries.find(requestId);
+    if (query != m_pendingQueries.end())
+    {
+        //The value is decoded from the response, the Register may hold a value that was received later
+        QVariant value;
+        if (!query->queryRegister.isNull() && !messageVector.isEmpty())
+        {
+            value = PresentationLayerV0::queryRegisterValue(*query->queryRegister, messageVector.mid(1));
+        }
+        if (value.isValid())
+        {
+            query->future.reportResult(value);
+        }
+        else
+        {
+            //Register removed or a value that can not be decoded
+            query->future.reportCanceled();
+        }
+        query->future.reportFinished();
+        m_pendingQueries.erase(query);
+        return;
+    }
+
+    auto write = m_pendingWrites.find(requestId);
+    if (write != m_pendingWrites.end())
+    {
+        //Response is the command followed by the result, 0 is ok
+        write->reportResult(messageVector.size() >= 2 && messageVector.at(1) == 0x00);
+        write->reportFinished();
+        m_pendingWrites.erase(write);
+    }
+}
+
+void ApplicationLayerV0::requestFailed(quint32 requestId)
+{
+    auto query = m_pendingQueries.find(requestId);
+    if (query != m_pendingQueries.end())
+    {
+        query->future.reportCanceled();
+        query->future.reportFinished();
+        m_pendingQueries.erase(query);
+    }
+
+    auto write = m_pendingWrites.find(requestId);
+    if (write != m_pendingWrites.end())
+    {
+        write->reportCanceled();
+        write->reportFinished();
+        m_pendingWrites.erase(write);
+    }
+}
+
+quint32 ApplicationLayerV0::nextRequestId()
+{
+    m_requestId++;
+    if (m_requestId == 0)
+    {
+        m_requestId++;
+    }
+    return m_requestId;
+}
@@ -21,12 +21,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../BaseInterface/ApplicationLayerBase.h"
 #include "PresentationLayerV0.h"
+#include <QFutureInterface>
+#include <QHash>
+#include <QPointer>
 
 class ApplicationLayerV0 : public ApplicationLayerBase
 {
     Q_OBJECT
 public:
     explicit ApplicationLayerV0(PresentationLayerV0& presentationLayerV0, QObject *parent = nullptr);
+    virtual ~ApplicationLayerV0();
+
+    /**
+    * @copydoc ApplicationLayerBase::queryRegisterAsync()
+    */
+    QFuture<QVariant> queryRegisterAsync(Register& registerToRead) override;
+
+    /**
+    * @copydoc ApplicationLayerBase::writeRegisterAsync()
+    */
+    QFuture<bool> writeRegisterAsync(Register& registerToWrite, const QVariant& value) override;
 
 public slots:
     /**
@@ -39,11 +53,21 @@ public slots:
     */
     void queryRegister(const Register& registerToRead) override;
 
+    /**
+    * @copydoc ApplicationLayerBase::pollRegister()
+    */
+    void pollRegister(const Register& registerToPoll) override;
+
     /**
     * @copydoc ApplicationLayerBase::writeRegister()
     */
     void writeRegister(const Register& registerToWrite) override;
 
+    /**
+    * @copydoc ApplicationLayerBase::writeRegisterValue()
+    */
+    void writeRegisterValue(const Register& registerToWrite, const QVariant& value) override;
+
     /**
     * @copydoc ApplicationLayerBase::resetTime()
     */
@@ -52,7 +76,7 @@ public slots:
     /**
     * @copydoc ApplicationLayerBase::configDebugChannel()
     */
-    void configDebugChannel(Register& registerToConfigDebugChannel) override;
+    void configDebugChannel(const Cpu& cpu, int channel, const Register* channelRegister) override;
 
     /**
     * @copydoc ApplicationLayerBase::getDecimation()
@@ -64,8 +88,30 @@ public slots:
     */
     void setDecimation(const Cpu& cpu) override;
 
+    /**
+    * @copydoc ApplicationLayerBase::requestCompleted()
+    */
+    void requestCompleted(quint32 requestId, QVector<uint8_t> messageVector) override;
+
+    /**
+    * @copydoc ApplicationLayerBase::requestFailed()
+    */
+    void requestFailed(quint32 requestId) override;
+
+private:
+    struct PendingQuery
+    {
+        QPointer<Register> queryRegister;   /**< Null when the Register was destroyed while waiting */
+        QFutureInterface<QVariant> future;
+    };
+
+    quint32 nextRequestId();
+
 private:
     PresentationLayerV0& m_presentationLayer; /**< Reference to PresentationLayerV0 for easy access this class*/
+    QHash<quint32, PendingQuery> m_pendingQueries;
+    QHash<quint32, QFutureInterface<bool>> m_pendingWrites;
+    quint32 m_requestId = 0;
 };
 
 #endif // APPLICATIONLAYERV0_H
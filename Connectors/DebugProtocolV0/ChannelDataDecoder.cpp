@@ -0,0 +1,301 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ChannelDataDecoder.h"
+#include "TransportLayerV0.h"
+#include "DebugProtocolV0Enums.h"
+#include "Medium/CPU/TriggerEngine.h"
+#include <QThread>
+#include <cstring>
+
+ChannelDataDecoder::ChannelDataDecoder(int workers, QObject *parent) :
+    QObject(parent)
+{
+    connect(this, &ChannelDataDecoder::framesPending, this, &ChannelDataDecoder::dispatch, Qt::QueuedConnection);
+    for (int i = 0; i < qMax(1, workers); i++)
+    {
+        auto shard = new Shard();
+        shard->thread = new QThread();
+        shard->context = new QObject();
+        shard->context->moveToThread(shard->thread);
+        shard->thread->start();
+        m_shards.append(shard);
+    }
+}
+
+ChannelDataDecoder::~ChannelDataDecoder()
+{
+    //Frames that are still queued are dropped
+    for (auto shard : qAsConst(m_shards))
+    {
+        shard->thread->quit();
+        shard->thread->wait();
+        delete shard->context;
+        delete shard->thread;
+        delete shard;
+    }
+}
+
+int ChannelDataDecoder::defaultWorkers()
+{
+    return qBound(1, QThread::idealThreadCount() / 2, 4);
+}
+
+int ChannelDataDecoder::addClient(ChannelDataDecoder::Client *client)
+{
+    int id = m_nextClientId++;
+    m_clients.insert(id, client);
+    return id;
+}
+
+void ChannelDataDecoder::removeClient(int id)
+{
+    m_clients.remove(id);
+}
+
+int ChannelDataDecoder::frameSize(const Layout &layout, uint16_t mask)
+{
+    //Time stamp and mask
+    int size = 5;
+    for (int i = 0; i < layout.channels.size(); i++)
+    {
+        if ((mask >> i & 1) == 1)
+        {
+            if (layout.channels.at(i).size <= 0)
+            {
+                return -1;
+            }
+            size += layout.channels.at(i).size;
+        }
+    }
+    return size;
+}
+
+bool ChannelDataDecoder::unpack(ChannelDataDecoder::Frame &frame)
+{
+    if (!frame.receivedFrame.isEmpty())
+    {
+        QVector<uint8_t> messageVector;
+        if (!TransportLayerV0::unpackFrame(frame.receivedFrame.constData(), frame.receivedFrame.size(), messageVector) ||
+            messageVector.at(0) != frame.layout->cpuId || messageVector.at(2) != DebugProtocolV0Enums::ReadChannelData)
+        {
+            return false;
+        }
+        //Without uC id, msgId and command
+        frame.commandData = messageVector.mid(3);
+        frame.receivedFrame.clear();
+    }
+
+    if (frame.commandData.size() < 5)
+    {
+        return false;
+    }
+    auto mask = static_cast<uint16_t>(frame.commandData[3] | (frame.commandData[4] << 8));
+    int size = frameSize(*frame.layout, mask);
+    return size >= 0 && size <= frame.commandData.size();
+}
+
+void ChannelDataDecoder::decode(const Layout &layout, const QVector<uint8_t> &commandData, quint16 source, QVector<DecodedSample> &samples)
+{
+    auto time = static_cast<uint>((commandData[2] << 16) | (commandData[1] << 8) | commandData[0]);
+    auto mask = static_cast<uint16_t>(commandData[3] | (commandData[4] << 8));
+
+    //Channel values follow the mask in order of channel number
+    int dataIndex = 5;
+    for (int i = 0; i < layout.channels.size(); i++)
+    {
+        if ((mask >> i & 1) == 1)
+        {
+            const Channel& channel = layout.channels.at(i);
+            double value;
+            if (decodeValue(channel.type, channel.size, channel.isSigned, commandData.constData() + dataIndex, value))
+            {
+                samples.append({channel.channelRegister, channel.registerId, time, value, source, layout.cpuId, static_cast<uint8_t>(i)});
+            }
+            dataIndex += channel.size;
+        }
+    }
+}
+
+bool ChannelDataDecoder::decodeValue(Register::VariableType type, int size, bool isSigned, const uint8_t *data, double &value)
+{
+    if (size <= 0 || size > 8)
+    {
+        return false;
+    }
+
+    quint64 raw = 0;
+    for (int i = size - 1; i >= 0; i--)
+    {
+        raw = raw << 8 | data[i];
+    }
+
+    switch (type)
+    {
+    case Register::VariableType::Bool:
+    {
+        value = raw != 0 ? 1.0 : 0.0;
+        return true;
+    }
+    case Register::VariableType::Pointer:
+    case Register::VariableType::Char:
+    case Register::VariableType::Short:
+    case Register::VariableType::Int:
+    case Register::VariableType::Long:
+    {
+        if (isSigned && size < 8 && ((raw >> (size * 8 - 1)) & 1) == 1)
+        {
+            raw |= ~quint64(0) << (size * 8);
+        }
+        value = isSigned ? static_cast<double>(static_cast<qint64>(raw)) : static_cast<double>(raw);
+        return true;
+    }
+    case Register::VariableType::Float:
+    case Register::VariableType::Double:
+    case Register::VariableType::LongDouble:
+    {
+        //The size tells the format, a double is a float on some targets
+        if (size == 4)
+        {
+            auto bits = static_cast<quint32>(raw);
+            float floatValue;
+            std::memcpy(&floatValue, &bits, sizeof(floatValue));
+            value = static_cast<double>(floatValue);
+            return true;
+        }
+        if (size == 8)
+        {
+            std::memcpy(&value, &raw, sizeof(value));
+            return true;
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+void ChannelDataDecoder::feed(const Layout &layout, const QVector<DecodedSample> &samples)
+{
+    TriggerEngine* triggerEngine = layout.triggerEngine.data();
+    for (const auto& sample : samples)
+    {
+        const Channel& channel = layout.channels.at(sample.channel);
+        if (channel.history != nullptr)
+        {
+            channel.history->append(sample.timeStamp, sample.value);
+        }
+        if (triggerEngine != nullptr)
+        {
+            triggerEngine->process(channel.channelRegister, layout.guards.at(sample.channel), sample.timeStamp, sample.value);
+        }
+    }
+}
+
+QVariant ChannelDataDecoder::toVariant(Register::VariableType type, bool isSigned, double value)
+{
+    switch (type)
+    {
+    case Register::VariableType::Bool:
+        return QVariant(value != 0.0);
+    case Register::VariableType::Float:
+    case Register::VariableType::Double:
+    case Register::VariableType::LongDouble:
+        return QVariant(value);
+    default:
+        return isSigned ? QVariant(static_cast<qlonglong>(value)) : QVariant(static_cast<qulonglong>(value));
+    }
+}
+
+void ChannelDataDecoder::enqueue(int client, ChannelDataDecoder::Frame frame)
+{
+    //The Cpu`s of the targets of a multi target medium have the same ids, spread them over the workers
+    frame.client = client;
+    Shard* shard = m_shards.at(static_cast<int>((static_cast<uint>(client) * 31u + frame.layout->cpuId) % static_cast<uint>(m_shards.size())));
+    QMutexLocker locker(&shard->mutex);
+    shard->frames.append(frame);
+    if (!shard->scheduled)
+    {
+        //One invocation takes all frames that are queued until it runs
+        shard->scheduled = true;
+        QMetaObject::invokeMethod(shard->context, [this, shard]()
+        {
+            decodeShard(*shard);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ChannelDataDecoder::dispatch()
+{
+    QVector<Frame> frames;
+    {
+        QMutexLocker locker(&m_decodedMutex);
+        frames.swap(m_decodedFrames);
+    }
+
+    //One call per client, in order per Cpu
+    QHash<int, QVector<Frame>> clientFrames;
+    for (const auto& frame : qAsConst(frames))
+    {
+        clientFrames[frame.client].append(frame);
+    }
+    for (auto it = clientFrames.constBegin(); it != clientFrames.constEnd(); ++it)
+    {
+        Client* client = m_clients.value(it.key(), nullptr);
+        if (client != nullptr)
+        {
+            client->framesDecoded(it.value());
+        }
+    }
+}
+
+void ChannelDataDecoder::decodeShard(Shard &shard)
+{
+    QVector<Frame> frames;
+    {
+        QMutexLocker locker(&shard.mutex);
+        frames.swap(shard.frames);
+        shard.scheduled = false;
+    }
+
+    for (auto& frame : frames)
+    {
+        frame.valid = unpack(frame);
+        if (!frame.valid)
+        {
+            continue;
+        }
+        decode(*frame.layout, frame.commandData, frame.source, frame.samples);
+        if (frame.sink != nullptr && !frame.samples.isEmpty())
+        {
+            frame.sink->append(frame.samples);
+        }
+        feed(*frame.layout, frame.samples);
+    }
+
+    bool notify;
+    {
+        QMutexLocker locker(&m_decodedMutex);
+        notify = m_decodedFrames.isEmpty();
+        m_decodedFrames.append(frames);
+    }
+    if (notify)
+    {
+        emit framesPending();
+    }
+}
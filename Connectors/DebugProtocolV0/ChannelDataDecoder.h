@@ -0,0 +1,200 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHANNELDATADECODER_H
+#define CHANNELDATADECODER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QHash>
+#include <QVector>
+#include "Medium/Register/Register.h"
+#include "../BaseInterface/SampleSink.h"
+class Cpu;
+class TriggerEngine;
+class QThread;
+
+/**
+ * @brief Decodes the ReadChannelData frames of many Cpu`s on a pool of worker threads.
+ *
+ * One decoder is shared by all presentation layers of a medium, or of all targets of a medium, each
+ * layer is a Client of it. Frames are sharded by client and Cpu id, so the frames of one Cpu are
+ * decoded in order by one worker while different Cpu`s are decoded in parallel. Frames can be
+ * queued as received, then the worker also removes the escape characters, checks the CRC and checks
+ * the size against the mask.
+ *
+ * A worker does all per sample work of a frame: it appends the samples to the SampleSink of the
+ * frame, to the history of their Registers and to the trigger engine of the Cpu, see feed(). The
+ * decoded frames are handed back to the thread of the decoder, in order per Cpu, where the Client
+ * only sets the latest values on the Registers.
+ *
+ * The worker never touches a Register or a Cpu. Each frame carries a snapshot of the channel layout
+ * of its Cpu, taken when the frame was received, so a channel that is reconfigured while frames are
+ * in flight does not change how the earlier frames are decoded. The snapshot shares the history and
+ * trigger engine, which are thread safe, so they outlive a Register or Cpu that is removed meanwhile.
+ */
+class ChannelDataDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Register that is configured on a debug channel, as seen by the workers.
+     */
+    struct Channel
+    {
+        Register* channelRegister = nullptr;
+        uint registerId = 0;
+        Register::VariableType type = Register::VariableType::Unknown;
+        int size = 0;
+        bool isSigned = false;
+        QSharedPointer<RegisterHistory> history;
+    };
+
+    /**
+     * @brief Debug channels of a Cpu at the time a frame was received.
+     * The guards are only dereferenced on the thread of the decoder, the workers pass them on to the trigger engine.
+     */
+    struct Layout
+    {
+        uint8_t cpuId = 0;
+        QVector<Channel> channels;
+        QPointer<Cpu> cpu;
+        QVector<QPointer<Register>> guards;
+        QSharedPointer<TriggerEngine> triggerEngine;
+    };
+
+    struct Frame
+    {
+        int client = 0;                 /**< Set by enqueue() */
+        QSharedPointer<const Layout> layout;
+        QByteArray receivedFrame;       /**< Bytes between STX and ETX as received, unpacked into commandData by the worker */
+        QVector<uint8_t> commandData;   /**< ReadChannelData command without the command byte */
+        SampleSink* sink = nullptr;
+        quint16 source = 0;
+        bool valid = true;              /**< false if unpack() rejected the frame */
+        QVector<DecodedSample> samples; /**< Filled by the worker */
+    };
+
+    /**
+     * @brief Receives the decoded frames of one presentation layer, on the thread of the decoder
+     */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+        virtual void framesDecoded(const QVector<Frame>& frames) = 0;
+    };
+
+    /**
+     * @brief Constructor of ChannelDataDecoder, starts the worker threads
+     * @param workers number of worker threads, at least one.
+     */
+    explicit ChannelDataDecoder(int workers, QObject* parent = nullptr);
+    ~ChannelDataDecoder();
+
+    int workers() const {return m_shards.size();}
+
+    /**
+     * @brief Number of workers a medium starts by default, half of the cores and at most 4
+     */
+    static int defaultWorkers();
+
+    /**
+     * @return id of the client for enqueue(), the client is not owned.
+     */
+    int addClient(Client* client);
+
+    /**
+     * @brief Remove a client, its frames that are still being decoded are dropped
+     */
+    void removeClient(int id);
+
+    /**
+     * @brief Size of a ReadChannelData command with the given mask
+     * @return -1 if a channel in the mask has no Register with a known size.
+     */
+    static int frameSize(const Layout& layout, uint16_t mask);
+
+    /**
+     * @brief Fill the commandData of a frame from its receivedFrame, if any, and check its size against the mask
+     * @return false for a CRC error, a frame of another Cpu or command, or a frame that is too short.
+     */
+    static bool unpack(Frame& frame);
+
+    /**
+     * @brief Decode the values of a ReadChannelData command, the size must be checked with frameSize() first
+     * @param samples to append the decoded samples to.
+     */
+    static void decode(const Layout& layout, const QVector<uint8_t>& commandData, quint16 source, QVector<DecodedSample>& samples);
+
+    /**
+     * @brief Decode a little endian value of a Register
+     * @param size of the variable type as reported by GetInfo.
+     * @param value as double, 64 bit integers above 2^53 lose precision.
+     * @return false if values of this type and size cannot be decoded.
+     */
+    static bool decodeValue(Register::VariableType type, int size, bool isSigned, const uint8_t* data, double& value);
+
+    /**
+     * @brief Convert a decoded value to the QVariant type that is stored in a Register of this type
+     */
+    static QVariant toVariant(Register::VariableType type, bool isSigned, double value);
+
+    /**
+     * @brief Append the decoded samples of a frame to the histories and the trigger engine of its layout, thread safe
+     */
+    static void feed(const Layout& layout, const QVector<DecodedSample>& samples);
+
+    /**
+     * @brief Queue a frame on the worker of its client and Cpu
+     */
+    void enqueue(int client, Frame frame);
+
+signals:
+    /**
+     * @brief Emitted from a worker thread when decoded frames are pending, once until they are dispatched
+     */
+    void framesPending();
+
+private slots:
+    void dispatch();
+
+private:
+    struct Shard
+    {
+        QThread* thread = nullptr;
+        QObject* context = nullptr;     /**< Lives in the thread, runs the decoding */
+        QMutex mutex;
+        QVector<Frame> frames;
+        bool scheduled = false;
+    };
+
+    void decodeShard(Shard& shard);
+
+private:
+    QVector<Shard*> m_shards;
+    QHash<int, Client*> m_clients;
+    int m_nextClientId = 1;
+    QMutex m_decodedMutex;
+    QVector<Frame> m_decodedFrames;
+};
+
+#endif // CHANNELDATADECODER_H
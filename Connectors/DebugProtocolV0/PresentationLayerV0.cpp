@@ -18,8 +18,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "PresentationLayerV0.h"
 #include "../DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../BaseInterface/SampleSink.h"
 #include <QDebug>
 #include <QVector>
+#include <cstring>
 #include "Medium/CPU/CpuListModel.h"
 
 PresentationLayerV0::PresentationLayerV0(CpuListModel& cpuListModel, RegisterListModel& registerListModel, QObject *parent) :
@@ -30,6 +32,8 @@ PresentationLayerV0::PresentationLayerV0(CpuListModel& cpuListModel, RegisterLis
 
 PresentationLayerV0::~PresentationLayerV0()
 {
+    //Frames that are still being decoded for this layer are dropped
+    setChannelDataDecoder(nullptr);
     qDebug() << "presentation Layer destroyed";
 }
 
@@ -57,6 +61,16 @@ void PresentationLayerV0::receivedDebugProtocolCommand(uint8_t uCID, QVector<uin
         receivedQueryRegister(uCID,protocolCommand);
         break;
     }
+    case DebugProtocolV0Enums::ProtocolCommand::Decimation:
+    {
+        receivedDecimation(uCID,protocolCommand);
+        break;
+    }
+    case DebugProtocolV0Enums::ProtocolCommand::ConfigChannel:
+    {
+        receivedConfigChannel(uCID,protocolCommand);
+        break;
+    }
     case DebugProtocolV0Enums::ProtocolCommand::ReadChannelData:
     {
         receivedReadChannelData(uCID,protocolCommand);
@@ -75,88 +89,95 @@ void PresentationLayerV0::scanForCpu()
 {
     QVector<uint8_t> debugProtocolMessage;
     debugProtocolMessage.append(DebugProtocolV0Enums::GetVersion);
-    emit newDebugProtocolCommand(0xFF, debugProtocolMessage); //Send GetVersion to all cpu's
+    send(0xFF, debugProtocolMessage, CommandLane::Interactive); //Send GetVersion to all cpu's
     qDebug() << "Send scanForCpu";
 }
 
 
 
-void PresentationLayerV0::queryRegister(const Register &registerToRead)
+void PresentationLayerV0::queryRegister(const Register &registerToRead, CommandLane lane, quint32 requestId)
 {
-    QVector<uint8_t> newDebugProtocolMessage;
-    newDebugProtocolMessage.append(DebugProtocolV0Enums::QueryRegister);
-    append32BitValue(newDebugProtocolMessage, registerToRead.offset());
-    newDebugProtocolMessage.append(controlByte(registerToRead));
-    newDebugProtocolMessage.append(registerToRead.getVariableTypeSize());
-    emit newDebugProtocolCommand(registerToRead.cpu().id(),newDebugProtocolMessage);
+    auto queryCommand = m_queryCommands.constFind(&registerToRead);
+    if (queryCommand == m_queryCommands.constEnd())
+    {
+        QVector<uint8_t> newDebugProtocolMessage;
+        newDebugProtocolMessage.append(DebugProtocolV0Enums::QueryRegister);
+        append32BitValue(newDebugProtocolMessage, registerToRead.offset());
+        newDebugProtocolMessage.append(controlByte(registerToRead));
+        newDebugProtocolMessage.append(registerToRead.getVariableTypeSize());
+        if (registerToRead.getVariableTypeSize() == 0)
+        {
+            //Sent before GetInfo, the size is not known yet and must not be kept
+            send(registerToRead.cpu().id(), newDebugProtocolMessage, lane, requestId);
+            return;
+        }
+        queryCommand = m_queryCommands.insert(&registerToRead, newDebugProtocolMessage);
+        connect(&registerToRead, &QObject::destroyed, this, [this](QObject* destroyedRegister)
+        {
+            m_queryCommands.remove(static_cast<Register*>(destroyedRegister));
+        });
+    }
+    //The cached command is implicitly shared all the way to the transport layer
+    send(registerToRead.cpu().id(), *queryCommand, lane, requestId);
 }
 
 void PresentationLayerV0::writeRegister(const Register &registerToWrite)
+{
+    writeRegister(registerToWrite, registerToWrite.value(), CommandLane::Interactive, 0);
+}
+
+void PresentationLayerV0::writeRegister(const Register &registerToWrite, const QVariant &value, CommandLane lane, quint32 requestId)
 {
     QVector<uint8_t> newDebugProtocolMessage;
     newDebugProtocolMessage.append(DebugProtocolV0Enums::WriteRegister);
     append32BitValue(newDebugProtocolMessage, registerToWrite.offset());
     newDebugProtocolMessage.append(controlByte(registerToWrite));
     newDebugProtocolMessage.append(registerToWrite.getVariableTypeSize());
-    newDebugProtocolMessage.append(toQVector(registerToWrite.value()));
-    emit newDebugProtocolCommand(registerToWrite.cpu().id(),newDebugProtocolMessage);
+    newDebugProtocolMessage.append(encodeValue(registerToWrite, value));
+    send(registerToWrite.cpu().id(), newDebugProtocolMessage, lane, requestId);
 }
 
 void PresentationLayerV0::resetTime(uint8_t uCId)
 {
     QVector<uint8_t> newDebugProtocolMessage;
     newDebugProtocolMessage.append(DebugProtocolV0Enums::ResetTime);
-    emit newDebugProtocolCommand(uCId,newDebugProtocolMessage);
+    send(uCId, newDebugProtocolMessage, CommandLane::ChannelConfig);
 
 }
 
-void PresentationLayerV0::configDebugChannel(Register &registerToConfigDebugChannel)
+void PresentationLayerV0::configDebugChannel(uint8_t uCId, uint8_t channel, const Register* channelRegister)
 {
     QVector<uint8_t> newDebugProtocolMessage;
     newDebugProtocolMessage.append(DebugProtocolV0Enums::ConfigChannel);
-    int debugChannel = registerToConfigDebugChannel.cpu().debugChannels().indexOf(&registerToConfigDebugChannel);
-    if (debugChannel >= 0)
+    newDebugProtocolMessage.append(channel);
+    if (channelRegister == nullptr || channelRegister->activeChannelMode() == Register::ChannelMode::Off)
     {
-        //Debugchannel already exists. only need to change channelmode
-        newDebugProtocolMessage.append(static_cast<uint8_t>(debugChannel));
-        newDebugProtocolMessage.append(static_cast<uint8_t>(registerToConfigDebugChannel.channelMode()));
-        emit newDebugProtocolCommand(registerToConfigDebugChannel.cpu().id(),newDebugProtocolMessage);
-
-        if (registerToConfigDebugChannel.channelMode() == Register::ChannelMode::Off)
-        {
-            registerToConfigDebugChannel.cpu().debugChannels().removeOne(&registerToConfigDebugChannel);
-        }
+        newDebugProtocolMessage.append(static_cast<uint8_t>(Register::ChannelMode::Off));
     }
     else
     {
-        //Debugchannel does not exists.
-        debugChannel = registerToConfigDebugChannel.cpu().nextDebugChannel();
-        if(debugChannel >= 0)
-        {
-            registerToConfigDebugChannel.cpu().debugChannels().append(&registerToConfigDebugChannel);
-            newDebugProtocolMessage.append(static_cast<uint8_t>(debugChannel));
-            newDebugProtocolMessage.append(static_cast<uint8_t>(registerToConfigDebugChannel.channelMode()));
-            append32BitValue(newDebugProtocolMessage, registerToConfigDebugChannel.offset());
-            newDebugProtocolMessage.append(controlByte(registerToConfigDebugChannel));
-            newDebugProtocolMessage.append(registerToConfigDebugChannel.getVariableTypeSize());
-            emit newDebugProtocolCommand(registerToConfigDebugChannel.cpu().id(),newDebugProtocolMessage);
-        }
+        //Always send the full configuration, the channel can have carried another Register
+        newDebugProtocolMessage.append(static_cast<uint8_t>(channelRegister->activeChannelMode()));
+        append32BitValue(newDebugProtocolMessage, channelRegister->offset());
+        newDebugProtocolMessage.append(controlByte(*channelRegister));
+        newDebugProtocolMessage.append(channelRegister->getVariableTypeSize());
     }
+    send(uCId, newDebugProtocolMessage, CommandLane::ChannelConfig);
 }
 
 void PresentationLayerV0::getDecimation(uint8_t uCId)
 {
     QVector<uint8_t> debugProtocolMessage;
     debugProtocolMessage.append(DebugProtocolV0Enums::Decimation);
-    emit newDebugProtocolCommand(uCId, debugProtocolMessage);
+    send(uCId, debugProtocolMessage, CommandLane::ChannelConfig);
 }
 
 void PresentationLayerV0::setDecimation(uint8_t uCId,int newDecimation)
 {
     QVector<uint8_t> debugProtocolMessage;
     debugProtocolMessage.append(DebugProtocolV0Enums::Decimation);
-    debugProtocolMessage.append(toQVector(newDecimation));
-    emit newDebugProtocolCommand(uCId, debugProtocolMessage);
+    debugProtocolMessage.append(static_cast<uint8_t>(qBound(1, newDecimation, 255)));
+    send(uCId, debugProtocolMessage, CommandLane::ChannelConfig);
 }
 
 void PresentationLayerV0::receivedGetVersion(uint8_t &uCId, const QVector<uint8_t> &commandData)
@@ -196,12 +217,30 @@ void PresentationLayerV0::receivedGetVersion(uint8_t &uCId, const QVector<uint8_
             serialNumber.append(commandData.value(i));
         }
 
+        Cpu* knownCpu = m_cpuListModel.getCpuNodeById(id);
+        if (knownCpu != nullptr)
+        {
+            if (knownCpu->name() == name && knownCpu->serialNumber() == serialNumber &&
+                knownCpu->protocolVersion() == protocolVersion && knownCpu->applicationVersion() == applicationVersion)
+            {
+                //Same target, for instance after a reconnect, its info and Registers are still valid
+                knownCpu->increaseMessageCounter();
+                emit cpuRestored(knownCpu);
+                return;
+            }
+            qWarning() << "Cpu" << id << "is another target than before:" << name << serialNumber << applicationVersion;
+            emit cpuIdentityChanged(knownCpu);
+            if (m_cpuListModel.contains(id))
+            {
+                return;
+            }
+        }
+
         auto* cpu = new Cpu(id,name,serialNumber,protocolVersion,applicationVersion);
         cpu->increaseMessageCounter();
-        cpu->loadConfiguration();
         emit newCpuFound(cpu);
-        //Disable All Cpu debugChannels
-        disableAllConfigChannels(id,cpu->maxDebugChannels());
+        //Switch off the debug channels that are still on from a previous session, in one burst
+        cpu->channelMultiplexer().synchronize();
         sendGetInfo(cpu->id());
     }
 }
@@ -230,27 +269,10 @@ void PresentationLayerV0::receivedQueryRegister(uint8_t &uCId, const QVector<uin
     {
         auto offset = toValue<qint32>(commandData.mid(0,4));
         uint8_t ctrl = commandData[4];
-        uint8_t size = commandData[5];
         Register* reg = m_registerListModel.getRegisterByCpuIdAndOffset(uCId,offset);
         if (reg != nullptr)
         {
-            QVariant newValue;
-            switch (reg->variableType())
-            {
-            case Register::VariableType::Bool:
-            {
-                newValue.setValue(toValue<bool>(commandData.mid(6,size)));
-                break;
-            }
-            case Register::VariableType::Char:
-            {
-                newValue.setValue(toValue<uint8_t>(commandData.mid(6,size)));
-                break;
-            }
-            default:      break;
-            }
-
-            reg->receivedNewRegisterValue(newValue);
+            reg->receivedNewRegisterValue(queryRegisterValue(*reg, commandData));
         }
         else
         {
@@ -260,52 +282,202 @@ void PresentationLayerV0::receivedQueryRegister(uint8_t &uCId, const QVector<uin
     }
 }
 
-void PresentationLayerV0::receivedDecimation(uint8_t uCId, const QVector<uint8_t> &commandData)
+QVariant PresentationLayerV0::queryRegisterValue(const Register &reg, const QVector<uint8_t> &commandData)
 {
+    //Offset, control byte, size and the value
+    if (commandData.size() < 7)
+    {
+        return QVariant();
+    }
+    uint8_t size = commandData[5];
+    double value;
+    if (6 + size > commandData.size() ||
+        !ChannelDataDecoder::decodeValue(reg.variableType(), size, reg.isSigned(), commandData.constData() + 6, value))
+    {
+        return QVariant();
+    }
+    return ChannelDataDecoder::toVariant(reg.variableType(), reg.isSigned(), value);
+}
+
+void PresentationLayerV0::receivedConfigChannel(uint8_t &uCId, const QVector<uint8_t> &commandData)
+{
+    Cpu* cpu = m_cpuListModel.getCpuNodeById(uCId);
+    if (cpu != nullptr && !commandData.isEmpty())
+    {
+        //The reply starts with the channel number, channel data after it uses the new configuration
+        cpu->increaseMessageCounter();
+        cpu->channelMultiplexer().channelConfigured(commandData[0]);
+    }
+}
 
+void PresentationLayerV0::receivedDecimation(uint8_t uCId, const QVector<uint8_t> &commandData)
+{
+    Cpu* cpu = m_cpuListModel.getCpuNodeById(uCId);
+    if (cpu != nullptr)
+    {
+        if (commandData.isEmpty())
+        {
+            qWarning() << "Received decimation from uC: " << uCId << " is invalid";
+            cpu->increaseInvalidMessageCounter();
+        }
+        else
+        {
+            cpu->increaseMessageCounter();
+            cpu->receivedDecimation(commandData[0]);
+        }
+    }
 }
 
 void PresentationLayerV0::receivedReadChannelData(uint8_t uCId, QVector<uint8_t> &commandData)
 {
-    if(commandData.size() < 5)
+    Cpu* cpu = m_cpuListModel.getCpuNodeById(uCId);
+    if(cpu != nullptr)
     {
-        qWarning() << "Received read channel datacommmand from uC: " << uCId << " is invalid";
+        ChannelDataDecoder::Frame frame;
+        frame.commandData = commandData;
+        handleChannelData(*cpu, frame);
     }
+}
+
+void PresentationLayerV0::receivedChannelDataFrame(uint8_t uCId, QByteArray frame)
+{
     Cpu* cpu = m_cpuListModel.getCpuNodeById(uCId);
     if(cpu != nullptr)
     {
-        auto time = static_cast<int>(((commandData[2] << 16) | (commandData[1] << 8) | commandData[0]));
-        auto mask = toValue<uint8_t>(commandData.mid(3,2));
-        commandData.remove(0,5);
+        ChannelDataDecoder::Frame channelFrame;
+        channelFrame.receivedFrame = frame;
+        handleChannelData(*cpu, channelFrame);
+    }
+}
+
+void PresentationLayerV0::handleChannelData(Cpu &cpu, ChannelDataDecoder::Frame &frame)
+{
+    //The layout is taken now, a ConfigChannel reply that follows must not change how this frame is decoded
+    frame.layout = channelLayout(cpu);
+    frame.sink = m_sampleSink;
+    frame.source = m_sampleSource;
 
-        for (int i = cpu->debugChannels().size(); i >= 0 ; i--)
+    if (m_channelDataDecoder != nullptr)
+    {
+        //Checked, decoded and fed by a worker, applied in framesDecoded()
+        m_channelDataDecoder->enqueue(m_decoderClientId, frame);
+        return;
+    }
+
+    frame.valid = ChannelDataDecoder::unpack(frame);
+    if (frame.valid)
+    {
+        ChannelDataDecoder::decode(*frame.layout, frame.commandData, frame.source, frame.samples);
+        if (m_sampleSink != nullptr && !frame.samples.isEmpty())
         {
-            if ((mask >> i & 1) == 1)
+            m_sampleSink->append(frame.samples);
+        }
+        ChannelDataDecoder::feed(*frame.layout, frame.samples);
+    }
+    applyFrame(frame);
+}
+
+void PresentationLayerV0::applyFrame(const ChannelDataDecoder::Frame &frame)
+{
+    Cpu* cpu = frame.layout->cpu;
+    if (cpu == nullptr)
+    {
+        return;
+    }
+    if (!frame.valid)
+    {
+        qWarning() << "Received read channel data from uC: " << frame.layout->cpuId << " is invalid";
+        cpu->increaseInvalidMessageCounter();
+        return;
+    }
+
+    const QVector<uint8_t>& commandData = frame.commandData;
+    auto time = static_cast<uint>((commandData[2] << 16) | (commandData[1] << 8) | commandData[0]);
+    cpu->channelMultiplexer().receivedChannelData(time);
+    applyValues(*frame.layout, frame.samples);
+    emit cpu->channelDataReceived(*cpu, commandData);
+}
+
+QSharedPointer<const ChannelDataDecoder::Layout> PresentationLayerV0::channelLayout(Cpu &cpu)
+{
+    QSharedPointer<ChannelDataDecoder::Layout>& layout = m_channelLayouts[cpu.id()];
+    const QVector<Register*>& debugChannels = cpu.debugChannels();
+    bool changed = layout.isNull() || layout->cpu != &cpu || layout->channels.size() != debugChannels.size();
+    for (int i = 0; !changed && i < debugChannels.size(); i++)
+    {
+        //A removed Register can be replaced by a new one at the same address
+        Register* reg = debugChannels.at(i);
+        const ChannelDataDecoder::Channel& channel = layout->channels.at(i);
+        changed = channel.channelRegister != reg ||
+                  (reg != nullptr && (layout->guards.at(i).isNull() || channel.size != reg->getVariableTypeSize()));
+    }
+
+    if (changed)
+    {
+        //Frames that are still being decoded keep the previous layout
+        layout.reset(new ChannelDataDecoder::Layout());
+        layout->cpuId = cpu.id();
+        layout->cpu = &cpu;
+        layout->triggerEngine = cpu.sharedTriggerEngine();
+        for (auto reg : debugChannels)
+        {
+            ChannelDataDecoder::Channel channel;
+            if (reg != nullptr)
             {
-                Register* reg = cpu->debugChannels().value(i);
-                if(reg != nullptr)
-                {
-                    switch (reg->variableType())
-                    {
-                    case Register::VariableType::Bool:
-                    {
-                        reg->receivedNewRegisterValue(toValue<bool>(commandData.mid(0,reg->getVariableTypeSize())),time);
-                        break;
-                    }
-                    case Register::VariableType::Char:
-                    {
-                        reg->receivedNewRegisterValue(toValue<uint8_t>(commandData.mid(0,reg->getVariableTypeSize())),time);
-                        break;
-                    }
-                    default: break;
-                    }
-                    commandData.remove(commandData.size() - reg->getVariableTypeSize() ,reg->getVariableTypeSize());
-                }
+                channel.channelRegister = reg;
+                channel.registerId = reg->id();
+                channel.type = reg->variableType();
+                channel.size = reg->getVariableTypeSize();
+                channel.isSigned = reg->isSigned();
+                channel.history = reg->sharedHistory();
             }
+            layout->channels.append(channel);
+            layout->guards.append(reg);
+        }
+    }
+    return layout;
+}
+
+void PresentationLayerV0::applyValues(const ChannelDataDecoder::Layout &layout, const QVector<DecodedSample> &samples)
+{
+    //The history and the trigger engine got the samples from ChannelDataDecoder::feed()
+    for (const auto& sample : samples)
+    {
+        //The Register can be removed while the frame was being decoded
+        if (layout.guards.at(sample.channel).isNull())
+        {
+            continue;
         }
+        Register* reg = sample.sampleRegister;
+        const ChannelDataDecoder::Channel& channel = layout.channels.at(sample.channel);
+        reg->receivedNewRegisterValue(ChannelDataDecoder::toVariant(channel.type, channel.isSigned, sample.value), sample.timeStamp);
+    }
+}
+
+void PresentationLayerV0::framesDecoded(const QVector<ChannelDataDecoder::Frame> &frames)
+{
+    for (const auto& frame : frames)
+    {
+        applyFrame(frame);
     }
 }
 
+void PresentationLayerV0::setChannelDataDecoder(ChannelDataDecoder *decoder)
+{
+    if (decoder == m_channelDataDecoder)
+    {
+        return;
+    }
+
+    //Frames that are still queued for this layer on the previous decoder are dropped
+    if (m_channelDataDecoder != nullptr)
+    {
+        m_channelDataDecoder->removeClient(m_decoderClientId);
+    }
+    m_channelDataDecoder = decoder;
+    m_decoderClientId = decoder != nullptr ? decoder->addClient(this) : 0;
+}
+
 void PresentationLayerV0::receivedDebugString(uint8_t uCId, const QVector<uint8_t> &commandData)
 {
 
@@ -327,29 +499,48 @@ void PresentationLayerV0::receivedGetInfo(uint8_t uCId,QVector<uint8_t>& command
         }
         else
         {
+            //Records are separated by RS, the last record is not terminated
             QVector<uint8_t> record;
+            auto processRecord = [&]()
+            {
+                if (record.size() >= 5 && record[0] == static_cast<uint8_t>(Register::VariableType::TimeStamp))
+                {
+                    //Timestamp is 4 byte
+                    cpu->setVariableTypeSize(Register::VariableType::TimeStamp,int(record[4] << 24 | record[3] << 16 | record[2] << 8 | record[1]));
+                }
+                else if (record.size() >= 2 && record[0] != static_cast<uint8_t>(Register::VariableType::TimeStamp))
+                {
+                    //Everything else is 1 byte.
+                    cpu->setVariableTypeSize(static_cast<Register::VariableType>(record[0]),record[1]);
+                }
+                record.clear();
+            };
             for (QVector<uint8_t>::iterator it=commandData.begin(); it != commandData.end(); ++it)
             {
-                if (*it == DebugProtocolV0Enums::ProtocolChar::RS || it == commandData.end())
+                if (*it == DebugProtocolV0Enums::ProtocolChar::RS)
                 {
-                    if (record[0] == static_cast<uint8_t>(Register::VariableType::TimeStamp))
-                    {
-                        //Timestamp is 4 byte
-                        cpu->setVariableTypeSize(Register::VariableType::TimeStamp,int(record[4] << 24 | record[3] << 16 | record[2] << 8 | record[1]));
-                    }
-                    else
-                    {
-                        //Everything else is 1 byte.
-                        cpu->setVariableTypeSize(static_cast<Register::VariableType>(record[0]),record[1]);
-                    }
-                    record.clear();
+                    processRecord();
                 }
                 else
                 {
                     record.append(*it);
                 }
             }
-            cpu->increaseMessageCounter();;
+            processRecord();
+            //The cached QueryRegister commands carry the sizes of the previous GetInfo
+            for (auto queryCommand = m_queryCommands.begin(); queryCommand != m_queryCommands.end();)
+            {
+                if (&queryCommand.key()->cpu() == cpu)
+                {
+                    queryCommand = m_queryCommands.erase(queryCommand);
+                }
+                else
+                {
+                    ++queryCommand;
+                }
+            }
+            cpu->increaseMessageCounter();
+            cpu->receivedInfo();
         }
     }
 }
@@ -359,30 +550,17 @@ void PresentationLayerV0::sendGetVersion(uint8_t uCId)
 {
     QVector<uint8_t> debugProtocolMessage;
     debugProtocolMessage.append(DebugProtocolV0Enums::GetVersion);
-    emit newDebugProtocolCommand(uCId, debugProtocolMessage);
+    send(uCId, debugProtocolMessage, CommandLane::Interactive);
 }
 
 void PresentationLayerV0::sendGetInfo(uint8_t uCId)
 {
     QVector<uint8_t> debugProtocolMessage;
     debugProtocolMessage.append(DebugProtocolV0Enums::GetInfo);
-    emit newDebugProtocolCommand(uCId, debugProtocolMessage);
+    send(uCId, debugProtocolMessage, CommandLane::Interactive);
 
 }
 
-void PresentationLayerV0::disableAllConfigChannels(uint8_t uCId, uint8_t nbrOfConfigChannels)
-{
-    QVector<uint8_t> newDebugProtocolMessage;
-    for(int i = 0; i < nbrOfConfigChannels; i++)
-    {
-        newDebugProtocolMessage.append(DebugProtocolV0Enums::ConfigChannel);
-        newDebugProtocolMessage.append(static_cast<uint8_t>(i));
-        newDebugProtocolMessage.append(static_cast<uint8_t>(Register::ChannelMode::Off));
-        emit newDebugProtocolCommand(uCId,newDebugProtocolMessage);
-        newDebugProtocolMessage.clear();
-    }
-}
-
 uint8_t PresentationLayerV0::controlByte(const Register &Register)
 {
     uint8_t control = 0;
@@ -392,3 +570,47 @@ uint8_t PresentationLayerV0::controlByte(const Register &Register)
     return control;
 }
 
+QVector<uint8_t> PresentationLayerV0::encodeValue(const Register &registerToWrite, const QVariant &value)
+{
+    int size = registerToWrite.getVariableTypeSize();
+    quint64 raw = 0;
+    switch (registerToWrite.variableType())
+    {
+    case Register::VariableType::Bool:
+    {
+        raw = value.toBool() ? 1 : 0;
+        break;
+    }
+    case Register::VariableType::Float:
+    case Register::VariableType::Double:
+    case Register::VariableType::LongDouble:
+    {
+        if (size == 4)
+        {
+            auto floatValue = static_cast<float>(value.toDouble());
+            quint32 bits;
+            std::memcpy(&bits, &floatValue, sizeof(bits));
+            raw = bits;
+        }
+        else
+        {
+            double doubleValue = value.toDouble();
+            std::memcpy(&raw, &doubleValue, sizeof(raw));
+        }
+        break;
+    }
+    default:
+    {
+        raw = registerToWrite.isSigned() ? static_cast<quint64>(value.toLongLong()) : value.toULongLong();
+        break;
+    }
+    }
+
+    //Little endian in the size of the variable type on the Cpu
+    QVector<uint8_t> encodedValue;
+    for (int i = 0; i < qBound(1, size, 8); i++)
+    {
+        encodedValue.append(static_cast<uint8_t>(raw >> (8 * i)));
+    }
+    return encodedValue;
+}
@@ -20,23 +20,53 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PRESENTATIONLAYERV0_H
 
 #include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include <QPointer>
 #include "../BaseInterface/PresentationLayerBase.h"
+#include "ChannelDataDecoder.h"
 class Register;
 
 
-class PresentationLayerV0 : public PresentationLayerBase
+class PresentationLayerV0 : public PresentationLayerBase, public ChannelDataDecoder::Client
 {
     Q_OBJECT
 public:
     explicit PresentationLayerV0(CpuListModel& cpuListModel, RegisterListModel& registerListModel, QObject *parent = nullptr);
     virtual ~PresentationLayerV0();
 
+    /**
+     * @brief Decode ReadChannelData on the workers of a decoder, see ChannelDataDecoder
+     * @param decoder that can be shared with other layers and is not owned, nullptr to decode on the thread of this layer.
+     */
+    void setChannelDataDecoder(ChannelDataDecoder* decoder);
+    ChannelDataDecoder* channelDataDecoder() const {return m_channelDataDecoder;}
+    int decodeWorkers() const {return m_channelDataDecoder != nullptr ? m_channelDataDecoder->workers() : 0;}
+
+    /**
+     * @copydoc ChannelDataDecoder::Client::framesDecoded
+     */
+    void framesDecoded(const QVector<ChannelDataDecoder::Frame>& frames) override;
+
+    /**
+     * @brief Decode the value of a QueryRegister response
+     * @param reg the Register that was queried
+     * @param commandData the response without the command
+     * @return invalid when the response is too short or the value can not be decoded for the Register.
+     */
+    static QVariant queryRegisterValue(const Register& reg, const QVector<uint8_t>& commandData);
+
 public slots:
     /**
      * @copydoc PresentationLayerBase::receivedDebugProtocolCommand
      */
     void receivedDebugProtocolCommand(uint8_t uCID, QVector<uint8_t> protocolCommand) override;
 
+    /**
+     * @copydoc PresentationLayerBase::receivedChannelDataFrame
+     */
+    void receivedChannelDataFrame(uint8_t uCId, QByteArray frame) override;
+
     /**
      * @brief Create a debug protocol command to scan all the Cpu`s
      */
@@ -44,8 +74,10 @@ public slots:
     /**
      * @brief Create a debug protocol command to query a Register
      * @param Register that needs to be queried
+     * @param lane of the CommandQueue, periodic polls use CommandLane::Poll
+     * @param requestId to be told about the response, 0 if nobody waits for it
      */
-    void queryRegister(const Register& registerToRead);
+    void queryRegister(const Register& registerToRead, CommandLane lane = CommandLane::Interactive, quint32 requestId = 0);
 
     /**
      * @brief Create a debug protocol command to write a Register
@@ -53,6 +85,15 @@ public slots:
      */
     void writeRegister(const Register& registerToWrite);
 
+    /**
+     * @brief Create a debug protocol command to write a value to a Register
+     * @param Register that needs to be written, its value is not changed
+     * @param value to write, converted to the variable type of the Register
+     * @param lane of the CommandQueue
+     * @param requestId to be told about the response, 0 if nobody waits for it
+     */
+    void writeRegister(const Register& registerToWrite, const QVariant& value, CommandLane lane, quint32 requestId);
+
     /**
      * @brief Create a debug protocol command to reset the time of a Cpu
      * @param uCId Id of the Cpu where the time needs to be reset from.
@@ -60,10 +101,12 @@ public slots:
     void resetTime(uint8_t uCId);
 
     /**
-     * @brief Create a debug protocol command  to config a debug channel
-     * @param Register that needs to be configured to be a debug channel
+     * @brief Create a debug protocol command to config a debug channel
+     * @param uCId Cpu of the debug channel
+     * @param channel number of the debug channel
+     * @param Register to stream on the channel with its active channel mode, nullptr to switch the channel off
      */
-    void configDebugChannel(Register &registerToConfigDebugChannel);
+    void configDebugChannel(uint8_t uCId, uint8_t channel, const Register* channelRegister);
 
     /**
      * @brief Create a debug protocol command to get the decimation of a Cpu
@@ -86,11 +129,22 @@ private:
     void receivedConfigChannel(uint8_t& uCId,const QVector<uint8_t>& commandData);
     void receivedDecimation(uint8_t uCId,const QVector<uint8_t>& commandData);
     void receivedReadChannelData(uint8_t uCId, QVector<uint8_t> &commandData);
+    void handleChannelData(Cpu& cpu, ChannelDataDecoder::Frame& frame);
+    void applyFrame(const ChannelDataDecoder::Frame& frame);
     void receivedDebugString(uint8_t uCId,const QVector<uint8_t>& commandData);
+    QSharedPointer<const ChannelDataDecoder::Layout> channelLayout(Cpu& cpu);
+    void applyValues(const ChannelDataDecoder::Layout& layout, const QVector<DecodedSample>& samples);
     void sendGetVersion(uint8_t uCId);
     void sendGetInfo(uint8_t uCId);
-    void disableAllConfigChannels(uint8_t uCId, uint8_t nbrOfConfigChannels);
     uint8_t controlByte(const Register& Register);
+    QVector<uint8_t> encodeValue(const Register& registerToWrite, const QVariant& value);
+    void send(uint8_t uCId, const QVector<uint8_t>& debugProtocolMessage, CommandLane lane, quint32 requestId = 0);
+
+private:
+    QHash<const Register*, QVector<uint8_t>> m_queryCommands;  /**< QueryRegister command per Register, the same for every poll until the next GetInfo */
+    QHash<uint8_t, QSharedPointer<ChannelDataDecoder::Layout>> m_channelLayouts;  /**< Debug channels per Cpu id, replaced when they change */
+    QPointer<ChannelDataDecoder> m_channelDataDecoder;
+    int m_decoderClientId = 0;
 };
 
 #endif // PRESENTATIONLAYERV0_H
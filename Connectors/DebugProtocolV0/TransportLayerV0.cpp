@@ -20,6 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DebugProtocolV0Enums.h"
 #include <QVector>
 #include <QDebug>
+#include <QLoggingCategory>
+
+//Every frame is logged, so this is off unless enabled with QT_LOGGING_RULES="debugprotocol.frames.debug=true"
+Q_LOGGING_CATEGORY(frameLog, "debugprotocol.frames", QtWarningMsg)
 
 static const uint8_t crcTable[] = {
     0,  94, 188, 226,  97,  63, 221, 131, 194, 156, 126,  32, 163, 253,  31,  65,
@@ -40,10 +44,15 @@ static const uint8_t crcTable[] = {
     116,  42, 200, 150,  21,  75, 169, 247, 182, 232,  10,  84, 215, 137, 107,  53
 };
 
+static const int maxAnsweredMsgIds = 32;
+static const int maxFrameTemplates = 4096;
+static const int maxFrameSize = 64 * 1024;     /**< Bytes after an STX without ETX that are kept waiting for the end of the frame */
+
 TransportLayerV0::TransportLayerV0(QObject *parent) :
     TransportLayerBase(parent)
 {
-
+    m_clock.start();
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &TransportLayerV0::checkTimeouts);
 }
 
 TransportLayerV0::~TransportLayerV0()
@@ -53,94 +62,518 @@ TransportLayerV0::~TransportLayerV0()
 
 void TransportLayerV0::sendDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> messageVector)
 {
-    //Protocol Commands is onlyt the command + commandData.
-    messageVector.prepend(msgId()); //Add msgId
-    messageVector.prepend(uCId); //Add uC id
-    messageVector.append(calculateCRC(messageVector));
-    addEscapeCharacters(messageVector);
-    messageVector.prepend(DebugProtocolV0Enums::ProtocolChar::STX);
-    messageVector.append(DebugProtocolV0Enums::ProtocolChar::ETX);
-    qDebug() << "Send message: " << messageVector;
+    sendDebugProtocolRequest(uCId, messageVector, 0);
+}
+
+void TransportLayerV0::sendDebugProtocolRequest(uint8_t uCId, QVector<uint8_t> messageVector, quint32 requestId, bool burst)
+{
+    if (!isTracked(uCId, messageVector))
+    {
+        m_sentFrames++;
+        writeFrame(frame(uCId, msgId(), messageVector));
+        if (requestId != 0)
+        {
+            //There is no response to wait for
+            emit requestFailed(requestId);
+        }
+        return;
+    }
 
-    emit write(toByteArray(messageVector));
+    Window& window = m_windows[uCId];
+    //Requests are sent in order, so nothing overtakes a request that is already waiting
+    if (!window.waiting.isEmpty() || window.inFlight.size() >= windowSize(burst))
+    {
+        WaitingRequest waiting;
+        waiting.messageVector = messageVector;
+        waiting.requestId = requestId;
+        waiting.burst = burst;
+        window.waiting.enqueue(waiting);
+    }
+    else
+    {
+        send(uCId, window, messageVector, requestId);
+    }
 }
 
 void TransportLayerV0::receivedData(QByteArray message)
 {
+    m_receivedBytes += static_cast<quint64>(message.size());
     m_dataBuffer.append(message);
 
-    while(!m_dataBuffer.isEmpty())
+    //A block can hold many frames and end in the middle of one, the handled bytes are removed once
+    int position = 0;
+    while(position < m_dataBuffer.size())
     {
-        int STXindex = m_dataBuffer.indexOf(DebugProtocolV0Enums::ProtocolChar::STX);
+        int STXindex = m_dataBuffer.indexOf(DebugProtocolV0Enums::ProtocolChar::STX, position);
+        if (STXindex < 0)
+        {
+            position = m_dataBuffer.size();
+            break;
+        }
         int ETXindex = m_dataBuffer.indexOf(DebugProtocolV0Enums::ProtocolChar::ETX,STXindex);
-        if (STXindex >= 0 && ETXindex >= 0 && STXindex < m_dataBuffer.size() && ETXindex < m_dataBuffer.size() && STXindex + 4 < ETXindex)
+        if (ETXindex < 0)
+        {
+            //The rest of the frame is in a later block, unless this is garbage without an end
+            position = m_dataBuffer.size() - STXindex > maxFrameSize ? STXindex + 1 : STXindex;
+            break;
+        }
+        const char* frameData = m_dataBuffer.constData() + STXindex + 1;
+        int frameSize = ETXindex - STXindex - 1;
+        uint8_t uCId;
+        uint8_t command;
+        if (frameSize > 4 && m_channelDataUnchecked && readHeader(frameData, frameSize, uCId, command) &&
+            command == DebugProtocolV0Enums::ReadChannelData)
+        {
+            //Checked by the receiver, off this thread
+            m_receivedFrames++;
+            emit frameReceived(uCId, ETXindex - STXindex + 1, true);
+            emit receivedChannelDataFrame(uCId, QByteArray(frameData, frameSize));
+        }
+        else if (frameSize > 4) //Minimal messageSize uC,msg-ID,CRC
         {
             QVector<uint8_t> messageVector;
-            for(int i = STXindex + 1; i < ETXindex; i++)
+            if (unpackFrame(frameData, frameSize, messageVector))
             {
-                messageVector.append(static_cast<uint8_t>(m_dataBuffer[i]));
+                //CRC is correct
+                m_receivedFrames++;
+                qCDebug(frameLog) << "Message Received: " << messageVector;
+                uCId = messageVector.takeFirst();
+                uint8_t msgID = messageVector.takeFirst();
+                emit frameReceived(uCId, ETXindex - STXindex + 1, true);
+                quint32 requestId = 0;
+                if (receivedResponse(uCId, msgID, messageVector, requestId))
+                {
+                    emit receivedDebugProtocolCommand(uCId,messageVector);
+                    if (requestId != 0)
+                    {
+                        emit requestCompleted(requestId, messageVector);
+                    }
+                    if (isTracked(uCId, messageVector))
+                    {
+                        emit windowAvailable(uCId);
+                    }
+                }
             }
-            if(messageVector.size() > 4) //Minimal messageSize uC,msg-ID,CRC
+            else
             {
-                //Replace Escaped characters
-                replaceEscapeCharacters(messageVector);
+                m_invalidFrames++;
+                qCDebug(frameLog) << "CRC INCORRECT";
+                emit frameReceived(messageVector.value(0), ETXindex - STXindex + 1, false);
+            }
+        }
+        position = ETXindex + 1;
+    }
+    m_dataBuffer.remove(0, position);
+}
 
-                //Check CRC
+void TransportLayerV0::checkTimeouts()
+{
+    qint64 now = m_clock.elapsed();
+    QVector<QPair<uint8_t, uint8_t>> timedOut;
+    QVector<QVector<uint8_t>> timedOutMessages;
+    QVector<quint32> timedOutRequestIds;
+    bool inFlight = false;
+    bool retransmissionQueued = false;
 
-                if(messageVector.takeLast() == calculateCRC(messageVector))
-                {
-                    //CRC is correct
-                    qDebug() << "Message Received: " << messageVector;
-                    uint8_t uCId = messageVector.takeFirst();
-                    uint8_t msgID = messageVector.takeFirst();
-                    emit receivedDebugProtocolCommand(uCId,messageVector);
-                }
-                else
-                {
-                    qDebug() << "CRC INCORRECT";
-                }
+    for (auto window = m_windows.begin(); window != m_windows.end(); ++window)
+    {
+        for (auto request = window->inFlight.begin(); request != window->inFlight.end();)
+        {
+            if (request->retransmissionDue || now - request->sentTime < m_responseTimeout)
+            {
+                ++request;
+            }
+            else if (request->retries < m_maxRetries)
+            {
+                //Sent by the CommandQueue through sendRetransmission()
+                request->retransmissionDue = true;
+                window->retransmissions.enqueue(request.key());
+                retransmissionQueued = true;
+                ++request;
+            }
+            else
+            {
+                timedOut.append(qMakePair(window.key(), request.key()));
+                timedOutMessages.append(request->messageVector);
+                timedOutRequestIds.append(request->requestId);
+                quarantine(*window, request.key());
+                request = window->inFlight.erase(request);
+            }
+        }
+        inFlight = inFlight || !window->inFlight.isEmpty() || !window->waiting.isEmpty();
+    }
+
+    for (int i = 0; i < timedOut.size(); i++)
+    {
+        m_timedOutRequests++;
+        qWarning() << "No response from uC" << timedOut.at(i).first << "to msgId" << timedOut.at(i).second << "after" << m_maxRetries << "retransmissions";
+        sendWaiting(timedOut.at(i).first, m_windows[timedOut.at(i).first]);
+        emit requestTimedOut(timedOut.at(i).first, timedOut.at(i).second, timedOutMessages.at(i));
+        if (timedOutRequestIds.at(i) != 0)
+        {
+            emit requestFailed(timedOutRequestIds.at(i));
+        }
+        emit windowAvailable(timedOut.at(i).first);
+    }
+
+    if (retransmissionQueued)
+    {
+        emit retransmissionsDue();
+    }
+
+    if (!inFlight)
+    {
+        m_timeoutTimer.stop();
+    }
+}
+
+int TransportLayerV0::availableWindow(uint8_t uCId, bool burst) const
+{
+    int size = windowSize(burst);
+    auto window = m_windows.constFind(uCId);
+    if (window == m_windows.constEnd())
+    {
+        return size;
+    }
+    return qMax(0, size - window->inFlight.size() - window->waiting.size());
+}
+
+QList<uint8_t> TransportLayerV0::retransmissionCpus() const
+{
+    QList<uint8_t> uCIds;
+    for (auto window = m_windows.constBegin(); window != m_windows.constEnd(); ++window)
+    {
+        if (!window->retransmissions.isEmpty())
+        {
+            uCIds.append(window.key());
+        }
+    }
+    return uCIds;
+}
+
+int TransportLayerV0::nextRetransmissionSize(uint8_t uCId)
+{
+    auto window = m_windows.find(uCId);
+    if (window == m_windows.end())
+    {
+        return 0;
+    }
+    while (!window->retransmissions.isEmpty())
+    {
+        auto request = window->inFlight.constFind(window->retransmissions.head());
+        if (request != window->inFlight.constEnd() && request->retransmissionDue)
+        {
+            return request->frame.size();
+        }
+        //The request was answered while it waited
+        window->retransmissions.dequeue();
+    }
+    return 0;
+}
+
+void TransportLayerV0::sendRetransmission(uint8_t uCId)
+{
+    if (nextRetransmissionSize(uCId) == 0)
+    {
+        return;
+    }
+    Window& window = m_windows[uCId];
+    Request& request = window.inFlight[window.retransmissions.dequeue()];
+    request.retransmissionDue = false;
+    request.retries++;
+    request.sentTime = m_clock.elapsed();
+    m_retransmittedFrames++;
+    writeFrame(request.frame);
+}
+
+bool TransportLayerV0::isTracked(uint8_t uCId, const QVector<uint8_t> &messageVector)
+{
+    if (uCId == 0xFF || messageVector.isEmpty())
+    {
+        return false;
+    }
+    //Sent by the Cpu on its own, not as a response
+    return messageVector.first() != DebugProtocolV0Enums::ReadChannelData &&
+           messageVector.first() != DebugProtocolV0Enums::DebugString;
+}
+
+uint8_t TransportLayerV0::msgId(TransportLayerV0::Window &window)
+{
+    //Never reuse a msgId that is still waiting for its response, nor one that can still get a late response
+    qint64 now = m_clock.elapsed();
+    for (int attempt = 0; attempt < 255; attempt++)
+    {
+        uint8_t id = nextMsgId(window.lastMsgId);
+        auto quarantined = window.quarantined.find(id);
+        if (quarantined != window.quarantined.end() && *quarantined <= now)
+        {
+            window.quarantined.erase(quarantined);
+            quarantined = window.quarantined.end();
+        }
+        if (quarantined == window.quarantined.end() && !window.inFlight.contains(id))
+        {
+            return id;
+        }
+    }
+
+    //Every msgId is in use or quarantined, only the ones in flight must not be reused
+    uint8_t id = nextMsgId(window.lastMsgId);
+    while (window.inFlight.contains(id))
+    {
+        id = nextMsgId(window.lastMsgId);
+    }
+    return id;
+}
+
+void TransportLayerV0::quarantine(TransportLayerV0::Window &window, uint8_t msgId)
+{
+    //The last retransmission can be answered up to a response timeout later
+    window.quarantined.insert(msgId, m_clock.elapsed() + m_responseTimeout * (m_maxRetries + 1));
+}
+
+bool TransportLayerV0::matchesRequest(const QVector<uint8_t> &request, const QVector<uint8_t> &response)
+{
+    if (request.isEmpty() || response.isEmpty() || request.first() != response.first())
+    {
+        return false;
+    }
+
+    //A QueryRegister response starts with the offset of the request, a WriteRegister response only has a result
+    if (request.first() == DebugProtocolV0Enums::QueryRegister && request.size() >= 5 && response.size() >= 5)
+    {
+        for (int i = 1; i < 5; i++)
+        {
+            if (request.at(i) != response.at(i))
+            {
+                return false;
             }
         }
-        m_dataBuffer.remove(0,ETXindex + 1);
     }
+    return true;
+}
+
+QByteArray TransportLayerV0::frame(uint8_t uCId, uint8_t msgId, QVector<uint8_t> messageVector)
+{
+    //Protocol Commands is onlyt the command + commandData.
+    messageVector.prepend(msgId); //Add msgId
+    messageVector.prepend(uCId); //Add uC id
+    messageVector.append(calculateCRC(messageVector));
+
+    //Only the frame bytes, like the frames of the FrameTemplates
+    QByteArray newFrame;
+    newFrame.reserve(2 * messageVector.size() + 2);
+    newFrame.append(static_cast<char>(DebugProtocolV0Enums::ProtocolChar::STX));
+    for (auto value : qAsConst(messageVector))
+    {
+        appendEscaped(newFrame, value);
+    }
+    newFrame.append(static_cast<char>(DebugProtocolV0Enums::ProtocolChar::ETX));
+    qCDebug(frameLog) << "Send message: " << newFrame.toHex(' ');
+    return newFrame;
+}
+
+QByteArray TransportLayerV0::templateFrame(uint8_t uCId, uint8_t msgId, const QVector<uint8_t> &messageVector)
+{
+    auto frameTemplate = m_frameTemplates.constFind(qMakePair(uCId, messageVector));
+    if (frameTemplate == m_frameTemplates.constEnd())
+    {
+        if (m_frameTemplates.size() >= maxFrameTemplates)
+        {
+            m_frameTemplates.clear();
+        }
+
+        FrameTemplate newTemplate;
+        newTemplate.head.append(static_cast<char>(DebugProtocolV0Enums::ProtocolChar::STX));
+        appendEscaped(newTemplate.head, uCId);
+        for (auto value : messageVector)
+        {
+            appendEscaped(newTemplate.body, value);
+        }
+
+        QVector<uint8_t> crcInput;
+        crcInput.append(uCId);
+        crcInput.append(0);
+        crcInput.append(messageVector);
+        newTemplate.crc = calculateCRC(crcInput);
+        crcInput.fill(0);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crcInput[1] = static_cast<uint8_t>(1 << bit);
+            newTemplate.msgIdCrc[bit] = calculateCRC(crcInput);
+        }
+        frameTemplate = m_frameTemplates.insert(qMakePair(uCId, messageVector), newTemplate);
+    }
+
+    uint8_t crc = frameTemplate->crc;
+    for (int bit = 0; bit < 8; bit++)
+    {
+        if (msgId & (1 << bit))
+        {
+            crc ^= frameTemplate->msgIdCrc[bit];
+        }
+    }
+
+    QByteArray newFrame;
+    newFrame.reserve(frameTemplate->head.size() + frameTemplate->body.size() + 5);
+    newFrame.append(frameTemplate->head);
+    appendEscaped(newFrame, msgId);
+    newFrame.append(frameTemplate->body);
+    appendEscaped(newFrame, crc);
+    newFrame.append(static_cast<char>(DebugProtocolV0Enums::ProtocolChar::ETX));
+    return newFrame;
+}
+
+void TransportLayerV0::appendEscaped(QByteArray &frame, uint8_t value)
+{
+    if (value == DebugProtocolV0Enums::ProtocolChar::ETX ||
+        value == DebugProtocolV0Enums::ProtocolChar::STX ||
+        value == DebugProtocolV0Enums::ProtocolChar::ESC)
+    {
+        frame.append(static_cast<char>(DebugProtocolV0Enums::ProtocolChar::ESC));
+        value ^= DebugProtocolV0Enums::ProtocolChar::ESC;
+    }
+    frame.append(static_cast<char>(value));
+}
+
+void TransportLayerV0::send(uint8_t uCId, TransportLayerV0::Window &window, const QVector<uint8_t> &messageVector, quint32 requestId)
+{
+    uint8_t id = msgId(window);
+    Request& request = window.inFlight[id];
+    request.messageVector = messageVector;
+    if (m_frameTemplatesEnabled && messageVector.first() == DebugProtocolV0Enums::QueryRegister)
+    {
+        request.frame = templateFrame(uCId, id, messageVector);
+    }
+    else
+    {
+        request.frame = frame(uCId, id, messageVector);
+    }
+    request.sentTime = m_clock.elapsed();
+    request.retries = 0;
+    request.requestId = requestId;
+
+    m_sentFrames++;
+    writeFrame(request.frame);
+    if (!m_timeoutTimer.isActive())
+    {
+        m_timeoutTimer.start(qMax(10, m_responseTimeout / 4));
+    }
+}
+
+void TransportLayerV0::sendWaiting(uint8_t uCId, TransportLayerV0::Window &window)
+{
+    //A waiting burst request may use the burst window, like when it was requested
+    while (!window.waiting.isEmpty() && window.inFlight.size() < windowSize(window.waiting.head().burst))
+    {
+        WaitingRequest waiting = window.waiting.dequeue();
+        send(uCId, window, waiting.messageVector, waiting.requestId);
+    }
+}
+
+bool TransportLayerV0::receivedResponse(uint8_t uCId, uint8_t msgId, const QVector<uint8_t> &messageVector, quint32& requestId)
+{
+    auto window = m_windows.find(uCId);
+    if (window == m_windows.end() || !isTracked(uCId, messageVector))
+    {
+        return true;
+    }
+
+    auto request = window->inFlight.find(msgId);
+    if (request != window->inFlight.end())
+    {
+        if (!matchesRequest(request->messageVector, messageVector))
+        {
+            //Late response to an earlier request with the same msgId
+            m_duplicateFrames++;
+            return false;
+        }
+        requestId = request->requestId;
+        if (request->retries > 0)
+        {
+            quarantine(*window, msgId);
+        }
+        window->inFlight.erase(request);
+        window->answered.append(msgId);
+        if (window->answered.size() > maxAnsweredMsgIds)
+        {
+            window->answered.removeFirst();
+        }
+        sendWaiting(uCId, *window);
+        return true;
+    }
+
+    if (window->answered.contains(msgId) || window->quarantined.contains(msgId))
+    {
+        m_duplicateFrames++;
+        return false;
+    }
+
+    //Not a response to a tracked request, for instance to the broadcast scan
+    return true;
 }
 
 uint8_t TransportLayerV0::msgId()
 {
-    m_msgId++;
-    if (m_msgId == 0)
+    return nextMsgId(m_msgId);
+}
+
+uint8_t TransportLayerV0::nextMsgId(uint8_t &lastMsgId)
+{
+    lastMsgId++;
+    if (lastMsgId == 0)
     {
-        m_msgId++;
+        lastMsgId++;
     }
-    return m_msgId;
+    return lastMsgId;
 }
 
-void TransportLayerV0::addEscapeCharacters(QVector<uint8_t> &messageVector)
+bool TransportLayerV0::unpackFrame(const char *data, int size, QVector<uint8_t> &messageVector)
 {
-    for(int i = messageVector.size() -1; i >= 0; i--)
+    messageVector.clear();
+    messageVector.reserve(size);
+    for (int i = 0; i < size; i++)
     {
-        if (messageVector.at(i) == DebugProtocolV0Enums::ProtocolChar::ETX ||
-                messageVector.at(i) == DebugProtocolV0Enums::ProtocolChar::STX ||
-                messageVector.at(i) == DebugProtocolV0Enums::ProtocolChar::ESC)
+        auto value = static_cast<uint8_t>(data[i]);
+        if (value == DebugProtocolV0Enums::ProtocolChar::ESC && i + 1 < size)
         {
-            uint8_t value = messageVector.at(i);
-            messageVector.replace(i, DebugProtocolV0Enums::ProtocolChar::ESC ^ value);
-            messageVector.insert(i, DebugProtocolV0Enums::ProtocolChar::ESC);
+            value = static_cast<uint8_t>(data[++i]) ^ DebugProtocolV0Enums::ProtocolChar::ESC;
         }
+        messageVector.append(value);
     }
+
+    //uC id, msgId, command and CRC
+    if (messageVector.size() < 4)
+    {
+        return false;
+    }
+    uint8_t crc = messageVector.takeLast();
+    return crc == calculateCRC(messageVector);
 }
 
-void TransportLayerV0::replaceEscapeCharacters(QVector<uint8_t> &messageVector)
+bool TransportLayerV0::readHeader(const char *data, int size, uint8_t &uCId, uint8_t &command)
 {
-    for (int i = 0 ; i < messageVector.size() ; i++)
+    //uC id, msgId and command, each can be escaped
+    uint8_t header[3];
+    int index = 0;
+    for (auto& value : header)
     {
-        if (messageVector[i] == DebugProtocolV0Enums::ProtocolChar::ESC)
+        if (index >= size)
+        {
+            return false;
+        }
+        value = static_cast<uint8_t>(data[index++]);
+        if (value == DebugProtocolV0Enums::ProtocolChar::ESC)
         {
-            messageVector.remove(i);
-            uint8_t value = (DebugProtocolV0Enums::ProtocolChar::ESC ^ messageVector[i]);
-            messageVector.replace(i,value);
+            if (index >= size)
+            {
+                return false;
+            }
+            value = static_cast<uint8_t>(data[index++]) ^ DebugProtocolV0Enums::ProtocolChar::ESC;
         }
     }
+    uCId = header[0];
+    command = header[2];
+    return true;
 }
 
 uint8_t TransportLayerV0::calculateCRC(const QVector<uint8_t>& messageVector)
@@ -21,7 +21,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../BaseInterface/TransportLayerBase.h"
 #include "../BaseInterface/Common.h"
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QPair>
+#include <QTimer>
+#include <QElapsedTimer>
 
+/**
+ * @brief Frames protocol commands and keeps track of the requests that wait for a response.
+ *
+ * Every request to a single Cpu is kept in the in flight window of that Cpu under its msgId until
+ * the response with the same msgId arrives. Up to maxInFlight() requests per Cpu are sent without
+ * waiting, further requests are queued. The commands of a configuration burst, all debug channels and
+ * the decimation of a Cpu, may use burstWindow() more places, so a burst is never split. A request without a response after the response timeout is
+ * sent again with the same msgId once the CommandQueue lets it pass, after maxRetries() retransmissions it is dropped and
+ * requestTimedOut() is emitted. A response to a msgId that was already answered, for instance the
+ * late response to a retransmitted request, is dropped.
+ *
+ * msgIds are counted per Cpu. The msgId of a retransmitted request can still get late responses,
+ * so it is not reused until those can no longer arrive. A response must also match the command of
+ * the request, and the offset for a QueryRegister, before it completes the request.
+ *
+ * Broadcasts and the commands a Cpu sends on its own, ReadChannelData and DebugString, are not
+ * tracked. With setChannelDataUnchecked() only the header of a ReadChannelData frame is read here,
+ * the escape characters and CRC are handled by the ChannelDataDecoder workers.
+ *
+ * Polling sends the same QueryRegister commands over and over. Their frames are built once into a
+ * FrameTemplate; per send only the msgId is inserted and the CRC is patched for it. All frames are
+ * written as raw bytes, from STX up to ETX.
+ */
 class TransportLayerV0 : public TransportLayerBase
 {
     Q_OBJECT
@@ -29,21 +58,108 @@ public:
     explicit TransportLayerV0(QObject *parent = nullptr);
     virtual ~TransportLayerV0();
 
+    int maxInFlight() const {return m_maxInFlight;}
+    void setMaxInFlight(int maxInFlight) {m_maxInFlight = qBound(1, maxInFlight, 128);}
+    int responseTimeout() const {return m_responseTimeout;}
+    void setResponseTimeout(int milliseconds) {m_responseTimeout = qMax(1, milliseconds);}
+    int maxRetries() const {return m_maxRetries;}
+    void setMaxRetries(int retries) {m_maxRetries = qMax(0, retries);}
+    bool frameTemplatesEnabled() const {return m_frameTemplatesEnabled;}
+    void setFrameTemplatesEnabled(bool enabled) {m_frameTemplatesEnabled = enabled;}    /**< On by default, off to compare in benchmarks */
+    int burstWindow() const {return m_burstWindow;}
+    void setBurstWindow(int burstWindow) {m_burstWindow = qBound(0, burstWindow, 64);}
+    int inFlight(uint8_t uCId) const {return m_windows.value(uCId).inFlight.size();}
+    int availableWindow(uint8_t uCId, bool burst = false) const override;
 
+    /**
+     * @brief Remove the escape characters of a received frame and check its CRC, safe on any thread
+     * @param data the bytes between STX and ETX.
+     * @param messageVector uC id, msgId and protocol command, without the CRC.
+     * @return false if the frame is too short or its CRC is incorrect.
+     */
+    static bool unpackFrame(const char* data, int size, QVector<uint8_t>& messageVector);
+    QList<uint8_t> retransmissionCpus() const override;
+    int nextRetransmissionSize(uint8_t uCId) override;
+    void sendRetransmission(uint8_t uCId) override;
 
 public slots:
     void sendDebugProtocolCommand(uint8_t uCId, QVector<uint8_t> messageVector) override;
+    void sendDebugProtocolRequest(uint8_t uCId, QVector<uint8_t> messageVector, quint32 requestId, bool burst = false) override;
     void receivedData(QByteArray message) override;
 
+private slots:
+    void checkTimeouts();
+
 private:
+    struct Request
+    {
+        QVector<uint8_t> messageVector;     /**< Protocol command, kept for requestTimedOut() */
+        QByteArray frame;                   /**< Framed message, sent again as is */
+        qint64 sentTime = 0;                /**< ms on m_clock */
+        int retries = 0;
+        quint32 requestId = 0;              /**< 0 when nobody waits for the outcome */
+        bool retransmissionDue = false;     /**< Timed out, waits in Window::retransmissions */
+    };
+
+    /**
+     * @brief Frame of a repeated command without its msgId.
+     *
+     * The CRC is linear in its input, so the CRC of a frame is the CRC of the frame with msgId 0,
+     * xor-ed with the CRC contribution of every bit that is set in the msgId.
+     */
+    struct FrameTemplate
+    {
+        QByteArray head;        /**< STX and the escaped uC id */
+        QByteArray body;        /**< Escaped protocol command */
+        uint8_t crc = 0;        /**< CRC with msgId 0 */
+        uint8_t msgIdCrc[8];    /**< CRC contribution of each msgId bit */
+    };
+
+    struct WaitingRequest
+    {
+        QVector<uint8_t> messageVector;
+        quint32 requestId = 0;
+        bool burst = false;                 /**< May use the burst window once it is sent */
+    };
+
+    struct Window
+    {
+        QMap<uint8_t, Request> inFlight;            /**< Requests by msgId */
+        QQueue<WaitingRequest> waiting;             /**< Requests that did not fit in the window, in order */
+        QVector<uint8_t> answered;                  /**< Recently answered msgIds, to drop duplicates */
+        QQueue<uint8_t> retransmissions;            /**< msgIds of timed out requests, in order of their timeout */
+        QMap<uint8_t, qint64> quarantined;          /**< msgIds that can still get a late response, until ms on m_clock */
+        uint8_t lastMsgId = 0;
+    };
+
+    static bool isTracked(uint8_t uCId, const QVector<uint8_t>& messageVector);
+    uint8_t msgId(Window& window);
+    void quarantine(Window& window, uint8_t msgId);
+    static bool matchesRequest(const QVector<uint8_t>& request, const QVector<uint8_t>& response);
+    static uint8_t nextMsgId(uint8_t& lastMsgId);
+    QByteArray frame(uint8_t uCId, uint8_t msgId, QVector<uint8_t> messageVector);
+    QByteArray templateFrame(uint8_t uCId, uint8_t msgId, const QVector<uint8_t>& messageVector);
+    static void appendEscaped(QByteArray& frame, uint8_t value);
+    static bool readHeader(const char* data, int size, uint8_t& uCId, uint8_t& command);
+    void send(uint8_t uCId, Window& window, const QVector<uint8_t>& messageVector, quint32 requestId);
+    int windowSize(bool burst) const {return m_maxInFlight + (burst ? m_burstWindow : 0);}
+    void sendWaiting(uint8_t uCId, Window& window);
+    bool receivedResponse(uint8_t uCId, uint8_t msgId, const QVector<uint8_t>& messageVector, quint32& requestId);
     uint8_t msgId();
-    uint8_t calculateCRC(const QVector<uint8_t>& messageVector);
-    void addEscapeCharacters(QVector<uint8_t>& messageVector);
-    void replaceEscapeCharacters(QVector<uint8_t>& messageVector);
+    static uint8_t calculateCRC(const QVector<uint8_t>& messageVector);
 
 private:
     uint8_t m_msgId = 0;
     QByteArray m_dataBuffer;
+    QHash<uint8_t, Window> m_windows;
+    QHash<QPair<uint8_t, QVector<uint8_t>>, FrameTemplate> m_frameTemplates;   /**< By uC id and QueryRegister command */
+    QTimer m_timeoutTimer;
+    QElapsedTimer m_clock;
+    int m_maxInFlight = 16;
+    int m_burstWindow = 24;     /**< Extra places for a burst: 16 debug channels, the decimation and reset time */
+    int m_responseTimeout = 250;
+    int m_maxRetries = 3;
+    bool m_frameTemplatesEnabled = true;
 };
 
 #endif // TRANSPORTLAYERV0_H
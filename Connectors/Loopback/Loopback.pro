@@ -0,0 +1,21 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+CONFIG += staticlib
+QT              += network widgets
+HEADERS         = LoopbackMedium.h \
+    LoopbackLink.h \
+    LoopbackSettings.h \
+    ../../Tools/TargetSimulator/TargetSimulator.h
+
+SOURCES         = LoopbackMedium.cpp \
+    LoopbackLink.cpp \
+    ../../Tools/TargetSimulator/TargetSimulator.cpp \
+    LoopbackSettings.cpp
+
+TARGET          = $$qtLibraryTarget(Loopback)
+DESTDIR         = ../../plugins
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+FORMS += \
+    LoopbackSettings.ui
+
@@ -0,0 +1,129 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LoopbackLink.h"
+#include <QtMath>
+
+LoopbackLink::LoopbackLink(QObject *parent) :
+    QObject(parent),
+    m_random(1)
+{
+    m_deliveryTimer.setSingleShot(true);
+    m_deliveryTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_deliveryTimer, &QTimer::timeout, this, &LoopbackLink::deliver);
+    m_clock.start();
+}
+
+void LoopbackLink::setJitter(int microseconds, LoopbackLink::Distribution distribution)
+{
+    m_jitter = qMax(0, microseconds);
+    m_distribution = distribution;
+}
+
+void LoopbackLink::clear()
+{
+    m_deliveryTimer.stop();
+    m_packets.clear();
+    m_busyUntil = 0;
+    m_lastDelivery = 0;
+}
+
+void LoopbackLink::send(const QByteArray &frame)
+{
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    qint64 sendTime = 0;
+    if (m_bandwidth > 0.0)
+    {
+        sendTime = static_cast<qint64>(frame.size() * 1e6 / m_bandwidth);
+    }
+    m_busyUntil = qMax(now, m_busyUntil) + sendTime;
+    m_sentFrames++;
+
+    if (m_lossRate > 0.0 && m_random.generateDouble() < m_lossRate)
+    {
+        m_lostFrames++;
+        return;
+    }
+
+    QByteArray data = frame;
+    if (m_corruptionRate > 0.0 && !data.isEmpty() && m_random.generateDouble() < m_corruptionRate)
+    {
+        int index = static_cast<int>(m_random.bounded(static_cast<quint32>(data.size())));
+        data[index] = static_cast<char>(data.at(index) ^ (1 << m_random.bounded(8)));
+        m_corruptedFrames++;
+    }
+
+    m_lastDelivery = qMax(m_lastDelivery, m_busyUntil + delay());
+    m_packets.enqueue({m_lastDelivery, data});
+    if (m_packets.size() == 1)
+    {
+        scheduleDelivery();
+    }
+}
+
+void LoopbackLink::deliver()
+{
+    //Always from the event loop, so a medium is never re-entered from its own write
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    QByteArray data;
+    while (!m_packets.isEmpty() && m_packets.head().deliveryTime <= now)
+    {
+        data.append(m_packets.dequeue().data);
+    }
+    scheduleDelivery();
+    if (!data.isEmpty())
+    {
+        m_deliveredBytes += static_cast<quint64>(data.size());
+        emit delivered(data);
+    }
+}
+
+qint64 LoopbackLink::delay()
+{
+    if (m_jitter == 0)
+    {
+        return m_latency;
+    }
+
+    double variation = 0.0;
+    switch (m_distribution)
+    {
+    case Distribution::Uniform:
+        variation = (m_random.generateDouble() * 2.0 - 1.0) * m_jitter;
+        break;
+    case Distribution::Normal:
+        //Box-Muller, 1 - u so the logarithm never gets 0
+        variation = qSqrt(-2.0 * qLn(1.0 - m_random.generateDouble())) * qCos(2.0 * M_PI * m_random.generateDouble()) * m_jitter;
+        break;
+    case Distribution::Exponential:
+        variation = -qLn(1.0 - m_random.generateDouble()) * m_jitter;
+        break;
+    }
+    return qMax<qint64>(0, m_latency + static_cast<qint64>(variation));
+}
+
+void LoopbackLink::scheduleDelivery()
+{
+    if (m_packets.isEmpty())
+    {
+        return;
+    }
+    qint64 wait = m_packets.head().deliveryTime - m_clock.nsecsElapsed() / 1000;
+    m_deliveryTimer.start(static_cast<int>(qMax<qint64>(0, (wait + 999) / 1000)));
+}
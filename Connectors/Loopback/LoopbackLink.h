@@ -0,0 +1,133 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOOPBACKLINK_H
+#define LOOPBACKLINK_H
+
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+/**
+ * @brief One direction of an emulated link between the host and an in-process target.
+ *
+ * Every frame occupies the link for its size divided by the bandwidth, then arrives after the latency
+ * plus a jitter drawn from the delay distribution. Frames never overtake each other, as on a byte stream.
+ * A lost frame still occupies the link, as it would on a real wire, and a corrupted frame arrives with
+ * one bit flipped. Frames that are due at the same time are delivered together, like a read from a socket.
+ * The jitter, losses and corruption come from a seeded generator, so a run can be repeated exactly.
+ */
+class LoopbackLink : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Distribution{
+        Uniform,    /**< Between -jitter and +jitter */
+        Normal,     /**< Standard deviation of jitter */
+        Exponential /**< Only later, with a mean of jitter */
+    };
+
+    explicit LoopbackLink(QObject* parent = nullptr);
+
+    /**
+     * @param microseconds from the end of sending a frame until it arrives.
+     */
+    void setLatency(int microseconds) {m_latency = qMax(0, microseconds);}
+    int latency() const {return m_latency;}
+
+    /**
+     * @brief Set the variation on the latency, the delay is never negative
+     * @param microseconds scale of the distribution, 0 for a fixed latency.
+     */
+    void setJitter(int microseconds, Distribution distribution);
+    int jitter() const {return m_jitter;}
+    Distribution distribution() const {return m_distribution;}
+
+    /**
+     * @param bytesPerSecond that the link can carry, 0 for no limit.
+     */
+    void setBandwidth(double bytesPerSecond) {m_bandwidth = qMax(0.0, bytesPerSecond);}
+    double bandwidth() const {return m_bandwidth;}
+
+    /**
+     * @param fraction of the frames that is lost, from 0 to 1.
+     */
+    void setLossRate(double fraction) {m_lossRate = qBound(0.0, fraction, 1.0);}
+    double lossRate() const {return m_lossRate;}
+
+    /**
+     * @param fraction of the frames that arrives with a bit flipped, from 0 to 1.
+     */
+    void setCorruptionRate(double fraction) {m_corruptionRate = qBound(0.0, fraction, 1.0);}
+    double corruptionRate() const {return m_corruptionRate;}
+
+    void setSeed(quint32 seed) {m_random.seed(seed);}
+
+    /**
+     * @brief Drop the frames that are on the way
+     */
+    void clear();
+
+    quint64 sentFrames() const {return m_sentFrames;}
+    quint64 lostFrames() const {return m_lostFrames;}
+    quint64 corruptedFrames() const {return m_corruptedFrames;}
+    quint64 deliveredBytes() const {return m_deliveredBytes;}
+
+public slots:
+    /**
+     * @brief Put a frame on the link
+     */
+    void send(const QByteArray& frame);
+
+signals:
+    void delivered(const QByteArray& data);
+
+private:
+    struct Packet
+    {
+        qint64 deliveryTime;    /**< us on m_clock */
+        QByteArray data;
+    };
+
+    void deliver();
+    void scheduleDelivery();
+    qint64 delay();
+
+private:
+    QQueue<Packet> m_packets;
+    QTimer m_deliveryTimer;
+    QElapsedTimer m_clock;
+    QRandomGenerator m_random;
+    int m_latency = 0;
+    double m_bandwidth = 0.0;
+    int m_jitter = 0;
+    Distribution m_distribution = Distribution::Uniform;
+    double m_lossRate = 0.0;
+    double m_corruptionRate = 0.0;
+    qint64 m_busyUntil = 0;     /**< us on m_clock when the last frame is completely sent */
+    qint64 m_lastDelivery = 0;  /**< us on m_clock when the last frame arrives */
+    quint64 m_sentFrames = 0;
+    quint64 m_lostFrames = 0;
+    quint64 m_corruptedFrames = 0;
+    quint64 m_deliveredBytes = 0;
+};
+
+#endif // LOOPBACKLINK_H
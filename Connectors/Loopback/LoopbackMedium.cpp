@@ -0,0 +1,143 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LoopbackMedium.h"
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+#include "LoopbackSettings.h"
+#endif
+#include "../DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../../Tools/TargetSimulator/TargetSimulator.h"
+#include <QDebug>
+
+LoopbackMedium::LoopbackMedium(QObject *parent) :
+    ProtocolMedium(parent),
+    m_uplink(this),
+    m_downlink(this)
+{
+    QObject::connect(&m_downlink, &LoopbackLink::delivered, this, &LoopbackMedium::receivedData);
+}
+
+LoopbackMedium::~LoopbackMedium()
+{
+    disconnect();
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    delete m_loopbackSettingsDialog;
+#endif
+}
+
+void LoopbackMedium::setLink(int latency, double bandwidth, double lossRate)
+{
+    for (auto link : {&m_uplink, &m_downlink})
+    {
+        link->setLatency(latency);
+        link->setBandwidth(bandwidth);
+        link->setLossRate(lossRate);
+    }
+}
+
+void LoopbackMedium::setSeed(quint32 seed)
+{
+    m_uplink.setSeed(seed);
+    m_downlink.setSeed(seed + 1);
+}
+
+void LoopbackMedium::connect()
+{
+    m_settings.beginGroup("Loopback");
+    int cpuCount = m_settings.value("Cpus", m_cpuCount).toInt();
+    int sampleRate = m_settings.value("SampleRate", m_sampleRate).toInt();
+    int latency = m_settings.value("Latency", 0).toInt();
+    double bandwidth = m_settings.value("Bandwidth", 0.0).toDouble();
+    double loss = m_settings.value("Loss", 0.0).toDouble();
+    m_settings.endGroup();
+
+    setLink(latency, bandwidth * 1024.0, loss / 100.0);
+    open(cpuCount, sampleRate);
+}
+
+void LoopbackMedium::open(int cpuCount, int sampleRate)
+{
+    createProtocolLayers();
+    closeSimulator();
+    m_cpuCount = qMax(1, cpuCount);
+    m_sampleRate = sampleRate;
+
+    m_simulator = new TargetSimulator(m_cpuCount, this);
+    m_simulator->setSampleRate(m_sampleRate);
+    QObject::connect(m_simulator, &TargetSimulator::write, &m_downlink, &LoopbackLink::send);
+    QObject::connect(&m_uplink, &LoopbackLink::delivered, m_simulator, &TargetSimulator::receivedData);
+    m_simulator->start();
+    connectionOpened();
+}
+
+void LoopbackMedium::reconnect()
+{
+    clearPendingCommands();
+    open(m_cpuCount, m_sampleRate);
+}
+
+void LoopbackMedium::disconnect()
+{
+    m_reconnectScheduler.stop();
+    closeSimulator();
+    setConnected(false);
+    clearModels();
+    destroyProtocolLayers();
+}
+
+void LoopbackMedium::showSettings()
+{
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    if (m_loopbackSettingsDialog == nullptr)
+    {
+        m_loopbackSettingsDialog = new LoopbackSettings();
+    }
+    m_loopbackSettingsDialog->show();
+#else
+    qWarning() << "No settings dialog without widgets, the settings are read from QSettings";
+#endif
+}
+
+void LoopbackMedium::writeData(const QByteArray &data)
+{
+    //Split the batch, so the link loses whole frames
+    int start = 0;
+    while (start < data.size())
+    {
+        int end = data.indexOf(static_cast<char>(DebugProtocolV0Enums::ETX), start);
+        if (end < 0)
+        {
+            end = data.size() - 1;
+        }
+        m_uplink.send(data.mid(start, end - start + 1));
+        start = end + 1;
+    }
+}
+
+void LoopbackMedium::closeSimulator()
+{
+    m_uplink.clear();
+    m_downlink.clear();
+    if (m_simulator != nullptr)
+    {
+        m_simulator->stop();
+        delete m_simulator;
+        m_simulator = nullptr;
+    }
+}
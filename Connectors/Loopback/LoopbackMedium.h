@@ -0,0 +1,90 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOOPBACKMEDIUM_H
+#define LOOPBACKMEDIUM_H
+
+#include <QSettings>
+#include "LoopbackLink.h"
+#include "../BaseInterface/ProtocolMedium.h"
+
+class TargetSimulator;
+class LoopbackSettings;
+
+/**
+ * @brief Medium that connects the protocol stack to an in-process TargetSimulator.
+ *
+ * The frames go through memory, over a LoopbackLink in each direction with the configured latency,
+ * bandwidth and loss. Without a socket or a driver in between, benchmarks measure the protocol stack
+ * and the application, and a run with the same settings and seed loses the same frames.
+ */
+class LoopbackMedium : public ProtocolMedium
+{
+    Q_OBJECT
+public:
+    explicit LoopbackMedium(QObject* parent = nullptr);
+    virtual ~LoopbackMedium();
+
+    /**
+     * @brief Set the properties of both directions of the link
+     * @param latency in us.
+     * @param bandwidth in bytes per second, 0 for no limit.
+     * @param lossRate fraction of the frames that is lost, from 0 to 1.
+     */
+    void setLink(int latency, double bandwidth, double lossRate);
+    void setSeed(quint32 seed);
+
+    LoopbackLink& uplink() {return m_uplink;}       /**< From the host to the target */
+    LoopbackLink& downlink() {return m_downlink;}   /**< From the target to the host */
+    TargetSimulator* simulator() const {return m_simulator;}   /**< nullptr when not connected */
+
+public slots:
+    void connect() override;
+    void disconnect() override;
+    void showSettings() override;
+
+    /**
+     * @brief Start a simulator and connect to it
+     * @param cpuCount number of simulated Cpu`s.
+     * @param sampleRate channel data samples per second before decimation.
+     */
+    void open(int cpuCount, int sampleRate);
+
+    /**
+     * @brief Connect to a fresh simulator without clearing the Cpu and Register models
+     */
+    void reconnect() override;
+
+protected:
+    void writeData(const QByteArray& data) override;
+
+private:
+    void closeSimulator();
+
+private:
+    TargetSimulator* m_simulator = nullptr;
+    LoopbackLink m_uplink;
+    LoopbackLink m_downlink;
+    int m_cpuCount = 1;
+    int m_sampleRate = 1000;
+    LoopbackSettings* m_loopbackSettingsDialog = nullptr;
+    QSettings m_settings;
+};
+
+#endif // LOOPBACKMEDIUM_H
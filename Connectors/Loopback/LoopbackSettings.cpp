@@ -0,0 +1,54 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LoopbackSettings.h"
+#include "ui_LoopbackSettings.h"
+
+LoopbackSettings::LoopbackSettings(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::LoopbackSettings)
+{
+    ui->setupUi(this);
+
+    m_settings.beginGroup("Loopback");
+    ui->CpusSpinBox->setValue(m_settings.value(m_settingsCpus, 1).toInt());
+    ui->SampleRateSpinBox->setValue(m_settings.value(m_settingsSampleRate, 1000).toInt());
+    ui->LatencySpinBox->setValue(m_settings.value(m_settingsLatency, 0).toInt());
+    ui->BandwidthSpinBox->setValue(m_settings.value(m_settingsBandwidth, 0).toInt());
+    ui->LossSpinBox->setValue(m_settings.value(m_settingsLoss, 0.0).toDouble());
+    m_settings.endGroup();
+}
+
+LoopbackSettings::~LoopbackSettings()
+{
+    delete ui;
+}
+
+void LoopbackSettings::on_buttonBox_accepted()
+{
+    //User Clicked OK.
+    m_settings.beginGroup("Loopback");
+    m_settings.setValue(m_settingsCpus, ui->CpusSpinBox->value());
+    m_settings.setValue(m_settingsSampleRate, ui->SampleRateSpinBox->value());
+    m_settings.setValue(m_settingsLatency, ui->LatencySpinBox->value());
+    m_settings.setValue(m_settingsBandwidth, ui->BandwidthSpinBox->value());
+    m_settings.setValue(m_settingsLoss, ui->LossSpinBox->value());
+    m_settings.endGroup();
+    close();
+}
@@ -0,0 +1,54 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOOPBACKSETTINGS_H
+#define LOOPBACKSETTINGS_H
+
+#include <QDialog>
+#include <QSettings>
+
+namespace Ui {
+class LoopbackSettings;
+}
+
+/**
+ * @brief Dialog for the simulated Cpu`s and the link properties of the loopback medium
+ */
+class LoopbackSettings : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LoopbackSettings(QWidget *parent = nullptr);
+    ~LoopbackSettings();
+
+private slots:
+    void on_buttonBox_accepted();
+
+private:
+    Ui::LoopbackSettings *ui;
+    QSettings m_settings;
+    const QString m_settingsCpus = "Cpus";
+    const QString m_settingsSampleRate = "SampleRate";
+    const QString m_settingsLatency = "Latency";
+    const QString m_settingsBandwidth = "Bandwidth";
+    const QString m_settingsLoss = "Loss";
+};
+
+#endif // LOOPBACKSETTINGS_H
@@ -0,0 +1,520 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "EpollPoller.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+static const int maximumEvents = 256;
+static const int readSize = 64 * 1024;
+static const int maximumReadPerEvent = 4 * readSize;    /**< Bytes read from one socket per readiness event, so a busy target does not starve the others */
+
+EpollPoller::EpollPoller(QObject *parent) :
+    QThread(parent)
+{
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epoll < 0 || m_wakeup < 0)
+    {
+        qWarning() << "Could not create the epoll set:" << strerror(errno);
+        return;
+    }
+    epoll_event wakeupEvent = {};
+    wakeupEvent.events = EPOLLIN;
+    wakeupEvent.data.u64 = 0;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &wakeupEvent);
+}
+
+EpollPoller::~EpollPoller()
+{
+    stop();
+    for (auto& socket : m_sockets)
+    {
+        ::close(socket.fd);
+    }
+    if (m_wakeup >= 0)
+    {
+        ::close(m_wakeup);
+    }
+    if (m_epoll >= 0)
+    {
+        ::close(m_epoll);
+    }
+}
+
+int EpollPoller::addClient(EpollPoller::Client *client)
+{
+    int id = m_nextId++;
+    m_clients.insert(id, client);
+    m_generations.insert(id, 0);
+    return id;
+}
+
+void EpollPoller::removeClient(int id)
+{
+    close(id);
+    m_clients.remove(id);
+    m_generations.remove(id);
+}
+
+void EpollPoller::open(int id, const QHostAddress &address, quint16 port)
+{
+    quint32 generation = ++m_generations[id];
+    request({Request::Open, id, generation, address, port});
+}
+
+void EpollPoller::close(int id)
+{
+    //Events of the closed socket are not dispatched anymore
+    m_generations[id]++;
+    request({Request::Close, id, 0, QHostAddress(), 0});
+}
+
+qint64 EpollPoller::write(int id, const QByteArray &data)
+{
+    qint64 queued;
+    {
+        QMutexLocker locker(&m_mutex);
+        QByteArray& outbound = m_outbound[id];
+        outbound.append(data);
+        queued = outbound.size();
+    }
+    requestFlush(id);
+    return queued;
+}
+
+void EpollPoller::notifyWhenWritten(int id)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_notifyWritten.insert(id);
+    }
+    //The queue can already be empty, the flush checks it again
+    requestFlush(id);
+}
+
+void EpollPoller::requestFlush(int id)
+{
+    bool wakeNeeded;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_flushRequested.contains(id))
+        {
+            return;
+        }
+        m_flushRequested.insert(id);
+        wakeNeeded = m_requests.isEmpty();
+        m_requests.append({Request::Flush, id, 0, QHostAddress(), 0});
+    }
+    if (wakeNeeded)
+    {
+        wake();
+    }
+}
+
+void EpollPoller::stop()
+{
+    if (isRunning())
+    {
+        m_stopping.storeRelease(1);
+        wake();
+        wait();
+    }
+}
+
+void EpollPoller::request(const EpollPoller::Request &newRequest)
+{
+    bool wakeNeeded;
+    {
+        QMutexLocker locker(&m_mutex);
+        wakeNeeded = m_requests.isEmpty();
+        m_requests.append(newRequest);
+    }
+    if (wakeNeeded)
+    {
+        wake();
+    }
+}
+
+void EpollPoller::wake()
+{
+    quint64 one = 1;
+    if (::write(m_wakeup, &one, sizeof(one)) < 0)
+    {
+        qWarning() << "Could not wake the I/O thread:" << strerror(errno);
+    }
+}
+
+void EpollPoller::run()
+{
+    epoll_event events[maximumEvents];
+    while (m_stopping.loadAcquire() == 0)
+    {
+        int count = epoll_wait(m_epoll, events, maximumEvents, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            qWarning() << "epoll_wait failed:" << strerror(errno);
+            break;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int id = static_cast<int>(events[i].data.u64 & 0xFFFFFFFF);
+            if (id == 0)
+            {
+                quint64 wakeups;
+                if (::read(m_wakeup, &wakeups, sizeof(wakeups)) > 0)
+                {
+                    handleRequests();
+                }
+            }
+            else
+            {
+                handleSocket(id, static_cast<quint32>(events[i].data.u64 >> 32), events[i].events);
+            }
+        }
+    }
+
+    for (auto id : m_sockets.keys())
+    {
+        closeSocket(id);
+    }
+}
+
+void EpollPoller::handleRequests()
+{
+    QVector<Request> requests;
+    {
+        QMutexLocker locker(&m_mutex);
+        requests.swap(m_requests);
+        m_flushRequested.clear();
+    }
+    for (const auto& pendingRequest : requests)
+    {
+        switch (pendingRequest.type)
+        {
+        case Request::Open:
+            openSocket(pendingRequest);
+            break;
+        case Request::Close:
+            closeSocket(pendingRequest.id);
+            break;
+        case Request::Flush:
+            flushSocket(pendingRequest.id);
+            break;
+        }
+    }
+}
+
+void EpollPoller::openSocket(const EpollPoller::Request &openRequest)
+{
+    closeSocket(openRequest.id);
+
+    sockaddr_storage address = {};
+    socklen_t addressLength;
+    if (openRequest.address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        auto ipv6 = reinterpret_cast<sockaddr_in6*>(&address);
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(openRequest.port);
+        Q_IPV6ADDR bytes = openRequest.address.toIPv6Address();
+        memcpy(&ipv6->sin6_addr, &bytes, sizeof(bytes));
+        addressLength = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        auto ipv4 = reinterpret_cast<sockaddr_in*>(&address);
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(openRequest.port);
+        ipv4->sin_addr.s_addr = htonl(openRequest.address.toIPv4Address());
+        addressLength = sizeof(sockaddr_in);
+    }
+
+    int fd = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        postEvent(Event::Closed, openRequest.id, openRequest.generation, QByteArray(), QString("Could not create a socket: %1").arg(strerror(errno)));
+        return;
+    }
+    //The frames are small and sent as soon as they are ready
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    Socket& socket = m_sockets[openRequest.id];
+    socket.fd = fd;
+    socket.generation = openRequest.generation;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), addressLength) < 0 && errno != EINPROGRESS)
+    {
+        failSocket(openRequest.id, QString("Could not connect to %1:%2: %3").arg(openRequest.address.toString()).arg(openRequest.port).arg(strerror(errno)));
+        return;
+    }
+
+    //Writable when the connection is made
+    epoll_event socketEvent = {};
+    socketEvent.events = EPOLLIN | EPOLLOUT;
+    socketEvent.data.u64 = static_cast<quint64>(openRequest.generation) << 32 | static_cast<quint64>(openRequest.id);
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &socketEvent);
+}
+
+void EpollPoller::handleSocket(int id, quint32 generation, uint32_t events)
+{
+    //An event of this batch can belong to a socket that was closed and opened again by a request
+    auto socket = m_sockets.find(id);
+    if (socket == m_sockets.end() || socket->generation != generation)
+    {
+        return;
+    }
+
+    if (socket->connecting)
+    {
+        if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0)
+        {
+            return;
+        }
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        getsockopt(socket->fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+        if (error != 0)
+        {
+            failSocket(id, QString("Could not connect: %1").arg(strerror(error)));
+            return;
+        }
+        socket->connecting = false;
+        postEvent(Event::Connected, id, socket->generation);
+        updateInterest(id, *socket);
+        flushSocket(id);
+        return;
+    }
+
+    if ((events & EPOLLIN) != 0)
+    {
+        QByteArray data;
+        while (true)
+        {
+            int size = data.size();
+            data.resize(size + readSize);
+            ssize_t received = ::read(socket->fd, data.data() + size, readSize);
+            data.resize(size + static_cast<int>(qMax<ssize_t>(0, received)));
+            if (received > 0 && data.size() < maximumReadPerEvent)
+            {
+                continue;
+            }
+            if (received > 0)
+            {
+                //The socket is level triggered, the next epoll_wait reports the rest after the other sockets had their turn
+                postEvent(Event::Received, id, socket->generation, data);
+                break;
+            }
+            if (!data.isEmpty())
+            {
+                postEvent(Event::Received, id, socket->generation, data);
+            }
+            if (received == 0)
+            {
+                failSocket(id, QString());
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                failSocket(id, QString("Connection lost: %1").arg(strerror(errno)));
+                return;
+            }
+            break;
+        }
+    }
+    else if ((events & (EPOLLERR | EPOLLHUP)) != 0)
+    {
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        getsockopt(socket->fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+        failSocket(id, error != 0 ? QString("Connection lost: %1").arg(strerror(error)) : QString());
+        return;
+    }
+
+    if ((events & EPOLLOUT) != 0)
+    {
+        flushSocket(id);
+    }
+}
+
+void EpollPoller::flushSocket(int id)
+{
+    auto socket = m_sockets.find(id);
+    if (socket == m_sockets.end())
+    {
+        //Nothing can be sent before the open or after the close
+        QMutexLocker locker(&m_mutex);
+        m_outbound.remove(id);
+        return;
+    }
+    if (socket->connecting)
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto outbound = m_outbound.find(id);
+        if (outbound != m_outbound.end())
+        {
+            socket->sending.append(*outbound);
+            m_outbound.erase(outbound);
+        }
+    }
+
+    while (!socket->sending.isEmpty())
+    {
+        ssize_t sent = ::send(socket->fd, socket->sending.constData(), static_cast<size_t>(socket->sending.size()), MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            socket->sending.remove(0, static_cast<int>(sent));
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else
+        {
+            failSocket(id, QString("Could not send: %1").arg(strerror(errno)));
+            return;
+        }
+    }
+
+    if (socket->waitingForWrite != !socket->sending.isEmpty())
+    {
+        socket->waitingForWrite = !socket->sending.isEmpty();
+        updateInterest(id, *socket);
+    }
+    if (!socket->waitingForWrite)
+    {
+        bool notify;
+        {
+            QMutexLocker locker(&m_mutex);
+            notify = !m_outbound.contains(id) && m_notifyWritten.remove(id);
+        }
+        if (notify)
+        {
+            postEvent(Event::Written, id, socket->generation);
+        }
+    }
+}
+
+void EpollPoller::updateInterest(int id, EpollPoller::Socket &socket)
+{
+    epoll_event socketEvent = {};
+    socketEvent.events = EPOLLIN | (socket.waitingForWrite ? EPOLLOUT : 0);
+    socketEvent.data.u64 = static_cast<quint64>(socket.generation) << 32 | static_cast<quint64>(id);
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket.fd, &socketEvent);
+}
+
+void EpollPoller::closeSocket(int id)
+{
+    auto socket = m_sockets.find(id);
+    if (socket != m_sockets.end())
+    {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket->fd, nullptr);
+        ::close(socket->fd);
+        m_sockets.erase(socket);
+    }
+    QMutexLocker locker(&m_mutex);
+    m_outbound.remove(id);
+    m_notifyWritten.remove(id);
+}
+
+void EpollPoller::failSocket(int id, const QString &error)
+{
+    quint32 generation = m_sockets.value(id).generation;
+    closeSocket(id);
+    postEvent(Event::Closed, id, generation, QByteArray(), error);
+}
+
+void EpollPoller::postEvent(Event::Type type, int id, quint32 generation, const QByteArray &data, const QString &error)
+{
+    QMutexLocker locker(&m_mutex);
+    if (type == Event::Received)
+    {
+        //Append to the data that the owner did not get yet
+        auto pending = m_pendingReceived.constFind(id);
+        if (pending != m_pendingReceived.constEnd() && m_events.at(*pending).generation == generation)
+        {
+            m_events[*pending].data.append(data);
+            return;
+        }
+        m_pendingReceived.insert(id, m_events.size());
+    }
+    else
+    {
+        //Later data must stay after this event
+        m_pendingReceived.remove(id);
+    }
+    m_events.append({type, id, generation, data, error});
+
+    if (!m_dispatchPosted)
+    {
+        m_dispatchPosted = true;
+        QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+    }
+}
+
+void EpollPoller::dispatch()
+{
+    QVector<Event> events;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_events);
+        m_pendingReceived.clear();
+        m_dispatchPosted = false;
+    }
+
+    for (const auto& event : events)
+    {
+        //A client can close or remove connections from its callbacks
+        Client* client = m_clients.value(event.id);
+        if (client == nullptr || m_generations.value(event.id) != event.generation)
+        {
+            continue;
+        }
+        switch (event.type)
+        {
+        case Event::Connected:
+            client->pollerConnected();
+            break;
+        case Event::Received:
+            client->pollerReceived(event.data);
+            break;
+        case Event::Written:
+            client->pollerWritten();
+            break;
+        case Event::Closed:
+            client->pollerClosed(event.error);
+            break;
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef EPOLLPOLLER_H
+#define EPOLLPOLLER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QByteArray>
+#include <QHostAddress>
+
+/**
+ * @brief I/O thread that serves many TCP connections with one epoll set.
+ *
+ * The sockets are only touched by the thread, the owner talks to it with requests: open(), close() and
+ * write() are thread safe and only queue the request and wake the thread through an eventfd. What
+ * happens on the sockets is queued as events, which are dispatched to the Client of each connection
+ * on the owner thread. All data that a connection received before the owner got to the events is
+ * passed on in one call, so a busy owner handles larger blocks instead of more calls. A socket is
+ * read up to a fixed number of bytes per readiness event, the sockets are level triggered so the rest
+ * is read on the next round, after the other sockets that are ready.
+ *
+ * Every open() starts a new generation of its connection, events of an earlier socket that are still
+ * queued are not dispatched anymore.
+ */
+class EpollPoller : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Receives the events of one connection, on the owner thread
+     */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+        virtual void pollerConnected() = 0;
+        virtual void pollerReceived(const QByteArray& data) = 0;
+
+        /**
+         * @brief Everything that was written is handed to the socket, after notifyWhenWritten()
+         */
+        virtual void pollerWritten() = 0;
+
+        /**
+         * @brief The connection failed or was closed by the peer, in which case error is empty
+         */
+        virtual void pollerClosed(const QString& error) = 0;
+    };
+
+    explicit EpollPoller(QObject* parent = nullptr);
+    virtual ~EpollPoller();
+
+    /**
+     * @return id of the connection of the client, the client is not owned.
+     */
+    int addClient(Client* client);
+    void removeClient(int id);
+
+    void open(int id, const QHostAddress& address, quint16 port);
+    void close(int id);
+
+    /**
+     * @brief Queue data to send
+     * @return bytes that are queued for the connection and not handed to the socket yet.
+     */
+    qint64 write(int id, const QByteArray& data);
+
+    /**
+     * @brief Tell the client once all data that was written is handed to the socket
+     */
+    void notifyWhenWritten(int id);
+
+    /**
+     * @brief Stop the thread, the connections are closed
+     */
+    void stop();
+
+    int connectionCount() const {return m_clients.size();}
+
+protected:
+    void run() override;
+
+private slots:
+    void dispatch();
+
+private:
+    struct Request
+    {
+        enum Type{Open, Close, Flush};
+        Type type;
+        int id;
+        quint32 generation;
+        QHostAddress address;
+        quint16 port;
+    };
+
+    struct Event
+    {
+        enum Type{Connected, Received, Written, Closed};
+        Type type;
+        int id;
+        quint32 generation;
+        QByteArray data;
+        QString error;
+    };
+
+    struct Socket
+    {
+        int fd = -1;
+        quint32 generation = 0;
+        bool connecting = true;
+        bool waitingForWrite = false;   /**< EPOLLOUT is armed because the socket was full */
+        QByteArray sending;             /**< Taken from the outbound queue, not accepted by the socket yet */
+    };
+
+    void wake();
+    void request(const Request& newRequest);
+    void requestFlush(int id);
+    void handleRequests();
+    void handleSocket(int id, quint32 generation, uint32_t events);
+    void openSocket(const Request& openRequest);
+    void closeSocket(int id);
+    void failSocket(int id, const QString& error);
+    void flushSocket(int id);
+    void updateInterest(int id, Socket& socket);
+    void postEvent(Event::Type type, int id, quint32 generation, const QByteArray& data = QByteArray(), const QString& error = QString());
+
+private:
+    int m_epoll = -1;
+    int m_wakeup = -1;                  /**< eventfd, registered with id 0, sockets with their generation in the upper 32 bits */
+    QAtomicInt m_stopping;
+
+    //Owner thread
+    QHash<int, Client*> m_clients;
+    QHash<int, quint32> m_generations;
+    int m_nextId = 1;
+
+    //Shared, guarded by m_mutex
+    QMutex m_mutex;
+    QVector<Request> m_requests;
+    QVector<Event> m_events;
+    QHash<int, int> m_pendingReceived;  /**< Index of the Received event in m_events that data is appended to */
+    QHash<int, QByteArray> m_outbound;
+    QSet<int> m_flushRequested;
+    QSet<int> m_notifyWritten;
+    bool m_dispatchPosted = false;
+
+    //I/O thread
+    QHash<int, Socket> m_sockets;
+};
+
+#endif // EPOLLPOLLER_H
@@ -0,0 +1,21 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+CONFIG += staticlib
+QT              += network widgets
+HEADERS         = MultiTargetMedium.h \
+    TargetMedium.h \
+    EpollPoller.h \
+    MultiTargetSettings.h
+
+SOURCES         = MultiTargetMedium.cpp \
+    TargetMedium.cpp \
+    EpollPoller.cpp \
+    MultiTargetSettings.cpp
+
+TARGET          = $$qtLibraryTarget(MultiTarget)
+DESTDIR         = ../../plugins
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+FORMS += \
+    MultiTargetSettings.ui
+
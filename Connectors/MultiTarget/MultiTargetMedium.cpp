@@ -0,0 +1,185 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "MultiTargetMedium.h"
+#include "MultiTargetSettings.h"
+#include "../DebugProtocolV0/ChannelDataDecoder.h"
+#include <QSettings>
+#include <QDebug>
+
+MultiTargetMedium::MultiTargetMedium(int ioThreads, int decodeWorkers, QObject *parent) :
+    QObject(parent),
+    m_sampleExporter(m_sampleSink)
+{
+    for (int i = 0; i < qMax(1, ioThreads); i++)
+    {
+        auto poller = new EpollPoller(this);
+        poller->start();
+        m_pollers.append(poller);
+    }
+    if (decodeWorkers > 0)
+    {
+        m_channelDataDecoder = new ChannelDataDecoder(decodeWorkers);
+    }
+    QObject::connect(&m_sampleExporter, &SampleExporter::samplesDropped, this, [this](quint64 dropped)
+    {
+        qWarning() << "Sample export fell behind, dropped" << dropped << "samples, total" << m_sampleExporter.droppedSamples();
+    });
+}
+
+MultiTargetMedium::~MultiTargetMedium()
+{
+    //The targets unregister from the pollers and the decoder, so they go first
+    qDeleteAll(m_targets);
+    m_targets.clear();
+    qDeleteAll(m_pollers);
+    m_pollers.clear();
+    delete m_channelDataDecoder;
+    m_sampleExporter.stop();
+    delete m_multiTargetSettingsDialog;
+}
+
+TargetMedium *MultiTargetMedium::addTarget(const QString &hostName, quint16 port)
+{
+    if (m_targets.size() >= MaximumTargets)
+    {
+        qWarning() << "No more than" << MaximumTargets << "targets, skipped" << hostName << port;
+        return nullptr;
+    }
+    EpollPoller& poller = *m_pollers.at(m_targets.size() % m_pollers.size());
+    auto target = new TargetMedium(*this, poller, hostName, port, this);
+    if (m_channelDataDecoder != nullptr)
+    {
+        target->setChannelDataDecoder(m_channelDataDecoder);
+    }
+    else
+    {
+        target->setDecodeWorkers(0);
+    }
+    if (m_sampleExporter.isExporting())
+    {
+        target->setSampleSink(&m_sampleSink, static_cast<quint16>(m_targets.size()));
+    }
+    m_targets.append(target);
+    return target;
+}
+
+bool MultiTargetMedium::setSampleFile(const QString &fileName)
+{
+    m_sampleExporter.stop();
+    bool exporting = !fileName.isEmpty() && m_sampleExporter.start(fileName);
+
+    //Without an export nobody takes the samples, so the targets do not append them
+    for (int i = 0; i < m_targets.size(); i++)
+    {
+        m_targets.at(i)->setSampleSink(exporting ? &m_sampleSink : nullptr, static_cast<quint16>(i));
+    }
+    return exporting || fileName.isEmpty();
+}
+
+int MultiTargetMedium::addConfiguredTargets()
+{
+    QSettings settings;
+    settings.beginGroup("MultiTarget");
+    QStringList entries = settings.value("Targets").toStringList();
+    settings.endGroup();
+
+    int added = 0;
+    for (const auto& entry : entries)
+    {
+        int separator = entry.lastIndexOf(':');
+        bool portConverted = false;
+        quint16 port = separator > 0 ? static_cast<quint16>(entry.mid(separator + 1).toUInt(&portConverted)) : 0;
+        if (!portConverted || port == 0)
+        {
+            qWarning() << "Invalid target" << entry << ", expected host:port";
+            continue;
+        }
+        if (addTarget(entry.left(separator).trimmed(), port) != nullptr)
+        {
+            added++;
+        }
+    }
+    return added;
+}
+
+int MultiTargetMedium::configuredIoThreads()
+{
+    QSettings settings;
+    settings.beginGroup("MultiTarget");
+    int ioThreads = settings.value("IoThreads", 1).toInt();
+    settings.endGroup();
+    return ioThreads;
+}
+
+int MultiTargetMedium::configuredDecodeWorkers()
+{
+    QSettings settings;
+    settings.beginGroup("MultiTarget");
+    int decodeWorkers = settings.value("DecodeWorkers", ChannelDataDecoder::defaultWorkers()).toInt();
+    settings.endGroup();
+    return decodeWorkers;
+}
+
+QString MultiTargetMedium::configuredSampleFile()
+{
+    QSettings settings;
+    settings.beginGroup("MultiTarget");
+    QString sampleFile = settings.value("SampleFile").toString();
+    settings.endGroup();
+    return sampleFile;
+}
+
+int MultiTargetMedium::connectedTargets() const
+{
+    int connected = 0;
+    for (auto target : m_targets)
+    {
+        if (target->isConnected())
+        {
+            connected++;
+        }
+    }
+    return connected;
+}
+
+void MultiTargetMedium::connectAll()
+{
+    for (auto target : qAsConst(m_targets))
+    {
+        target->connect();
+    }
+}
+
+void MultiTargetMedium::disconnectAll()
+{
+    for (auto target : qAsConst(m_targets))
+    {
+        target->disconnect();
+    }
+}
+
+void MultiTargetMedium::showSettings()
+{
+    if (m_multiTargetSettingsDialog == nullptr)
+    {
+        m_multiTargetSettingsDialog = new MultiTargetSettings();
+    }
+    m_multiTargetSettingsDialog->show();
+}
@@ -0,0 +1,99 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MULTITARGETMEDIUM_H
+#define MULTITARGETMEDIUM_H
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include "TargetMedium.h"
+#include "../BaseInterface/SampleSink.h"
+#include "../BaseInterface/SampleExporter.h"
+
+class MultiTargetSettings;
+class ChannelDataDecoder;
+
+/**
+ * @brief Connects to many targets, for instance all boards of a test rack, from a few I/O threads.
+ *
+ * Every target gets a TargetMedium with its own protocol stack and models, so targets can use the same
+ * Cpu ids. The sockets of all targets are spread over a small number of EpollPoller threads instead of
+ * a QTcpSocket per target on the event loop. The protocol stacks run on the thread of this object.
+ * The channel data of all targets is decoded on one pool of ChannelDataDecoder workers.
+ *
+ * When a sample file is set, the decoded channel data of all targets also goes to one SampleSink,
+ * the source of a sample is the index of its target. A SampleExporter drains it to the file and
+ * the samples the sink had to drop are logged.
+ */
+class MultiTargetMedium : public QObject
+{
+    Q_OBJECT
+public:
+    static const int MaximumTargets = 256;
+
+    /**
+     * @param ioThreads number of EpollPoller threads the targets are spread over.
+     * @param decodeWorkers number of threads that decode the channel data of all targets, 0 to decode on the thread of this object.
+     */
+    explicit MultiTargetMedium(int ioThreads = 1, int decodeWorkers = 1, QObject* parent = nullptr);
+    virtual ~MultiTargetMedium();
+
+    /**
+     * @brief Add a target, it is owned by this object
+     * @return nullptr when there are already MaximumTargets.
+     */
+    TargetMedium* addTarget(const QString& hostName, quint16 port);
+
+    /**
+     * @brief Add the targets of the settings, as "host:port" entries
+     * @return number of targets that was added.
+     */
+    int addConfiguredTargets();
+    static int configuredIoThreads();
+    static int configuredDecodeWorkers();
+    static QString configuredSampleFile();
+
+    /**
+     * @brief Export the decoded channel data of all targets to a file, see SampleExporter
+     * @param fileName of the export, empty to stop exporting.
+     * @return false if the file could not be opened.
+     */
+    bool setSampleFile(const QString& fileName);
+
+    const QVector<TargetMedium*>& targets() const {return m_targets;}
+    SampleSink& sampleSink() {return m_sampleSink;}
+    const SampleExporter& sampleExporter() const {return m_sampleExporter;}
+    int connectedTargets() const;
+
+public slots:
+    void connectAll();
+    void disconnectAll();
+    void showSettings();
+
+private:
+    QVector<EpollPoller*> m_pollers;
+    QVector<TargetMedium*> m_targets;
+    ChannelDataDecoder* m_channelDataDecoder = nullptr;     /**< Shared by all targets, nullptr to decode on this thread */
+    SampleSink m_sampleSink;
+    SampleExporter m_sampleExporter;
+    MultiTargetSettings* m_multiTargetSettingsDialog = nullptr;
+};
+
+#endif // MULTITARGETMEDIUM_H
@@ -0,0 +1,61 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "MultiTargetSettings.h"
+#include "ui_MultiTargetSettings.h"
+#include "../DebugProtocolV0/ChannelDataDecoder.h"
+
+MultiTargetSettings::MultiTargetSettings(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::MultiTargetSettings)
+{
+    ui->setupUi(this);
+
+    m_settings.beginGroup("MultiTarget");
+    ui->TargetsEdit->setPlainText(m_settings.value(m_settingsTargets).toStringList().join('\n'));
+    ui->IoThreadsSpinBox->setValue(m_settings.value(m_settingsIoThreads, 1).toInt());
+    ui->DecodeWorkersSpinBox->setValue(m_settings.value(m_settingsDecodeWorkers, ChannelDataDecoder::defaultWorkers()).toInt());
+    ui->SampleFileEdit->setText(m_settings.value(m_settingsSampleFile).toString());
+    m_settings.endGroup();
+}
+
+MultiTargetSettings::~MultiTargetSettings()
+{
+    delete ui;
+}
+
+void MultiTargetSettings::on_buttonBox_accepted()
+{
+    //User Clicked OK. The targets are created when the profile is loaded.
+    QStringList targets;
+    for (const auto& line : ui->TargetsEdit->toPlainText().split('\n'))
+    {
+        if (!line.trimmed().isEmpty())
+        {
+            targets.append(line.trimmed());
+        }
+    }
+    m_settings.beginGroup("MultiTarget");
+    m_settings.setValue(m_settingsTargets, targets);
+    m_settings.setValue(m_settingsIoThreads, ui->IoThreadsSpinBox->value());
+    m_settings.setValue(m_settingsDecodeWorkers, ui->DecodeWorkersSpinBox->value());
+    m_settings.setValue(m_settingsSampleFile, ui->SampleFileEdit->text().trimmed());
+    m_settings.endGroup();
+    close();
+}
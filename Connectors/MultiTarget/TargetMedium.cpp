@@ -0,0 +1,156 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TargetMedium.h"
+#include "MultiTargetMedium.h"
+#include "../BaseInterface/CommandQueue.h"
+#include <QHostInfo>
+
+TargetMedium::TargetMedium(MultiTargetMedium &owner, EpollPoller &poller, const QString &hostName, quint16 port, QObject *parent) :
+    ProtocolMedium(parent),
+    m_owner(owner),
+    m_poller(poller),
+    m_connectionId(poller.addClient(this)),
+    m_hostName(hostName),
+    m_port(port)
+{
+
+}
+
+TargetMedium::~TargetMedium()
+{
+    abortLookup();
+    disconnect();
+    m_poller.removeClient(m_connectionId);
+}
+
+void TargetMedium::connect()
+{
+    if (m_hostName.isEmpty() || m_port == 0)
+    {
+        showSettings();
+        return;
+    }
+
+    createProtocolLayers();
+    open();
+}
+
+void TargetMedium::open()
+{
+    if (!m_address.isNull() || m_address.setAddress(m_hostName))
+    {
+        m_poller.open(m_connectionId, m_address, m_port);
+        return;
+    }
+
+    //A name is looked up once, without blocking the other targets
+    if (m_lookupId >= 0)
+    {
+        return;
+    }
+    m_lookupId = QHostInfo::lookupHost(m_hostName, this, [this](const QHostInfo& hostInfo)
+    {
+        if (hostInfo.lookupId() != m_lookupId)
+        {
+            return;
+        }
+        m_lookupId = -1;
+        if (hostInfo.addresses().isEmpty())
+        {
+            connectionError(QString("Could not resolve %1: %2").arg(m_hostName, hostInfo.errorString()));
+            return;
+        }
+        m_address = hostInfo.addresses().first();
+        m_poller.open(m_connectionId, m_address, m_port);
+    });
+}
+
+void TargetMedium::abortLookup()
+{
+    if (m_lookupId >= 0)
+    {
+        QHostInfo::abortHostLookup(m_lookupId);
+        m_lookupId = -1;
+    }
+}
+
+void TargetMedium::reconnect()
+{
+    //Only the connection and the protocol state are dropped, the models are kept
+    m_poller.close(m_connectionId);
+    clearPendingCommands();
+    createProtocolLayers();
+    open();
+}
+
+void TargetMedium::disconnect()
+{
+    abortLookup();
+    m_reconnectScheduler.stop();
+    m_poller.close(m_connectionId);
+    setConnected(false);
+    clearModels();
+    destroyProtocolLayers();
+}
+
+void TargetMedium::showSettings()
+{
+    m_owner.showSettings();
+}
+
+void TargetMedium::writeData(const QByteArray &data)
+{
+    qint64 queued = m_poller.write(m_connectionId, data);
+    if (queued > writeBufferThreshold() && m_commandQueue != nullptr && !m_commandQueue->isBackpressure())
+    {
+        m_commandQueue->setBackpressure(true);
+        m_poller.notifyWhenWritten(m_connectionId);
+    }
+}
+
+void TargetMedium::pollerConnected()
+{
+    connectionOpened();
+}
+
+void TargetMedium::pollerReceived(const QByteArray &data)
+{
+    receivedData(data);
+}
+
+void TargetMedium::pollerWritten()
+{
+    if (m_commandQueue != nullptr && m_commandQueue->isBackpressure())
+    {
+        m_commandQueue->setBackpressure(false);
+    }
+}
+
+void TargetMedium::pollerClosed(const QString &error)
+{
+    if (!error.isEmpty())
+    {
+        connectionError(QString("%1:%2: %3").arg(m_hostName).arg(m_port).arg(error));
+    }
+    if (isConnected())
+    {
+        connectionClosed();
+    }
+}
@@ -0,0 +1,77 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TARGETMEDIUM_H
+#define TARGETMEDIUM_H
+
+#include <QHostAddress>
+#include "EpollPoller.h"
+#include "../BaseInterface/ProtocolMedium.h"
+
+class MultiTargetMedium;
+
+/**
+ * @brief Medium for one target of a MultiTargetMedium.
+ *
+ * It has its own protocol stack and Cpu and Register models like TCP, but its socket is served by an
+ * EpollPoller thread that it shares with other targets. The decoded channel data also goes to the
+ * SampleSink of the MultiTargetMedium.
+ */
+class TargetMedium : public ProtocolMedium, public EpollPoller::Client
+{
+    Q_OBJECT
+public:
+    TargetMedium(MultiTargetMedium& owner, EpollPoller& poller, const QString& hostName, quint16 port, QObject* parent = nullptr);
+    virtual ~TargetMedium();
+
+    QString hostName() const {return m_hostName;}
+    quint16 port() const {return m_port;}
+
+public slots:
+    void connect() override;
+    void disconnect() override;
+    void showSettings() override;
+
+    /**
+     * @brief Connect again to the same target without clearing the Cpu and Register models
+     */
+    void reconnect() override;
+
+protected:
+    void writeData(const QByteArray& data) override;
+
+private:
+    void pollerConnected() override;
+    void pollerReceived(const QByteArray& data) override;
+    void pollerWritten() override;
+    void pollerClosed(const QString& error) override;
+    void open();
+    void abortLookup();
+
+private:
+    MultiTargetMedium& m_owner;
+    EpollPoller& m_poller;
+    int m_connectionId;
+    QString m_hostName;
+    quint16 m_port;
+    QHostAddress m_address;     /**< Resolved on the first connect */
+    int m_lookupId = -1;        /**< Host name lookup in progress, -1 for none */
+};
+
+#endif // TARGETMEDIUM_H
@@ -0,0 +1,65 @@
+# Protocol layers and models that every connector uses, without widgets.
+# Linked once next to the connector libraries, so HeadlessRecorder needs no widgets.
+TEMPLATE        = lib
+CONFIG += staticlib
+QT              += network
+QT              -= gui
+HEADERS         = ../DebugProtocolV0/ApplicationLayerV0.h \
+    ../DebugProtocolV0/DebugProtocolV0Enums.h \
+    ../DebugProtocolV0/PresentationLayerV0.h \
+    ../DebugProtocolV0/ChannelDataDecoder.h \
+    ../DebugProtocolV0/TransportLayerV0.h \
+    ../BaseInterface/ApplicationLayerBase.h \
+    ../BaseInterface/PresentationLayerBase.h \
+    ../BaseInterface/TransportLayerBase.h \
+    ../BaseInterface/CommandQueue.h \
+    ../BaseInterface/ProtocolMedium.h \
+    ../BaseInterface/SampleSink.h \
+    ../BaseInterface/SampleExporter.h \
+    ../../EmbeddedDebugger/Medium/Register/Register.h \
+    ../../EmbeddedDebugger/Medium/Register/RegisterListModel.h \
+    ../../EmbeddedDebugger/Medium/Register/RegisterHistory.h \
+    ../../EmbeddedDebugger/Medium/Register/RegisterConfigurationLoader.h \
+    ../../EmbeddedDebugger/Medium/Register/RegisterConfigurationCache.h \
+    ../../EmbeddedDebugger/Medium/CPU/Cpu.h \
+    ../../EmbeddedDebugger/Medium/CPU/CpuListModel.h \
+    ../../EmbeddedDebugger/Medium/CPU/TriggerEngine.h \
+    ../../EmbeddedDebugger/Medium/CPU/ChannelMultiplexer.h \
+    ../../EmbeddedDebugger/Medium/Recorder/DataRecorder.h \
+    ../../EmbeddedDebugger/Medium/Scheduler/PollScheduler.h \
+    ../../EmbeddedDebugger/Medium/Scheduler/SubscriptionManager.h \
+    ../../EmbeddedDebugger/Medium/Scheduler/BandwidthEstimator.h \
+    ../../EmbeddedDebugger/Medium/Scheduler/WriteCoalescer.h \
+    ../../EmbeddedDebugger/Medium/Scheduler/ReconnectScheduler.h \
+    ../../EmbeddedDebugger/Medium/Medium.h \
+    ../BaseInterface/Common.h \
+    ../../Profiles/kconcatenaterowsproxymodel.h
+
+SOURCES         = ../DebugProtocolV0/ApplicationLayerV0.cpp \
+    ../DebugProtocolV0/PresentationLayerV0.cpp \
+    ../DebugProtocolV0/ChannelDataDecoder.cpp \
+    ../DebugProtocolV0/TransportLayerV0.cpp \
+    ../BaseInterface/CommandQueue.cpp \
+    ../BaseInterface/ProtocolMedium.cpp \
+    ../BaseInterface/SampleSink.cpp \
+    ../BaseInterface/SampleExporter.cpp \
+    ../../EmbeddedDebugger/Medium/Register/Register.cpp \
+    ../../EmbeddedDebugger/Medium/Register/RegisterListModel.cpp \
+    ../../EmbeddedDebugger/Medium/Register/RegisterHistory.cpp \
+    ../../EmbeddedDebugger/Medium/Register/RegisterConfigurationLoader.cpp \
+    ../../EmbeddedDebugger/Medium/Register/RegisterConfigurationCache.cpp \
+    ../../EmbeddedDebugger/Medium/CPU/Cpu.cpp \
+    ../../EmbeddedDebugger/Medium/CPU/CpuListModel.cpp \
+    ../../EmbeddedDebugger/Medium/CPU/TriggerEngine.cpp \
+    ../../EmbeddedDebugger/Medium/CPU/ChannelMultiplexer.cpp \
+    ../../EmbeddedDebugger/Medium/Recorder/DataRecorder.cpp \
+    ../../EmbeddedDebugger/Medium/Scheduler/PollScheduler.cpp \
+    ../../EmbeddedDebugger/Medium/Scheduler/SubscriptionManager.cpp \
+    ../../EmbeddedDebugger/Medium/Scheduler/BandwidthEstimator.cpp \
+    ../../EmbeddedDebugger/Medium/Scheduler/WriteCoalescer.cpp \
+    ../../EmbeddedDebugger/Medium/Scheduler/ReconnectScheduler.cpp \
+    ../../Profiles/kconcatenaterowsproxymodel.cpp
+
+TARGET          = $$qtLibraryTarget(ProtocolCore)
+DESTDIR         = ../../plugins
+INCLUDEPATH += ../../EmbeddedDebugger/
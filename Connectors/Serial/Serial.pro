@@ -0,0 +1,17 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+CONFIG += staticlib
+QT              += network widgets serialport
+HEADERS         = SerialMedium.h \
+    SerialSettings.h
+
+SOURCES         = SerialMedium.cpp \
+    SerialSettings.cpp
+
+TARGET          = $$qtLibraryTarget(Serial)
+DESTDIR         = ../../plugins
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+FORMS += \
+    SerialSettings.ui
+
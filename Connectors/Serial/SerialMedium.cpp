@@ -0,0 +1,210 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SerialMedium.h"
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+#include "SerialSettings.h"
+#endif
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalBlocker>
+#include <QDebug>
+
+SerialMedium::SerialMedium(QObject *parent) :
+    ProtocolMedium(parent),
+    m_serialPort(this)
+{
+    m_latencyTimer.setSingleShot(true);
+    m_latencyTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_latencyTimer, &QTimer::timeout, this, &SerialMedium::readBlock);
+    QObject::connect(&m_serialPort, &QSerialPort::readyRead, this, [&]()
+    {
+        if (m_readLatency == 0 || m_serialPort.bytesAvailable() >= m_readBlockSize)
+        {
+            readBlock();
+        }
+        else if (!m_latencyTimer.isActive())
+        {
+            m_latencyTimer.start(m_readLatency);
+        }
+    });
+    QObject::connect(&m_serialPort, &QSerialPort::bytesWritten, this, [&]()
+    {
+        deviceBytesWritten(m_serialPort);
+    });
+    QObject::connect(&m_serialPort, &QSerialPort::errorOccurred, this, [&](QSerialPort::SerialPortError error)
+    {
+        if (error == QSerialPort::NoError || !m_serialPort.isOpen())
+        {
+            return;
+        }
+        connectionError(m_serialPort.errorString());
+        if (error == QSerialPort::ResourceError)
+        {
+            //The device was removed, for instance a USB-UART that was unplugged
+            m_latencyTimer.stop();
+            m_serialPort.close();
+            connectionClosed();
+        }
+    });
+}
+
+SerialMedium::~SerialMedium()
+{
+    disconnect();
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    delete m_serialSettingsDialog;
+#endif
+}
+
+void SerialMedium::setReadBlock(int blockSize, int latency)
+{
+    m_readBlockSize = qMax(1, blockSize);
+    m_readLatency = qMax(0, latency);
+}
+
+void SerialMedium::connect()
+{
+    m_settings.beginGroup("Serial");
+    QString portName = m_settings.value("PortName","").toString();
+    qint32 baudRate = m_settings.value("BaudRate",115200).toInt();
+    int readLatency = m_settings.value("ReadLatency",m_readLatency).toInt();
+    m_settings.endGroup();
+
+    if (portName.isEmpty() || baudRate <= 0)
+    {
+        showSettings();
+    }
+    else
+    {
+        setReadBlock(m_readBlockSize, readLatency);
+        openPort(portName, baudRate);
+    }
+}
+
+void SerialMedium::openPort(const QString &portName, qint32 baudRate)
+{
+    createProtocolLayers();
+    m_portName = portName;
+    m_baudRate = baudRate;
+
+    m_serialPort.setPortName(portName);
+    if (!m_serialPort.open(QIODevice::ReadWrite))
+    {
+        connectionError(QString("Could not open %1: %2").arg(portName, m_serialPort.errorString()));
+        return;
+    }
+    if (!m_serialPort.setBaudRate(baudRate) ||
+        !m_serialPort.setDataBits(QSerialPort::Data8) ||
+        !m_serialPort.setParity(QSerialPort::NoParity) ||
+        !m_serialPort.setStopBits(QSerialPort::OneStop) ||
+        !m_serialPort.setFlowControl(m_flowControl))
+    {
+        QString error = QString("Could not configure %1 for %2 baud: %3").arg(portName).arg(baudRate).arg(m_serialPort.errorString());
+        m_serialPort.close();
+        connectionError(error);
+        return;
+    }
+    m_serialPort.clear();
+    if (m_deviceLatency > 0)
+    {
+        setLatencyTimer(portName, m_deviceLatency);
+    }
+    connectionOpened();
+}
+
+void SerialMedium::reconnect()
+{
+    if (m_portName.isEmpty())
+    {
+        connect();
+        return;
+    }
+
+    //Only the port and the protocol state are dropped, the models are kept
+    {
+        QSignalBlocker blocker(m_serialPort);
+        m_latencyTimer.stop();
+        m_serialPort.close();
+    }
+    clearPendingCommands();
+    openPort(m_portName, m_baudRate);
+}
+
+void SerialMedium::disconnect()
+{
+    m_reconnectScheduler.stop();
+    m_latencyTimer.stop();
+    m_serialPort.close();
+    setConnected(false);
+    clearModels();
+    destroyProtocolLayers();
+}
+
+void SerialMedium::showSettings()
+{
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    if (m_serialSettingsDialog == nullptr)
+    {
+        m_serialSettingsDialog = new SerialSettings();
+    }
+    m_serialSettingsDialog->show();
+#else
+    qWarning() << "No settings dialog without widgets, the settings are read from QSettings";
+#endif
+}
+
+void SerialMedium::writeData(const QByteArray &data)
+{
+    writeToDevice(m_serialPort, data);
+}
+
+void SerialMedium::readBlock()
+{
+    m_latencyTimer.stop();
+    QByteArray block = m_serialPort.readAll();
+    if (!block.isEmpty())
+    {
+        m_readBlocks++;
+        m_readBytes += static_cast<quint64>(block.size());
+        receivedData(block);
+    }
+}
+
+bool SerialMedium::setLatencyTimer(const QString &portName, int latency)
+{
+#ifdef Q_OS_LINUX
+    //Only USB-UARTs with a latency timer have this attribute, a pseudo terminal has nothing to set
+    QFile latencyTimer(QString("/sys/bus/usb-serial/devices/%1/latency_timer").arg(QFileInfo(portName).fileName()));
+    if (!latencyTimer.exists())
+    {
+        return false;
+    }
+    if (!latencyTimer.open(QIODevice::WriteOnly) || latencyTimer.write(QByteArray::number(latency)) < 0)
+    {
+        qWarning() << "Could not set the latency timer of" << portName << "to" << latency << "ms:" << latencyTimer.errorString();
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(portName);
+    Q_UNUSED(latency);
+    return false;
+#endif
+}
@@ -0,0 +1,103 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SERIALMEDIUM_H
+#define SERIALMEDIUM_H
+
+#include <QSerialPort>
+#include <QSettings>
+#include <QTimer>
+#include "../BaseInterface/ProtocolMedium.h"
+
+class SerialSettings;
+
+/**
+ * @brief Medium for targets on a serial port or USB-UART.
+ *
+ * Received bytes are handed to the transport layer in blocks instead of for every readyRead(): a
+ * block is passed on as soon as the read block size is available, otherwise at most the read latency
+ * after its first byte. At high baud rates this keeps the frame parsing per block instead of per few
+ * bytes, at low rates the latency bounds the delay that is added.
+ *
+ * Baud rates that are not standard, up to the 12 Mbaud of fast USB-UARTs, are passed to the driver
+ * as is. USB-UARTs with a latency timer, such as FTDI, buffer up to 16 ms before they send a USB
+ * packet; on Linux the timer of the opened port is set to the device latency when it can be written.
+ */
+class SerialMedium : public ProtocolMedium
+{
+    Q_OBJECT
+public:
+    explicit SerialMedium(QObject* parent = nullptr);
+    virtual ~SerialMedium();
+
+    /**
+     * @brief Set when received bytes are passed on
+     * @param blockSize bytes that are passed on immediately.
+     * @param latency ms after which fewer bytes are passed on, 0 to pass on every readyRead().
+     */
+    void setReadBlock(int blockSize, int latency);
+    int readBlockSize() const {return m_readBlockSize;}
+    int readLatency() const {return m_readLatency;}
+
+    /**
+     * @brief Set the latency timer of a USB-UART, applied when the port is opened
+     * @param latency in ms, 0 to leave the driver setting alone.
+     */
+    void setDeviceLatency(int latency) {m_deviceLatency = qMax(0, latency);}
+    int deviceLatency() const {return m_deviceLatency;}
+
+    void setFlowControl(QSerialPort::FlowControl flowControl) {m_flowControl = flowControl;}
+
+    quint64 readBlocks() const {return m_readBlocks;}
+    quint64 readBytes() const {return m_readBytes;}
+
+public slots:
+    void connect() override;
+    void disconnect() override;
+    void showSettings() override;
+    void openPort(const QString& portName, qint32 baudRate);
+
+    /**
+     * @brief Open the same port again without clearing the Cpu and Register models
+     */
+    void reconnect() override;
+
+protected:
+    void writeData(const QByteArray& data) override;
+
+private:
+    void readBlock();
+    static bool setLatencyTimer(const QString& portName, int latency);
+
+private:
+    QSerialPort m_serialPort;
+    QTimer m_latencyTimer;
+    QString m_portName;             /**< Port of the last openPort(), used by reconnect() */
+    qint32 m_baudRate = 115200;
+    QSerialPort::FlowControl m_flowControl = QSerialPort::NoFlowControl;
+    int m_readBlockSize = 4096;
+    int m_readLatency = 2;
+    int m_deviceLatency = 1;
+    SerialSettings* m_serialSettingsDialog = nullptr;
+    QSettings m_settings;
+    quint64 m_readBlocks = 0;
+    quint64 m_readBytes = 0;
+};
+
+#endif // SERIALMEDIUM_H
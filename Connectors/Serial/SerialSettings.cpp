@@ -0,0 +1,77 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SerialSettings.h"
+#include "ui_SerialSettings.h"
+
+#include <QSerialPortInfo>
+#include <QMessageBox>
+
+static const qint32 baudRates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+                                   1000000, 2000000, 3000000, 4000000, 6000000, 12000000};
+
+SerialSettings::SerialSettings(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::SerialSettings)
+{
+    ui->setupUi(this);
+
+    for (const auto& portInfo : QSerialPortInfo::availablePorts())
+    {
+        ui->PortComboBox->addItem(portInfo.systemLocation());
+    }
+    for (auto baudRate : baudRates)
+    {
+        ui->BaudRateComboBox->addItem(QString::number(baudRate));
+    }
+
+    m_settings.beginGroup("Serial");
+    ui->PortComboBox->setCurrentText(m_settings.value(m_settingsPortName,"").toString());
+    ui->BaudRateComboBox->setCurrentText(QString::number(m_settings.value(m_settingsBaudRate, 115200).toInt()));
+    ui->ReadLatencySpinBox->setValue(m_settings.value(m_settingsReadLatency, 2).toInt());
+    m_settings.endGroup();
+}
+
+SerialSettings::~SerialSettings()
+{
+    delete ui;
+}
+
+void SerialSettings::on_buttonBox_accepted()
+{
+    //User Clicked OK.
+    bool baudRateValid = false;
+    int baudRate = ui->BaudRateComboBox->currentText().toInt(&baudRateValid);
+    if (ui->PortComboBox->currentText().isEmpty() || !baudRateValid || baudRate <= 0)
+    {
+        QMessageBox invalidMsgBox;
+        invalidMsgBox.setText("Invalid port or baud rate");
+        invalidMsgBox.setIcon(QMessageBox::Information);
+        invalidMsgBox.exec();
+    }
+    else
+    {
+        m_settings.beginGroup("Serial");
+        m_settings.setValue(m_settingsPortName, ui->PortComboBox->currentText());
+        m_settings.setValue(m_settingsBaudRate, baudRate);
+        m_settings.setValue(m_settingsReadLatency, ui->ReadLatencySpinBox->value());
+        m_settings.endGroup();
+    }
+    close();
+}
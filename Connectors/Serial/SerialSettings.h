@@ -0,0 +1,52 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SERIALSETTINGS_H
+#define SERIALSETTINGS_H
+
+#include <QDialog>
+#include <QSettings>
+
+namespace Ui {
+class SerialSettings;
+}
+
+/**
+ * @brief Dialog for the port, baud rate and read latency of the serial medium
+ */
+class SerialSettings : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SerialSettings(QWidget *parent = nullptr);
+    ~SerialSettings();
+
+private slots:
+    void on_buttonBox_accepted();
+
+private:
+    Ui::SerialSettings *ui;
+    QSettings m_settings;
+    const QString m_settingsPortName = "PortName";
+    const QString m_settingsBaudRate = "BaudRate";
+    const QString m_settingsReadLatency = "ReadLatency";
+};
+
+#endif // SERIALSETTINGS_H
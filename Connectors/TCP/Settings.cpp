@@ -24,13 +24,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QValidator>
 #include <QSettings>
 
-Settings::Settings(QWidget *parent) :
+Settings::Settings(const QString &settingsGroup, QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::Settings)
+    ui(new Ui::Settings),
+    m_settingsGroup(settingsGroup)
 {
     ui->setupUi(this);
+    setWindowTitle(settingsGroup + " settings");
 
-    m_settings.beginGroup("TCP");
+    m_settings.beginGroup(m_settingsGroup);
     ui->IPAddressLineEdit->setText(m_settings.value(m_settingsIPAddress,"").toString());
     ui->PortLineEdit->setText(QString::number(m_settings.value(m_settingsIPPort, 0).toInt()));
     m_settings.endGroup();
@@ -73,7 +75,7 @@ void Settings::on_buttonBox_accepted()
     else
     {
         //Ip Address & Port are valid
-        m_settings.beginGroup("TCP");
+        m_settings.beginGroup(m_settingsGroup);
         m_settings.setValue(m_settingsIPAddress, ui->IPAddressLineEdit->text());
         m_settings.setValue(m_settingsIPPort, ui->PortLineEdit->text().toInt());
         m_settings.endGroup();
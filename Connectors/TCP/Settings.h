@@ -26,12 +26,18 @@ namespace Ui {
 class Settings;
 }
 
+/**
+ * @brief Dialog for the IP address and port of a network medium
+ */
 class Settings : public QDialog
 {
     Q_OBJECT
 
 public:
-    explicit Settings(QWidget *parent = nullptr);
+    /**
+     * @param settingsGroup QSettings group the address and port are stored in, one per medium.
+     */
+    explicit Settings(const QString& settingsGroup, QWidget *parent = nullptr);
     ~Settings();
 
 private slots:
@@ -41,6 +47,7 @@ private:
     Ui::Settings *ui;
     bool portValid(QString portString);
     QSettings m_settings;
+    const QString m_settingsGroup;
     const QString m_settingsIPAddress = "IPAddress";
     const QString m_settingsIPPort = "IPPort";
 };
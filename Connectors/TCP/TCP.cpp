@@ -17,105 +17,45 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "TCP.h"
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+#include "Settings.h"
+#endif
 #include <QDebug>
 
-#include "../DebugProtocolV0/ApplicationLayerV0.h"
-#include "../DebugProtocolV0/PresentationLayerV0.h"
-#include "../DebugProtocolV0/TransportLayerV0.h"
-
 
 TCP::TCP(QObject* parent) :
-    Medium(parent),
+    ProtocolMedium(parent),
     m_tcpSocket(this)
 {
-    m_availableProtocols.append("DebugProtocol V0");
-
-    QObject::connect(&m_tcpSocket,&QTcpSocket::connected, this, [&]()
+    QObject::connect(&m_tcpSocket,&QTcpSocket::connected, this, &TCP::connectionOpened);
+    QObject::connect(&m_tcpSocket,&QTcpSocket::disconnected, this, &TCP::connectionClosed);
+    QObject::connect(&m_tcpSocket,&QTcpSocket::readyRead, this, [&]()
     {
-        if(m_presentationLayer != nullptr)
-        {
-            static_cast<PresentationLayerV0*>(m_presentationLayer)->scanForCpu();
-            setConnected(true);
-        }
+        receivedData(m_tcpSocket.readAll());
     });
-    QObject::connect(&m_tcpSocket,&QTcpSocket::disconnected, this, [&](){setConnected(false);});
-    QObject::connect(&m_cpuListModel,&CpuListModel::newRegisterFound,this,[&](Register* newRegister)
+    QObject::connect(&m_tcpSocket,&QTcpSocket::bytesWritten, this, [&]()
     {
-       if (m_applicationLayer != nullptr)
-       {
-           QObject::connect(newRegister,QOverload<Register&>::of(&Register::configDebugChannel),m_applicationLayer,&ApplicationLayerBase::configDebugChannel);
-           QObject::connect(newRegister,&Register::writeRegister,m_applicationLayer,&ApplicationLayerBase::writeRegister);
-           QObject::connect(newRegister,QOverload<Register&>::of(&Register::queryRegister),m_applicationLayer,&ApplicationLayerBase::queryRegister);
-       }
-       m_registerListModel.append(newRegister);
+        deviceBytesWritten(m_tcpSocket);
     });
-
     QObject::connect(&m_tcpSocket,QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, [&]()
     {
-        emit errorOccured(m_tcpSocket.errorString());
-        qDebug() << m_tcpSocket.errorString();
+        connectionError(m_tcpSocket.errorString());
     });
 }
 
 TCP::~TCP()
 {
     disconnect();
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    delete m_tcpSettingsDialog;
+#endif
 }
 
-void TCP::createDebugProtocolV0Layers()
-{
-    destroyProtocolLayers();
-    m_transportLayer = new TransportLayerV0(this);
-    m_presentationLayer = new PresentationLayerV0(m_cpuListModel,m_registerListModel,this);
-    m_applicationLayer = new ApplicationLayerV0(static_cast<PresentationLayerV0&>(*m_presentationLayer),this);
-}
-
-void TCP::connectLayers()
-{
-    QObject::connect(m_transportLayer,&TransportLayerBase::receivedDebugProtocolCommand,
-                     m_presentationLayer,&PresentationLayerBase::receivedDebugProtocolCommand);
-    QObject::connect(&m_tcpSocket,&QTcpSocket::readyRead, this, [&]()
-    {
-        m_transportLayer->receivedData(m_tcpSocket.readAll());
-    });
-    QObject::connect(m_transportLayer,&TransportLayerBase::write, this, [&](const QByteArray& message)
-    {
-        m_tcpSocket.write(message);
-    });
-    QObject::connect(m_presentationLayer,&PresentationLayerBase::newDebugProtocolCommand,
-                     m_transportLayer,&TransportLayerBase::sendDebugProtocolCommand);
-    QObject::connect(m_presentationLayer,&PresentationLayerBase::newCpuFound,this, [&](Cpu* newCpu)
-    {
-        if (!m_cpuListModel.contains(newCpu->id()))
-        {
-            QObject::connect(newCpu,&Cpu::resetTime,m_applicationLayer,&ApplicationLayerBase::resetTime);
-            QObject::connect(newCpu,QOverload<Cpu&>::of(&Cpu::setDecimation),m_applicationLayer,&ApplicationLayerBase::setDecimation);
-            m_cpuListModel.append(newCpu);
-        }
-    });
-}
-
-void TCP::destroyProtocolLayers()
+void TCP::writeData(const QByteArray &data)
 {
-    if (m_applicationLayer != nullptr)
-    {
-        m_applicationLayer->deleteLater();
-        m_applicationLayer = nullptr;
-    }
-    if (m_presentationLayer != nullptr)
-    {
-        m_presentationLayer->deleteLater();
-        m_presentationLayer = nullptr;
-    }
-    if (m_transportLayer != nullptr)
-    {
-        QObject::disconnect(&m_tcpSocket, &QTcpSocket::readyRead, this, nullptr); //Disconnect tcpSocket lambda
-        m_transportLayer->deleteLater();
-        m_transportLayer = nullptr;
-    }
+    writeToDevice(m_tcpSocket, data);
 }
 
-
 void TCP::connect()
 {
 
@@ -130,32 +70,56 @@ void TCP::connect()
         !portConverted ||
         port == 0)
     {
-        m_tcpSettingsDialog.show();
+        showSettings();
     }
     else
     {
-        switch(m_selectedProtocolVersion)
-        {
-            case 0:  createDebugProtocolV0Layers(); break;
-        }
+        connectToHost(hostname, port);
+    }
+}
+
+void TCP::connectToHost(const QString &hostName, quint16 port)
+{
+    createProtocolLayers();
+    m_connectedHostName = hostName;
+    m_connectedPort = port;
+    m_tcpSocket.connectToHost(hostName,port);
+}
 
-        connectLayers();
-        m_tcpSocket.connectToHost(hostname,port);
+void TCP::reconnect()
+{
+    if (m_connectedHostName.isEmpty())
+    {
+        connect();
+        return;
     }
+
+    //Only the connection and the protocol state are dropped, the models are kept
+    m_tcpSocket.abort();
+    clearPendingCommands();
+    connectToHost(m_connectedHostName, m_connectedPort);
 }
 
 void TCP::disconnect()
 {
+    m_reconnectScheduler.stop();
     m_tcpSocket.disconnectFromHost();
     m_tcpSocket.reset();
-    m_cpuListModel.clear();
-    m_registerListModel.clear();
+    clearModels();
     destroyProtocolLayers();
 }
 
 void TCP::showSettings()
 {
-    m_tcpSettingsDialog.show();
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    if (m_tcpSettingsDialog == nullptr)
+    {
+        m_tcpSettingsDialog = new Settings("TCP");
+    }
+    m_tcpSettingsDialog->show();
+#else
+    qWarning() << "No settings dialog without widgets, the settings are read from QSettings";
+#endif
 }
 
 bool TCP::setHostAddress(const QString &ipAddress, int ipPort)
@@ -163,11 +127,3 @@ bool TCP::setHostAddress(const QString &ipAddress, int ipPort)
     m_hostPort = ipPort;
     return m_hostAddress.setAddress(ipAddress);
 }
-
-void TCP::setProtocolVersion(int availableProtocolVersionIndex)
-{
-    if(availableProtocolVersionIndex < m_availableProtocols.size())
-    {
-        m_selectedProtocolVersion = availableProtocolVersionIndex;
-    }
-}
@@ -21,15 +21,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QTcpSocket>
 #include <QHostAddress>
-#include "../../EmbeddedDebugger/Medium/Medium.h"
-#include <QStringList>
-#include "Settings.h"
+#include "../BaseInterface/ProtocolMedium.h"
+#include <QSettings>
 
-class ApplicationLayerBase;
-class PresentationLayerBase;
-class TransportLayerBase;
+class Settings;
 
-class TCP : public Medium
+class TCP : public ProtocolMedium
 {
     Q_OBJECT
 public:
@@ -39,31 +36,31 @@ public:
     QString hostAddress() const {return m_hostAddress.toString();}
     int hostPort() const {return m_hostPort;}
 
-    QStringList availableProtocolVersions() {return m_availableProtocols;}
-
 public slots:
     void connect() override;
     void disconnect() override;
     void showSettings() override;
+    void connectToHost(const QString& hostName, quint16 port);
+
+    /**
+     * @brief Connect again to the same host without clearing the Cpu and Register models.
+     * Cpu`s that answer the scan with the same identity keep their Registers, and their decimation and
+     * debug channels are restored in one write. A Cpu that turns out to be another target clears the models.
+     */
+    void reconnect() override;
     bool setHostAddress(const QString& ipAddress, int ipPort);
-    void setProtocolVersion(int availableProtocolVersionIndex);
 
-private:
-    void createDebugProtocolV0Layers();
-    void connectLayers();
-    void destroyProtocolLayers();
+protected:
+    void writeData(const QByteArray& data) override;
 
 private:
-    ApplicationLayerBase* m_applicationLayer = nullptr;
-    PresentationLayerBase* m_presentationLayer = nullptr;
-    TransportLayerBase* m_transportLayer = nullptr;
     QTcpSocket m_tcpSocket;
-    QStringList m_availableProtocols;
     QHostAddress m_hostAddress;
-    Settings m_tcpSettingsDialog;
+    QString m_connectedHostName;    /**< Host of the last connectToHost(), used by reconnect() */
+    quint16 m_connectedPort = 0;
+    Settings* m_tcpSettingsDialog = nullptr; /**< Created on first use, so TCP can be used without a QApplication */
     QSettings m_settings;
     int m_hostPort = 0;
-    int m_selectedProtocolVersion = 0;
 };
 
 #endif // TCP_H
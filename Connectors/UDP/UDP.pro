@@ -0,0 +1,17 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+CONFIG += staticlib
+QT              += network widgets
+HEADERS         = UdpMedium.h \
+    ../TCP/Settings.h
+
+SOURCES         = UdpMedium.cpp \
+    ../TCP/Settings.cpp
+
+TARGET          = $$qtLibraryTarget(Udp)
+DESTDIR         = ../../plugins
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+FORMS += \
+    ../TCP/Settings.ui
+
@@ -0,0 +1,256 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "UdpMedium.h"
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+#include "../TCP/Settings.h"
+#endif
+#include "../DebugProtocolV0/DebugProtocolV0Enums.h"
+#include <QSignalBlocker>
+#include <QDebug>
+
+UdpMedium::UdpMedium(QObject *parent) :
+    ProtocolMedium(parent),
+    m_udpSocket(this)
+{
+    QObject::connect(&m_udpSocket,&QUdpSocket::connected, this, &UdpMedium::connectionOpened);
+    QObject::connect(&m_udpSocket,&QUdpSocket::disconnected, this, &UdpMedium::connectionClosed);
+    QObject::connect(&m_udpSocket,&QUdpSocket::readyRead, this, &UdpMedium::readDatagrams);
+    QObject::connect(&m_udpSocket,QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, [&]()
+    {
+        //There is no connection to lose, an error such as an unreachable port ends it
+        connectionError(m_udpSocket.errorString());
+        if (isConnected())
+        {
+            connectionClosed();
+        }
+    });
+}
+
+UdpMedium::~UdpMedium()
+{
+    disconnect();
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    delete m_udpSettingsDialog;
+#endif
+}
+
+double UdpMedium::lossRate() const
+{
+    quint64 expected = m_sequencedFrames + m_lostFrames;
+    return expected > 0 ? static_cast<double>(m_lostFrames) / expected : 0.0;
+}
+
+void UdpMedium::connect()
+{
+    m_settings.beginGroup("UDP");
+    QString hostname = m_settings.value("IPAddress","").toString();
+    bool portConverted;
+    uint16_t port = static_cast<uint16_t>(m_settings.value("IPPort",0).toInt(&portConverted));
+    m_settings.endGroup();
+
+    if (hostname.isEmpty() ||
+        !portConverted ||
+        port == 0)
+    {
+        showSettings();
+    }
+    else
+    {
+        connectToHost(hostname, port);
+    }
+}
+
+void UdpMedium::connectToHost(const QString &hostName, quint16 port)
+{
+    createProtocolLayers();
+    m_connectedHostName = hostName;
+    m_connectedPort = port;
+    m_sequences.clear();
+    m_udpSocket.connectToHost(hostName, port);
+}
+
+void UdpMedium::reconnect()
+{
+    if (m_connectedHostName.isEmpty())
+    {
+        connect();
+        return;
+    }
+
+    //The socket is closed quietly, the outage was already reported
+    {
+        QSignalBlocker blocker(m_udpSocket);
+        m_udpSocket.abort();
+    }
+    clearPendingCommands();
+    connectToHost(m_connectedHostName, m_connectedPort);
+}
+
+void UdpMedium::disconnect()
+{
+    m_reconnectScheduler.stop();
+    m_udpSocket.disconnectFromHost();
+    m_udpSocket.abort();
+    clearModels();
+    destroyProtocolLayers();
+}
+
+void UdpMedium::showSettings()
+{
+#ifndef EMBEDDEDDEBUGGER_NO_WIDGETS
+    if (m_udpSettingsDialog == nullptr)
+    {
+        m_udpSettingsDialog = new Settings("UDP");
+    }
+    m_udpSettingsDialog->show();
+#else
+    qWarning() << "No settings dialog without widgets, the settings are read from QSettings";
+#endif
+}
+
+void UdpMedium::writeData(const QByteArray &data)
+{
+    //A batch holds several frames, each from its STX up to the only unescaped ETX, one per datagram
+    int start = data.indexOf(static_cast<char>(DebugProtocolV0Enums::STX));
+    while (start >= 0)
+    {
+        int end = data.indexOf(static_cast<char>(DebugProtocolV0Enums::ETX), start);
+        if (end < 0)
+        {
+            qWarning() << "Dropped" << data.size() - start << "bytes without an ETX";
+            break;
+        }
+        if (m_udpSocket.write(data.constData() + start, end - start + 1) < 0)
+        {
+            qWarning() << "Could not send datagram:" << m_udpSocket.errorString();
+        }
+        else
+        {
+            m_sentDatagrams++;
+        }
+        start = data.indexOf(static_cast<char>(DebugProtocolV0Enums::STX), end + 1);
+    }
+}
+
+void UdpMedium::readDatagrams()
+{
+    while (m_udpSocket.hasPendingDatagrams())
+    {
+        QByteArray datagram(static_cast<int>(qMax<qint64>(0, m_udpSocket.pendingDatagramSize())), 0);
+        qint64 size = m_udpSocket.readDatagram(datagram.data(), datagram.size());
+        if (size < 0)
+        {
+            break;
+        }
+        datagram.resize(static_cast<int>(size));
+        m_receivedDatagrams++;
+        if (acceptDatagram(datagram))
+        {
+            receivedData(datagram);
+        }
+    }
+}
+
+bool UdpMedium::acceptDatagram(const QByteArray &datagram)
+{
+    uint8_t uCId;
+    uint8_t msgId;
+    uint8_t command;
+    if (!readHeader(datagram, uCId, msgId, command))
+    {
+        m_invalidDatagrams++;
+        return false;
+    }
+    if (command != DebugProtocolV0Enums::ReadChannelData && command != DebugProtocolV0Enums::DebugString)
+    {
+        //Responses are matched to their request by the transport layer
+        return true;
+    }
+
+    Sequence& sequence = m_sequences[uCId];
+    if (msgId == 0)
+    {
+        sequence.usesZero = true;
+    }
+    if (!sequence.valid)
+    {
+        sequence.valid = true;
+        sequence.lastMsgId = msgId;
+        m_sequencedFrames++;
+        return true;
+    }
+
+    int step = (msgId - sequence.lastMsgId) & 0xFF;
+    if (step == 0)
+    {
+        m_duplicateFrames++;
+        return false;
+    }
+    if (step < 128)
+    {
+        if (!sequence.usesZero && msgId < sequence.lastMsgId)
+        {
+            //The counter wrapped around and skipped 0
+            step--;
+        }
+        m_lostFrames += static_cast<quint64>(step - 1);
+        sequence.lastMsgId = msgId;
+        m_sequencedFrames++;
+        return true;
+    }
+
+    //Overtaken by a newer frame, which was counted as a loss
+    m_reorderedFrames++;
+    if (m_lostFrames > 0)
+    {
+        m_lostFrames--;
+    }
+    return false;
+}
+
+bool UdpMedium::readHeader(const QByteArray &datagram, uint8_t &uCId, uint8_t &msgId, uint8_t &command)
+{
+    if (datagram.size() < 6 ||
+        static_cast<uint8_t>(datagram.at(0)) != DebugProtocolV0Enums::STX ||
+        static_cast<uint8_t>(datagram.at(datagram.size() - 1)) != DebugProtocolV0Enums::ETX ||
+        datagram.indexOf(static_cast<char>(DebugProtocolV0Enums::ETX)) != datagram.size() - 1)
+    {
+        return false;
+    }
+
+    uint8_t header[3];
+    int index = 1;
+    for (auto& value : header)
+    {
+        if (index >= datagram.size() - 1)
+        {
+            return false;
+        }
+        value = static_cast<uint8_t>(datagram.at(index++));
+        if (value == DebugProtocolV0Enums::ESC)
+        {
+            value = static_cast<uint8_t>(datagram.at(index++)) ^ DebugProtocolV0Enums::ESC;
+        }
+    }
+    uCId = header[0];
+    msgId = header[1];
+    command = header[2];
+    return true;
+}
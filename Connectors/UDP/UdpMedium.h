@@ -0,0 +1,103 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef UDPMEDIUM_H
+#define UDPMEDIUM_H
+
+#include <QUdpSocket>
+#include <QHash>
+#include <QSettings>
+#include "../BaseInterface/ProtocolMedium.h"
+
+class Settings;
+
+/**
+ * @brief Medium that sends every DebugProtocol V0 frame in its own UDP datagram.
+ *
+ * Without a byte stream there is no head of line blocking: a lost datagram only loses its own frame
+ * instead of delaying everything behind it. Requests that get no response are retransmitted by the
+ * transport layer as for TCP.
+ *
+ * The frames a Cpu sends on its own, the channel data, carry a msgId counter per Cpu. A jump in the
+ * counter means frames were lost, a msgId from before the last one is a frame that was overtaken.
+ * Late channel data is dropped, because the samples after it were already handled. The loss rate
+ * counts the lost frames of all Cpu`s that did not arrive late.
+ */
+class UdpMedium : public ProtocolMedium
+{
+    Q_OBJECT
+public:
+    explicit UdpMedium(QObject* parent = nullptr);
+    virtual ~UdpMedium();
+
+    quint64 receivedDatagrams() const {return m_receivedDatagrams;}
+    quint64 sentDatagrams() const {return m_sentDatagrams;}
+    quint64 lostFrames() const {return m_lostFrames;}
+    quint64 reorderedFrames() const {return m_reorderedFrames;}     /**< Channel data that arrived after a newer frame and was dropped */
+    quint64 duplicateFrames() const {return m_duplicateFrames;}
+    quint64 invalidDatagrams() const {return m_invalidDatagrams;}   /**< Datagrams that did not hold exactly one frame */
+
+    /**
+     * @brief Fraction of the channel data frames that was lost, from 0 to 1
+     */
+    double lossRate() const;
+
+public slots:
+    void connect() override;
+    void disconnect() override;
+    void showSettings() override;
+    void connectToHost(const QString& hostName, quint16 port);
+
+    /**
+     * @brief Connect again to the same host without clearing the Cpu and Register models
+     */
+    void reconnect() override;
+
+protected:
+    void writeData(const QByteArray& data) override;
+
+private:
+    struct Sequence
+    {
+        uint8_t lastMsgId = 0;
+        bool valid = false;
+        bool usesZero = false;  /**< The Cpu sent msgId 0, so its counter does not skip it */
+    };
+
+    void readDatagrams();
+    bool acceptDatagram(const QByteArray& datagram);
+    static bool readHeader(const QByteArray& datagram, uint8_t& uCId, uint8_t& msgId, uint8_t& command);
+
+private:
+    QUdpSocket m_udpSocket;
+    QString m_connectedHostName;    /**< Host of the last connectToHost(), used by reconnect() */
+    quint16 m_connectedPort = 0;
+    QHash<uint8_t, Sequence> m_sequences;   /**< Channel data msgId counter by uC id */
+    Settings* m_udpSettingsDialog = nullptr;
+    QSettings m_settings;
+    quint64 m_receivedDatagrams = 0;
+    quint64 m_sentDatagrams = 0;
+    quint64 m_sequencedFrames = 0;  /**< Channel data frames that were accepted */
+    quint64 m_lostFrames = 0;
+    quint64 m_reorderedFrames = 0;
+    quint64 m_duplicateFrames = 0;
+    quint64 m_invalidDatagrams = 0;
+};
+
+#endif // UDPMEDIUM_H
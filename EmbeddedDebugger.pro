@@ -5,5 +5,8 @@ CONFIG += ordered
 SUBDIRS    = Connectors \
 Profiles \
 EmbeddedDebugger \
+HeadlessRecorder \
+Tools \
+Tests \
 
 Profile.depends = Connectors
@@ -34,7 +34,10 @@ SOURCES += \
     ../Profiles/kconcatenaterowsproxymodel.cpp \
     ui/RegisterTab.cpp \
     ui/ComboBoxDelegate.cpp \
-    ui/PushButtonDelegate.cpp
+    ui/PushButtonDelegate.cpp \
+    ui/PlotTab.cpp \
+    ui/PlotWidget.cpp \
+    Medium/Register/RegisterHistory.cpp
 
 HEADERS += \
         ui\MainWindow.h \
@@ -46,12 +49,16 @@ HEADERS += \
     ../Profiles/kconcatenaterowsproxymodel.h \
     ui/RegisterTab.h \
     ui/ComboBoxDelegate.h \
-    ui/PushButtonDelegate.h
+    ui/PushButtonDelegate.h \
+    ui/PlotTab.h \
+    ui/PlotWidget.h \
+    Medium/Register/RegisterHistory.h
 
 FORMS += \
         ui\MainWindow.ui \
     ui/ConnectTab.ui \
-    ui/RegisterTab.ui
+    ui/RegisterTab.ui \
+    ui/PlotTab.ui
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
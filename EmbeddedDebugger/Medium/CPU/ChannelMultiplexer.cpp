@@ -0,0 +1,407 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ChannelMultiplexer.h"
+#include "Cpu.h"
+#include "Medium/Register/Register.h"
+#include <algorithm>
+#include <QDebug>
+
+static const int acknowledgementTimeout = 250;  /**< ms after which a ConfigChannel is assumed to be applied */
+static const int maxAssignmentLogSize = 10000;
+
+ChannelMultiplexer::ChannelMultiplexer(Cpu &cpu, QObject *parent) :
+    QObject(parent),
+    m_cpu(cpu),
+    m_slots(cpu.maxDebugChannels())
+{
+    m_clock.start();
+    m_statisticsClock.start();
+    m_rotationTimer.setInterval(m_dwellTime);
+    m_acknowledgementTimer.setInterval(acknowledgementTimeout / 5);
+    connect(&m_rotationTimer, &QTimer::timeout, this, &ChannelMultiplexer::rotate);
+    connect(&m_acknowledgementTimer, &QTimer::timeout, this, &ChannelMultiplexer::checkAcknowledgements);
+    connect(&m_statisticsTimer, &QTimer::timeout, this, &ChannelMultiplexer::updateStatistics);
+}
+
+void ChannelMultiplexer::setDwellTime(int milliseconds)
+{
+    m_dwellTime = qMax(acknowledgementTimeout, milliseconds);
+    m_rotationTimer.setInterval(m_dwellTime);
+}
+
+QVector<Register *> ChannelMultiplexer::requestedRegisters() const
+{
+    QVector<Register*> registers;
+    registers.reserve(m_requests.size());
+    for (const auto& request : m_requests)
+    {
+        registers.append(request.channelRegister);
+    }
+    return registers;
+}
+
+void ChannelMultiplexer::commitTransaction()
+{
+    if (m_transactionDepth > 0 && --m_transactionDepth == 0)
+    {
+        sendChanges();
+    }
+}
+
+void ChannelMultiplexer::updateRegister(Register &channelRegister)
+{
+    beginTransaction();
+    int request = requestIndex(&channelRegister);
+    int channel = slotIndex(&channelRegister);
+
+    if (channelRegister.activeChannelMode() == Register::ChannelMode::Off)
+    {
+        if (request >= 0)
+        {
+            m_requests.remove(request);
+            channelRegister.setStreamRate(0.0);
+            emit requestsChanged(m_cpu);
+        }
+        if (channel >= 0)
+        {
+            assign(channel, nullptr);
+        }
+    }
+    else
+    {
+        if (request < 0)
+        {
+            m_requests.append({&channelRegister, 0.0, channelRegister.streamedSamples()});
+            emit requestsChanged(m_cpu);
+        }
+        if (channel >= 0)
+        {
+            //Already on a channel, only the channel mode changed
+            assign(channel, &channelRegister);
+        }
+    }
+    fillFreeSlots();
+    commitTransaction();
+
+    if (isMultiplexing() != m_rotationTimer.isActive())
+    {
+        if (isMultiplexing())
+        {
+            m_rotationTimer.start();
+        }
+        else
+        {
+            m_rotationTimer.stop();
+        }
+    }
+    if (m_requests.isEmpty())
+    {
+        m_statisticsTimer.stop();
+    }
+    else if (!m_statisticsTimer.isActive())
+    {
+        m_statisticsClock.restart();
+        m_statisticsTimer.start(1000);
+    }
+}
+
+void ChannelMultiplexer::channelConfigured(int channel)
+{
+    if (channel >= 0 && channel < m_slots.size() && m_slots.at(channel).pending)
+    {
+        switchMapping(channel);
+    }
+}
+
+void ChannelMultiplexer::removeRegister(QObject *channelRegister)
+{
+    //Only the pointer value is used, the Register can already be destroyed
+    auto reg = static_cast<Register*>(channelRegister);
+    beginTransaction();
+    int request = requestIndex(reg);
+    if (request >= 0)
+    {
+        m_requests.remove(request);
+        emit requestsChanged(m_cpu);
+    }
+
+    int channel = slotIndex(reg);
+    if (channel >= 0)
+    {
+        assign(channel, nullptr);
+    }
+
+    //Never decode channel data for a destroyed Register
+    QVector<Register*>& debugChannels = m_cpu.debugChannels();
+    for (int i = 0; i < debugChannels.size(); i++)
+    {
+        if (debugChannels.at(i) == reg)
+        {
+            debugChannels[i] = nullptr;
+        }
+    }
+    fillFreeSlots();
+    commitTransaction();
+    if (!isMultiplexing())
+    {
+        m_rotationTimer.stop();
+    }
+}
+
+void ChannelMultiplexer::synchronize()
+{
+    for (auto& slot : m_slots)
+    {
+        slot.configured = false;
+    }
+    beginTransaction();
+    commitTransaction();
+}
+
+void ChannelMultiplexer::rotate()
+{
+    //Registers on a channel that is not acknowledged yet keep it for another round
+    QVector<int> candidates;
+    for (int i = 0; i < m_requests.size(); i++)
+    {
+        Request& request = m_requests[i];
+        request.credit += qMax(1, request.channelRegister->streamPriority());
+        int channel = slotIndex(request.channelRegister);
+        if (channel < 0 || !m_slots.at(channel).pending)
+        {
+            candidates.append(i);
+        }
+    }
+
+    int freeSlots = 0;
+    for (const auto& slot : qAsConst(m_slots))
+    {
+        if (!slot.pending)
+        {
+            freeSlots++;
+        }
+    }
+
+    //Most credit first, on equal credit keep the Register that is already on a channel
+    std::stable_sort(candidates.begin(), candidates.end(), [&](int a, int b)
+    {
+        const Request& first = m_requests.at(a);
+        const Request& second = m_requests.at(b);
+        if (!qFuzzyCompare(first.credit + 1.0, second.credit + 1.0))
+        {
+            return first.credit > second.credit;
+        }
+        return slotIndex(first.channelRegister) >= 0 && slotIndex(second.channelRegister) < 0;
+    });
+    candidates.resize(qMin(freeSlots, candidates.size()));
+
+    QVector<Register*> selected;
+    for (int index : qAsConst(candidates))
+    {
+        m_requests[index].credit = 0.0;
+        selected.append(m_requests.at(index).channelRegister);
+    }
+
+    //Selected Registers that are on a channel stay there, the others take the channels of the deselected ones.
+    //Deselected Registers that do not get a replacement are switched off when the transaction is committed.
+    beginTransaction();
+    for (int channel = 0; channel < m_slots.size(); channel++)
+    {
+        Slot& slot = m_slots[channel];
+        if (slot.pending || slot.channelRegister == nullptr)
+        {
+            continue;
+        }
+        int index = selected.indexOf(slot.channelRegister);
+        if (index >= 0)
+        {
+            selected.remove(index);
+        }
+        else
+        {
+            slot.channelRegister = nullptr;
+        }
+    }
+    for (int channel = 0; channel < m_slots.size() && !selected.isEmpty(); channel++)
+    {
+        const Slot& slot = m_slots.at(channel);
+        if (!slot.pending && slot.channelRegister == nullptr)
+        {
+            assign(channel, selected.takeFirst());
+        }
+    }
+    commitTransaction();
+}
+
+void ChannelMultiplexer::checkAcknowledgements()
+{
+    qint64 now = m_clock.elapsed();
+    bool pending = false;
+    for (int channel = 0; channel < m_slots.size(); channel++)
+    {
+        const Slot& slot = m_slots.at(channel);
+        if (slot.pending)
+        {
+            if (now - slot.sentTime >= acknowledgementTimeout)
+            {
+                qDebug() << "No ConfigChannel acknowledgement for channel" << channel << "of cpu" << m_cpu.id();
+                switchMapping(channel);
+            }
+            else
+            {
+                pending = true;
+            }
+        }
+    }
+    if (!pending)
+    {
+        m_acknowledgementTimer.stop();
+    }
+}
+
+void ChannelMultiplexer::updateStatistics()
+{
+    double seconds = m_statisticsClock.restart() / 1000.0;
+    if (seconds <= 0.0)
+    {
+        return;
+    }
+
+    for (auto& request : m_requests)
+    {
+        quint64 samples = request.channelRegister->streamedSamples();
+        request.channelRegister->setStreamRate((samples - request.lastSamples) / seconds);
+        request.lastSamples = samples;
+    }
+}
+
+int ChannelMultiplexer::requestIndex(Register *channelRegister) const
+{
+    for (int i = 0; i < m_requests.size(); i++)
+    {
+        if (m_requests.at(i).channelRegister == channelRegister)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ChannelMultiplexer::slotIndex(Register *channelRegister) const
+{
+    for (int i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots.at(i).channelRegister == channelRegister)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ChannelMultiplexer::assign(int channel, Register *channelRegister)
+{
+    m_slots[channel].channelRegister = channelRegister;
+    if (m_transactionDepth == 0)
+    {
+        sendChanges();
+    }
+}
+
+void ChannelMultiplexer::switchMapping(int channel)
+{
+    Slot& slot = m_slots[channel];
+    slot.pending = false;
+    if (m_cpu.debugChannels().at(channel) == slot.configuredRegister)
+    {
+        return;
+    }
+
+    m_cpu.debugChannels()[channel] = slot.configuredRegister;
+    if (m_assignmentLog.size() >= maxAssignmentLogSize)
+    {
+        m_assignmentLog.remove(0, maxAssignmentLogSize / 2);
+    }
+    m_assignmentLog.append({channel, slot.configuredRegister, m_lastTimeStamp, m_clock.elapsed()});
+}
+
+void ChannelMultiplexer::fillFreeSlots()
+{
+    //Requests without a channel, most credit first
+    QVector<int> waiting;
+    for (int i = 0; i < m_requests.size(); i++)
+    {
+        if (slotIndex(m_requests.at(i).channelRegister) < 0)
+        {
+            waiting.append(i);
+        }
+    }
+    std::stable_sort(waiting.begin(), waiting.end(), [&](int a, int b)
+    {
+        return m_requests.at(a).credit > m_requests.at(b).credit;
+    });
+
+    for (int index : qAsConst(waiting))
+    {
+        int channel = slotIndex(nullptr);
+        if (channel < 0)
+        {
+            break;
+        }
+        m_requests[index].credit = 0.0;
+        assign(channel, m_requests.at(index).channelRegister);
+    }
+}
+
+void ChannelMultiplexer::sendChanges()
+{
+    qint64 now = m_clock.elapsed();
+    QVector<int> changed;
+    for (int channel = 0; channel < m_slots.size(); channel++)
+    {
+        Slot& slot = m_slots[channel];
+        Register::ChannelMode mode = slot.channelRegister != nullptr ? slot.channelRegister->activeChannelMode() : Register::ChannelMode::Off;
+        if (slot.configured && slot.configuredRegister == slot.channelRegister && slot.configuredMode == mode)
+        {
+            continue;
+        }
+        slot.configuredRegister = slot.channelRegister;
+        slot.configuredMode = mode;
+        slot.configured = true;
+        slot.pending = true;
+        slot.sentTime = now;
+        changed.append(channel);
+    }
+    if (changed.isEmpty())
+    {
+        return;
+    }
+
+    emit burstStarted(m_cpu);
+    for (int channel : qAsConst(changed))
+    {
+        emit configChannel(m_cpu, channel, m_slots.at(channel).configuredRegister);
+    }
+    emit burstFinished(m_cpu);
+
+    if (!m_acknowledgementTimer.isActive())
+    {
+        m_acknowledgementTimer.start();
+    }
+}
@@ -0,0 +1,172 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHANNELMULTIPLEXER_H
+#define CHANNELMULTIPLEXER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include "Medium/Register/Register.h"
+class Cpu;
+
+/**
+ * @brief Assigns the streaming Registers of a Cpu to its debug channels.
+ *
+ * As long as there are no more streaming Registers than debug channels every Register keeps its
+ * own channel. When there are more, the channels are time-division multiplexed: every dwell time
+ * the Registers with the most credit get a channel. Every round each Register gains credit equal to
+ * its stream priority and a Register that gets a channel loses its credit, so the share of channel
+ * time of a Register is proportional to its priority. A Register that keeps its channel is not
+ * reconfigured.
+ *
+ * The Cpu::debugChannels() mapping, which is used to decode channel data, is switched when the Cpu
+ * acknowledges the ConfigChannel command. Channel data that was sent before the acknowledgement
+ * still belongs to the previous Register, so every sample is attributed to the Register that was
+ * actually on the channel. Every switch is kept in the assignment log.
+ *
+ * Changes are collected in a transaction: the channels are only compared with what was last sent
+ * to the Cpu when the transaction is committed, and the channels that differ are sent in one burst
+ * that the medium writes at once. A rotation or the configuration of all channels when a Cpu is
+ * found therefore takes one round trip.
+ */
+class ChannelMultiplexer : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief One assignment of a channel to a Register
+     */
+    struct Assignment
+    {
+        int channel;
+        Register* channelRegister;      /**< nullptr if the channel was switched off */
+        uint timeStamp;                 /**< Last channel data time stamp of the Cpu before the switch */
+        qint64 time;                    /**< ms since the multiplexer was created */
+    };
+
+    explicit ChannelMultiplexer(Cpu& cpu, QObject* parent = nullptr);
+
+    int dwellTime() const {return m_dwellTime;}
+    void setDwellTime(int milliseconds);
+    bool isMultiplexing() const {return m_requests.size() > m_slots.size();}
+    const QVector<Assignment>& assignmentLog() const {return m_assignmentLog;}
+    QVector<Register*> requestedRegisters() const;
+
+    /**
+     * @brief Must be called for every ReadChannelData, keeps the time stamp for the assignment log
+     */
+    void receivedChannelData(uint timeStamp) {m_lastTimeStamp = timeStamp;}
+
+    /**
+     * @brief Collect channel changes until the matching commitTransaction(), transactions can be nested
+     */
+    void beginTransaction() {m_transactionDepth++;}
+
+    /**
+     * @brief Send the channels whose configuration differs from what the Cpu has, in one burst
+     */
+    void commitTransaction();
+
+public slots:
+    /**
+     * @brief Start, change or stop streaming a Register with its Register::activeChannelMode()
+     */
+    void updateRegister(Register& channelRegister);
+
+    /**
+     * @brief The Cpu acknowledged a ConfigChannel
+     */
+    void channelConfigured(int channel);
+
+    /**
+     * @brief Forget a Register, used when it is destroyed
+     */
+    void removeRegister(QObject* channelRegister);
+
+    /**
+     * @brief Forget what is configured on the Cpu and send all channels in one burst
+     * Used when the Cpu is found, its channels can still be on from a previous session.
+     */
+    void synchronize();
+
+signals:
+    /**
+     * @brief Configure a debug channel of the Cpu
+     * @param channelRegister Register to stream on the channel, nullptr to switch the channel off.
+     */
+    void configChannel(Cpu& cpu, int channel, Register* channelRegister);
+
+    /**
+     * @brief A Register started or stopped streaming
+     */
+    void requestsChanged(Cpu& cpu);
+
+    /**
+     * @brief Emitted before and after the configChannel() signals of a burst, so the medium can send them at once
+     */
+    void burstStarted(Cpu& cpu);
+    void burstFinished(Cpu& cpu);
+
+private slots:
+    void rotate();
+    void checkAcknowledgements();
+    void updateStatistics();
+
+private:
+    struct Request
+    {
+        Register* channelRegister;
+        double credit;
+        quint64 lastSamples;
+    };
+
+    struct Slot
+    {
+        Register* channelRegister = nullptr;    /**< Register that should be on the channel */
+        Register* configuredRegister = nullptr; /**< Register that was last sent to the Cpu, only compared */
+        Register::ChannelMode configuredMode = Register::ChannelMode::Off;
+        bool configured = false;                /**< False while the configuration on the Cpu is unknown */
+        bool pending = false;                   /**< Waiting for the acknowledgement */
+        qint64 sentTime = 0;
+    };
+
+    int requestIndex(Register* channelRegister) const;
+    int slotIndex(Register* channelRegister) const;
+    void assign(int channel, Register* channelRegister);
+    void switchMapping(int channel);
+    void fillFreeSlots();
+    void sendChanges();
+
+private:
+    Cpu& m_cpu;
+    QVector<Request> m_requests;
+    QVector<Slot> m_slots;
+    QVector<Assignment> m_assignmentLog;
+    QTimer m_rotationTimer;
+    QTimer m_acknowledgementTimer;
+    QTimer m_statisticsTimer;
+    QElapsedTimer m_clock;
+    QElapsedTimer m_statisticsClock;
+    int m_dwellTime = 250;
+    uint m_lastTimeStamp = 0;
+    int m_transactionDepth = 0;
+};
+
+#endif // CHANNELMULTIPLEXER_H
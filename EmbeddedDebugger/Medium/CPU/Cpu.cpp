@@ -18,9 +18,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Cpu.h"
 #include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QFile>
+#include <QThread>
 #include <QDebug>
 
 Cpu::Cpu(uint8_t id,const QString& name,const QString& serialNumber,const QString& protocolVersion,
@@ -30,32 +29,38 @@ Cpu::Cpu(uint8_t id,const QString& name,const QString& serialNumber,const QStrin
     m_name(name),
     m_serialNumber(serialNumber),
     m_protocolVersion(protocolVersion),
-    m_applicationVersion(applicationVersion)
+    m_applicationVersion(applicationVersion),
+    m_debugChannels(m_maxDebugChannels, nullptr),
+    m_triggerEngine(new TriggerEngine(m_maxDebugChannels), &QObject::deleteLater),
+    m_channelMultiplexer(*this)
 {
     qDebug() << "New cpu: " << m_id;
 }
 
 Cpu::~Cpu()
 {
-
+    //Frames that are still decoded can hold on to the engine, nothing hears of it anymore
+    m_triggerEngine->stop();
+    m_triggerEngine->disconnect();
+    if (m_configurationCancelled)
+    {
+        m_configurationCancelled->store(1);
+    }
 }
 
 void Cpu::setVariableTypeSize(const Register::VariableType &variableType, int size)
 {
-    m_variableTypeSizes.append(qMakePair(variableType,size));
+    //Every GetInfo reports all sizes again
+    m_variableTypeSizes.insert(static_cast<int>(variableType), size);
+    if (variableType == Register::VariableType::TimeStamp)
+    {
+        emit timeStampUnitsChanged(size);
+    }
 }
 
-int Cpu::getVariableTypeSize(const Register::VariableType& variableType)
+int Cpu::getVariableTypeSize(const Register::VariableType& variableType) const
 {
-    int returnValue = 0;
-    for(auto variable : qAsConst(m_variableTypeSizes))
-    {
-        if(variable.first == variableType)
-        {
-            returnValue = variable.second;
-        }
-    }
-    return returnValue;
+    return m_variableTypeSizes.value(static_cast<int>(variableType), 0);
 }
 
 void Cpu::increaseMessageCounter()
@@ -69,13 +74,15 @@ void Cpu::increaseInvalidMessageCounter()
     m_invalidMessageCounter++;
 }
 
+void Cpu::receivedInfo()
+{
+    m_hasInfo = true;
+    emit infoReceived();
+}
+
 int Cpu::nextDebugChannel()
 {
-    if(m_debugChannels.size() < m_maxDebugChannels)
-    {
-        return m_debugChannels.size();
-    }
-    return -1;
+    return m_debugChannels.indexOf(nullptr);
 }
 
 
@@ -88,39 +95,80 @@ void Cpu::setDecimation(int newDecimation)
 bool Cpu::loadConfiguration()
 {
     QString fileLocation(QDir::currentPath() + "/Registers/" + m_name + "/" + m_applicationVersion+ ".json");
-    QFile loadFile(fileLocation);
-    if (!loadFile.open(QIODevice::ReadOnly))
+    if (!QFile::exists(fileLocation))
     {
         qWarning() << "Could not open register List at location: " << fileLocation.toStdString().c_str();
         return false;
     }
 
-    QByteArray registerData = loadFile.readAll();
+    if (m_configurationCancelled)
+    {
+        m_configurationCancelled->store(1);
+    }
+    m_configurationCancelled = QSharedPointer<QAtomicInt>::create(0);
+    m_configurationLoaded = false;
+
+    auto loaderThread = new QThread();
+    auto loader = new RegisterConfigurationLoader(fileLocation, m_configurationCancelled);
+    loader->moveToThread(loaderThread);
+    m_configurationLoader = loader;
+    connect(loaderThread, &QThread::started, loader, &RegisterConfigurationLoader::load);
+    connect(loader, &RegisterConfigurationLoader::registersLoaded, this, &Cpu::createRegisters);
+    connect(loader, &RegisterConfigurationLoader::finished, this, &Cpu::configurationLoadingFinished);
+    connect(loader, &RegisterConfigurationLoader::finished, loaderThread, &QThread::quit);
+    connect(loaderThread, &QThread::finished, loader, &QObject::deleteLater);
+    connect(loaderThread, &QThread::finished, loaderThread, &QObject::deleteLater);
+    loaderThread->start(QThread::LowPriority);
+    return true;
+}
+
+void Cpu::createRegisters(const QVector<RegisterDescription> &registerDescriptions)
+{
+    if (sender() != m_configurationLoader)
+    {
+        return;
+    }
 
-    QJsonDocument loadDoc(QJsonDocument::fromJson(registerData));
+    QVector<Register*> newRegisters;
+    newRegisters.reserve(registerDescriptions.size());
+    for (const auto& description : registerDescriptions)
+    {
+        auto newRegister = new Register(description.id,
+                                        description.name,
+                                        description.readWrite,
+                                        description.variableType,
+                                        description.source,
+                                        description.derefDepth,
+                                        description.offset,
+                                        *this,
+                                        description.isSigned);
+        connect(newRegister, QOverload<Register&>::of(&Register::configDebugChannel), &m_channelMultiplexer, &ChannelMultiplexer::updateRegister);
+        connect(newRegister, &QObject::destroyed, &m_channelMultiplexer, &ChannelMultiplexer::removeRegister);
+        newRegisters.append(newRegister);
+    }
+    emit newRegistersFound(newRegisters);
+}
 
-    QJsonObject registerObject = loadDoc.object();
-    QJsonArray registerAray = registerObject["Registers"].toArray();
-    for (auto RegisterRef : registerAray)
+void Cpu::configurationLoadingFinished(bool success)
+{
+    if (sender() != m_configurationLoader)
     {
-        QJsonObject Reg = RegisterRef.toObject();
-        Register* newRegister = new Register(Reg["id"].toInt(),
-                Reg["name"].toString(),
-                Register::ReadWritefromString(Reg["ReadWrite"].toString()),
-                Register::variableTypeFromString(Reg["Type"].toString()),
-                Register::SourcefromString(Reg["Source"].toString()),
-                Reg["DerefDepth"].toInt(),
-                Reg["Offset"].toInt(),
-                *this);
-
-        emit newRegisterFound(newRegister);
+        return;
     }
-    return true;
+
+    m_configurationLoader = nullptr;
+    m_configurationCancelled.clear();
+    m_configurationLoaded = success;
+    emit configurationLoaded(success);
 }
 
 void Cpu::receivedDecimation(int decimation)
 {
-    m_decimation = decimation;
+    if (m_decimation != decimation)
+    {
+        m_decimation = decimation;
+        emit decimationChanged();
+    }
 }
 
 
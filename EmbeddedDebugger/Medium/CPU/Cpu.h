@@ -21,8 +21,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QVector>
+#include <QHash>
+#include <QSharedPointer>
 #include "Medium/Register/RegisterListModel.h"
 #include "Medium/Register/Register.h"
+#include "TriggerEngine.h"
+#include "ChannelMultiplexer.h"
+#include "Medium/Register/RegisterConfigurationLoader.h"
 
 class Cpu : public QObject
 {
@@ -42,30 +47,50 @@ public:
     int decimation() const {return m_decimation;}
     int messageCounter() const {return m_messageCounter;}
     int invalidMessageCounter() const {return m_invalidMessageCounter;}
+    bool hasInfo() const {return m_hasInfo;}
+    bool isConfigurationLoaded() const {return m_configurationLoaded;}
 
     void setVariableTypeSize(const Register::VariableType &variableType, int size);
-    int getVariableTypeSize(const Register::VariableType& variableType);
+    int getVariableTypeSize(const Register::VariableType& variableType) const;
     void increaseMessageCounter();
     void increaseInvalidMessageCounter();
+    void receivedInfo();
     void increaseNbrOfActiveDebugChannels() {m_activeDebugChannels++;}
     void decreaseNbrOfActiveDebugChannels() {m_activeDebugChannels--;}
     int maxDebugChannels() const {return m_maxDebugChannels;}
     int  nextDebugChannel();
-    QVector<Register*>& debugChannels() {return m_debugChannels;}
+    QVector<Register*>& debugChannels() {return m_debugChannels;}    /**< One slot per channel, nullptr when free */
+    TriggerEngine& triggerEngine() {return *m_triggerEngine;}
+    QSharedPointer<TriggerEngine> sharedTriggerEngine() const {return m_triggerEngine;}   /**< For the decode workers, which feed it the streamed samples */
+    ChannelMultiplexer& channelMultiplexer() {return m_channelMultiplexer;}
 
 signals:
     void resetTime(Cpu& cpu);
     void getDecimation(Cpu& cpu);
     void setDecimation(Cpu& cpu);
     void decimationChanged();
-    void newRegisterFound(Register* newRegister);
+    void timeStampUnitsChanged(int timeStampUnits);
+    void infoReceived();
+    void channelDataReceived(Cpu& cpu, const QVector<uint8_t>& channelData);
+    void newRegistersFound(const QVector<Register*>& newRegisters);
+    void configurationLoaded(bool success);
 
 public slots:
 
     void setDecimation(int newDecimation);
+
+    /**
+     * @brief Start loading the register configuration of this Cpu on a worker thread.
+     * Registers are created in batches while loading, configurationLoaded() is emitted when done.
+     * @return false if there is no register configuration for this Cpu.
+     */
     bool loadConfiguration();
     void receivedDecimation(int decimation);
 
+private slots:
+    void createRegisters(const QVector<RegisterDescription>& registerDescriptions);
+    void configurationLoadingFinished(bool success);
+
 private:
     uint8_t m_id = 0;
     QString m_name;
@@ -77,8 +102,14 @@ private:
     int m_decimation = 0;
     int m_messageCounter= 0;
     int m_invalidMessageCounter = 0;
+    bool m_hasInfo = false;
+    bool m_configurationLoaded = false;
+    QObject* m_configurationLoader = nullptr;                /**< Only used to ignore batches of a cancelled load */
+    QSharedPointer<QAtomicInt> m_configurationCancelled;
     QVector<Register*> m_debugChannels;
-    QVector<QPair<Register::VariableType,int>> m_variableTypeSizes;
+    QSharedPointer<TriggerEngine> m_triggerEngine;     /**< Deleted later on its own thread, after the last decoded frame that uses it */
+    ChannelMultiplexer m_channelMultiplexer;
+    QHash<int,int> m_variableTypeSizes;     /**< Size per Register::VariableType as reported by GetInfo */
 
 };
 
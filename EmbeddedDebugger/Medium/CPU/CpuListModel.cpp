@@ -136,7 +136,7 @@ void CpuListModel::insert(int index, Cpu* cpuNode)
     beginInsertRows(QModelIndex(), index, index);
     cpuNode->setParent(this); //Set the parent of the object cpuNode to this listModel
     m_cpuNodes.insert(index,cpuNode);
-    connect(cpuNode,&Cpu::newRegisterFound,this,&CpuListModel::newRegisterFound);
+    connect(cpuNode,&Cpu::newRegistersFound,this,&CpuListModel::newRegistersFound);
     cpuNode->loadConfiguration();
     endInsertRows();
 }
@@ -42,7 +42,7 @@ public:
     Cpu* getCpuNodeById(uint8_t cpuNodeID);
 
 signals:
-    void newRegisterFound(Register* newRegister);
+    void newRegistersFound(const QVector<Register*>& newRegisters);
 
 private:
     QVector<Cpu*> m_cpuNodes;
@@ -0,0 +1,306 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TriggerEngine.h"
+#include "Medium/Register/RegisterHistory.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <limits>
+
+TriggerEngine::TriggerEngine(int nbrOfChannels, QObject *parent) :
+    QObject(parent)
+{
+    qRegisterMetaType<TriggerCapture>();
+    m_buffers.reserve(nbrOfChannels);
+    m_bufferIndexes.reserve(nbrOfChannels);
+}
+
+TriggerEngine::Mode TriggerEngine::mode() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_mode;
+}
+
+Register *TriggerEngine::triggerRegister() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_triggerRegister;
+}
+
+void TriggerEngine::setCondition(Register *triggerRegister, TriggerEngine::Condition condition, double threshold)
+{
+    QMutexLocker locker(&m_mutex);
+    m_triggerRegister = triggerRegister;
+    m_condition = condition;
+    m_threshold = threshold;
+}
+
+void TriggerEngine::setMode(TriggerEngine::Mode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_mode = mode;
+}
+
+void TriggerEngine::setWindow(int preTriggerSamples, int postTriggerSamples)
+{
+    QMutexLocker locker(&m_mutex);
+    m_preTriggerSamples = qMax(0, preTriggerSamples);
+    m_postTriggerSamples = qMax(0, postTriggerSamples);
+}
+
+void TriggerEngine::setAutoTimeout(uint timeStampTicks)
+{
+    QMutexLocker locker(&m_mutex);
+    m_autoTimeout = timeStampTicks;
+}
+
+void TriggerEngine::arm()
+{
+    Notifications notifications;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_triggerRegister == nullptr)
+        {
+            return;
+        }
+
+        //Ring buffers hold the complete window of the trigger Register
+        int capacity = 1;
+        while (capacity < m_preTriggerSamples + m_postTriggerSamples + 1)
+        {
+            capacity <<= 1;
+        }
+        m_mask = static_cast<uint>(capacity - 1);
+        m_buffers.clear();
+        m_bufferIndexes.clear();
+
+        m_triggerSamples = 0;
+        m_previousValue = std::numeric_limits<double>::quiet_NaN();
+        m_forced = false;
+        setState(State::Armed, notifications);
+    }
+    notify(notifications);
+}
+
+void TriggerEngine::stop()
+{
+    Notifications notifications;
+    {
+        QMutexLocker locker(&m_mutex);
+        setState(State::Stopped, notifications);
+    }
+    notify(notifications);
+}
+
+void TriggerEngine::storeSample(Register *channelRegister, const QPointer<Register> &guard, uint timeStamp, double value)
+{
+    Notifications notifications;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (state() == State::Stopped)
+        {
+            //Stopped after the check in process()
+            return;
+        }
+
+        //A channel can carry several Registers in turn, so their samples are kept apart
+        auto bufferIndex = m_bufferIndexes.constFind(channelRegister);
+        if (bufferIndex == m_bufferIndexes.constEnd())
+        {
+            RegisterBuffer newBuffer;
+            newBuffer.times.resize(static_cast<int>(m_mask + 1));
+            newBuffer.values.resize(static_cast<int>(m_mask + 1));
+            newBuffer.bufferRegister = channelRegister;
+            newBuffer.guard = guard;
+            bufferIndex = m_bufferIndexes.insert(channelRegister, m_buffers.size());
+            m_buffers.append(newBuffer);
+        }
+
+        RegisterBuffer& buffer = m_buffers[*bufferIndex];
+        int index = static_cast<int>(buffer.written & m_mask);
+        buffer.times[index] = timeStamp;
+        buffer.values[index] = value;
+        buffer.written++;
+
+        if (channelRegister != m_triggerRegister)
+        {
+            return;
+        }
+        processTriggerSample(timeStamp, value, notifications);
+    }
+    notify(notifications);
+}
+
+void TriggerEngine::processTriggerSample(uint timeStamp, double value, Notifications& notifications)
+{
+    m_triggerSamples++;
+    if (state() == State::Triggered)
+    {
+        if (m_triggerSamples > m_postTriggerSamples)
+        {
+            freeze(notifications);
+        }
+        return;
+    }
+
+    if (m_triggerSamples == 1)
+    {
+        m_armTime = timeStamp;
+    }
+
+    bool fired = false;
+    if (m_triggerSamples > m_preTriggerSamples)
+    {
+        //Pre trigger buffer is filled
+        switch (m_condition)
+        {
+        case Condition::RisingEdge:  fired = m_previousValue <= m_threshold && value > m_threshold; break;
+        case Condition::FallingEdge: fired = m_previousValue >= m_threshold && value < m_threshold; break;
+        case Condition::Above:       fired = value > m_threshold; break;
+        case Condition::Below:       fired = value < m_threshold; break;
+        }
+    }
+    m_previousValue = value;
+
+    if (!fired &&
+        m_mode == Mode::Auto &&
+        m_triggerSamples > m_preTriggerSamples &&
+        ((timeStamp - m_armTime) & (RegisterHistory::TimeStampRange - 1)) > m_autoTimeout)
+    {
+        fired = true;
+        m_forced = true;
+    }
+
+    if (fired)
+    {
+        m_triggerTime = timeStamp;
+        m_triggerSamples = 0;
+        setState(State::Triggered, notifications);
+        if (m_postTriggerSamples == 0)
+        {
+            freeze(notifications);
+        }
+    }
+}
+
+void TriggerEngine::setState(TriggerEngine::State newState, Notifications& notifications)
+{
+    if (state() != newState)
+    {
+        m_state.storeRelease(static_cast<int>(newState));
+        notifications.states.append(newState);
+    }
+}
+
+void TriggerEngine::freeze(Notifications& notifications)
+{
+    const qint64 timeMask = RegisterHistory::TimeStampRange - 1;
+    const RegisterBuffer& triggerBuffer = m_buffers.at(m_bufferIndexes.value(m_triggerRegister));
+    uint freezeTime = triggerBuffer.times.at((triggerBuffer.written - 1) & m_mask);
+    uint windowSize = qMin(triggerBuffer.written, static_cast<uint>(m_preTriggerSamples + m_postTriggerSamples + 1));
+    uint windowStart = triggerBuffer.times.at((triggerBuffer.written - windowSize) & m_mask);
+    qint64 windowLength = (freezeTime - windowStart) & timeMask;
+
+    TriggerCapture capture;
+    QVector<QPointer<Register>> guards;
+    capture.triggerTime = m_triggerTime;
+    capture.forced = m_forced;
+    for (const auto& buffer : qAsConst(m_buffers))
+    {
+        //Other Registers can have a different rate, take their samples in the time window of the trigger Register
+        QVector<uint> times;
+        QVector<double> values;
+        uint available = qMin(buffer.written, m_mask + 1);
+        for (uint i = buffer.written - available; i != buffer.written; i++)
+        {
+            uint time = buffer.times.at(i & m_mask);
+            if (((freezeTime - time) & timeMask) <= windowLength)
+            {
+                times.append(time);
+                values.append(buffer.values.at(i & m_mask));
+            }
+        }
+        if (times.isEmpty())
+        {
+            //The Register was rotated out of its channel before the window
+            continue;
+        }
+        capture.registers.append(buffer.bufferRegister);
+        capture.times.append(times);
+        capture.values.append(values);
+        guards.append(buffer.guard);
+    }
+
+    if (m_mode == Mode::Single)
+    {
+        setState(State::Stopped, notifications);
+    }
+    else
+    {
+        m_triggerSamples = 0;
+        m_previousValue = std::numeric_limits<double>::quiet_NaN();
+        m_forced = false;
+        setState(State::Armed, notifications);
+    }
+    notifications.captures.append(capture);
+    notifications.captureGuards.append(guards);
+}
+
+void TriggerEngine::notify(const Notifications& notifications)
+{
+    if (notifications.states.isEmpty() && notifications.captures.isEmpty())
+    {
+        return;
+    }
+    if (QThread::currentThread() == thread())
+    {
+        emitNotifications(notifications);
+    }
+    else
+    {
+        //Dropped when the engine is destroyed before the event is handled
+        QMetaObject::invokeMethod(this, [this, notifications]()
+        {
+            emitNotifications(notifications);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void TriggerEngine::emitNotifications(Notifications notifications)
+{
+    for (auto newState : qAsConst(notifications.states))
+    {
+        emit stateChanged(newState);
+    }
+    for (int i = 0; i < notifications.captures.size(); i++)
+    {
+        //A Register can be removed while the capture was on its way to this thread
+        TriggerCapture& capture = notifications.captures[i];
+        const QVector<QPointer<Register>>& guards = notifications.captureGuards.at(i);
+        for (int j = guards.size() - 1; j >= 0; j--)
+        {
+            if (guards.at(j).isNull())
+            {
+                capture.registers.remove(j);
+                capture.times.remove(j);
+                capture.values.remove(j);
+            }
+        }
+        emit captured(capture);
+    }
+}
@@ -0,0 +1,188 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QMetaType>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QPointer>
+class Register;
+
+/**
+ * @brief Samples of all debug channels of a Cpu around a trigger event.
+ */
+struct TriggerCapture
+{
+    uint triggerTime = 0;               /**< Time stamp of the sample that fired the trigger */
+    bool forced = false;                /**< True when the capture was forced by the auto mode timeout */
+    QVector<Register*> registers;       /**< Captured Registers that still exist, in the order their first sample arrived */
+    QVector<QVector<uint>> times;       /**< Time stamps per Register, oldest first */
+    QVector<QVector<double>> values;    /**< Values per Register, oldest first */
+};
+Q_DECLARE_METATYPE(TriggerCapture)
+
+/**
+ * @brief Oscilloscope style trigger on the debug channels of a Cpu.
+ *
+ * process() is called from the channel data decoding for every received sample. While armed
+ * every sample is stored in a ring buffer per Register, not per channel, because the
+ * ChannelMultiplexer can rotate several Registers through one channel. When the trigger condition
+ * on the trigger Register is met, the post trigger window is recorded and then the buffers are
+ * frozen into a TriggerCapture. When not armed, process() only checks the state.
+ *
+ * process() runs on the channel data decode workers, the other methods on the thread of the engine.
+ * The state is guarded by a mutex, a stopped engine is recognized without locking. captured() and
+ * stateChanged() are always emitted on the thread of the engine, after the mutex is released.
+ */
+class TriggerEngine : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Mode{
+        Single, /**< Capture once, then stop */
+        Normal, /**< Re-arm after every capture */
+        Auto    /**< Like Normal, but force a capture when no trigger occurs within the auto timeout */
+    };
+
+    enum class Condition{
+        RisingEdge,
+        FallingEdge,
+        Above,
+        Below
+    };
+
+    enum class State{
+        Stopped,
+        Armed,      /**< Filling the pre trigger buffers and waiting for the condition */
+        Triggered   /**< Condition met, recording the post trigger window */
+    };
+
+    /**
+     * @param nbrOfChannels debug channels of the Cpu, the number of buffers that is expected.
+     */
+    explicit TriggerEngine(int nbrOfChannels, QObject* parent = nullptr);
+
+    Mode mode() const;
+    State state() const {return static_cast<State>(m_state.loadAcquire());}
+    Register* triggerRegister() const;
+
+    /**
+     * @brief Set the condition that fires the trigger
+     * @param triggerRegister Register that is checked, must be configured as debug channel.
+     * @param condition when to trigger.
+     * @param threshold value the condition is checked against, use 0.5 for a bool.
+     */
+    void setCondition(Register* triggerRegister, Condition condition, double threshold);
+    void setMode(Mode mode);
+
+    /**
+     * @brief Set the capture window in samples of the trigger Register.
+     * Changes take effect when the trigger is armed.
+     */
+    void setWindow(int preTriggerSamples, int postTriggerSamples);
+
+    /**
+     * @brief Set the time without trigger after which the Auto mode forces a capture.
+     * @param timeStampTicks timeout in time stamp units of the Cpu.
+     */
+    void setAutoTimeout(uint timeStampTicks);
+
+    /**
+     * @brief Process a sample of a debug channel, thread safe
+     * @param channelRegister Register the sample belongs to, only used as key.
+     * @param guard of channelRegister, taken on the thread of the Register, to leave it out of a capture once it is removed.
+     * @param timeStamp of the sample.
+     * @param value of the sample.
+     */
+    inline void process(Register* channelRegister, const QPointer<Register>& guard, uint timeStamp, double value)
+    {
+        if (m_state.loadAcquire() == static_cast<int>(State::Stopped))
+        {
+            return;
+        }
+        storeSample(channelRegister, guard, timeStamp, value);
+    }
+
+public slots:
+    /**
+     * @brief Start waiting for the trigger condition
+     */
+    void arm();
+
+    /**
+     * @brief Stop without making a capture
+     */
+    void stop();
+
+signals:
+    void captured(const TriggerCapture& capture);
+    void stateChanged(TriggerEngine::State newState);
+
+private:
+    struct RegisterBuffer
+    {
+        QVector<uint> times;
+        QVector<double> values;
+        uint written = 0;
+        Register* bufferRegister = nullptr;
+        QPointer<Register> guard;
+    };
+
+    /**
+     * @brief What happened while the mutex was held, emitted after it is released
+     */
+    struct Notifications
+    {
+        QVector<State> states;
+        QVector<TriggerCapture> captures;
+        QVector<QVector<QPointer<Register>>> captureGuards;
+    };
+
+    void storeSample(Register* channelRegister, const QPointer<Register>& guard, uint timeStamp, double value);
+    void processTriggerSample(uint timeStamp, double value, Notifications& notifications);
+    void setState(State newState, Notifications& notifications);
+    void freeze(Notifications& notifications);
+    void notify(const Notifications& notifications);
+    void emitNotifications(Notifications notifications);
+
+private:
+    mutable QMutex m_mutex;
+    QAtomicInt m_state {static_cast<int>(State::Stopped)};  /**< Written with m_mutex held */
+    QVector<RegisterBuffer> m_buffers;
+    QHash<Register*, int> m_bufferIndexes;  /**< Index in m_buffers per Register, filled while armed */
+    Register* m_triggerRegister = nullptr;
+    Condition m_condition = Condition::RisingEdge;
+    Mode m_mode = Mode::Single;
+    double m_threshold = 0.0;
+    double m_previousValue = 0.0;
+    uint m_mask = 0;
+    int m_preTriggerSamples = 1000;
+    int m_postTriggerSamples = 1000;
+    int m_triggerSamples = 0;       /**< Samples of the trigger Register since arming or since the trigger */
+    uint m_armTime = 0;
+    uint m_triggerTime = 0;
+    uint m_autoTimeout = 1000000;
+    bool m_forced = false;
+};
+
+#endif // TRIGGERENGINE_H
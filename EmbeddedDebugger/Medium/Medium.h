@@ -23,19 +23,53 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "CPU/CpuListModel.h"
 #include "../Profiles/kconcatenaterowsproxymodel.h"
 #include "Register/RegisterListModel.h"
+#include "Scheduler/PollScheduler.h"
+#include "Scheduler/SubscriptionManager.h"
+#include "Scheduler/BandwidthEstimator.h"
+#include "Scheduler/WriteCoalescer.h"
+#include "Scheduler/ReconnectScheduler.h"
 
 class Medium : public QObject
 {
     Q_OBJECT
 public:
     explicit Medium(QObject *parent = nullptr) :
-        QObject(parent){}
+        QObject(parent)
+    {
+        QObject::connect(this, &Medium::backpressureChanged, &m_pollScheduler, &PollScheduler::setPaused);
+        QObject::connect(&m_reconnectScheduler, &ReconnectScheduler::reconnectRequested, this, [this](){reconnect();});
+        QObject::connect(&m_reconnectScheduler, &ReconnectScheduler::outageStarted, this, [this]()
+        {
+            for (auto outageRegister : m_registerListModel)
+            {
+                outageRegister->markGap();
+            }
+        });
+    }
 
     virtual void connect() = 0;
     virtual void disconnect() = 0;
     virtual void showSettings() = 0;
+
+    /**
+     * @brief Connect again after the connection was lost, a medium that can keep its models overrides this
+     */
+    virtual void reconnect() {disconnect(); connect();}
+
+    /**
+     * @brief Limit the commands sent to each Cpu, a medium without a command queue ignores it
+     * @param bytesPerSecond maximum frame bytes per second, 0 for no limit.
+     * @param framesPerSecond maximum frames per second, 0 for no limit.
+     */
+    virtual void setCpuRateLimit(double bytesPerSecond, double framesPerSecond) {Q_UNUSED(bytesPerSecond) Q_UNUSED(framesPerSecond)}
+    virtual qint64 throttledTime() const {return 0;}      /**< ms that commands waited for the rate limit of their Cpu */
     CpuListModel& cpuListModel() {return m_cpuListModel;}
     RegisterListModel& registerListModel() {return m_registerListModel;}
+    PollScheduler& pollScheduler() {return m_pollScheduler;}
+    SubscriptionManager& subscriptionManager() {return m_subscriptionManager;}
+    BandwidthEstimator& bandwidthEstimator() {return m_bandwidthEstimator;}
+    WriteCoalescer& writeCoalescer() {return m_writeCoalescer;}
+    ReconnectScheduler& reconnectScheduler() {return m_reconnectScheduler;}
 
     bool isConnected() const {return m_connected;}
     void setConnected(bool isConnected)
@@ -43,6 +77,10 @@ public:
         if(m_connected != isConnected)
         {
             m_connected = isConnected;
+            if (m_connected)
+            {
+                m_reconnectScheduler.connectionEstablished();
+            }
             emit connectedChanged();
         }
     }
@@ -51,10 +89,20 @@ signals:
     void errorOccured(QString error);
     void connectedChanged();
     void registerListModelChanged();
+    /**
+     * @brief Emitted when the medium can not send for a while because its write buffer is full,
+     * producers of periodic commands should pause until it is released.
+     */
+    void backpressureChanged(bool backpressure);
 
 protected:
     CpuListModel m_cpuListModel;
     RegisterListModel m_registerListModel;
+    PollScheduler m_pollScheduler;
+    SubscriptionManager m_subscriptionManager;
+    BandwidthEstimator m_bandwidthEstimator;
+    WriteCoalescer m_writeCoalescer;
+    ReconnectScheduler m_reconnectScheduler;
     bool m_connected = false;
 };
 
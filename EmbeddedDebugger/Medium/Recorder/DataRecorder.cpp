@@ -0,0 +1,174 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DataRecorder.h"
+#include "Medium/CPU/Cpu.h"
+#include <QDebug>
+
+static const char fileMagic[] = "EDREC";
+static const char fileVersion = 1;
+static const int flushSize = 256 * 1024;            /**< Write to disk when this much is buffered */
+static const int maximumBufferSize = 64 * 1024 * 1024; /**< Drop frames when the disk cannot keep up */
+static const int flushInterval = 200;
+
+DataRecorder::DataRecorder(QObject *parent) :
+    QObject(parent)
+{
+    connect(&m_flushTimer, &QTimer::timeout, this, &DataRecorder::flush);
+}
+
+DataRecorder::~DataRecorder()
+{
+    stop();
+}
+
+bool DataRecorder::start(const QString &fileName)
+{
+    stop();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Could not open recording file: " << fileName << m_file.errorString();
+        return false;
+    }
+
+    m_buffer.reserve(flushSize * 2);
+    m_buffer.append(fileMagic, sizeof(fileMagic) - 1);
+    m_buffer.append(fileVersion);
+    m_channelMaps.clear();
+    m_recordedFrames = 0;
+    m_recordedBytes = 0;
+    m_droppedFrames = 0;
+    m_flushTimer.start(flushInterval);
+    return true;
+}
+
+void DataRecorder::stop()
+{
+    if (m_file.isOpen())
+    {
+        m_flushTimer.stop();
+        flush();
+        m_file.close();
+    }
+}
+
+void DataRecorder::addCpu(Cpu *cpu)
+{
+    connect(cpu, &Cpu::channelDataReceived, this, &DataRecorder::recordChannelData, Qt::UniqueConnection);
+}
+
+void DataRecorder::recordChannelData(Cpu &cpu, const QVector<uint8_t> &channelData)
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+    if (m_buffer.size() > maximumBufferSize)
+    {
+        m_droppedFrames++;
+        return;
+    }
+
+    auto channelMap = m_channelMaps.constFind(cpu.id());
+    if (channelMap == m_channelMaps.constEnd() || *channelMap != cpu.debugChannels())
+    {
+        appendChannelMap(cpu);
+    }
+
+    appendRecord(ChannelDataRecord, cpu.id(), reinterpret_cast<const char*>(channelData.constData()), channelData.size());
+    m_recordedFrames++;
+    if (m_buffer.size() >= flushSize)
+    {
+        flush();
+    }
+}
+
+void DataRecorder::recordGap(const QDateTime &startTime, qint64 duration)
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+
+    char payload[12];
+    quint64 start = static_cast<quint64>(startTime.toMSecsSinceEpoch());
+    quint32 length = static_cast<quint32>(qBound<qint64>(0, duration, 0xFFFFFFFF));
+    for (int i = 0; i < 8; i++)
+    {
+        payload[i] = static_cast<char>((start >> (8 * i)) & 0xFF);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        payload[8 + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+    }
+    appendRecord(GapRecord, 0xFF, payload, sizeof(payload));
+
+    //The Cpu could have been reconfigured during the outage
+    m_channelMaps.clear();
+}
+
+void DataRecorder::flush()
+{
+    if (!m_buffer.isEmpty() && m_file.isOpen())
+    {
+        qint64 written = m_file.write(m_buffer);
+        if (written < 0)
+        {
+            qWarning() << "Could not write recording: " << m_file.errorString();
+            return;
+        }
+        m_recordedBytes += static_cast<quint64>(written);
+        m_buffer.remove(0, static_cast<int>(written));
+    }
+}
+
+void DataRecorder::appendRecord(DataRecorder::RecordType type, uint8_t cpuId, const char *payload, int length)
+{
+    m_buffer.append(static_cast<char>(type));
+    m_buffer.append(static_cast<char>(cpuId));
+    m_buffer.append(static_cast<char>(length & 0xFF));
+    m_buffer.append(static_cast<char>((length >> 8) & 0xFF));
+    m_buffer.append(payload, length);
+}
+
+void DataRecorder::appendChannelMap(Cpu &cpu)
+{
+    QByteArray payload;
+    const QVector<Register*>& debugChannels = cpu.debugChannels();
+    for (int channel = 0; channel < debugChannels.size(); channel++)
+    {
+        Register* channelRegister = debugChannels.at(channel);
+        if (channelRegister == nullptr)
+        {
+            continue;
+        }
+        QByteArray name = channelRegister->name().toUtf8().left(255);
+        uint id = channelRegister->id();
+        payload.append(static_cast<char>(channel));
+        payload.append(static_cast<char>(channelRegister->getVariableTypeSize()));
+        payload.append(static_cast<char>(id & 0xFF));
+        payload.append(static_cast<char>((id >> 8) & 0xFF));
+        payload.append(static_cast<char>((id >> 16) & 0xFF));
+        payload.append(static_cast<char>((id >> 24) & 0xFF));
+        payload.append(static_cast<char>(name.size()));
+        payload.append(name);
+    }
+    appendRecord(ChannelMapRecord, cpu.id(), payload.constData(), payload.size());
+    m_channelMaps.insert(cpu.id(), debugChannels);
+}
@@ -0,0 +1,106 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATARECORDER_H
+#define DATARECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include <QDateTime>
+class Cpu;
+class Register;
+
+/**
+ * @brief Records the channel data of Cpu`s to a binary file.
+ *
+ * The channel data is written as received (time stamp, mask and values), so recording does not
+ * decode anything. A channel map record is written before the first data record of a Cpu and
+ * every time its debug channel configuration changes.
+ *
+ * File layout: "EDREC" followed by a version byte, then records of
+ * [type (1 byte), Cpu id (1 byte), payload length (2 bytes LE), payload].
+ * Channel map payload per channel: [channel, size, register id (4 bytes LE), name length, name].
+ * Gap payload: [outage start in ms since epoch (8 bytes LE), duration in ms (4 bytes LE)] with
+ * Cpu id 0xFF, the channel maps are written again after a gap.
+ */
+class DataRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    enum RecordType{
+        ChannelMapRecord = 'C',
+        ChannelDataRecord = 'D',
+        GapRecord = 'G'
+    };
+
+    explicit DataRecorder(QObject* parent = nullptr);
+    virtual ~DataRecorder();
+
+    /**
+     * @brief Start recording to a file, an existing file is overwritten.
+     * @return false if the file could not be opened.
+     */
+    bool start(const QString& fileName);
+
+    /**
+     * @brief Flush the buffered records and close the file.
+     */
+    void stop();
+
+    bool isRecording() const {return m_file.isOpen();}
+
+    /**
+     * @brief Record the channel data of a Cpu from now on.
+     */
+    void addCpu(Cpu* cpu);
+
+    quint64 recordedFrames() const {return m_recordedFrames;}
+    quint64 recordedBytes() const {return m_recordedBytes;}
+    quint64 droppedFrames() const {return m_droppedFrames;}
+
+public slots:
+    void recordChannelData(Cpu& cpu, const QVector<uint8_t>& channelData);
+
+    /**
+     * @brief Record that no data could be received during a connection outage
+     * @param startTime when the connection was lost.
+     * @param duration of the outage in ms.
+     */
+    void recordGap(const QDateTime& startTime, qint64 duration);
+
+private slots:
+    void flush();
+
+private:
+    void appendRecord(RecordType type, uint8_t cpuId, const char* payload, int length);
+    void appendChannelMap(Cpu& cpu);
+
+private:
+    QFile m_file;
+    QByteArray m_buffer;
+    QTimer m_flushTimer;
+    QHash<uint8_t, QVector<Register*>> m_channelMaps; /**< Last channel map that was written per Cpu id */
+    quint64 m_recordedFrames = 0;
+    quint64 m_recordedBytes = 0;
+    quint64 m_droppedFrames = 0;
+};
+
+#endif // DATARECORDER_H
@@ -22,29 +22,38 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Medium/CPU/Cpu.h"
 #include <QDebug>
 
-Register::Register(uint id, QString name, Register::ReadWrite readWrite, Register::VariableType variableType, Register::Source source, uint derefDepth, uint offset, Cpu& cpu) :
+Register::Register(uint id, QString name, Register::ReadWrite readWrite, Register::VariableType variableType, Register::Source source, uint derefDepth, uint offset, Cpu& cpu, bool isSigned) :
     m_id(id),
     m_name(name),
     m_readWrite(readWrite),
     m_variableType(variableType),
+    m_signed(isSigned),
     m_source(source),
     m_derefDepth(derefDepth),
     m_offset(offset),
+    m_history(new RegisterHistory()),
     m_cpu(cpu),
     m_registerValue()
 {
-
+    m_timeStampUnits = static_cast<uint>(m_cpu.getVariableTypeSize(Register::VariableType::TimeStamp));
+    connect(&m_cpu, &Cpu::timeStampUnitsChanged, this, [&](int timeStampUnits)
+    {
+        m_timeStampUnits = static_cast<uint>(timeStampUnits);
+    });
 }
 
 int Register::getVariableTypeSize() const
 {
-    m_cpu.getVariableTypeSize(m_variableType);
+    return m_cpu.getVariableTypeSize(m_variableType);
 }
 
 void Register::configDebugChannel(Register::ChannelMode newChannelMode)
 {
     m_channelMode = newChannelMode;
-    emit configDebugChannel(*this);
+    if (!m_suspended)
+    {
+        emit configDebugChannel(*this);
+    }
 }
 
 void Register::setValue(const QVariant &value)
@@ -71,6 +80,112 @@ void Register::queryRegister()
     emit queryRegister(*this);
 }
 
+void Register::poll()
+{
+    emit pollRegister(*this);
+}
+
+void Register::setPollRate(double rate)
+{
+    rate = qMax(0.0, rate);
+    if (!qFuzzyCompare(m_pollRate + 1.0, rate + 1.0))
+    {
+        m_pollRate = rate;
+        if (m_pollRate == 0.0)
+        {
+            m_achievedPollRate = 0.0;
+        }
+        emit pollRateChanged(*this);
+        emit registerDataChanged(*this);
+    }
+}
+
+void Register::subscribe()
+{
+    m_subscribers++;
+    if (m_subscribers == 1)
+    {
+        emit subscriptionChanged(*this);
+    }
+}
+
+void Register::unsubscribe()
+{
+    if (m_subscribers > 0)
+    {
+        m_subscribers--;
+        if (m_subscribers == 0)
+        {
+            emit subscriptionChanged(*this);
+        }
+    }
+}
+
+void Register::subscribeHistory()
+{
+    m_historySubscribers++;
+    m_history->setEnabled(true);
+}
+
+void Register::unsubscribeHistory()
+{
+    if (m_historySubscribers > 0)
+    {
+        m_historySubscribers--;
+        if (m_historySubscribers == 0)
+        {
+            m_history->setEnabled(false);
+        }
+    }
+}
+
+void Register::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended)
+    {
+        return;
+    }
+
+    m_suspended = suspended;
+    if (m_pollRate > 0.0)
+    {
+        emit pollRateChanged(*this);
+    }
+    if (m_channelMode != Register::ChannelMode::Off)
+    {
+        emit configDebugChannel(*this);
+    }
+}
+
+void Register::setAchievedPollRate(double rate)
+{
+    //Only update the view when the change is visible with one decimal
+    if (qAbs(m_achievedPollRate - rate) >= 0.05)
+    {
+        m_achievedPollRate = rate;
+        emit registerDataChanged(*this);
+    }
+}
+
+void Register::setStreamPriority(int priority)
+{
+    priority = qMax(1, priority);
+    if (m_streamPriority != priority)
+    {
+        m_streamPriority = priority;
+        emit registerDataChanged(*this);
+    }
+}
+
+void Register::setStreamRate(double rate)
+{
+    if (qAbs(m_streamRate - rate) >= 0.05)
+    {
+        m_streamRate = rate;
+        emit registerDataChanged(*this);
+    }
+}
+
 Register::ReadWrite Register::ReadWritefromString(const QString& enumString)
 {
     if (enumString == "Read"){ return Register::ReadWrite::Read;}
@@ -101,20 +216,28 @@ Register::VariableType Register::variableTypeFromString(const QString&  enumStri
     if(enumString == "bool"){ return Register::VariableType::Bool;}
     if(enumString == "int8_t"){ return Register::VariableType::Char;}
     if(enumString == "uint8_t"){ return Register::VariableType::Char;}
-    // if(enumString == "int16_t"){ return Register::VariableType::int16_t;}
-    // if(enumString == "uint16_t"){ return Register::VariableType::uint16_t;}
-    // if(enumString == "int32_t"){ return Register::VariableType::int32_t;}
-    // if(enumString == "uint32_t"){ return Register::VariableType::uint32_t;}
-    // if(enumString == "int64_t"){ return Register::VariableType::int64_t;}
-    // if(enumString == "uint64_t"){ return Register::VariableType::uint64_t;}
-    // if(enumString == "float"){ return Register::VariableType::Float;}
-    // if(enumString == "double"){ return Register::VariableType::Double;}
+    if(enumString == "int16_t"){ return Register::VariableType::Short;}
+    if(enumString == "uint16_t"){ return Register::VariableType::Short;}
+    if(enumString == "int32_t"){ return Register::VariableType::Int;}
+    if(enumString == "uint32_t"){ return Register::VariableType::Int;}
+    if(enumString == "int64_t"){ return Register::VariableType::Long;}
+    if(enumString == "uint64_t"){ return Register::VariableType::Long;}
+    if(enumString == "float"){ return Register::VariableType::Float;}
+    if(enumString == "double"){ return Register::VariableType::Double;}
 
     qWarning() << "Unknown Variabletype from String requested: " << enumString;
     return Register::VariableType::Unknown;
 
 }
 
+bool Register::isSignedFromString(const QString &enumString)
+{
+    return enumString == "int8_t" ||
+           enumString == "int16_t" ||
+           enumString == "int32_t" ||
+           enumString == "int64_t";
+}
+
 QString Register::variableTypeToString(const Register::VariableType &variableType)
 {
     switch(variableType)
@@ -122,8 +245,15 @@ QString Register::variableTypeToString(const Register::VariableType &variableTyp
     case Register::VariableType::Pointer: return "Pointer";
     case Register::VariableType::Bool: return "Bool";
     case Register::VariableType::Char: return "Char";
+    case Register::VariableType::Short: return "Short";
+    case Register::VariableType::Int: return "Int";
+    case Register::VariableType::Long: return "Long";
+    case Register::VariableType::Float: return "Float";
+    case Register::VariableType::Double: return "Double";
+    case Register::VariableType::LongDouble: return "LongDouble";
     default: break;
     }
+    return "Unknown";
 }
 
 void Register::receivedNewRegisterValue(QVariant newRegisterValue)
@@ -133,10 +263,13 @@ void Register::receivedNewRegisterValue(QVariant newRegisterValue)
         m_registerValue.setValue(QVariant::fromValue(newRegisterValue));
         emit registerDataChanged(*this);
     }
+    emit queryResponseReceived(*this);
 }
 
 void Register::receivedNewRegisterValue(QVariant newRegisterValue, uint timeStamp)
 {
+    //The sample is already in the history, the decoding appends it on its own thread
+    m_streamedSamples++;
     if (m_registerValue != newRegisterValue)
     {
         m_registerValue = std::move(newRegisterValue);
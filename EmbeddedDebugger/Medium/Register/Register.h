@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QVariant>
 #include <QObject>
 #include <QPair>
+#include <QSharedPointer>
+#include "RegisterHistory.h"
 class Cpu;
 
 class Register : public QObject
@@ -68,28 +70,80 @@ public:
 
     };
 
-    Register(uint id, QString name, Register::ReadWrite readWrite, Register::VariableType variableType, Register::Source source, uint derefDepth, uint offset, Cpu& cpu);
+    Register(uint id, QString name, Register::ReadWrite readWrite, Register::VariableType variableType, Register::Source source, uint derefDepth, uint offset, Cpu& cpu, bool isSigned = false);
 
     uint id() const {return m_id;}
     QString name() const {return m_name;}
     Register::ReadWrite readWrite() const {return m_readWrite;}
     Register::ChannelMode channelMode() const {return m_channelMode;}
+    Register::ChannelMode activeChannelMode() const {return m_suspended ? Register::ChannelMode::Off : m_channelMode;}
     Register::Source source() const {return m_source;}
     Register::VariableType variableType() const {return m_variableType;}
     int getVariableTypeSize() const;
+    bool isSigned() const {return m_signed;}     /**< Integer values are two's complement, the VariableType does not tell */
     uint derefDepth() const {return m_derefDepth;}
     uint32_t offset() const {return m_offset;}
     uint timeStampUnits() const {return m_timeStampUnits;}
     QVariant value() const {return m_registerValue;}
     uint timeStamp() const {return m_lastRegisterValueTimestamp;}
+    double pollRate() const {return m_pollRate;}
+    double achievedPollRate() const {return m_achievedPollRate;}
+    bool isPolled() const {return m_pollRate > 0.0 && !m_suspended;}
+    bool isSubscribed() const {return m_subscribers > 0;}
+    bool isSuspended() const {return m_suspended;}
+    int streamPriority() const {return m_streamPriority;}
+    double streamRate() const {return m_streamRate;}
+    quint64 streamedSamples() const {return m_streamedSamples;}
     Cpu& cpu() const {return m_cpu;}
+    const RegisterHistory& history() const {return *m_history;}
+    QSharedPointer<RegisterHistory> sharedHistory() const {return m_history;}   /**< For the decode workers, which append the streamed samples */
+    void markGap() {m_history->appendGap();}    /**< Samples were missed, see RegisterHistory::appendGap() */
     void configDebugChannel(ChannelMode newChannelMode);
     void setValue(const QVariant &value);
     void queryRegister();
+    void poll();        /**< Query as a periodic poll, see PollScheduler */
+
+    /**
+     * @brief Set the rate at which the Register is polled with QueryRegister
+     * @param rate in Hz, 0 stops polling.
+     */
+    void setPollRate(double rate);
+    void setAchievedPollRate(double rate);
+
+    /**
+     * @brief Set the share of debug channel time this Register gets when there are more streaming
+     * Registers than debug channels, see ChannelMultiplexer
+     * @param priority relative weight, at least 1.
+     */
+    void setStreamPriority(int priority);
+
+    /**
+     * @brief Set the measured rate of samples received over a debug channel
+     */
+    void setStreamRate(double rate);
+
+    /**
+     * @brief A view that shows this Register subscribes to it, see SubscriptionManager
+     */
+    void subscribe();
+    void unsubscribe();
+
+    /**
+     * @brief A view that shows the history of this Register subscribes to it, the history only keeps
+     * samples while it has subscribers, see RegisterHistory
+     */
+    void subscribeHistory();
+    void unsubscribeHistory();
+
+    /**
+     * @brief Suspend polling and streaming without changing the requested poll rate and channel mode
+     */
+    void setSuspended(bool suspended);
 
     static Register::ReadWrite ReadWritefromString(const QString& enumString);
     static Register::Source SourcefromString(const QString&  enumString);
     static Register::VariableType variableTypeFromString(const QString&  enumString);
+    static bool isSignedFromString(const QString& enumString);
     static QString variableTypeToString(const Register::VariableType&  variableType);
 
 
@@ -102,13 +156,18 @@ signals:
     void configDebugChannel(Register& Register);
     void writeRegister(Register& Register);
     void queryRegister(Register& Register);
+    void pollRegister(Register& Register);
     void registerDataChanged(Register& Register);
+    void pollRateChanged(Register& Register);
+    void queryResponseReceived(Register& Register);
+    void subscriptionChanged(Register& Register);
 
 private:
     uint m_id;
     QString m_name;
     Register::ReadWrite m_readWrite;
     Register::VariableType m_variableType;
+    bool m_signed = false;
     Register::ChannelMode m_channelMode = Register::ChannelMode::Off;
     Register::Source m_source;
     uint m_derefDepth = 0;
@@ -116,6 +175,15 @@ private:
     uint m_timeStampUnits = 0;
     QVariant m_registerValue;
     uint m_lastRegisterValueTimestamp = 0;
+    double m_pollRate = 0.0;
+    double m_achievedPollRate = 0.0;
+    int m_streamPriority = 1;
+    double m_streamRate = 0.0;
+    quint64 m_streamedSamples = 0;
+    int m_subscribers = 0;
+    int m_historySubscribers = 0;
+    bool m_suspended = false;
+    QSharedPointer<RegisterHistory> m_history;  /**< Fed by the channel data decoding, can outlive the Register while frames are decoded */
     Cpu& m_cpu;
 };
 
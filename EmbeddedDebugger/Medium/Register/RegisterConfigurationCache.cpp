@@ -0,0 +1,203 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RegisterConfigurationCache.h"
+#include "RegisterConfigurationLoader.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <cstring>
+
+static const char cacheMagic[8] = {'E', 'D', 'R', 'E', 'G', 'C', 'A', 'C'};
+static const quint32 cacheVersion = 2;
+
+RegisterConfigurationCache::RegisterConfigurationCache(const QString &sourceFileName) :
+    m_sourceFileName(sourceFileName),
+    m_sourceInfo(sourceFileName)
+{
+    static_assert(sizeof(Header) == 64, "Header layout must not contain padding");
+    static_assert(sizeof(Record) == 40, "Record layout must not contain padding");
+}
+
+bool RegisterConfigurationCache::load(QVector<RegisterDescription> &registers)
+{
+    QFile cacheFile(cacheFileName());
+    if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = cacheFile.size();
+    const uchar* data = cacheFile.map(0, size);
+    if (data == nullptr || !validate(data, size))
+    {
+        return false;
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    bool sourceTouched = header->sourceSize != m_sourceInfo.size() ||
+                         header->sourceModified != m_sourceInfo.lastModified().toMSecsSinceEpoch();
+    if (sourceTouched &&
+        contentHash(m_sourceFileName) != QByteArray(header->contentHash, sizeof(header->contentHash)))
+    {
+        return false;
+    }
+
+    const Record* records = reinterpret_cast<const Record*>(data + sizeof(Header));
+    const char* strings = reinterpret_cast<const char*>(records + header->recordCount);
+    registers.resize(static_cast<int>(header->recordCount));
+    for (quint32 i = 0; i < header->recordCount; i++)
+    {
+        const Record& record = records[i];
+        RegisterDescription& description = registers[static_cast<int>(i)];
+        description.id = record.id;
+        description.name = QString::fromUtf8(strings + record.nameOffset, static_cast<int>(record.nameLength));
+        description.readWrite = static_cast<Register::ReadWrite>(record.readWrite);
+        description.variableType = static_cast<Register::VariableType>(record.variableType);
+        description.source = static_cast<Register::Source>(record.source);
+        description.isSigned = record.isSigned != 0;
+        description.derefDepth = record.derefDepth;
+        description.offset = record.offset;
+    }
+    cacheFile.unmap(const_cast<uchar*>(data));
+    cacheFile.close();
+
+    if (sourceTouched)
+    {
+        //Same content, so the next load can skip the content hash
+        updateSourceInfo(cacheFile.fileName());
+    }
+    return true;
+}
+
+bool RegisterConfigurationCache::store(const QVector<RegisterDescription> &registers, const QByteArray &contentHash)
+{
+    QString fileName = cacheFileName();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QByteArray strings;
+    QVector<Record> records(registers.size());
+    for (int i = 0; i < registers.size(); i++)
+    {
+        const RegisterDescription& description = registers.at(i);
+        QByteArray name = description.name.toUtf8();
+        Record& record = records[i];
+        record.id = description.id;
+        record.nameOffset = static_cast<quint32>(strings.size());
+        record.nameLength = static_cast<quint32>(name.size());
+        record.derefDepth = description.derefDepth;
+        record.offset = description.offset;
+        record.readWrite = static_cast<quint32>(description.readWrite);
+        record.variableType = static_cast<quint32>(description.variableType);
+        record.source = static_cast<quint32>(description.source);
+        record.isSigned = description.isSigned ? 1 : 0;
+        record.reserved = 0;
+        strings.append(name);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.recordCount = static_cast<quint32>(records.size());
+    header.stringTableSize = static_cast<quint32>(strings.size());
+    header.sourceSize = m_sourceInfo.size();
+    header.sourceModified = m_sourceInfo.lastModified().toMSecsSinceEpoch();
+    std::memcpy(header.contentHash, contentHash.constData(), qMin<size_t>(sizeof(header.contentHash), static_cast<size_t>(contentHash.size())));
+
+    //Written to a temporary file first, so a reader never maps a half written cache
+    QSaveFile cacheFile(fileName);
+    if (!cacheFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Could not write register cache: " << fileName.toStdString().c_str();
+        return false;
+    }
+    cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    cacheFile.write(reinterpret_cast<const char*>(records.constData()), records.size() * static_cast<int>(sizeof(Record)));
+    cacheFile.write(strings);
+    return cacheFile.commit();
+}
+
+QByteArray RegisterConfigurationCache::contentHash(const QString &fileName)
+{
+    QFile sourceFile(fileName);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (sourceFile.open(QIODevice::ReadOnly))
+    {
+        hash.addData(&sourceFile);
+    }
+    return hash.result();
+}
+
+bool RegisterConfigurationCache::validate(const uchar *data, qint64 size) const
+{
+    if (size < static_cast<qint64>(sizeof(Header)))
+    {
+        return false;
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header->version != cacheVersion ||
+        size != static_cast<qint64>(sizeof(Header)) + static_cast<qint64>(header->recordCount) * static_cast<qint64>(sizeof(Record)) + header->stringTableSize)
+    {
+        qWarning() << "Invalid register cache: " << cacheFileName().toStdString().c_str();
+        return false;
+    }
+
+    const Record* records = reinterpret_cast<const Record*>(data + sizeof(Header));
+    for (quint32 i = 0; i < header->recordCount; i++)
+    {
+        const Record& record = records[i];
+        if (static_cast<quint64>(record.nameOffset) + record.nameLength > header->stringTableSize ||
+            record.readWrite > static_cast<quint32>(Register::ReadWrite::ReadWrite) ||
+            record.variableType > static_cast<quint32>(Register::VariableType::Unknown) ||
+            record.source > static_cast<quint32>(Register::Source::Unknown))
+        {
+            qWarning() << "Invalid register cache: " << cacheFileName().toStdString().c_str();
+            return false;
+        }
+    }
+    return true;
+}
+
+void RegisterConfigurationCache::updateSourceInfo(const QString &cacheFileName)
+{
+    QFile cacheFile(cacheFileName);
+    if (cacheFile.open(QIODevice::ReadWrite))
+    {
+        Header header;
+        if (cacheFile.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header))
+        {
+            header.sourceSize = m_sourceInfo.size();
+            header.sourceModified = m_sourceInfo.lastModified().toMSecsSinceEpoch();
+            cacheFile.seek(0);
+            cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+    }
+}
+
+QString RegisterConfigurationCache::cacheFileName() const
+{
+    QByteArray pathHash = QCryptographicHash::hash(m_sourceInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/Registers/" + QString::fromLatin1(pathHash) + ".cache";
+}
@@ -0,0 +1,96 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGISTERCONFIGURATIONCACHE_H
+#define REGISTERCONFIGURATIONCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFileInfo>
+#include <QVector>
+struct RegisterDescription;
+
+/**
+ * @brief Binary cache of a parsed register configuration file.
+ *
+ * The cache file holds a fixed size header, a table of fixed size records and a string table
+ * with the UTF-8 register names. It is memory mapped on load, so reading a cached configuration
+ * costs a map and one pass over the records instead of a JSON parse.
+ *
+ * A cache file is named after the hash of the path of its register file. The header stores the
+ * size, modification time and content hash of the register file; when size and modification time
+ * match the cache is used directly, otherwise the content hash of the register file decides.
+ */
+class RegisterConfigurationCache
+{
+public:
+    explicit RegisterConfigurationCache(const QString& sourceFileName);
+
+    /**
+     * @brief Read the cached registers of the register file.
+     * @return false if there is no valid cache for the current content of the register file.
+     */
+    bool load(QVector<RegisterDescription>& registers);
+
+    /**
+     * @brief Write the cache for the register file.
+     * @param registers that were parsed from the register file.
+     * @param contentHash Sha1 of the register file content that was parsed.
+     */
+    bool store(const QVector<RegisterDescription>& registers, const QByteArray& contentHash);
+
+    static QByteArray contentHash(const QString& fileName);
+
+private:
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 recordCount;
+        quint32 stringTableSize;
+        quint32 reserved;
+        qint64 sourceSize;
+        qint64 sourceModified;  /**< ms since epoch */
+        char contentHash[20];   /**< Sha1 */
+        char padding[4];
+    };
+
+    struct Record
+    {
+        quint32 id;
+        quint32 nameOffset;     /**< Offset in the string table */
+        quint32 nameLength;     /**< Length in bytes */
+        quint32 derefDepth;
+        quint32 offset;
+        quint32 readWrite;
+        quint32 variableType;
+        quint32 source;
+        quint32 isSigned;
+        quint32 reserved;
+    };
+
+    bool validate(const uchar* data, qint64 size) const;
+    void updateSourceInfo(const QString& cacheFileName);
+    QString cacheFileName() const;
+
+private:
+    QString m_sourceFileName;
+    QFileInfo m_sourceInfo;
+};
+
+#endif // REGISTERCONFIGURATIONCACHE_H
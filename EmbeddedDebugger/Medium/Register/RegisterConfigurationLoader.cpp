@@ -0,0 +1,248 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RegisterConfigurationLoader.h"
+#include "RegisterConfigurationCache.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+static const qint64 chunkSize = 64 * 1024;
+static const int firstBatchSize = 64;
+static const int maximumBatchSize = 4096;
+static const char registersKey[] = "\"Registers\"";
+
+RegisterConfigurationLoader::RegisterConfigurationLoader(const QString &fileName, const QSharedPointer<QAtomicInt> &cancelled, QObject *parent) :
+    QObject(parent),
+    m_fileName(fileName),
+    m_cancelled(cancelled)
+{
+    qRegisterMetaType<QVector<RegisterDescription>>();
+}
+
+void RegisterConfigurationLoader::load()
+{
+    QFile loadFile(m_fileName);
+    if (!loadFile.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Could not open register List at location: " << m_fileName.toStdString().c_str();
+        emit finished(false);
+        return;
+    }
+
+    m_state = ScanState::FindArray;
+    m_scanPosition = 0;
+    m_batchSize = firstBatchSize;
+    m_batch.clear();
+    m_batch.reserve(m_batchSize);
+    m_registers.clear();
+
+    RegisterConfigurationCache cache(m_fileName);
+    QVector<RegisterDescription> cachedRegisters;
+    if (cache.load(cachedRegisters))
+    {
+        for (const auto& description : qAsConst(cachedRegisters))
+        {
+            addRegister(description);
+        }
+        emitBatch();
+        emit finished(true);
+        return;
+    }
+
+    QCryptographicHash contentHash(QCryptographicHash::Sha1);
+    QByteArray pending;
+    while (m_state != ScanState::Done && m_cancelled->load() == 0)
+    {
+        QByteArray chunk = loadFile.read(chunkSize);
+        if (chunk.isEmpty())
+        {
+            break;
+        }
+        contentHash.addData(chunk);
+        pending.append(chunk);
+        scan(pending);
+    }
+
+    if (m_state == ScanState::Done)
+    {
+        //The hash has to cover the whole file, also what follows the register array
+        while (!loadFile.atEnd())
+        {
+            contentHash.addData(loadFile.read(chunkSize));
+        }
+    }
+
+    if (m_cancelled->load() != 0)
+    {
+        emit finished(false);
+        return;
+    }
+
+    emitBatch();
+    if (m_state == ScanState::Done)
+    {
+        cache.store(m_registers, contentHash.result());
+    }
+    else
+    {
+        qWarning() << "Register list is incomplete: " << m_fileName.toStdString().c_str();
+    }
+    emit finished(m_state == ScanState::Done);
+}
+
+void RegisterConfigurationLoader::scan(QByteArray &pending)
+{
+    const char* data = pending.constData();
+    int size = pending.size();
+    int position = m_scanPosition;
+
+    while (position < size && m_state != ScanState::Done)
+    {
+        switch (m_state)
+        {
+        case ScanState::FindArray:
+        {
+            int keyIndex = pending.indexOf(registersKey, position);
+            if (keyIndex < 0)
+            {
+                //Keep the tail, the key can be split over two chunks
+                pending.remove(0, qMax(position, size - static_cast<int>(sizeof(registersKey))));
+                m_scanPosition = 0;
+                return;
+            }
+            int bracketIndex = pending.indexOf('[', keyIndex);
+            if (bracketIndex < 0)
+            {
+                pending.remove(0, keyIndex);
+                m_scanPosition = 0;
+                return;
+            }
+            position = bracketIndex + 1;
+            m_state = ScanState::InArray;
+            break;
+        }
+        case ScanState::InArray:
+        {
+            char character = data[position];
+            if (character == '{')
+            {
+                m_state = ScanState::InObject;
+                m_objectStart = position;
+                m_depth = 1;
+                m_inString = false;
+                m_escaped = false;
+            }
+            else if (character == ']')
+            {
+                m_state = ScanState::Done;
+            }
+            position++;
+            break;
+        }
+        case ScanState::InObject:
+        {
+            char character = data[position];
+            if (m_inString)
+            {
+                if (m_escaped)
+                {
+                    m_escaped = false;
+                }
+                else if (character == '\\')
+                {
+                    m_escaped = true;
+                }
+                else if (character == '"')
+                {
+                    m_inString = false;
+                }
+            }
+            else if (character == '"')
+            {
+                m_inString = true;
+            }
+            else if (character == '{')
+            {
+                m_depth++;
+            }
+            else if (character == '}' && --m_depth == 0)
+            {
+                parseObject(QByteArray::fromRawData(data + m_objectStart, position + 1 - m_objectStart));
+                m_state = ScanState::InArray;
+            }
+            position++;
+            break;
+        }
+        case ScanState::Done:
+            break;
+        }
+    }
+
+    //Drop everything that was consumed, an unfinished object is kept from its start
+    int consumed = (m_state == ScanState::InObject) ? m_objectStart : position;
+    pending.remove(0, consumed);
+    m_objectStart -= consumed;
+    m_scanPosition = position - consumed;
+}
+
+void RegisterConfigurationLoader::parseObject(const QByteArray &objectData)
+{
+    QJsonParseError parseError;
+    QJsonObject Reg = QJsonDocument::fromJson(objectData, &parseError).object();
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        qWarning() << "Invalid register in " << m_fileName.toStdString().c_str() << ": " << parseError.errorString();
+        return;
+    }
+
+    RegisterDescription description;
+    description.id = static_cast<uint>(Reg["id"].toInt());
+    description.name = Reg["name"].toString();
+    description.readWrite = Register::ReadWritefromString(Reg["ReadWrite"].toString());
+    description.variableType = Register::variableTypeFromString(Reg["Type"].toString());
+    description.isSigned = Register::isSignedFromString(Reg["Type"].toString());
+    description.source = Register::SourcefromString(Reg["Source"].toString());
+    description.derefDepth = static_cast<uint>(Reg["DerefDepth"].toInt());
+    description.offset = static_cast<uint>(Reg["Offset"].toInt());
+    m_registers.append(description);
+    addRegister(description);
+}
+
+void RegisterConfigurationLoader::addRegister(const RegisterDescription &description)
+{
+    m_batch.append(description);
+
+    if (m_batch.size() >= m_batchSize)
+    {
+        emitBatch();
+        m_batchSize = qMin(m_batchSize * 2, maximumBatchSize);
+        m_batch.reserve(m_batchSize);
+    }
+}
+
+void RegisterConfigurationLoader::emitBatch()
+{
+    if (!m_batch.isEmpty())
+    {
+        emit registersLoaded(m_batch);
+        m_batch.clear();
+    }
+}
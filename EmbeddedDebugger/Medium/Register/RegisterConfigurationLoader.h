@@ -0,0 +1,104 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGISTERCONFIGURATIONLOADER_H
+#define REGISTERCONFIGURATIONLOADER_H
+
+#include <QObject>
+#include <QVector>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QMetaType>
+#include "Register.h"
+
+/**
+ * @brief Plain description of a Register as read from a register configuration file.
+ * Can be created on any thread, the Register itself is created by the Cpu.
+ */
+struct RegisterDescription
+{
+    uint id = 0;
+    QString name;
+    Register::ReadWrite readWrite = Register::ReadWrite::Unknown;
+    Register::VariableType variableType = Register::VariableType::Unknown;
+    bool isSigned = false;
+    Register::Source source = Register::Source::Unknown;
+    uint derefDepth = 0;
+    uint offset = 0;
+};
+Q_DECLARE_METATYPE(RegisterDescription)
+Q_DECLARE_METATYPE(QVector<RegisterDescription>)
+
+/**
+ * @brief Loads a register configuration file on a worker thread.
+ *
+ * The file is read in chunks and every object in the "Registers" array is parsed as soon as it
+ * is complete, so the whole file is never held as a QJsonDocument. Parsed registers are emitted
+ * in batches, the first batch is small so the Cpu is usable quickly, later batches grow to keep
+ * the number of model inserts low.
+ *
+ * A successfully parsed file is stored in a RegisterConfigurationCache, which is used instead of
+ * the file as long as its content does not change.
+ */
+class RegisterConfigurationLoader : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructor of RegisterConfigurationLoader
+     * @param fileName of the register configuration.
+     * @param cancelled loading stops when this is set to a non-zero value, it is shared so it can be
+     * set from any thread without having to know whether the loader still exists.
+     */
+    RegisterConfigurationLoader(const QString& fileName, const QSharedPointer<QAtomicInt>& cancelled, QObject* parent = nullptr);
+
+public slots:
+    void load();
+
+signals:
+    void registersLoaded(const QVector<RegisterDescription>& registers);
+    void finished(bool success);
+
+private:
+    enum class ScanState{
+        FindArray,  /**< Looking for the "Registers" key and the opening bracket of its array */
+        InArray,    /**< Between the objects of the array */
+        InObject,   /**< Inside an object of the array */
+        Done
+    };
+
+    void scan(QByteArray& pending);
+    void parseObject(const QByteArray& objectData);
+    void addRegister(const RegisterDescription& description);
+    void emitBatch();
+
+private:
+    QString m_fileName;
+    QSharedPointer<QAtomicInt> m_cancelled;
+    ScanState m_state = ScanState::FindArray;
+    int m_scanPosition = 0;
+    int m_objectStart = 0;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escaped = false;
+    int m_batchSize = 0;
+    QVector<RegisterDescription> m_batch;
+    QVector<RegisterDescription> m_registers;   /**< All parsed registers, for the cache */
+};
+
+#endif // REGISTERCONFIGURATIONLOADER_H
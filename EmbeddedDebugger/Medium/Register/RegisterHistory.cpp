@@ -0,0 +1,289 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RegisterHistory.h"
+#include <QMutexLocker>
+
+static int defaultMaximumSamples = RegisterHistory::DefaultMaximumCapacity;
+
+RegisterHistory::RegisterHistory(int maximumCapacity) :
+    m_maximumCapacity(maximumCapacity > 0 ? roundedCapacity(maximumCapacity) : defaultMaximumSamples)
+{
+
+}
+
+void RegisterHistory::setDefaultMaximumCapacity(int samples)
+{
+    defaultMaximumSamples = roundedCapacity(samples);
+}
+
+int RegisterHistory::defaultMaximumCapacity()
+{
+    return defaultMaximumSamples;
+}
+
+int RegisterHistory::roundedCapacity(int samples)
+{
+    int capacity = BlockSize;
+    while (capacity < samples && capacity < (1 << 30))
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+void RegisterHistory::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+
+    m_enabled = enabled;
+    if (!m_enabled)
+    {
+        clearSamples();
+        m_times = QVector<qint64>();
+        m_values = QVector<double>();
+        m_blocks = QVector<Block>();
+        m_capacity = 0;
+        m_mask = 0;
+        m_blockMask = 0;
+    }
+}
+
+void RegisterHistory::grow()
+{
+    //Only called while the ring did not wrap yet, so every sequence number stays at its index
+    m_capacity = m_capacity == 0 ? qMin(InitialCapacity, m_maximumCapacity) : m_capacity * 2;
+    m_mask = m_capacity - 1;
+    m_blockMask = m_capacity / BlockSize - 1;
+    m_times.resize(m_capacity);
+    m_values.resize(m_capacity);
+    m_blocks.resize(m_capacity / BlockSize);
+}
+
+bool RegisterHistory::isEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_enabled;
+}
+
+void RegisterHistory::append(uint timeStamp, double value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled)
+    {
+        return;
+    }
+    if (m_written == m_capacity && m_capacity < m_maximumCapacity)
+    {
+        grow();
+    }
+
+    if (m_gapPending)
+    {
+        //The number of wrap arounds during the gap is unknown, only keep the time increasing
+        m_gapPending = false;
+        if (m_count > 0 && timeStamp <= m_lastTimeStamp)
+        {
+            m_timeOffset += TimeStampRange;
+        }
+        m_gaps.append(m_written);
+    }
+    else if (m_count > 0 && timeStamp < m_lastTimeStamp && m_lastTimeStamp - timeStamp > TimeStampRange / 2)
+    {
+        //The 24 bit time stamp of the Cpu wrapped around
+        m_timeOffset += TimeStampRange;
+    }
+    m_lastTimeStamp = timeStamp;
+
+    int index = static_cast<int>(m_written & m_mask);
+    m_times[index] = m_timeOffset + timeStamp;
+    m_values[index] = value;
+
+    Block& block = m_blocks[static_cast<int>((m_written / BlockSize) & m_blockMask)];
+    if ((m_written & (BlockSize - 1)) == 0)
+    {
+        block.minimum = value;
+        block.maximum = value;
+    }
+    else
+    {
+        block.minimum = qMin(block.minimum, value);
+        block.maximum = qMax(block.maximum, value);
+    }
+
+    m_written++;
+    if (m_count < m_capacity)
+    {
+        m_count++;
+    }
+    while (!m_gaps.isEmpty() && m_gaps.first() < firstSequence())
+    {
+        m_gaps.removeFirst();
+    }
+}
+
+void RegisterHistory::appendGap()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_count > 0)
+    {
+        m_gapPending = true;
+    }
+}
+
+void RegisterHistory::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    clearSamples();
+}
+
+void RegisterHistory::clearSamples()
+{
+    m_written = 0;
+    m_count = 0;
+    m_lastTimeStamp = 0;
+    m_timeOffset = 0;
+    m_gaps.clear();
+    m_gapPending = false;
+}
+
+bool RegisterHistory::isEmpty() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count == 0;
+}
+
+int RegisterHistory::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count;
+}
+
+int RegisterHistory::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_capacity;
+}
+
+int RegisterHistory::gapCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_gaps.size();
+}
+
+qint64 RegisterHistory::firstTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count == 0 ? 0 : timeAt(firstSequence());
+}
+
+qint64 RegisterHistory::lastTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count == 0 ? 0 : timeAt(m_written - 1);
+}
+
+double RegisterHistory::lastValue() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count == 0 ? 0.0 : valueAt(m_written - 1);
+}
+
+bool RegisterHistory::minMax(qint64 from, qint64 to, double &minimum, double &maximum) const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 sequence = lowerBound(from);
+    qint64 end = lowerBound(to);
+    if (sequence >= end)
+    {
+        return false;
+    }
+
+    minimum = valueAt(sequence);
+    maximum = minimum;
+    while (sequence < end)
+    {
+        if ((sequence & (BlockSize - 1)) == 0 && sequence + BlockSize <= end)
+        {
+            //Whole block is inside the range, use its summary
+            const Block& block = m_blocks.at(static_cast<int>((sequence / BlockSize) & m_blockMask));
+            minimum = qMin(minimum, block.minimum);
+            maximum = qMax(maximum, block.maximum);
+            sequence += BlockSize;
+        }
+        else
+        {
+            double value = valueAt(sequence);
+            minimum = qMin(minimum, value);
+            maximum = qMax(maximum, value);
+            sequence++;
+        }
+    }
+    return true;
+}
+
+bool RegisterHistory::valueBefore(qint64 time, double &value) const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 sequence = lowerBound(time);
+    if (sequence <= firstSequence())
+    {
+        return false;
+    }
+    value = valueAt(sequence - 1);
+    return true;
+}
+
+bool RegisterHistory::hasGap(qint64 from, qint64 to) const
+{
+    QMutexLocker locker(&m_mutex);
+    for (qint64 gap : m_gaps)
+    {
+        qint64 time = timeAt(gap);
+        if (time >= from && time < to)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+qint64 RegisterHistory::lowerBound(qint64 time) const
+{
+    //Binary search for the first sample with a time stamp >= time
+    qint64 first = firstSequence();
+    qint64 count = m_count;
+    while (count > 0)
+    {
+        qint64 step = count / 2;
+        if (timeAt(first + step) < time)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
@@ -0,0 +1,147 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGISTERHISTORY_H
+#define REGISTERHISTORY_H
+
+#include <QVector>
+#include <QMutex>
+
+/**
+ * @brief Ring buffer with the most recent timestamped samples of a Register.
+ *
+ * Next to the raw samples a min/max summary is kept for every block of BlockSize samples,
+ * so a consumer that needs one value range per pixel column (the plot) only touches the raw
+ * samples at the edges of a column.
+ *
+ * When the connection was lost, a gap is marked before the next sample. Consumers must not
+ * connect the samples on either side of a gap. The time stamps of the Cpu can have wrapped any
+ * number of times during the outage. The samples after a gap are only kept later in time than the
+ * samples before it.
+ *
+ * A history only keeps samples while it is enabled, by a Register that is plotted. The ring starts
+ * small and doubles when it is full until it reaches its maximum capacity, after that the oldest
+ * samples are overwritten. Disabling frees the memory.
+ *
+ * The channel data decode workers append while the plot reads, so all methods are thread safe.
+ * Each call locks on its own, a reader that makes several calls can see samples appended in between.
+ */
+class RegisterHistory
+{
+public:
+    static const int DefaultMaximumCapacity = 1 << 18;  /**< Number of samples kept, must be a power of two */
+    static const int InitialCapacity = 1 << 12;         /**< Size of the ring when the first sample is appended */
+    static const int BlockSize = 64;            /**< Number of samples summarized by one block, must be a power of two */
+    static const qint64 TimeStampRange = 1 << 24; /**< Channel data time stamps are 24 bits and wrap around */
+
+    /**
+     * @brief Constructor of RegisterHistory, memory is allocated when the first sample is appended while enabled.
+     * @param maximumCapacity number of samples to keep at most, rounded up to a power of two, 0 for the default.
+     */
+    explicit RegisterHistory(int maximumCapacity = 0);
+
+    /**
+     * @brief Set the maximum capacity of the histories that are constructed after this call
+     * @param samples rounded up to a power of two, at least BlockSize.
+     */
+    static void setDefaultMaximumCapacity(int samples);
+    static int defaultMaximumCapacity();
+
+    /**
+     * @brief Keep samples or not, disabling removes all samples and frees the memory
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /**
+     * @brief Append a sample
+     * @param timeStamp raw 24 bit time stamp as received from the Cpu, wrap arounds are unwrapped.
+     * @param value of the sample
+     */
+    void append(uint timeStamp, double value);
+
+    /**
+     * @brief Mark that samples were missed, for instance because the connection was lost
+     */
+    void appendGap();
+
+    /**
+     * @brief Remove all samples
+     */
+    void clear();
+
+    bool isEmpty() const;
+    int size() const;
+    int capacity() const;
+    int maximumCapacity() const {return m_maximumCapacity;}
+    qint64 firstTime() const;
+    qint64 lastTime() const;
+    double lastValue() const;
+
+    /**
+     * @brief Get the minimum and maximum of all samples with from <= time < to.
+     * @return false if there are no samples in this range.
+     */
+    bool minMax(qint64 from, qint64 to, double& minimum, double& maximum) const;
+
+    /**
+     * @brief Get the value of the last sample with a time stamp before time.
+     * @return false if there is no such sample.
+     */
+    bool valueBefore(qint64 time, double& value) const;
+
+    /**
+     * @brief Check for a gap before a sample with from <= time < to.
+     */
+    bool hasGap(qint64 from, qint64 to) const;
+    int gapCount() const;
+
+private:
+    struct Block
+    {
+        double minimum;
+        double maximum;
+    };
+
+    qint64 firstSequence() const {return m_written - m_count;}
+    qint64 timeAt(qint64 sequence) const {return m_times.at(static_cast<int>(sequence & m_mask));}
+    double valueAt(qint64 sequence) const {return m_values.at(static_cast<int>(sequence & m_mask));}
+    qint64 lowerBound(qint64 time) const;
+    void grow();
+    void clearSamples();
+    static int roundedCapacity(int samples);
+
+private:
+    mutable QMutex m_mutex;
+    QVector<qint64> m_times;
+    QVector<double> m_values;
+    QVector<Block> m_blocks;
+    int m_capacity = 0;     /**< Size of the ring, grows up to m_maximumCapacity */
+    int m_maximumCapacity;
+    bool m_enabled = false;
+    qint64 m_mask = 0;
+    qint64 m_blockMask = 0;
+    qint64 m_written = 0;   /**< Total number of samples ever appended, used as sequence number */
+    int m_count = 0;        /**< Number of valid samples in the ring buffer */
+    uint m_lastTimeStamp = 0;
+    qint64 m_timeOffset = 0;
+    QVector<qint64> m_gaps;     /**< Sequence numbers of the first samples after a gap */
+    bool m_gapPending = false;
+};
+
+#endif // REGISTERHISTORY_H
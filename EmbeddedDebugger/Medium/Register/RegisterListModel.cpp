@@ -21,9 +21,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Medium/CPU/Cpu.h"
 #include <QDebug>
 
+static const int updateInterval = 1000 / 60;   /**< ms between updates of the changed rows */
+
 RegisterListModel::RegisterListModel(QObject* parent)
 {
-
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(updateInterval);
+    connect(&m_updateTimer, &QTimer::timeout, this, &RegisterListModel::updateChangedRows);
 }
 
 RegisterListModel::~RegisterListModel()
@@ -40,14 +44,14 @@ int RegisterListModel::rowCount(const QModelIndex &parent) const
 int RegisterListModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 6;
+    return 10;
 }
 
 Qt::ItemFlags RegisterListModel::flags(const QModelIndex &index) const
 {
     if (!index.isValid())
         return Qt::ItemIsEnabled;
-    if (index.column() == 3)
+    if (index.column() == 3 || index.column() == 6 || index.column() == 9)
     {
         return Qt::ItemIsEnabled | Qt::ItemIsEditable;
     }
@@ -99,10 +103,51 @@ QVariant RegisterListModel::data(const QModelIndex &index, int role) const
         case 4:
         {
             returnValue = static_cast<uint8_t>(Register->channelMode());
+            break;
+        }
+        case 6:
+        {
+            returnValue = Register->pollRate();
+            break;
+        }
+        case 7:
+        {
+            if (Register->pollRate() > 0.0)
+            {
+                returnValue = QString::number(Register->achievedPollRate(), 'f', 1);
+            }
+            break;
+        }
+        case 8:
+        {
+            if (Register->channelMode() != Register::ChannelMode::Off)
+            {
+                returnValue = QString::number(Register->streamRate(), 'f', 1);
+            }
+            break;
+        }
+        case 9:
+        {
+            returnValue = Register->streamPriority();
+            break;
         }
         default: break;
         }
     }
+    else if (index.isValid() &&
+             index.row() < m_registers.size() &&
+             index.row() >= 0 &&
+             role == RegisterRole)
+    {
+        returnValue = QVariant::fromValue(static_cast<QObject*>(m_registers.at(index.row())));
+    }
+    else if (index.isValid() &&
+             index.row() < m_registers.size() &&
+             index.row() >= 0 &&
+             role == SubscriptionRole)
+    {
+        returnValue = m_registers.at(index.row())->isSubscribed();
+    }
     return returnValue;
 }
 
@@ -135,6 +180,18 @@ bool RegisterListModel::setData(const QModelIndex &index, const QVariant &value,
             Register->queryRegister();
             break;
         }
+        case 6:
+        {
+            //Poll rate in Hz
+            Register->setPollRate(value.toDouble());
+            break;
+        }
+        case 9:
+        {
+            //Share of debug channel time when multiplexing
+            Register->setStreamPriority(value.toInt());
+            break;
+        }
         default:
         {
             qDebug() << "default";
@@ -143,6 +200,20 @@ bool RegisterListModel::setData(const QModelIndex &index, const QVariant &value,
 
         }
     }
+    else if (index.isValid() &&
+             index.row() < m_registers.size() &&
+             index.row() >= 0 &&
+             role == SubscriptionRole)
+    {
+        if (value.toBool())
+        {
+            m_registers.at(index.row())->subscribe();
+        }
+        else
+        {
+            m_registers.at(index.row())->unsubscribe();
+        }
+    }
 
     return true;
 }
@@ -184,6 +255,26 @@ QVariant RegisterListModel::headerData(int section, Qt::Orientation orientation,
             returnValue = tr("Refresh");
             break;
         }
+        case 6:
+        {
+            returnValue = tr("Poll rate [Hz]");
+            break;
+        }
+        case 7:
+        {
+            returnValue = tr("Achieved rate [Hz]");
+            break;
+        }
+        case 8:
+        {
+            returnValue = tr("Stream rate [Hz]");
+            break;
+        }
+        case 9:
+        {
+            returnValue = tr("Stream priority");
+            break;
+        }
         default: break;
         }
     }
@@ -201,6 +292,7 @@ void RegisterListModel::insert(int index, Register* registerNode)
     registerNode->setParent(this);
     connect(registerNode,&Register::registerDataChanged,this,&RegisterListModel::registerDataChanged);
     m_registers.insert(index,registerNode);
+    addToIndex(registerNode);
     endInsertRows();
 }
 
@@ -210,6 +302,23 @@ void RegisterListModel::append(Register* registerNode)
     insert(m_registers.count(),registerNode);
 }
 
+void RegisterListModel::append(const QVector<Register*>& registerNodes)
+{
+    if (registerNodes.isEmpty())
+    {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_registers.count(), m_registers.count() + registerNodes.count() - 1);
+    for (auto registerNode : registerNodes)
+    {
+        registerNode->setParent(this);
+        connect(registerNode,&Register::registerDataChanged,this,&RegisterListModel::registerDataChanged);
+        addToIndex(registerNode);
+    }
+    m_registers.append(registerNodes);
+    endInsertRows();
+}
+
 void RegisterListModel::clear()
 {
     beginResetModel();
@@ -218,6 +327,9 @@ void RegisterListModel::clear()
         registerNode->deleteLater();
     }
     m_registers.clear();
+    m_registersByCpuIdAndOffset.clear();
+    m_changedRegisters.clear();
+    m_updateTimer.stop();
     endResetModel();
 }
 
@@ -264,25 +376,41 @@ Register *RegisterListModel::getRegisterByOffset(uint32_t offset)
 
 Register *RegisterListModel::getRegisterByCpuIdAndOffset(uint8_t uCId, int32_t offset)
 {
-    Register* returnValue = nullptr;
+    return m_registersByCpuIdAndOffset.value(indexKey(uCId, static_cast<uint32_t>(offset)), nullptr);
+}
 
-    for (auto tempRegister : qAsConst(m_registers))
-    {
-        if (tempRegister->cpu().id() == uCId &&
-            tempRegister->offset() == offset)
-        {
-            returnValue = tempRegister;
-        }
-    }
-    return returnValue;
+void RegisterListModel::addToIndex(Register *registerNode)
+{
+    //A later Register with the same Cpu id and offset is found instead of the earlier one
+    m_registersByCpuIdAndOffset.insert(indexKey(registerNode->cpu().id(), registerNode->offset()), registerNode);
 }
 
 void RegisterListModel::registerDataChanged(Register &Register)
 {
-    int row = m_registers.indexOf(&Register);
-    QModelIndex startOfRow = this->index(row, 0);
-    QModelIndex endOfRow   = this->index(row, columnCount(QModelIndex()));
-
+    m_changedRegisters.insert(&Register);
+    if (!m_updateTimer.isActive())
+    {
+        m_updateTimer.start();
+    }
+}
 
-    emit dataChanged(startOfRow,endOfRow, {Qt::DisplayRole}); //TODO: CHECK THIS HACK
+void RegisterListModel::updateChangedRows()
+{
+    //One pass over the rows, neighbouring changed rows are updated together
+    int lastColumn = columnCount(QModelIndex()) - 1;
+    int firstChangedRow = -1;
+    for (int row = 0; row <= m_registers.size(); row++)
+    {
+        bool changed = row < m_registers.size() && m_changedRegisters.contains(m_registers.at(row));
+        if (changed && firstChangedRow < 0)
+        {
+            firstChangedRow = row;
+        }
+        else if (!changed && firstChangedRow >= 0)
+        {
+            emit dataChanged(index(firstChangedRow, 0), index(row - 1, lastColumn), {Qt::DisplayRole});
+            firstChangedRow = -1;
+        }
+    }
+    m_changedRegisters.clear();
 }
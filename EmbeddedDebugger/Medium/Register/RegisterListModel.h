@@ -22,11 +22,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 class Register;
 #include <QAbstractTableModel>
 #include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 
+/**
+ * @brief Table of all Registers of a medium.
+ *
+ * A streamed Register changes its value for every sample. Changes are collected and the changed
+ * rows are updated once per display frame, instead of once per sample.
+ *
+ * The Registers are indexed by Cpu id and offset, every QueryRegister response is looked up with them.
+ */
 class RegisterListModel : public QAbstractTableModel
 {
     Q_OBJECT
 public:
+    enum Roles{
+        RegisterRole = Qt::UserRole,        /**< Returns the Register of a row as QObject* */
+        SubscriptionRole                    /**< Set true to subscribe to the Register of a row, false to unsubscribe */
+    };
+
     explicit RegisterListModel(QObject* parent = nullptr);
     virtual ~RegisterListModel();
 
@@ -43,6 +59,7 @@ public:
 
     void insert(int index, Register* registerNode);
     void append(Register *registerNode);
+    void append(const QVector<Register*>& registerNodes);
     void clear();
     bool contains(uint registerId);
     Register* getRegisterById(uint registerID);
@@ -51,9 +68,17 @@ public:
 
 private slots:
     void registerDataChanged(Register& Register);
+    void updateChangedRows();
+
+private:
+    void addToIndex(Register* registerNode);
+    static quint64 indexKey(uint8_t uCId, uint32_t offset) {return static_cast<quint64>(uCId) << 32 | offset;}
 
 private:
     QVector<Register*> m_registers;
+    QHash<quint64, Register*> m_registersByCpuIdAndOffset;   /**< For the responses, which only carry the Cpu id and offset */
+    QSet<Register*> m_changedRegisters;     /**< Registers with a change that is not shown yet */
+    QTimer m_updateTimer;
 };
 
 #endif // REGISTERLISTMODEL_H
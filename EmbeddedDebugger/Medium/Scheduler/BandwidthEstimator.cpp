@@ -0,0 +1,298 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BandwidthEstimator.h"
+#include "Medium/CPU/Cpu.h"
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <QDebug>
+
+static const double budgetUtilization = 0.8;    /**< Part of the budget that may be planned, the rest is for queries and jitter */
+static const double decreaseUtilization = 0.7;  /**< Lower decimation only when it fits this part, so it does not toggle */
+static const double escapeOverhead = 1.0 + 3.0 / 256.0; /**< Expected growth of random data by escaping STX, ETX and ESC */
+static const uint timeStampMask = 0xFFFFFF;     /**< Channel data time stamps are 24 bits */
+
+BandwidthEstimator::BandwidthEstimator(QObject *parent) :
+    QObject(parent)
+{
+    connect(&m_statisticsTimer, &QTimer::timeout, this, &BandwidthEstimator::updateStatistics);
+}
+
+void BandwidthEstimator::setLinkBudget(double bytesPerSecond)
+{
+    m_linkBudget = qMax(0.0, bytesPerSecond);
+    tuneAll();
+}
+
+void BandwidthEstimator::setAutoDecimation(bool enabled)
+{
+    m_autoDecimation = enabled;
+    tuneAll();
+}
+
+double BandwidthEstimator::bytesPerSecond(uint8_t uCId) const
+{
+    return m_statistics.value(uCId).bytesPerSecond;
+}
+
+double BandwidthEstimator::frameLoss(uint8_t uCId) const
+{
+    return m_statistics.value(uCId).frameLoss;
+}
+
+double BandwidthEstimator::sampleRate(uint8_t uCId) const
+{
+    return m_statistics.value(uCId).sampleRate;
+}
+
+double BandwidthEstimator::predictedBytesPerSecond(Cpu &cpu, int decimation) const
+{
+    double rate = sampleRate(cpu.id());
+    int size = frameSize(cpu);
+    if (rate <= 0.0 || size == 0)
+    {
+        return 0.0;
+    }
+    return rate / qMax(1, decimation) * size * escapeOverhead;
+}
+
+void BandwidthEstimator::addCpu(Cpu &cpu)
+{
+    CpuStatistics& statistics = m_statistics[cpu.id()];
+    statistics = CpuStatistics();
+    statistics.cpu = &cpu;
+    statistics.lastInvalidMessages = cpu.invalidMessageCounter();
+    //Unique, a Cpu that is restored after a reconnect is added again
+    connect(&cpu, &Cpu::channelDataReceived, this, &BandwidthEstimator::receivedChannelData, Qt::UniqueConnection);
+    connect(&cpu.channelMultiplexer(), &ChannelMultiplexer::requestsChanged, this, &BandwidthEstimator::requestsChanged, Qt::UniqueConnection);
+    connect(&cpu, &QObject::destroyed, this, &BandwidthEstimator::removeCpu, Qt::UniqueConnection);
+
+    if (!m_statisticsTimer.isActive())
+    {
+        m_statisticsClock.start();
+        m_statisticsTimer.start(1000);
+    }
+}
+
+void BandwidthEstimator::removeCpu(QObject *cpu)
+{
+    //Only the pointer value is used, the Cpu can already be destroyed
+    for (auto it = m_statistics.begin(); it != m_statistics.end(); ++it)
+    {
+        if (it->cpu == cpu)
+        {
+            m_statistics.erase(it);
+            break;
+        }
+    }
+    if (m_statistics.isEmpty())
+    {
+        m_statisticsTimer.stop();
+    }
+    //The remaining Cpu`s can get a larger share of the budget
+    updateStreamingCpus();
+}
+
+void BandwidthEstimator::receivedFrame(uint8_t uCId, int frameSize, bool valid)
+{
+    auto statistics = m_statistics.find(uCId);
+    if (statistics == m_statistics.end())
+    {
+        //Replies to the broadcast scan arrive before the Cpu is known
+        return;
+    }
+    statistics->bytes += static_cast<quint64>(frameSize);
+    statistics->frames++;
+    if (!valid)
+    {
+        statistics->lostFrames++;
+    }
+}
+
+void BandwidthEstimator::tune(Cpu &cpu)
+{
+    if (!m_autoDecimation || m_linkBudget <= 0.0 || !cpu.hasInfo())
+    {
+        return;
+    }
+
+    //The budget is shared equally by the Cpu`s that stream
+    double budget = m_linkBudget / qMax(1, streamingCpus());
+
+    double required = predictedBytesPerSecond(cpu, 1);
+    if (required <= 0.0)
+    {
+        return;
+    }
+
+    int current = qMax(1, cpu.decimation());
+    int decimation = qBound(1, static_cast<int>(std::ceil(required / (budget * budgetUtilization))), MaxDecimation);
+    if (decimation < current && required / decimation > budget * decreaseUtilization)
+    {
+        //Fits, but too close to the budget to give up the current margin
+        return;
+    }
+    if (decimation != current)
+    {
+        qDebug() << "Cpu" << cpu.id() << "needs" << required << "B/s at decimation 1, budget" << budget << "B/s, decimation" << decimation;
+        cpu.setDecimation(decimation);
+    }
+}
+
+void BandwidthEstimator::clear()
+{
+    m_statistics.clear();
+    m_statisticsTimer.stop();
+    m_streamingCpus = 0;
+}
+
+void BandwidthEstimator::requestsChanged(Cpu &cpu)
+{
+    if (!updateStreamingCpus())
+    {
+        tune(cpu);
+    }
+}
+
+bool BandwidthEstimator::updateStreamingCpus()
+{
+    int streaming = streamingCpus();
+    if (streaming == m_streamingCpus)
+    {
+        return false;
+    }
+    //The share of the budget of every Cpu changed
+    m_streamingCpus = streaming;
+    tuneAll();
+    return true;
+}
+
+void BandwidthEstimator::receivedChannelData(Cpu &cpu, const QVector<uint8_t> &channelData)
+{
+    auto statistics = m_statistics.find(cpu.id());
+    if (statistics == m_statistics.end() || channelData.size() < 3)
+    {
+        return;
+    }
+
+    auto timeStamp = static_cast<uint>((channelData[2] << 16) | (channelData[1] << 8) | channelData[0]);
+    int decimation = qMax(1, cpu.decimation());
+    if (statistics->timeStampValid && decimation == statistics->stepDecimation)
+    {
+        uint step = (timeStamp - statistics->lastTimeStamp) & timeStampMask;
+        if (step > 0 && (statistics->minimumStep == 0 || step < statistics->minimumStep))
+        {
+            statistics->minimumStep = step;
+        }
+    }
+    else if (decimation != statistics->stepDecimation)
+    {
+        //Steps of the old and new decimation are not comparable
+        statistics->stepDecimation = decimation;
+        statistics->minimumStep = 0;
+    }
+    statistics->lastTimeStamp = timeStamp;
+    statistics->timeStampValid = true;
+}
+
+void BandwidthEstimator::updateStatistics()
+{
+    double seconds = m_statisticsClock.restart() / 1000.0;
+    if (seconds <= 0.0)
+    {
+        return;
+    }
+
+    for (auto it = m_statistics.begin(); it != m_statistics.end(); ++it)
+    {
+        CpuStatistics& statistics = *it;
+        Cpu& cpu = *statistics.cpu;
+
+        //Frames with a valid CRC that could not be decoded are lost as well
+        int invalidMessages = cpu.invalidMessageCounter();
+        quint64 lost = statistics.lostFrames + static_cast<quint64>(qMax(0, invalidMessages - statistics.lastInvalidMessages));
+        statistics.lastInvalidMessages = invalidMessages;
+
+        statistics.bytesPerSecond = statistics.bytes / seconds;
+        statistics.frameLoss = statistics.frames > 0 ? qMin(1.0, static_cast<double>(lost) / statistics.frames) : 0.0;
+
+        int timeStampUnits = cpu.getVariableTypeSize(Register::VariableType::TimeStamp);
+        if (statistics.minimumStep > 0 && timeStampUnits > 0)
+        {
+            double period = statistics.minimumStep * timeStampUnits * 1e-6 / statistics.stepDecimation;
+            double sampleRate = 1.0 / period;
+            bool changed = statistics.sampleRate <= 0.0 || qAbs(sampleRate - statistics.sampleRate) > statistics.sampleRate * 0.1;
+            statistics.sampleRate = sampleRate;
+            if (changed)
+            {
+                tune(cpu);
+            }
+        }
+
+        emit statisticsUpdated(it.key(), statistics.bytesPerSecond, statistics.frameLoss);
+        statistics.bytes = 0;
+        statistics.frames = 0;
+        statistics.lostFrames = 0;
+        statistics.minimumStep = 0;
+    }
+}
+
+int BandwidthEstimator::frameSize(Cpu &cpu) const
+{
+    //Only maxDebugChannels Registers are on a channel at once, predict for the largest ones
+    QVector<int> sizes;
+    for (auto channelRegister : cpu.channelMultiplexer().requestedRegisters())
+    {
+        sizes.append(channelRegister->getVariableTypeSize());
+    }
+    if (sizes.isEmpty())
+    {
+        return 0;
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<int>());
+    sizes.resize(qMin(sizes.size(), cpu.maxDebugChannels()));
+
+    int size = ChannelDataOverhead;
+    for (int registerSize : qAsConst(sizes))
+    {
+        size += registerSize;
+    }
+    return size;
+}
+
+int BandwidthEstimator::streamingCpus() const
+{
+    int streaming = 0;
+    for (const auto& statistics : m_statistics)
+    {
+        if (statistics.cpu != nullptr && !statistics.cpu->channelMultiplexer().requestedRegisters().isEmpty())
+        {
+            streaming++;
+        }
+    }
+    return streaming;
+}
+
+void BandwidthEstimator::tuneAll()
+{
+    for (const auto& statistics : qAsConst(m_statistics))
+    {
+        tune(*statistics.cpu);
+    }
+}
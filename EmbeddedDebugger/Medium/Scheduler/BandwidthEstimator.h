@@ -0,0 +1,131 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BANDWIDTHESTIMATOR_H
+#define BANDWIDTHESTIMATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+class Cpu;
+
+/**
+ * @brief Measures the link usage per Cpu and tunes the decimation to a link budget.
+ *
+ * Every received frame is counted for the Cpu it came from, which gives the achieved bytes/s and the
+ * fraction of frames that was lost to CRC errors or could not be decoded. The sample rate of a Cpu
+ * without decimation is estimated from the shortest time stamp step between two ReadChannelData
+ * frames.
+ *
+ * The bandwidth a channel configuration needs is predicted from the sizes of the streaming Registers,
+ * as reported in GetInfo, and the frame overhead. With automatic decimation enabled the smallest
+ * decimation whose prediction fits in the link budget is set, and tuned again whenever the streaming
+ * Registers of a Cpu change or the sample rate estimate moves. The budget is shared equally by the
+ * Cpu`s that stream, so all Cpu`s are tuned again when a Cpu starts or stops streaming.
+ */
+class BandwidthEstimator : public QObject
+{
+    Q_OBJECT
+public:
+    static const int ChannelDataOverhead = 11;   /**< STX, uC id, msg id, command, time stamp, mask, CRC and ETX */
+    static const int MaxDecimation = 255;
+
+    explicit BandwidthEstimator(QObject* parent = nullptr);
+
+    double linkBudget() const {return m_linkBudget;}
+    bool isAutoDecimation() const {return m_autoDecimation;}
+
+    /**
+     * @brief Set the bandwidth that all Cpu`s together may use
+     * @param bytesPerSecond link budget, 0 for no limit.
+     */
+    void setLinkBudget(double bytesPerSecond);
+    void setAutoDecimation(bool enabled);
+
+    double bytesPerSecond(uint8_t uCId) const;
+    double frameLoss(uint8_t uCId) const;                       /**< Fraction of the frames of the last second that was lost */
+    double sampleRate(uint8_t uCId) const;                      /**< Estimated samples/s at decimation 1, 0 if unknown */
+
+    /**
+     * @brief Predict the bytes/s of the channel data of a Cpu
+     * @param decimation to predict for, the rate of the Cpu is divided by it.
+     * @return 0 if the sample rate of the Cpu is not known yet.
+     */
+    double predictedBytesPerSecond(Cpu& cpu, int decimation) const;
+
+public slots:
+    void addCpu(Cpu& cpu);
+    void removeCpu(QObject* cpu);
+
+    /**
+     * @brief Must be called for every frame the transport layer received, also for the invalid ones
+     */
+    void receivedFrame(uint8_t uCId, int frameSize, bool valid);
+
+    /**
+     * @brief Pick the decimation of a Cpu for the link budget, only when automatic decimation is enabled
+     */
+    void tune(Cpu& cpu);
+
+    /**
+     * @brief Forget all Cpu`s, used when the medium disconnects
+     */
+    void clear();
+
+signals:
+    void statisticsUpdated(uint8_t uCId, double bytesPerSecond, double frameLoss);
+
+private slots:
+    void receivedChannelData(Cpu& cpu, const QVector<uint8_t>& channelData);
+    void requestsChanged(Cpu& cpu);
+    void updateStatistics();
+
+private:
+    struct CpuStatistics
+    {
+        Cpu* cpu = nullptr;
+        quint64 bytes = 0;              /**< Since the last statistics update */
+        quint64 frames = 0;
+        quint64 lostFrames = 0;
+        int lastInvalidMessages = 0;
+        uint lastTimeStamp = 0;
+        bool timeStampValid = false;
+        uint minimumStep = 0;           /**< Shortest time stamp step between channel data frames since the last update */
+        int stepDecimation = 1;         /**< Decimation while minimumStep was measured */
+        double bytesPerSecond = 0.0;
+        double frameLoss = 0.0;
+        double sampleRate = 0.0;
+    };
+
+    int frameSize(Cpu& cpu) const;
+    int streamingCpus() const;
+    bool updateStreamingCpus();
+    void tuneAll();
+
+private:
+    QHash<uint8_t, CpuStatistics> m_statistics;
+    QTimer m_statisticsTimer;
+    QElapsedTimer m_statisticsClock;
+    int m_streamingCpus = 0;        /**< Cpu`s with streaming Registers when they were last counted */
+    double m_linkBudget = 0.0;
+    bool m_autoDecimation = false;
+};
+
+#endif // BANDWIDTHESTIMATOR_H
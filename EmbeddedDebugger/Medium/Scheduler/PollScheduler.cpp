@@ -0,0 +1,282 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PollScheduler.h"
+#include "Medium/Register/Register.h"
+#include "Medium/CPU/Cpu.h"
+#include <algorithm>
+#include <functional>
+
+static const qint64 minimumTimeout = 500000000;     /**< A query without response for this long (or 4 intervals) is lost */
+static const int maximumStretch = 16;               /**< The interval is never stretched beyond this factor */
+static const int statisticsInterval = 1000;
+
+PollScheduler::PollScheduler(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+    m_dispatchTimer.setSingleShot(true);
+    m_dispatchTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_dispatchTimer, &QTimer::timeout, this, &PollScheduler::dispatch);
+    connect(&m_statisticsTimer, &QTimer::timeout, this, &PollScheduler::updateStatistics);
+}
+
+void PollScheduler::setMaxOutstanding(int maxOutstanding)
+{
+    m_maxOutstanding = qMax(1, maxOutstanding);
+}
+
+void PollScheduler::updateRegister(Register &pollRegister)
+{
+    double rate = pollRegister.pollRate();
+    if (!pollRegister.isPolled())
+    {
+        removeRegister(&pollRegister);
+        return;
+    }
+
+    qint64 now = m_clock.nsecsElapsed();
+    bool isNew = !m_pollStates.contains(&pollRegister);
+    PollState& state = m_pollStates[&pollRegister];
+    state.cpu = &pollRegister.cpu();
+    state.requestedInterval = static_cast<qint64>(1e9 / rate);
+    state.interval = state.requestedInterval;
+    state.generation++;
+    if (isNew || !state.inFlight)
+    {
+        schedule(&pollRegister, state, now);
+    }
+    else
+    {
+        schedule(&pollRegister, state, now + state.interval);
+    }
+
+    if (!m_statisticsTimer.isActive())
+    {
+        m_statisticsClock.start();
+        m_statisticsTimer.start(statisticsInterval);
+    }
+    restartTimer(now);
+}
+
+void PollScheduler::receivedQueryResponse(Register &pollRegister)
+{
+    auto state = m_pollStates.find(&pollRegister);
+    if (state == m_pollStates.end() || !state->inFlight)
+    {
+        //Response to a manual refresh or to a query that already timed out
+        return;
+    }
+
+    state->responses++;
+    qint64 now = m_clock.nsecsElapsed();
+    if (now - state->sentTime < state->interval && state->interval > state->requestedInterval)
+    {
+        //In time again, move back to the requested interval
+        state->interval = qMax(state->requestedInterval, state->interval * 3 / 4);
+    }
+    completed(*state);
+    sendWaiting(state->cpu, now);
+    restartTimer(now);
+}
+
+void PollScheduler::removeRegister(QObject *pollRegister)
+{
+    //Only the pointer value is used, the Register can already be destroyed
+    auto reg = static_cast<Register*>(pollRegister);
+    auto state = m_pollStates.find(reg);
+    if (state == m_pollStates.end())
+    {
+        return;
+    }
+
+    if (state->inFlight)
+    {
+        //The response is not waited for, free its slot
+        completed(*state);
+    }
+    m_waiting[state->cpu].removeAll(reg);
+    m_pollStates.erase(state);
+
+    //Stale deadlines are skipped by their generation, but the pointer could be reused
+    m_deadlines.erase(std::remove_if(m_deadlines.begin(), m_deadlines.end(),
+                                     [reg](const Deadline& deadline){return deadline.pollRegister == reg;}),
+                      m_deadlines.end());
+    std::make_heap(m_deadlines.begin(), m_deadlines.end(), std::greater<Deadline>());
+
+    if (m_pollStates.isEmpty())
+    {
+        m_statisticsTimer.stop();
+    }
+}
+
+void PollScheduler::clear()
+{
+    m_dispatchTimer.stop();
+    m_statisticsTimer.stop();
+    m_deadlines.clear();
+    m_pollStates.clear();
+    m_outstanding.clear();
+    m_waiting.clear();
+}
+
+void PollScheduler::setPaused(bool paused)
+{
+    if (m_paused == paused)
+    {
+        return;
+    }
+
+    m_paused = paused;
+    if (m_paused)
+    {
+        m_dispatchTimer.stop();
+        return;
+    }
+
+    qint64 now = m_clock.nsecsElapsed();
+    const QList<Cpu*> cpus = m_waiting.keys();
+    for (auto cpu : cpus)
+    {
+        sendWaiting(cpu, now);
+    }
+    dispatch();
+}
+
+void PollScheduler::dispatch()
+{
+    if (m_paused)
+    {
+        return;
+    }
+
+    qint64 now = m_clock.nsecsElapsed();
+    while (!m_deadlines.empty() && m_deadlines.front().time <= now)
+    {
+        std::pop_heap(m_deadlines.begin(), m_deadlines.end(), std::greater<Deadline>());
+        Deadline deadline = m_deadlines.back();
+        m_deadlines.pop_back();
+
+        auto state = m_pollStates.find(deadline.pollRegister);
+        if (state == m_pollStates.end() || state->generation != deadline.generation)
+        {
+            continue;
+        }
+
+        if (state->inFlight)
+        {
+            //Previous response is late, poll this Register less often
+            state->interval = qMin(state->interval * 3 / 2, state->requestedInterval * maximumStretch);
+            if (now - state->sentTime > qMax(minimumTimeout, state->interval * 4))
+            {
+                //Lost, free the slot so the Cpu does not stall
+                completed(*state);
+                sendWaiting(state->cpu, now);
+            }
+            schedule(deadline.pollRegister, *state, now + state->interval);
+        }
+        else if (state->waiting)
+        {
+            //Still queued at its Cpu, the next deadline is set when it is sent
+        }
+        else if (m_outstanding.value(state->cpu) >= m_maxOutstanding)
+        {
+            state->waiting = true;
+            m_waiting[state->cpu].enqueue(deadline.pollRegister);
+        }
+        else
+        {
+            send(deadline.pollRegister, *state, now);
+            //Do not catch up on missed deadlines with a burst
+            schedule(deadline.pollRegister, *state, qMax(deadline.time + state->interval, now));
+        }
+    }
+    restartTimer(now);
+}
+
+void PollScheduler::updateStatistics()
+{
+    double seconds = m_statisticsClock.restart() / 1000.0;
+    if (seconds <= 0.0)
+    {
+        return;
+    }
+
+    for (auto state = m_pollStates.begin(); state != m_pollStates.end(); ++state)
+    {
+        double rate = state->responses / seconds;
+        state->achievedRate = state->achievedRate * 0.5 + rate * 0.5;
+        state->responses = 0;
+        state.key()->setAchievedPollRate(state->achievedRate);
+    }
+}
+
+void PollScheduler::schedule(Register *pollRegister, PollScheduler::PollState &state, qint64 time)
+{
+    m_deadlines.push_back(Deadline{time, pollRegister, state.generation});
+    std::push_heap(m_deadlines.begin(), m_deadlines.end(), std::greater<Deadline>());
+}
+
+void PollScheduler::send(Register *pollRegister, PollScheduler::PollState &state, qint64 now)
+{
+    state.inFlight = true;
+    state.waiting = false;
+    state.sentTime = now;
+    m_outstanding[state.cpu]++;
+    pollRegister->poll();
+}
+
+void PollScheduler::completed(PollScheduler::PollState &state)
+{
+    state.inFlight = false;
+    int& outstanding = m_outstanding[state.cpu];
+    outstanding = qMax(0, outstanding - 1);
+}
+
+void PollScheduler::sendWaiting(Cpu *cpu, qint64 now)
+{
+    auto waiting = m_waiting.find(cpu);
+    if (m_paused || waiting == m_waiting.end())
+    {
+        return;
+    }
+
+    while (!waiting->isEmpty() && m_outstanding.value(cpu) < m_maxOutstanding)
+    {
+        Register* pollRegister = waiting->dequeue();
+        auto state = m_pollStates.find(pollRegister);
+        if (state != m_pollStates.end() && state->waiting)
+        {
+            send(pollRegister, *state, now);
+            state->generation++;
+            schedule(pollRegister, *state, now + state->interval);
+        }
+    }
+}
+
+void PollScheduler::restartTimer(qint64 now)
+{
+    if (m_paused || m_deadlines.empty())
+    {
+        m_dispatchTimer.stop();
+        return;
+    }
+
+    qint64 wait = (m_deadlines.front().time - now) / 1000000;
+    m_dispatchTimer.start(static_cast<int>(qBound<qint64>(0, wait, 60000)));
+}
@@ -0,0 +1,129 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+#include <vector>
+class Register;
+class Cpu;
+
+/**
+ * @brief Polls Registers with a QueryRegister at a per Register rate.
+ *
+ * The deadlines of all polled Registers are kept in a binary heap, a single timer is set to the
+ * earliest deadline. Queries are pipelined up to maxOutstanding() per Cpu; a Register whose
+ * deadline passes while the Cpu has no room waits in a queue of that Cpu and is sent as soon as a
+ * response comes in.
+ *
+ * When a Register is still waiting for its previous response at its next deadline the link or the
+ * target can not keep up. The interval of that Register is then stretched, and shrunk back to the
+ * requested interval while responses arrive in time. The achieved rate is measured per Register and
+ * reported through Register::setAchievedPollRate().
+ *
+ * While the medium applies backpressure the scheduler is paused, so no queries pile up in its queues.
+ */
+class PollScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PollScheduler(QObject* parent = nullptr);
+
+    int maxOutstanding() const {return m_maxOutstanding;}
+    void setMaxOutstanding(int maxOutstanding);
+    bool isPaused() const {return m_paused;}
+
+public slots:
+    /**
+     * @brief Start, change or stop polling a Register with its Register::pollRate()
+     * A suspended Register is not polled.
+     */
+    void updateRegister(Register& pollRegister);
+
+    /**
+     * @brief Must be called for every QueryRegister response
+     */
+    void receivedQueryResponse(Register& pollRegister);
+
+    /**
+     * @brief Forget a Register, used when it is destroyed
+     */
+    void removeRegister(QObject* pollRegister);
+
+    /**
+     * @brief Stop polling all Registers, used when the medium disconnects
+     */
+    void clear();
+
+    /**
+     * @brief Stop sending queries while the medium can not send, deadlines passed while paused are not caught up
+     */
+    void setPaused(bool paused);
+
+private slots:
+    void dispatch();
+    void updateStatistics();
+
+private:
+    struct Deadline
+    {
+        qint64 time;            /**< ns on m_clock */
+        Register* pollRegister;
+        quint32 generation;     /**< Must match the generation of the poll state, else the deadline is stale */
+
+        bool operator>(const Deadline& other) const {return time > other.time;}
+    };
+
+    struct PollState
+    {
+        Cpu* cpu = nullptr;             /**< Kept so a destroyed Register can still be removed */
+        qint64 requestedInterval = 0;   /**< ns */
+        qint64 interval = 0;            /**< Requested interval, stretched when responses are late */
+        qint64 sentTime = 0;
+        quint32 generation = 0;
+        bool inFlight = false;
+        bool waiting = false;           /**< Queued because the Cpu had too many outstanding queries */
+        int responses = 0;              /**< Responses since the last statistics update */
+        double achievedRate = 0.0;
+    };
+
+    void schedule(Register* pollRegister, PollState& state, qint64 time);
+    void send(Register* pollRegister, PollState& state, qint64 now);
+    void completed(PollState& state);
+    void sendWaiting(Cpu* cpu, qint64 now);
+    void restartTimer(qint64 now);
+
+private:
+    QElapsedTimer m_clock;
+    QTimer m_dispatchTimer;
+    QTimer m_statisticsTimer;
+    QElapsedTimer m_statisticsClock;
+    std::vector<Deadline> m_deadlines;              /**< Min heap on time */
+    QHash<Register*, PollState> m_pollStates;
+    QHash<Cpu*, int> m_outstanding;
+    QHash<Cpu*, QQueue<Register*>> m_waiting;
+    int m_maxOutstanding = 4;
+    bool m_paused = false;
+};
+
+#endif // POLLSCHEDULER_H
@@ -0,0 +1,123 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ReconnectScheduler.h"
+#include <QRandomGenerator>
+#include <QDebug>
+
+ReconnectScheduler::ReconnectScheduler(QObject *parent) :
+    QObject(parent)
+{
+    m_attemptTimer.setSingleShot(true);
+    connect(&m_attemptTimer, &QTimer::timeout, this, [this]()
+    {
+        m_attempts++;
+        emit reconnectRequested();
+    });
+}
+
+void ReconnectScheduler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!m_enabled)
+    {
+        m_attemptTimer.stop();
+    }
+    else if (m_outage && !m_attemptTimer.isActive())
+    {
+        m_attemptTimer.start(nextDelay());
+    }
+}
+
+void ReconnectScheduler::setBackoff(int initialDelay, int maximumDelay)
+{
+    m_initialDelay = qMax(1, initialDelay);
+    m_maximumDelay = qMax(m_initialDelay, maximumDelay);
+}
+
+qint64 ReconnectScheduler::downtime() const
+{
+    return m_downtime + (m_outage ? m_outageClock.elapsed() : 0);
+}
+
+void ReconnectScheduler::connectionEstablished()
+{
+    m_attemptTimer.stop();
+    m_connectionWanted = true;
+    m_failedAttempts = 0;
+    if (m_outage)
+    {
+        m_outage = false;
+        qint64 duration = m_outageClock.elapsed();
+        m_downtime += duration;
+        m_reconnectCount++;
+        emit outageEnded(m_outageStart, duration);
+    }
+}
+
+void ReconnectScheduler::connectionLost()
+{
+    if (!m_connectionWanted || m_attemptTimer.isActive())
+    {
+        //Disconnected on purpose, or the error and the disconnect of the same failure
+        return;
+    }
+
+    if (!m_outage)
+    {
+        m_outage = true;
+        m_outageStart = QDateTime::currentDateTime();
+        m_outageClock.start();
+        emit outageStarted(m_outageStart);
+    }
+    else
+    {
+        m_failedAttempts++;
+    }
+
+    if (m_enabled)
+    {
+        int delay = nextDelay();
+        qDebug() << "Connection lost, reconnecting in" << delay << "ms";
+        m_attemptTimer.start(delay);
+    }
+}
+
+void ReconnectScheduler::stop()
+{
+    m_attemptTimer.stop();
+    m_connectionWanted = false;
+    m_failedAttempts = 0;
+    if (m_outage)
+    {
+        //The outage ends without a reconnect
+        m_outage = false;
+        m_downtime += m_outageClock.elapsed();
+    }
+}
+
+int ReconnectScheduler::nextDelay()
+{
+    qint64 backoff = m_initialDelay;
+    for (int i = 0; i < m_failedAttempts && backoff < m_maximumDelay; i++)
+    {
+        backoff *= 2;
+    }
+    backoff = qMin<qint64>(backoff, m_maximumDelay);
+    return static_cast<int>(backoff / 2) + QRandomGenerator::global()->bounded(static_cast<int>(backoff / 2) + 1);
+}
@@ -0,0 +1,115 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RECONNECTSCHEDULER_H
+#define RECONNECTSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+
+/**
+ * @brief Reconnects a medium after its connection was lost, with jittered exponential backoff.
+ *
+ * After a lost connection, or a failed attempt, the next attempt is made after the backoff time.
+ * The backoff time starts at the initial delay and doubles after every failed attempt up to the
+ * maximum delay. A random part of the time (equal jitter: between half and the whole backoff time)
+ * keeps many recorders from hammering a target that comes back at the same moment.
+ *
+ * The outage from losing the connection until it is established again is reported with
+ * outageStarted() and outageEnded(), so histories and recordings can mark the gap. The number of
+ * reconnects and the total downtime are counted.
+ */
+class ReconnectScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReconnectScheduler(QObject* parent = nullptr);
+
+    bool isEnabled() const {return m_enabled;}
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Set the backoff times
+     * @param initialDelay ms before the first attempt.
+     * @param maximumDelay ms that the backoff time is limited to.
+     */
+    void setBackoff(int initialDelay, int maximumDelay);
+    int initialDelay() const {return m_initialDelay;}
+    int maximumDelay() const {return m_maximumDelay;}
+
+    bool isOutage() const {return m_outage;}
+    quint64 reconnectCount() const {return m_reconnectCount;}   /**< Outages that ended with a successful reconnect */
+    quint64 attempts() const {return m_attempts;}               /**< Reconnect attempts, including failed ones */
+    qint64 downtime() const;                                    /**< ms without connection since the first connection, including the current outage */
+
+public slots:
+    /**
+     * @brief The medium is connected, ends an outage
+     */
+    void connectionEstablished();
+
+    /**
+     * @brief The connection was lost or an attempt failed, the next attempt is scheduled
+     */
+    void connectionLost();
+
+    /**
+     * @brief The medium was disconnected on purpose, no attempts are made until it is connected again
+     */
+    void stop();
+
+signals:
+    /**
+     * @brief Emitted when it is time for a reconnect attempt
+     */
+    void reconnectRequested();
+
+    /**
+     * @brief Emitted when a connection that was established is lost
+     * @param startTime time at which the connection was lost.
+     */
+    void outageStarted(const QDateTime& startTime);
+
+    /**
+     * @brief Emitted when the connection is established again after an outage
+     * @param startTime time at which the connection was lost.
+     * @param duration of the outage in ms.
+     */
+    void outageEnded(const QDateTime& startTime, qint64 duration);
+
+private:
+    int nextDelay();
+
+private:
+    QTimer m_attemptTimer;
+    QElapsedTimer m_outageClock;
+    QDateTime m_outageStart;
+    bool m_enabled = false;
+    bool m_connectionWanted = false;    /**< Set while connected and during an outage, cleared by stop() */
+    bool m_outage = false;
+    int m_initialDelay = 500;
+    int m_maximumDelay = 30000;
+    int m_failedAttempts = 0;
+    quint64 m_reconnectCount = 0;
+    quint64 m_attempts = 0;
+    qint64 m_downtime = 0;
+};
+
+#endif // RECONNECTSCHEDULER_H
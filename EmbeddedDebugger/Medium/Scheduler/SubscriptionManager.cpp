@@ -0,0 +1,110 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SubscriptionManager.h"
+#include "Medium/Register/Register.h"
+
+SubscriptionManager::SubscriptionManager(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+    connect(&m_suspendTimer, &QTimer::timeout, this, &SubscriptionManager::suspendExpired);
+}
+
+void SubscriptionManager::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+
+    m_enabled = enabled;
+    m_pendingSuspends.clear();
+    m_suspendTimer.stop();
+    for (auto managedRegister : qAsConst(m_registers))
+    {
+        managedRegister->setSuspended(m_enabled && !managedRegister->isSubscribed());
+    }
+}
+
+void SubscriptionManager::addRegister(Register &newRegister)
+{
+    m_registers.insert(&newRegister);
+    if (m_enabled && !newRegister.isSubscribed())
+    {
+        newRegister.setSuspended(true);
+    }
+}
+
+void SubscriptionManager::subscriptionChanged(Register &changedRegister)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    if (changedRegister.isSubscribed())
+    {
+        m_pendingSuspends.remove(&changedRegister);
+        changedRegister.setSuspended(false);
+    }
+    else
+    {
+        m_pendingSuspends.insert(&changedRegister, m_clock.elapsed() + m_hysteresis);
+        if (!m_suspendTimer.isActive())
+        {
+            m_suspendTimer.start(qMax(10, m_hysteresis / 4));
+        }
+    }
+}
+
+void SubscriptionManager::removeRegister(QObject *removedRegister)
+{
+    //Only the pointer value is used, the Register can already be destroyed
+    m_registers.remove(static_cast<Register*>(removedRegister));
+    m_pendingSuspends.remove(static_cast<Register*>(removedRegister));
+}
+
+void SubscriptionManager::clear()
+{
+    m_registers.clear();
+    m_pendingSuspends.clear();
+    m_suspendTimer.stop();
+}
+
+void SubscriptionManager::suspendExpired()
+{
+    qint64 now = m_clock.elapsed();
+    for (auto pending = m_pendingSuspends.begin(); pending != m_pendingSuspends.end();)
+    {
+        if (pending.value() <= now)
+        {
+            pending.key()->setSuspended(!pending.key()->isSubscribed());
+            pending = m_pendingSuspends.erase(pending);
+        }
+        else
+        {
+            ++pending;
+        }
+    }
+
+    if (m_pendingSuspends.isEmpty())
+    {
+        m_suspendTimer.stop();
+    }
+}
@@ -0,0 +1,67 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBSCRIPTIONMANAGER_H
+#define SUBSCRIPTIONMANAGER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+class Register;
+
+/**
+ * @brief Suspends polling and streaming of Registers that nobody looks at.
+ *
+ * Views subscribe the Registers they show (visible rows, plotted or pinned Registers). When enabled,
+ * every Register without subscribers is suspended: it is not polled by the PollScheduler and its
+ * debug channel is released, while its requested poll rate and channel mode are kept. A Register
+ * that loses its last subscriber is suspended after the hysteresis time, so scrolling back and forth
+ * does not reconfigure the target for every step.
+ */
+class SubscriptionManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SubscriptionManager(QObject* parent = nullptr);
+
+    bool isEnabled() const {return m_enabled;}
+    void setEnabled(bool enabled);
+    int hysteresis() const {return m_hysteresis;}
+    void setHysteresis(int milliseconds) {m_hysteresis = milliseconds;}
+
+public slots:
+    void addRegister(Register& newRegister);
+    void subscriptionChanged(Register& changedRegister);
+    void removeRegister(QObject* removedRegister);
+    void clear();
+
+private slots:
+    void suspendExpired();
+
+private:
+    bool m_enabled = false;
+    int m_hysteresis = 1000;
+    QSet<Register*> m_registers;
+    QHash<Register*, qint64> m_pendingSuspends;  /**< Time in ms on m_clock at which the Register is suspended */
+    QTimer m_suspendTimer;
+    QElapsedTimer m_clock;
+};
+
+#endif // SUBSCRIPTIONMANAGER_H
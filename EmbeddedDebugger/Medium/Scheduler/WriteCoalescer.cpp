@@ -0,0 +1,214 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WriteCoalescer.h"
+#include "Medium/Register/Register.h"
+#include <QDebug>
+
+static const int unconfirmedTime = 1000;    /**< ms after which a sent write has been answered or timed out */
+static const int maxRetries = 3;            /**< Retries of a value that timed out */
+
+WriteCoalescer::WriteCoalescer(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &WriteCoalescer::sendDue);
+}
+
+void WriteCoalescer::setMinimumInterval(int milliseconds)
+{
+    m_minimumInterval = qMax(0, milliseconds);
+    sendDue();
+}
+
+void WriteCoalescer::writeRequested(Register &writeRegister)
+{
+    qint64 now = m_clock.elapsed();
+    auto state = m_writeStates.find(&writeRegister);
+    if (state == m_writeStates.end())
+    {
+        state = m_writeStates.insert(&writeRegister, WriteState());
+        state->lastSent = now - m_minimumInterval;
+    }
+
+    if (state->pending)
+    {
+        //Superseded before it was sent
+        m_elidedWrites++;
+        m_pending--;
+        state->pending = false;
+    }
+
+    state->value = writeRegister.value();
+    state->retries = 0;
+    if (!m_held && now - state->lastSent >= m_minimumInterval)
+    {
+        send(&writeRegister, *state, now);
+    }
+    else
+    {
+        state->pending = true;
+        m_pending++;
+        if (!m_held)
+        {
+            restartTimer(now);
+        }
+    }
+}
+
+void WriteCoalescer::flush()
+{
+    if (m_held)
+    {
+        return;
+    }
+    qint64 now = m_clock.elapsed();
+    for (auto state = m_writeStates.begin(); state != m_writeStates.end(); ++state)
+    {
+        if (state->pending)
+        {
+            send(state.key(), *state, now);
+        }
+    }
+    m_timer.stop();
+}
+
+void WriteCoalescer::removeRegister(QObject *writeRegister)
+{
+    //Only the pointer value is used, the Register can already be destroyed
+    auto state = m_writeStates.find(static_cast<Register*>(writeRegister));
+    if (state != m_writeStates.end())
+    {
+        if (state->pending)
+        {
+            m_pending--;
+        }
+        m_writeStates.erase(state);
+    }
+}
+
+void WriteCoalescer::hold()
+{
+    if (m_held)
+    {
+        return;
+    }
+    m_held = true;
+    m_timer.stop();
+
+    qint64 now = m_clock.elapsed();
+    for (auto& state : m_writeStates)
+    {
+        if (!state.pending && now - state.lastSent < unconfirmedTime)
+        {
+            state.pending = true;
+            m_pending++;
+        }
+    }
+}
+
+void WriteCoalescer::resume()
+{
+    if (!m_held)
+    {
+        return;
+    }
+    m_held = false;
+    flush();
+}
+
+void WriteCoalescer::retry(Register &writeRegister)
+{
+    auto state = m_writeStates.find(&writeRegister);
+    if (state == m_writeStates.end() || state->pending)
+    {
+        //Unknown, or a newer value is about to be sent anyway
+        return;
+    }
+    if (state->retries >= maxRetries)
+    {
+        qWarning() << "Gave up writing" << writeRegister.name() << "after" << maxRetries << "retries";
+        return;
+    }
+
+    state->retries++;
+    state->pending = true;
+    m_pending++;
+    if (!m_held)
+    {
+        restartTimer(m_clock.elapsed());
+    }
+}
+
+void WriteCoalescer::clear()
+{
+    m_timer.stop();
+    m_writeStates.clear();
+    m_pending = 0;
+    m_held = false;
+}
+
+void WriteCoalescer::sendDue()
+{
+    if (m_held)
+    {
+        return;
+    }
+    qint64 now = m_clock.elapsed();
+    for (auto state = m_writeStates.begin(); state != m_writeStates.end(); ++state)
+    {
+        if (state->pending && now - state->lastSent >= m_minimumInterval)
+        {
+            send(state.key(), *state, now);
+        }
+    }
+    restartTimer(now);
+}
+
+void WriteCoalescer::send(Register *writeRegister, WriteCoalescer::WriteState &state, qint64 now)
+{
+    if (state.pending)
+    {
+        state.pending = false;
+        m_pending--;
+    }
+    state.lastSent = now;
+    //The value is copied, a value received from the Cpu meanwhile does not replace the written value
+    emit this->writeRegister(*writeRegister, state.value);
+}
+
+void WriteCoalescer::restartTimer(qint64 now)
+{
+    if (m_pending == 0)
+    {
+        m_timer.stop();
+        return;
+    }
+
+    qint64 earliest = -1;
+    for (const auto& state : qAsConst(m_writeStates))
+    {
+        if (state.pending && (earliest < 0 || state.lastSent < earliest))
+        {
+            earliest = state.lastSent;
+        }
+    }
+    m_timer.start(static_cast<int>(qMax<qint64>(0, earliest + m_minimumInterval - now)));
+}
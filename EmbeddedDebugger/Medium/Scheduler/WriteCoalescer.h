@@ -0,0 +1,121 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WRITECOALESCER_H
+#define WRITECOALESCER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVariant>
+class Register;
+
+/**
+ * @brief Limits the rate of writes to a Register, the latest value wins.
+ *
+ * A slider or spin box changes a Register value many times per second, every change would be a
+ * WriteRegister on the link that is superseded by the next one. The first write to a Register is
+ * sent right away. Writes within the minimum interval after it are held back; only the newest held
+ * value is sent when the interval has passed, the values it replaced are counted as elided. The
+ * final value of an edit is therefore always written, at most one interval late.
+ *
+ * While the medium reconnects the coalescer is held: held back values are kept, and the values
+ * sent shortly before the link dropped are sent again after resume(), their WriteRegister may
+ * have been lost. A write that timed out is sent again with retry(), with the latest value.
+ */
+class WriteCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WriteCoalescer(QObject* parent = nullptr);
+
+    /**
+     * @brief Set the minimum time between two writes to the same Register
+     * @param milliseconds 0 sends every write right away.
+     */
+    void setMinimumInterval(int milliseconds);
+    int minimumInterval() const {return m_minimumInterval;}
+    quint64 elidedWrites() const {return m_elidedWrites;}
+    int pendingWrites() const {return m_pending;}
+
+public slots:
+    /**
+     * @brief Write the current value of a Register, connected to Register::writeRegister
+     */
+    void writeRequested(Register& writeRegister);
+
+    /**
+     * @brief Send all held back values now
+     */
+    void flush();
+
+    /**
+     * @brief Forget a Register, used when it is destroyed
+     */
+    void removeRegister(QObject* writeRegister);
+
+    /**
+     * @brief Keep all values until resume(), used while the medium reconnects
+     */
+    void hold();
+
+    /**
+     * @brief Send the values that were kept by hold()
+     */
+    void resume();
+
+    /**
+     * @brief Write the latest value of a Register again, used when its write timed out
+     */
+    void retry(Register& writeRegister);
+
+    /**
+     * @brief Drop all held back values, used when the medium disconnects
+     */
+    void clear();
+
+signals:
+    void writeRegister(Register& writeRegister, const QVariant& value);
+
+private slots:
+    void sendDue();
+
+private:
+    struct WriteState
+    {
+        qint64 lastSent = 0;    /**< ms on m_clock */
+        QVariant value;
+        bool pending = false;
+        int retries = 0;        /**< Retries of the latest value */
+    };
+
+    void send(Register* writeRegister, WriteState& state, qint64 now);
+    void restartTimer(qint64 now);
+
+private:
+    QHash<Register*, WriteState> m_writeStates;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    int m_minimumInterval = 50;
+    int m_pending = 0;
+    bool m_held = false;
+    quint64 m_elidedWrites = 0;
+};
+
+#endif // WRITECOALESCER_H
@@ -31,12 +31,9 @@ ProfileListModel::~ProfileListModel()
 
 void ProfileListModel::clear()
 {
-    for(auto Plugin : qAsConst(m_profileList))
-    {
-        Plugin->unload();
-        Plugin->deleteLater();
-    }
+    beginResetModel();
     m_profileList.clear();
+    endResetModel();
 }
 
 int ProfileListModel::rowCount(const QModelIndex &parent) const
@@ -50,14 +47,13 @@ QVariant ProfileListModel::data(const QModelIndex &index, int role) const
     QVariant returnValue;
 
        int row = index.row();
-       if(row > 0 || row <= m_profileList.count())
+       if(row >= 0 && row < m_profileList.count())
        {
-           QJsonObject metaData = m_profileList.at(row)->metaData().value("MetaData").toObject();
            switch (role)
            {
            case Qt::DisplayRole:
            {
-               returnValue = metaData.value("profile").toString();
+               returnValue = m_profileList.at(row).profileName;
                break;
            }
            }
@@ -67,40 +63,30 @@ QVariant ProfileListModel::data(const QModelIndex &index, int role) const
 
 QHash<int, QByteArray> ProfileListModel::roleNames() const
 {
-
+    return QAbstractListModel::roleNames();
 }
 
-void ProfileListModel::insert(int index, QPluginLoader *connector)
+void ProfileListModel::insert(int index, const QString &profileName, const QString &fileName)
 {
     if(index < 0) {
         return;
     }
     emit beginInsertRows(QModelIndex(), index, index);
-    m_profileList.insert(index,connector);
+    m_profileList.insert(index, ProfileEntry{profileName, fileName});
     emit endInsertRows();
 }
 
-void ProfileListModel::append(QPluginLoader *connector)
+void ProfileListModel::append(const QString &profileName, const QString &fileName)
 {
-    insert(m_profileList.count(),connector);
+    insert(m_profileList.count(), profileName, fileName);
 }
 
-QPluginLoader *ProfileListModel::at(int index)
+QString ProfileListModel::fileName(int index) const
 {
-    QPluginLoader* returnValue = nullptr;
+    QString returnValue;
     if (index >= 0 && index < m_profileList.size())
     {
-        returnValue = m_profileList.at(index);
-    }
-    return returnValue;
-}
-
-QPluginLoader *ProfileListModel::last()
-{
-    QPluginLoader* returnValue = nullptr;
-    if (!m_profileList.isEmpty())
-    {
-        returnValue = m_profileList.last();
+        returnValue = m_profileList.at(index).fileName;
     }
     return returnValue;
 }
@@ -21,8 +21,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QAbstractListModel>
 #include <QList>
-#include <QPluginLoader>
 
+/**
+ * @brief List of the profiles that were found in the plugins directory.
+ * Only the name and file of each profile are kept, the plugin is loaded when the profile is selected.
+ */
 class ProfileListModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -36,13 +39,18 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
-    void insert(int index, QPluginLoader* connector);
-    void append(QPluginLoader* connector);
-    QPluginLoader* at(int index);
-    QPluginLoader* last();
+    void insert(int index, const QString& profileName, const QString& fileName);
+    void append(const QString& profileName, const QString& fileName);
+    QString fileName(int index) const;
 
 private:
-   QList<QPluginLoader*> m_profileList;
+    struct ProfileEntry
+    {
+        QString profileName;    /**< Name from the profile key in the plugin meta data */
+        QString fileName;       /**< Absolute path of the plugin */
+    };
+
+   QList<ProfileEntry> m_profileList;
 };
 
 #endif // PROFILELISTMODEL_H
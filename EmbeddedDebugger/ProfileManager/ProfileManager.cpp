@@ -19,13 +19,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ProfileManager.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonObject>
 #include <QPluginLoader>
+#include <QSettings>
+#include <QDebug>
+
+static const char profileCacheGroup[] = "ProfileCache";
 
 ProfileManager::ProfileManager(QObject *parent) : QObject(parent)
 {
 
 }
 
+ProfileManager::~ProfileManager()
+{
+    unloadActiveProfile();
+}
+
 void ProfileManager::searchProfiles()
 {
     QDir pluginsDir(qApp->applicationDirPath());
@@ -43,34 +55,86 @@ void ProfileManager::searchProfiles()
     pluginsDir.cdUp();
 #endif
     pluginsDir.cd("plugins");
-    foreach (QString fileName, pluginsDir.entryList(QDir::Files)) {
-        QPluginLoader* newPlugin = new QPluginLoader(pluginsDir.absoluteFilePath(fileName));
-        auto tempInterface = qobject_cast<BaseProfile*>(newPlugin->instance());
-        if (tempInterface != nullptr)
+
+    //Cache entry per plugin file: modification time, size and profile name (empty if it is no profile)
+    QSettings settings;
+    QVariantMap oldCache = settings.value(profileCacheGroup).toMap();
+    QVariantMap newCache;
+
+    m_profileListModel.clear();
+    foreach (QFileInfo fileInfo, pluginsDir.entryInfoList(QDir::Files, QDir::Name)) {
+        QString filePath = fileInfo.absoluteFilePath();
+        qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+        QString profileName;
+
+        QVariantMap cacheEntry = oldCache.value(filePath).toMap();
+        if (!cacheEntry.isEmpty() &&
+            cacheEntry.value("modified").toLongLong() == modified &&
+            cacheEntry.value("size").toLongLong() == fileInfo.size())
+        {
+            profileName = cacheEntry.value("profile").toString();
+        }
+        else
         {
-            newPlugin->unload();
-            m_profileListModel.append(newPlugin);
+            //metaData() only reads the plugin file, the library is not loaded
+            QPluginLoader pluginLoader(filePath);
+            profileName = pluginLoader.metaData().value("MetaData").toObject().value("profile").toString();
+            cacheEntry.clear();
+            cacheEntry.insert("modified", modified);
+            cacheEntry.insert("size", fileInfo.size());
+            cacheEntry.insert("profile", profileName);
         }
-        else {
-            newPlugin->deleteLater();
+        newCache.insert(filePath, cacheEntry);
+
+        if (!profileName.isEmpty())
+        {
+            m_profileListModel.append(profileName, filePath);
         }
     }
+
+    //Entries of removed plugins are dropped
+    if (newCache != oldCache)
+    {
+        settings.setValue(profileCacheGroup, newCache);
+    }
 }
 
 void ProfileManager::setActiveConnector(int indexOfConnectorListModel)
 {
     if (indexOfConnectorListModel >= 0 && indexOfConnectorListModel < m_profileListModel.rowCount())
     {
-        if (m_activePluginLoader != nullptr)
+        QString fileName = m_profileListModel.fileName(indexOfConnectorListModel);
+        if (m_activeProfile != nullptr && fileName == m_activeProfileFile)
         {
-            m_activePluginLoader->unload();
-            m_activeProfile = nullptr;
-            m_activePluginLoader = nullptr;
+            return;
         }
+        unloadActiveProfile();
 
-        m_activePluginLoader = m_profileListModel.at(indexOfConnectorListModel);
+        m_activePluginLoader = new QPluginLoader(fileName, this);
         m_activeProfile = qobject_cast<BaseProfile*>(m_activePluginLoader->instance());
+        if (m_activeProfile == nullptr)
+        {
+            qWarning() << "Could not load profile " << fileName << m_activePluginLoader->errorString();
+            unloadActiveProfile();
+        }
+        else
+        {
+            m_activeProfileFile = fileName;
+        }
+    }
+}
+
+void ProfileManager::unloadActiveProfile()
+{
+    if (m_activePluginLoader != nullptr)
+    {
+        //Unloading deletes the profile instance
+        m_activePluginLoader->unload();
+        m_activePluginLoader->deleteLater();
     }
+    m_activeProfile = nullptr;
+    m_activePluginLoader = nullptr;
+    m_activeProfileFile.clear();
 }
 
 KConcatenateRowsProxyModel* ProfileManager::cpuListModel()
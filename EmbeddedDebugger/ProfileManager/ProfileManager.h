@@ -22,24 +22,40 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 #include "ProfileListModel.h"
 #include "../Profiles/BaseProfile.h"
+class QPluginLoader;
 
 class ProfileManager : public QObject
 {
     Q_OBJECT
 public:
     explicit ProfileManager(QObject *parent = nullptr);
+    ~ProfileManager() override;
 
+    /**
+     * @brief Find the profiles in the plugins directory.
+     * Profiles are recognised by the profile key in the plugin meta data, no plugin is loaded.
+     * The result per file is cached in QSettings and only read again when the file was modified.
+     */
     void searchProfiles();
 
     BaseProfile* getActiveProfile() {return m_activeProfile;}
+
+    /**
+     * @brief Load the plugin of a profile and make it the active profile.
+     * The previously active profile is unloaded.
+     */
     void setActiveConnector(int indexOfConnectorListModel);
     ProfileListModel& profileList() {return m_profileListModel;}
     KConcatenateRowsProxyModel* cpuListModel();
     KConcatenateRowsProxyModel* registerListModel();
 
+private:
+    void unloadActiveProfile();
+
 private:
     BaseProfile* m_activeProfile = nullptr;
     QPluginLoader* m_activePluginLoader = nullptr;
+    QString m_activeProfileFile;
     ProfileListModel m_profileListModel;
 };
 
@@ -20,9 +20,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ui_ConnectTab.h"
 #include "Core.h"
 #include "ProfileManager/ProfileManager.h"
+#include "Medium/Medium.h"
 #include <QDebug>
 #include <QHeaderView>
 #include <QMenu>
+#include <QSettings>
 
 ConnectTab::ConnectTab(QWidget *parent) :
     QWidget(parent),
@@ -46,6 +48,21 @@ ConnectTab::~ConnectTab()
 
 void ConnectTab::init()
 {
+    QSettings settings;
+    {
+        QSignalBlocker budgetBlocker(ui->linkBudgetSpinBox);
+        QSignalBlocker decimationBlocker(ui->autoDecimationCheckBox);
+        QSignalBlocker writeIntervalBlocker(ui->writeIntervalSpinBox);
+        QSignalBlocker byteLimitBlocker(ui->cpuByteLimitSpinBox);
+        QSignalBlocker frameLimitBlocker(ui->cpuFrameLimitSpinBox);
+        ui->linkBudgetSpinBox->setValue(settings.value("Medium/LinkBudget", 0).toInt());
+        ui->autoDecimationCheckBox->setChecked(settings.value("Medium/AutoDecimation", false).toBool());
+        ui->writeIntervalSpinBox->setValue(settings.value("Medium/WriteInterval", ui->writeIntervalSpinBox->value()).toInt());
+        ui->cpuByteLimitSpinBox->setValue(settings.value("Medium/CpuByteLimit", 0).toInt());
+        ui->cpuFrameLimitSpinBox->setValue(settings.value("Medium/CpuFrameLimit", 0).toInt());
+    }
+
+    //Selects the first profile, which applies the link settings to its media
     ui->profileCombobox->setModel(&Core::Instance().profileManager().profileList());
     ui->cpuTableView->setModel(Core::Instance().profileManager().cpuListModel());
 }
@@ -61,6 +78,8 @@ void ConnectTab::on_connectButton_clicked()
 void ConnectTab::on_profileCombobox_currentIndexChanged(int index)
 {
     Core::Instance().profileManager().setActiveConnector(index);
+    applyLinkSettings();
+    connectLinkStatus();
 }
 
 void ConnectTab::customHeaderMenuRequested()
@@ -94,3 +113,115 @@ void ConnectTab::on_settingsButton_clicked()
         Core::Instance().profileManager().getActiveProfile()->showSettings();
     }
 }
+
+void ConnectTab::on_linkBudgetSpinBox_valueChanged(int kiloBytesPerSecond)
+{
+    QSettings settings;
+    settings.setValue("Medium/LinkBudget", kiloBytesPerSecond);
+    applyLinkSettings();
+}
+
+void ConnectTab::on_autoDecimationCheckBox_toggled(bool checked)
+{
+    QSettings settings;
+    settings.setValue("Medium/AutoDecimation", checked);
+    applyLinkSettings();
+}
+
+void ConnectTab::on_writeIntervalSpinBox_valueChanged(int milliseconds)
+{
+    QSettings settings;
+    settings.setValue("Medium/WriteInterval", milliseconds);
+    applyLinkSettings();
+}
+
+void ConnectTab::on_cpuByteLimitSpinBox_valueChanged(int kiloBytesPerSecond)
+{
+    QSettings settings;
+    settings.setValue("Medium/CpuByteLimit", kiloBytesPerSecond);
+    applyLinkSettings();
+}
+
+void ConnectTab::on_cpuFrameLimitSpinBox_valueChanged(int framesPerSecond)
+{
+    QSettings settings;
+    settings.setValue("Medium/CpuFrameLimit", framesPerSecond);
+    applyLinkSettings();
+}
+
+void ConnectTab::applyLinkSettings()
+{
+    BaseProfile* profile = Core::Instance().profileManager().getActiveProfile();
+    if (profile == nullptr)
+    {
+        return;
+    }
+    for (auto medium : qAsConst(profile->mediumList()))
+    {
+        medium->bandwidthEstimator().setLinkBudget(ui->linkBudgetSpinBox->value() * 1024.0);
+        medium->bandwidthEstimator().setAutoDecimation(ui->autoDecimationCheckBox->isChecked());
+        medium->writeCoalescer().setMinimumInterval(ui->writeIntervalSpinBox->value());
+        medium->setCpuRateLimit(ui->cpuByteLimitSpinBox->value() * 1024.0, ui->cpuFrameLimitSpinBox->value());
+    }
+}
+
+void ConnectTab::connectLinkStatus()
+{
+    //The connections to the media of the previous profile go with its context
+    delete m_profileContext;
+    m_profileContext = new QObject(this);
+    m_linkStatus.clear();
+    ui->linkStatusLabel->clear();
+
+    BaseProfile* profile = Core::Instance().profileManager().getActiveProfile();
+    if (profile == nullptr)
+    {
+        return;
+    }
+    for (int i = 0; i < profile->mediumList().size(); i++)
+    {
+        Medium* medium = profile->mediumList().at(i);
+        connect(&medium->bandwidthEstimator(), &BandwidthEstimator::statisticsUpdated, m_profileContext,
+                [this, i, medium](uint8_t uCId, double bytesPerSecond, double frameLoss) {
+            linkStatisticsUpdated(i, medium, uCId, bytesPerSecond, frameLoss);
+        });
+    }
+}
+
+void ConnectTab::linkStatisticsUpdated(int mediumIndex, Medium *medium, uint8_t uCId, double bytesPerSecond, double frameLoss)
+{
+    Cpu* cpu = medium->cpuListModel().getCpuNodeById(uCId);
+    QString status = QString("Cpu %1: %2 kB/s, loss %3 %")
+            .arg(uCId)
+            .arg(bytesPerSecond / 1024.0, 0, 'f', 1)
+            .arg(frameLoss * 100.0, 0, 'f', 1);
+    if (cpu != nullptr)
+    {
+        status += QString(", decimation %1").arg(qMax(1, cpu->decimation()));
+    }
+    m_linkStatus.insert(qMakePair(mediumIndex, uCId), status);
+
+    QStringList lines;
+    for (const auto& line : qAsConst(m_linkStatus))
+    {
+        lines.append(line);
+    }
+    lines.append(mediumStatus());
+    ui->linkStatusLabel->setText(lines.join(" | "));
+}
+
+QString ConnectTab::mediumStatus() const
+{
+    quint64 elidedWrites = 0;
+    qint64 throttledTime = 0;
+    BaseProfile* profile = Core::Instance().profileManager().getActiveProfile();
+    if (profile != nullptr)
+    {
+        for (auto medium : qAsConst(profile->mediumList()))
+        {
+            elidedWrites += medium->writeCoalescer().elidedWrites();
+            throttledTime += medium->throttledTime();
+        }
+    }
+    return QString("elided writes %1, throttled %2 ms").arg(elidedWrites).arg(throttledTime);
+}
@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CONNECTTAB_H
 
 #include <QWidget>
+#include <QMap>
+#include <QPair>
+class Medium;
 
 namespace Ui {
 class ConnectTab;
@@ -44,8 +47,22 @@ private slots:
 
     void on_settingsButton_clicked();
 
+    void on_linkBudgetSpinBox_valueChanged(int kiloBytesPerSecond);
+    void on_autoDecimationCheckBox_toggled(bool checked);
+    void on_writeIntervalSpinBox_valueChanged(int milliseconds);
+    void on_cpuByteLimitSpinBox_valueChanged(int kiloBytesPerSecond);
+    void on_cpuFrameLimitSpinBox_valueChanged(int framesPerSecond);
+
+private:
+    void applyLinkSettings();
+    void connectLinkStatus();
+    void linkStatisticsUpdated(int mediumIndex, Medium* medium, uint8_t uCId, double bytesPerSecond, double frameLoss);
+    QString mediumStatus() const;
+
 private:
     Ui::ConnectTab *ui;
+    QObject* m_profileContext = nullptr;                /**< Receiver of the connections to the media of the active profile */
+    QMap<QPair<int, uint8_t>, QString> m_linkStatus;    /**< Status line per medium and Cpu */
 };
 
 #endif // CONNECTTAB_H
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ui_MainWindow.h"
 #include "ConnectTab.h"
 #include "RegisterTab.h"
+#include "PlotTab.h"
 #include <qDebug>
 
 MainWindow::MainWindow(QWidget *parent) :
@@ -29,8 +30,10 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->setupUi(this);
     m_connectTab = new ConnectTab();
     m_registerTab = new RegisterTab();
+    m_plotTab = new PlotTab();
     ui->tabWidget->addTab(m_connectTab, "Connect");
     ui->tabWidget->addTab(m_registerTab, "Register");
+    ui->tabWidget->addTab(m_plotTab, "Plot");
 }
 
 MainWindow::~MainWindow()
@@ -44,4 +47,5 @@ void MainWindow::init()
 {
     m_connectTab->init();
     m_registerTab->init();
+    m_plotTab->init();
 }
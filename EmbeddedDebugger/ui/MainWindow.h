@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMainWindow>
 class ConnectTab;
 class RegisterTab;
+class PlotTab;
 
 namespace Ui {
 class MainWindow;
@@ -42,6 +43,7 @@ private:
     Ui::MainWindow *ui;
     ConnectTab* m_connectTab;
     RegisterTab* m_registerTab;
+    PlotTab* m_plotTab;
 };
 
 #endif // MAINWINDOW_H
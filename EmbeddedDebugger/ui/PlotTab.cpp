@@ -0,0 +1,172 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PlotTab.h"
+#include "ui_PlotTab.h"
+#include "Core.h"
+#include "ProfileManager/ProfileManager.h"
+#include "Medium/Register/Register.h"
+#include "Medium/Register/RegisterListModel.h"
+#include <QDebug>
+#include <QSet>
+#include <QSettings>
+
+PlotTab::PlotTab(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::PlotTab)
+{
+    ui->setupUi(this);
+    ui->timeSpanSpinBox->setValue(ui->plotWidget->timeSpan());
+    connect(ui->plotWidget, &PlotWidget::frameStatistics, this, &PlotTab::showFrameStatistics);
+    connect(ui->registerListWidget, &QListWidget::itemChanged, this, &PlotTab::updatePlotRegisters);
+}
+
+PlotTab::~PlotTab()
+{
+    qDebug() << "Delete PlotTab";
+    delete ui;
+    qDebug() << "Delete PlotTab done";
+}
+
+void PlotTab::init()
+{
+    //Samples kept per plotted Register, the history grows up to this size
+    QSettings settings;
+    RegisterHistory::setDefaultMaximumCapacity(settings.value("Plot/HistorySamples", RegisterHistory::DefaultMaximumCapacity).toInt());
+
+    QAbstractItemModel* registerModel = Core::Instance().profileManager().registerListModel();
+    if (registerModel != nullptr)
+    {
+        connect(registerModel, &QAbstractItemModel::rowsInserted, this, &PlotTab::registersInserted);
+        connect(registerModel, &QAbstractItemModel::rowsRemoved, this, &PlotTab::updateRegisterList);
+        connect(registerModel, &QAbstractItemModel::modelReset, this, &PlotTab::updateRegisterList);
+    }
+    updateRegisterList();
+}
+
+void PlotTab::updateRegisterList()
+{
+    //Keep the selection of registers that still exist
+    QSet<QObject*> checkedRegisters;
+    for (int i = 0; i < ui->registerListWidget->count(); i++)
+    {
+        QListWidgetItem* item = ui->registerListWidget->item(i);
+        if (item->checkState() == Qt::Checked)
+        {
+            checkedRegisters.insert(item->data(RegisterListModel::RegisterRole).value<QObject*>());
+        }
+    }
+
+    QSignalBlocker blocker(ui->registerListWidget);
+    ui->registerListWidget->clear();
+    QAbstractItemModel* registerModel = Core::Instance().profileManager().registerListModel();
+    if (registerModel != nullptr)
+    {
+        for (int row = 0; row < registerModel->rowCount(); row++)
+        {
+            QListWidgetItem* item = createRegisterItem(*registerModel, row);
+            if (checkedRegisters.contains(item->data(RegisterListModel::RegisterRole).value<QObject*>()))
+            {
+                item->setCheckState(Qt::Checked);
+            }
+            ui->registerListWidget->addItem(item);
+        }
+    }
+    updatePlotRegisters();
+}
+
+void PlotTab::registersInserted(const QModelIndex &parent, int first, int last)
+{
+    //Registers are loaded in batches, only the new rows are added, they are not plotted yet
+    QAbstractItemModel* registerModel = Core::Instance().profileManager().registerListModel();
+    if (registerModel == nullptr || parent.isValid())
+    {
+        return;
+    }
+    QSignalBlocker blocker(ui->registerListWidget);
+    for (int row = first; row <= last; row++)
+    {
+        ui->registerListWidget->insertItem(row, createRegisterItem(*registerModel, row));
+    }
+}
+
+QListWidgetItem *PlotTab::createRegisterItem(QAbstractItemModel &registerModel, int row)
+{
+    //One item per row, so the rows of the list and the model stay the same
+    auto item = new QListWidgetItem();
+    QObject* registerObject = registerModel.index(row, 0).data(RegisterListModel::RegisterRole).value<QObject*>();
+    if (registerObject != nullptr)
+    {
+        item->setText(static_cast<Register*>(registerObject)->name());
+        item->setData(RegisterListModel::RegisterRole, QVariant::fromValue(registerObject));
+        item->setData(RegisterListModel::SubscriptionRole, QPersistentModelIndex(registerModel.index(row, 0)));
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+    }
+    else
+    {
+        item->setFlags(Qt::NoItemFlags);
+    }
+    return item;
+}
+
+void PlotTab::updatePlotRegisters()
+{
+    QVector<Register*> plotRegisters;
+    QList<QPersistentModelIndex> plotRows;
+    for (int i = 0; i < ui->registerListWidget->count(); i++)
+    {
+        QListWidgetItem* item = ui->registerListWidget->item(i);
+        if (item->checkState() == Qt::Checked)
+        {
+            plotRegisters.append(static_cast<Register*>(item->data(RegisterListModel::RegisterRole).value<QObject*>()));
+            plotRows.append(item->data(RegisterListModel::SubscriptionRole).value<QPersistentModelIndex>());
+        }
+    }
+    ui->plotWidget->setRegisters(plotRegisters);
+
+    //Subscribe first, so Registers that stay plotted are never suspended
+    for (const auto& row : qAsConst(plotRows))
+    {
+        if (row.isValid())
+        {
+            const_cast<QAbstractItemModel*>(row.model())->setData(row, true, RegisterListModel::SubscriptionRole);
+        }
+    }
+    for (const auto& row : qAsConst(m_subscribedRows))
+    {
+        if (row.isValid())
+        {
+            const_cast<QAbstractItemModel*>(row.model())->setData(row, false, RegisterListModel::SubscriptionRole);
+        }
+    }
+    m_subscribedRows = plotRows;
+}
+
+void PlotTab::showFrameStatistics(int framesPerSecond, double averageFrameTime, double maximumFrameTime)
+{
+    ui->frameTimeLabel->setText(tr("%1 fps, frame time %2 ms (max %3 ms)")
+                                .arg(framesPerSecond)
+                                .arg(averageFrameTime, 0, 'f', 2)
+                                .arg(maximumFrameTime, 0, 'f', 2));
+}
+
+void PlotTab::on_timeSpanSpinBox_valueChanged(double seconds)
+{
+    ui->plotWidget->setTimeSpan(seconds);
+}
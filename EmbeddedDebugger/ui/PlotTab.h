@@ -0,0 +1,57 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLOTTAB_H
+#define PLOTTAB_H
+
+#include <QWidget>
+#include <QList>
+#include <QPersistentModelIndex>
+class QAbstractItemModel;
+class QListWidgetItem;
+
+namespace Ui {
+class PlotTab;
+}
+
+class PlotTab : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PlotTab(QWidget *parent = nullptr);
+    ~PlotTab();
+
+    void init();
+
+private slots:
+    void updateRegisterList();
+    void registersInserted(const QModelIndex& parent, int first, int last);
+    void updatePlotRegisters();
+    void showFrameStatistics(int framesPerSecond, double averageFrameTime, double maximumFrameTime);
+    void on_timeSpanSpinBox_valueChanged(double seconds);
+
+private:
+    QListWidgetItem* createRegisterItem(QAbstractItemModel& registerModel, int row);
+
+private:
+    Ui::PlotTab *ui;
+    QList<QPersistentModelIndex> m_subscribedRows;  /**< Plotted Registers are subscribed, see SubscriptionManager */
+};
+
+#endif // PLOTTAB_H
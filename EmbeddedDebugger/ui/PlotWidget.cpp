@@ -0,0 +1,296 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PlotWidget.h"
+#include "Medium/Register/Register.h"
+#include <QPainter>
+
+static const QRgb channelColors[] = {
+    0xFF4DAF4A, 0xFFE41A1C, 0xFF377EB8, 0xFFFF7F00,
+    0xFF984EA3, 0xFFFFFF33, 0xFFA65628, 0xFFF781BF,
+    0xFF66C2A5, 0xFFFC8D62, 0xFF8DA0CB, 0xFFE78AC3,
+    0xFFA6D854, 0xFFFFD92F, 0xFFE5C494, 0xFFB3B3B3
+};
+static const int nbrOfChannelColors = sizeof(channelColors) / sizeof(channelColors[0]);
+static const QRgb backgroundColor = 0xFF000000;
+
+PlotWidget::PlotWidget(QWidget *parent) :
+    QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &PlotWidget::renderFrame);
+    m_frameTimer.start(1000 / 60);
+    m_statisticsTimer.start();
+}
+
+PlotWidget::~PlotWidget()
+{
+    setRegisters(QVector<Register*>());
+}
+
+void PlotWidget::setRegisters(const QVector<Register*> &registers)
+{
+    //Subscribe first, so Registers that stay plotted keep their history
+    QVector<QPointer<Register>> historyRegisters;
+    for (auto plotRegister : registers)
+    {
+        plotRegister->subscribeHistory();
+        historyRegisters.append(plotRegister);
+    }
+    for (const auto& historyRegister : qAsConst(m_historyRegisters))
+    {
+        if (!historyRegister.isNull())
+        {
+            historyRegister->unsubscribeHistory();
+        }
+    }
+    m_historyRegisters = historyRegisters;
+
+    m_channels.clear();
+    for (auto plotRegister : registers)
+    {
+        Channel channel;
+        channel.plotRegister = plotRegister;
+        channel.color = channelColors[m_channels.size() % nbrOfChannelColors];
+        channel.minimum = 0.0;
+        channel.maximum = 0.0;
+        channel.rangeValid = false;
+        channel.lastY = -1;
+        m_channels.append(channel);
+    }
+    m_redrawNeeded = true;
+    update();
+}
+
+void PlotWidget::setTimeSpan(double seconds)
+{
+    if (seconds > 0.0)
+    {
+        m_timeSpan = seconds;
+        m_redrawNeeded = true;
+    }
+}
+
+void PlotWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    QPainter painter(this);
+    if (m_canvas.isNull())
+    {
+        painter.fillRect(rect(), QColor(backgroundColor));
+    }
+    else
+    {
+        //The oldest column is the write column, paint the ring starting from there.
+        int width = m_canvas.width();
+        int height = m_canvas.height();
+        painter.drawImage(QPoint(0, 0), m_canvas, QRect(m_writeColumn, 0, width - m_writeColumn, height));
+        painter.drawImage(QPoint(width - m_writeColumn, 0), m_canvas, QRect(0, 0, m_writeColumn, height));
+    }
+
+    int textY = painter.fontMetrics().ascent() + 2;
+    for (const auto& channel : qAsConst(m_channels))
+    {
+        painter.setPen(QColor(channel.color));
+        painter.drawText(4, textY, channel.plotRegister->name());
+        textY += painter.fontMetrics().height();
+    }
+
+    updateStatistics(m_renderTime + paintTimer.nsecsElapsed() / 1e6);
+    m_renderTime = 0.0;
+}
+
+void PlotWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_redrawNeeded = true;
+}
+
+void PlotWidget::renderFrame()
+{
+    if (!isVisible() || m_channels.isEmpty() || width() <= 0 || height() <= 0)
+    {
+        return;
+    }
+
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
+    qint64 newest = newestTime();
+    if (m_redrawNeeded || m_canvas.size() != size())
+    {
+        redraw(newest);
+    }
+    else
+    {
+        qint64 newColumns = (newest - m_rightEdgeTime) / m_ticksPerColumn;
+        if (newColumns >= m_canvas.width())
+        {
+            redraw(newest);
+        }
+        else if (newColumns > 0)
+        {
+            drawColumns(static_cast<int>(newColumns));
+        }
+        else
+        {
+            //Nothing new to show
+            return;
+        }
+    }
+
+    m_renderTime += renderTimer.nsecsElapsed() / 1e6;
+    update();
+}
+
+void PlotWidget::redraw(qint64 newestTime)
+{
+    m_redrawNeeded = false;
+    if (m_canvas.size() != size())
+    {
+        m_canvas = QImage(size(), QImage::Format_RGB32);
+    }
+
+    //Time stamps are in time stamp units of the Cpu, which are in us.
+    uint timeStampUnits = m_channels.first().plotRegister->timeStampUnits();
+    double ticksPerSecond = 1e6 / (timeStampUnits > 0 ? timeStampUnits : 1);
+    m_ticksPerColumn = qMax<qint64>(1, static_cast<qint64>(m_timeSpan * ticksPerSecond / m_canvas.width()));
+
+    for (auto& channel : m_channels)
+    {
+        channel.lastY = -1;
+    }
+    m_writeColumn = 0;
+    m_rightEdgeTime = newestTime - newestTime % m_ticksPerColumn - m_canvas.width() * m_ticksPerColumn;
+    drawColumns(m_canvas.width());
+}
+
+void PlotWidget::drawColumns(int columnCount)
+{
+    for (int i = 0; i < columnCount; i++)
+    {
+        drawColumn(m_writeColumn, m_rightEdgeTime, m_rightEdgeTime + m_ticksPerColumn);
+        m_rightEdgeTime += m_ticksPerColumn;
+        m_writeColumn = (m_writeColumn + 1) % m_canvas.width();
+    }
+}
+
+void PlotWidget::drawColumn(int column, qint64 from, qint64 to)
+{
+    uchar* bits = m_canvas.bits();
+    int bytesPerLine = m_canvas.bytesPerLine();
+    int height = m_canvas.height();
+
+    for (int y = 0; y < height; y++)
+    {
+        reinterpret_cast<QRgb*>(bits + y * bytesPerLine)[column] = backgroundColor;
+    }
+
+    for (auto& channel : m_channels)
+    {
+        double minimum;
+        double maximum;
+        if (!channel.plotRegister->history().minMax(from, to, minimum, maximum))
+        {
+            continue;
+        }
+        updateRange(channel, minimum, maximum);
+        if (channel.plotRegister->history().hasGap(from, to))
+        {
+            //Samples were missed, do not draw a line across the outage
+            channel.lastY = -1;
+        }
+
+        //Connect to the previous column so steps are drawn as a line
+        int top = toY(channel, maximum);
+        int bottom = toY(channel, minimum);
+        if (channel.lastY >= 0)
+        {
+            top = qMin(top, channel.lastY);
+            bottom = qMax(bottom, channel.lastY);
+        }
+        for (int y = top; y <= bottom; y++)
+        {
+            reinterpret_cast<QRgb*>(bits + y * bytesPerLine)[column] = channel.color;
+        }
+
+        double lastValue;
+        channel.lastY = channel.plotRegister->history().valueBefore(to, lastValue) ? toY(channel, lastValue) : -1;
+    }
+}
+
+int PlotWidget::toY(const Channel &channel, double value) const
+{
+    int height = m_canvas.height();
+    double relative = (value - channel.minimum) / (channel.maximum - channel.minimum);
+    return qBound(0, static_cast<int>((1.0 - relative) * (height - 1)), height - 1);
+}
+
+void PlotWidget::updateRange(PlotWidget::Channel &channel, double minimum, double maximum)
+{
+    if (channel.rangeValid && minimum >= channel.minimum && maximum <= channel.maximum)
+    {
+        return;
+    }
+
+    //Grow the range with a margin so this does not happen for every new extreme
+    if (channel.rangeValid)
+    {
+        minimum = qMin(minimum, channel.minimum);
+        maximum = qMax(maximum, channel.maximum);
+        m_redrawNeeded = true;
+    }
+    double margin = (maximum - minimum) * 0.1;
+    if (margin <= 0.0)
+    {
+        margin = 1.0;
+    }
+    channel.minimum = minimum - margin;
+    channel.maximum = maximum + margin;
+    channel.rangeValid = true;
+}
+
+qint64 PlotWidget::newestTime() const
+{
+    qint64 newest = 0;
+    for (const auto& channel : m_channels)
+    {
+        newest = qMax(newest, channel.plotRegister->history().lastTime());
+    }
+    return newest;
+}
+
+void PlotWidget::updateStatistics(double frameTime)
+{
+    m_frames++;
+    m_totalFrameTime += frameTime;
+    m_maximumFrameTime = qMax(m_maximumFrameTime, frameTime);
+
+    if (m_statisticsTimer.elapsed() >= 1000)
+    {
+        emit frameStatistics(m_frames, m_totalFrameTime / m_frames, m_maximumFrameTime);
+        m_frames = 0;
+        m_totalFrameTime = 0.0;
+        m_maximumFrameTime = 0.0;
+        m_statisticsTimer.restart();
+    }
+}
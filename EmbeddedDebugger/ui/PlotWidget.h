@@ -0,0 +1,110 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLOTWIDGET_H
+#define PLOTWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QPointer>
+class Register;
+
+/**
+ * @brief Software rendered scrolling plot of the history of Registers.
+ *
+ * The plot is rendered into a canvas that is used as a ring of pixel columns.
+ * Every frame only the columns for newly arrived samples are drawn, the canvas is
+ * never scrolled in memory but painted in two parts starting at the oldest column.
+ * Each column shows the min/max of the samples in its time range.
+ */
+class PlotWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PlotWidget(QWidget *parent = nullptr);
+    ~PlotWidget() override;
+
+    /**
+     * @brief Set the Registers that are plotted, their history is kept while they are plotted
+     * @param registers to plot, the widget does not take ownership.
+     */
+    void setRegisters(const QVector<Register*>& registers);
+
+    /**
+     * @brief Set the time that is visible in the plot
+     * @param seconds visible from the left to the right side of the plot.
+     */
+    void setTimeSpan(double seconds);
+    double timeSpan() const {return m_timeSpan;}
+
+signals:
+    /**
+     * @brief Emitted every second with the render statistics of the last second.
+     * @param framesPerSecond number of frames that were painted.
+     * @param averageFrameTime average time in ms spent on drawing new columns and painting a frame.
+     * @param maximumFrameTime maximum time in ms spent on a single frame.
+     */
+    void frameStatistics(int framesPerSecond, double averageFrameTime, double maximumFrameTime);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+    void renderFrame();
+
+private:
+    struct Channel
+    {
+        Register* plotRegister;
+        QRgb color;
+        double minimum;
+        double maximum;
+        bool rangeValid;
+        int lastY;
+    };
+
+    void redraw(qint64 newestTime);
+    void drawColumns(int columnCount);
+    void drawColumn(int column, qint64 from, qint64 to);
+    int toY(const Channel& channel, double value) const;
+    void updateRange(Channel& channel, double minimum, double maximum);
+    qint64 newestTime() const;
+    void updateStatistics(double frameTime);
+
+private:
+    QVector<Channel> m_channels;
+    QVector<QPointer<Register>> m_historyRegisters;    /**< Registers whose history this widget subscribed to */
+    QImage m_canvas;
+    QTimer m_frameTimer;
+    QElapsedTimer m_statisticsTimer;
+    double m_timeSpan = 10.0;
+    qint64 m_ticksPerColumn = 1;
+    qint64 m_rightEdgeTime = 0;     /**< End time of the newest column that is drawn */
+    int m_writeColumn = 0;          /**< Canvas column that is drawn next, also the oldest column */
+    bool m_redrawNeeded = true;
+    double m_renderTime = 0.0;      /**< Time in ms spent drawing columns for the next paint */
+    int m_frames = 0;
+    double m_totalFrameTime = 0.0;
+    double m_maximumFrameTime = 0.0;
+};
+
+#endif // PLOTWIDGET_H
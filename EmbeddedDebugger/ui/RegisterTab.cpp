@@ -21,7 +21,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Core.h"
 #include "ProfileManager/ProfileManager.h"
 #include "ProfileManager/ProfileListModel.h"
+#include "Medium/Register/RegisterListModel.h"
 #include <QDebug>
+#include <QEvent>
+#include <QMenu>
+#include <QScrollBar>
+
+static const int subscriptionDelay = 50;
 
 
 RegisterTab::RegisterTab(QWidget *parent) :
@@ -36,6 +42,13 @@ RegisterTab::RegisterTab(QWidget *parent) :
     channelModes.append("Once");
     m_channelModeDelegate.addItems(channelModes);
     ui->setupUi(this);
+
+    m_subscriptionTimer.setSingleShot(true);
+    connect(&m_subscriptionTimer, &QTimer::timeout, this, &RegisterTab::updateSubscriptions);
+    connect(ui->registerTableView->verticalScrollBar(), &QScrollBar::valueChanged, this, [&](){m_subscriptionTimer.start(subscriptionDelay);});
+    ui->registerTableView->viewport()->installEventFilter(this);
+    ui->registerTableView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->registerTableView, &QWidget::customContextMenuRequested, this, &RegisterTab::showContextMenu);
 }
 
 RegisterTab::~RegisterTab()
@@ -50,13 +63,121 @@ void RegisterTab::init()
     ui->registerTableView->setModel(Core::Instance().profileManager().registerListModel());
     ui->registerTableView->setItemDelegateForColumn(4,&m_channelModeDelegate);
     ui->registerTableView->setItemDelegateForColumn(5,&m_refreshButtonDelegate);
-      connect(ui->registerTableView->model(), &QAbstractItemModel::rowsInserted, this, [&](){
-          //qDebug() << ui->registerTableView->indexAt(ui->registerTableView->viewport()->rect().topLeft());
-          //qDebug() << ui->registerTableView->indexAt(ui->registerTableView->viewport()->rect().bottomLeft());
-          for (int i=0; i< ui->registerTableView->model()->rowCount(); i++) {
-              ui->registerTableView->openPersistentEditor(ui->registerTableView->model()->index(i, 4));
-              ui->registerTableView->openPersistentEditor(ui->registerTableView->model()->index(i, 5));
-          }
-
-      });
+    QAbstractItemModel* registerModel = ui->registerTableView->model();
+    if (registerModel != nullptr)
+    {
+        connect(registerModel, &QAbstractItemModel::rowsInserted, this, [&](){m_subscriptionTimer.start(subscriptionDelay);});
+        connect(registerModel, &QAbstractItemModel::rowsRemoved, this, [&](){m_subscriptionTimer.start(subscriptionDelay);});
+        connect(registerModel, &QAbstractItemModel::modelReset, this, [&](){m_subscriptionTimer.start(subscriptionDelay);});
+    }
+}
+
+bool RegisterTab::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->registerTableView->viewport() && event->type() == QEvent::Resize)
+    {
+        m_subscriptionTimer.start(subscriptionDelay);
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void RegisterTab::updateSubscriptions()
+{
+    QAbstractItemModel* registerModel = ui->registerTableView->model();
+    if (registerModel == nullptr)
+    {
+        return;
+    }
+
+    //Half a page above and below the visible rows is subscribed too, so slow scrolling
+    //does not subscribe and unsubscribe at the edges all the time
+    int rowCount = registerModel->rowCount();
+    int firstRow = ui->registerTableView->rowAt(0);
+    int lastRow = ui->registerTableView->rowAt(ui->registerTableView->viewport()->height() - 1);
+    if (firstRow < 0)
+    {
+        firstRow = 0;
+    }
+    if (lastRow < 0)
+    {
+        lastRow = rowCount - 1;
+    }
+    int margin = (lastRow - firstRow + 1) / 2;
+    firstRow = qMax(0, firstRow - margin);
+    lastRow = qMin(rowCount - 1, lastRow + margin);
+
+    QSet<QPersistentModelIndex> wantedRows;
+    for (int row = firstRow; row <= lastRow; row++)
+    {
+        wantedRows.insert(QPersistentModelIndex(registerModel->index(row, 0)));
+    }
+    for (const auto& pinnedRow : qAsConst(m_pinnedRows))
+    {
+        if (pinnedRow.isValid())
+        {
+            wantedRows.insert(pinnedRow);
+        }
+    }
+
+    for (const auto& subscribedRow : qAsConst(m_subscribedRows))
+    {
+        //Rows that were removed have an invalid index, their Register is gone
+        if (subscribedRow.isValid() && !wantedRows.contains(subscribedRow))
+        {
+            registerModel->setData(subscribedRow, false, RegisterListModel::SubscriptionRole);
+            ui->registerTableView->closePersistentEditor(subscribedRow.sibling(subscribedRow.row(), 4));
+            ui->registerTableView->closePersistentEditor(subscribedRow.sibling(subscribedRow.row(), 5));
+        }
+    }
+    for (const auto& wantedRow : qAsConst(wantedRows))
+    {
+        if (!m_subscribedRows.contains(wantedRow))
+        {
+            registerModel->setData(wantedRow, true, RegisterListModel::SubscriptionRole);
+            //Editors are only created for the rows around the view, not for every Register
+            ui->registerTableView->openPersistentEditor(wantedRow.sibling(wantedRow.row(), 4));
+            ui->registerTableView->openPersistentEditor(wantedRow.sibling(wantedRow.row(), 5));
+        }
+    }
+    m_subscribedRows = wantedRows;
+
+    QSet<QPersistentModelIndex> pinnedRows;
+    for (const auto& pinnedRow : qAsConst(m_pinnedRows))
+    {
+        if (pinnedRow.isValid())
+        {
+            pinnedRows.insert(pinnedRow);
+        }
+    }
+    m_pinnedRows = pinnedRows;
+}
+
+void RegisterTab::showContextMenu(const QPoint &position)
+{
+    QModelIndex index = ui->registerTableView->indexAt(position);
+    if (!index.isValid())
+    {
+        return;
+    }
+
+    QPersistentModelIndex row(index.sibling(index.row(), 0));
+    QMenu* menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+    if (m_pinnedRows.contains(row))
+    {
+        menu->addAction(tr("Unpin register"), this, [this, row]()
+        {
+            m_pinnedRows.remove(row);
+            updateSubscriptions();
+        });
+    }
+    else
+    {
+        menu->addAction(tr("Pin register (keep updating when not visible)"), this, [this, row]()
+        {
+            m_pinnedRows.insert(row);
+            updateSubscriptions();
+        });
+    }
+    menu->popup(ui->registerTableView->viewport()->mapToGlobal(position));
 }
@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define REGISTERTAB_H
 
 #include <QWidget>
+#include <QSet>
+#include <QTimer>
+#include <QPersistentModelIndex>
 #include "ComboBoxDelegate.h"
 #include "PushButtonDelegate.h"
 
@@ -37,10 +40,24 @@ public:
 
     void init();
 
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    /**
+     * @brief Subscribe the Registers in and around the visible rows and the pinned Registers,
+     * unsubscribe the Registers that scrolled out of view.
+     */
+    void updateSubscriptions();
+    void showContextMenu(const QPoint& position);
+
 private:
     Ui::RegisterTab *ui;
     ComboBoxDelegate m_channelModeDelegate;
     PushButtonDelegate m_refreshButtonDelegate;
+    QTimer m_subscriptionTimer;                     /**< Combines the updates of a scroll or resize */
+    QSet<QPersistentModelIndex> m_subscribedRows;
+    QSet<QPersistentModelIndex> m_pinnedRows;
 };
 
 #endif // REGISTERTAB_H
@@ -0,0 +1,614 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HeadlessRecorder.h"
+#include "../Connectors/BaseInterface/TransportLayerBase.h"
+#include "../Connectors/BaseInterface/CommandQueue.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextStream>
+#include <csignal>
+
+static volatile std::sig_atomic_t shutdownRequested = 0;
+
+HeadlessRecorder::HeadlessRecorder(QObject *parent) :
+    QObject(parent)
+{
+    connect(&m_statusTimer, &QTimer::timeout, this, &HeadlessRecorder::printStatus);
+    connect(&m_shutdownTimer, &QTimer::timeout, this, &HeadlessRecorder::checkShutdown);
+}
+
+void HeadlessRecorder::connectMedium()
+{
+    connect(&m_medium->cpuListModel(), &CpuListModel::rowsInserted, this, &HeadlessRecorder::cpusInserted);
+    connect(m_medium, &Medium::errorOccured, this, [&](const QString& error)
+    {
+        QTextStream(stderr) << "Connection error: " << error << endl;
+        //Only an established connection is retried, a target that is never reached is an error
+        if (!m_reconnect || (!m_medium->isConnected() && !m_medium->reconnectScheduler().isOutage()))
+        {
+            shutdown(1);
+        }
+    });
+    connect(&m_medium->reconnectScheduler(), &ReconnectScheduler::outageStarted, this, [](const QDateTime& startTime)
+    {
+        QTextStream(stderr) << "Connection lost at " << startTime.toString(Qt::ISODateWithMs) << ", reconnecting" << endl;
+    });
+    connect(&m_medium->reconnectScheduler(), &ReconnectScheduler::outageEnded, &m_recorder, &DataRecorder::recordGap);
+}
+
+bool HeadlessRecorder::configure(const QCommandLineParser &parser, QString &errorMessage)
+{
+    if (parser.isSet("config") && !readConfigurationFile(parser.value("config"), errorMessage))
+    {
+        return false;
+    }
+
+    if (parser.isSet("transport"))
+    {
+        m_transport = parser.value("transport");
+    }
+    if (parser.isSet("host"))
+    {
+        m_hostName = parser.value("host");
+    }
+    if (parser.isSet("port"))
+    {
+        m_port = static_cast<quint16>(parser.value("port").toUInt());
+    }
+    if (parser.isSet("device"))
+    {
+        m_device = parser.value("device");
+    }
+    if (parser.isSet("baud"))
+    {
+        m_baudRate = parser.value("baud").toInt();
+    }
+    if (parser.isSet("cpus"))
+    {
+        m_simulatedCpus = parser.value("cpus").toInt();
+    }
+    if (parser.isSet("rate"))
+    {
+        m_sampleRate = parser.value("rate").toInt();
+    }
+    if (parser.isSet("latency"))
+    {
+        m_latency = parser.value("latency").toInt();
+    }
+    if (parser.isSet("bandwidth"))
+    {
+        m_bandwidth = parser.value("bandwidth").toDouble();
+    }
+    if (parser.isSet("loss"))
+    {
+        m_loss = parser.value("loss").toDouble();
+    }
+    if (parser.isSet("decimation"))
+    {
+        m_decimation = parser.value("decimation").toInt();
+    }
+    if (parser.isSet("decode-workers"))
+    {
+        m_decodeWorkers = parser.value("decode-workers").toInt();
+    }
+    if (parser.isSet("link-budget"))
+    {
+        m_linkBudget = parser.value("link-budget").toDouble();
+    }
+    if (parser.isSet("write-interval"))
+    {
+        m_writeInterval = parser.value("write-interval").toInt();
+    }
+    if (parser.isSet("cpu-byte-limit"))
+    {
+        m_cpuByteLimit = parser.value("cpu-byte-limit").toDouble();
+    }
+    if (parser.isSet("cpu-frame-limit"))
+    {
+        m_cpuFrameLimit = parser.value("cpu-frame-limit").toDouble();
+    }
+    if (parser.isSet("output"))
+    {
+        m_outputFile = parser.value("output");
+    }
+    if (parser.isSet("no-reconnect"))
+    {
+        m_reconnect = false;
+    }
+    for (const auto& channelArgument : parser.values("channel"))
+    {
+        if (!addChannel(channelArgument, errorMessage))
+        {
+            return false;
+        }
+    }
+    if (parser.isSet("trigger") && !setTrigger(parser.value("trigger"), errorMessage))
+    {
+        return false;
+    }
+    if (parser.isSet("trigger-mode") && !triggerModeFromString(parser.value("trigger-mode"), m_trigger.mode))
+    {
+        errorMessage = "Invalid trigger mode " + parser.value("trigger-mode");
+        return false;
+    }
+    if (parser.isSet("pre-trigger"))
+    {
+        m_trigger.preTriggerSamples = parser.value("pre-trigger").toInt();
+    }
+    if (parser.isSet("post-trigger"))
+    {
+        m_trigger.postTriggerSamples = parser.value("post-trigger").toInt();
+    }
+    if (parser.isSet("capture-dir"))
+    {
+        m_captureDirectory = parser.value("capture-dir");
+    }
+
+    if (m_transport == "udp")
+    {
+        m_medium = &m_udp;
+    }
+    else if (m_transport == "serial")
+    {
+        m_medium = &m_serial;
+    }
+    else if (m_transport == "loopback")
+    {
+        m_medium = &m_loopback;
+    }
+    else if (m_transport != "tcp")
+    {
+        errorMessage = "Unknown transport " + m_transport;
+        return false;
+    }
+    if (m_medium == &m_serial)
+    {
+        if (m_device.isEmpty() || m_baudRate <= 0)
+        {
+            errorMessage = "A serial device and baud rate are required";
+            return false;
+        }
+    }
+    else if (m_medium != &m_loopback && (m_hostName.isEmpty() || m_port == 0))
+    {
+        errorMessage = "A host and port are required";
+        return false;
+    }
+    if (m_channels.isEmpty())
+    {
+        errorMessage = "No channels to record";
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessRecorder::start()
+{
+    if (!m_recorder.start(m_outputFile))
+    {
+        return false;
+    }
+
+    connectMedium();
+    std::signal(SIGINT, [](int){requestShutdown();});
+    std::signal(SIGTERM, [](int){requestShutdown();});
+    m_shutdownTimer.start(100);
+
+    if (m_linkBudget > 0.0)
+    {
+        m_medium->bandwidthEstimator().setLinkBudget(m_linkBudget * 1024.0);
+        m_medium->bandwidthEstimator().setAutoDecimation(true);
+    }
+
+    m_medium->reconnectScheduler().setEnabled(m_reconnect);
+    if (m_decodeWorkers >= 0)
+    {
+        m_medium->setDecodeWorkers(m_decodeWorkers);
+    }
+    if (m_writeInterval >= 0)
+    {
+        m_medium->writeCoalescer().setMinimumInterval(m_writeInterval);
+    }
+    m_medium->setCpuRateLimit(m_cpuByteLimit * 1024.0, m_cpuFrameLimit);
+    m_statusClock.start();
+    m_statusTimer.start(1000);
+    if (m_medium == &m_udp)
+    {
+        m_udp.connectToHost(m_hostName, m_port);
+    }
+    else if (m_medium == &m_serial)
+    {
+        m_serial.openPort(m_device, m_baudRate);
+    }
+    else if (m_medium == &m_loopback)
+    {
+        m_loopback.setLink(m_latency, m_bandwidth * 1024.0, m_loss / 100.0);
+        m_loopback.open(m_simulatedCpus, m_sampleRate);
+    }
+    else
+    {
+        m_tcp.connectToHost(m_hostName, m_port);
+    }
+    return true;
+}
+
+void HeadlessRecorder::requestShutdown()
+{
+    shutdownRequested = 1;
+}
+
+void HeadlessRecorder::cpusInserted(const QModelIndex &parent, int first, int last)
+{
+    for (int row = first; row <= last; row++)
+    {
+        auto cpuId = static_cast<uint8_t>(m_medium->cpuListModel().index(row, 0, parent).data().toUInt());
+        Cpu* cpu = m_medium->cpuListModel().getCpuNodeById(cpuId);
+        if (cpu == nullptr)
+        {
+            continue;
+        }
+
+        QTextStream(stdout) << "Found cpu " << static_cast<int>(cpu->id()) << ": " << cpu->name() << " " << cpu->applicationVersion() << endl;
+        m_recorder.addCpu(cpu);
+
+        //Channels are configured once the register sizes are known, and again for every batch of
+        //registers that is loaded after that
+        connect(cpu, &Cpu::infoReceived, this, [this, cpu](){configureCpu(cpu);});
+        connect(cpu, &Cpu::newRegistersFound, this, [this, cpu]()
+        {
+            if (cpu->hasInfo())
+            {
+                configureCpu(cpu);
+            }
+        });
+        connect(cpu, &Cpu::configurationLoaded, this, [this, cpu](){configureCpu(cpu);});
+        if (cpu->hasInfo())
+        {
+            configureCpu(cpu);
+        }
+    }
+}
+
+void HeadlessRecorder::configureCpu(Cpu *cpu)
+{
+    if (m_linkBudget <= 0.0 && m_decimation > 0 && cpu->decimation() != m_decimation)
+    {
+        cpu->setDecimation(m_decimation);
+    }
+
+    //All channels of the Cpu are configured in one burst
+    cpu->channelMultiplexer().beginTransaction();
+    for (const auto& channel : qAsConst(m_channels))
+    {
+        if (channel.cpuId != cpu->id())
+        {
+            continue;
+        }
+
+        Register* channelRegister = nullptr;
+        for (auto reg : m_medium->registerListModel())
+        {
+            if (&reg->cpu() == cpu && reg->name() == channel.registerName)
+            {
+                channelRegister = reg;
+                break;
+            }
+        }
+
+        if (channelRegister == nullptr)
+        {
+            if (!cpu->isConfigurationLoaded())
+            {
+                //The register may be in a batch that is not loaded yet
+                continue;
+            }
+            QTextStream(stderr) << "Register " << channel.registerName << " not found on cpu " << static_cast<int>(cpu->id()) << endl;
+        }
+        else if (channelRegister->channelMode() != channel.channelMode)
+        {
+            channelRegister->configDebugChannel(channel.channelMode);
+        }
+    }
+
+    if (m_trigger.enabled && m_trigger.cpuId == cpu->id() && cpu->triggerEngine().triggerRegister() == nullptr)
+    {
+        for (auto reg : m_medium->registerListModel())
+        {
+            if (&reg->cpu() == cpu && reg->name() == m_trigger.registerName)
+            {
+                armTrigger(cpu, reg);
+                break;
+            }
+        }
+    }
+    cpu->channelMultiplexer().commitTransaction();
+}
+
+void HeadlessRecorder::armTrigger(Cpu *cpu, Register *triggerRegister)
+{
+    //The trigger only sees samples of a Register that is streamed
+    if (triggerRegister->channelMode() == Register::ChannelMode::Off)
+    {
+        triggerRegister->configDebugChannel(Register::ChannelMode::OnChange);
+    }
+
+    TriggerEngine& triggerEngine = cpu->triggerEngine();
+    triggerEngine.setCondition(triggerRegister, m_trigger.condition, m_trigger.threshold);
+    triggerEngine.setMode(m_trigger.mode);
+    triggerEngine.setWindow(m_trigger.preTriggerSamples, m_trigger.postTriggerSamples);
+    connect(&triggerEngine, &TriggerEngine::captured, this, [this, cpu](const TriggerCapture& capture)
+    {
+        writeCapture(cpu, capture);
+    });
+    triggerEngine.arm();
+    QTextStream(stdout) << "Trigger armed on " << triggerRegister->name() << " of cpu " << static_cast<int>(cpu->id()) << endl;
+}
+
+void HeadlessRecorder::writeCapture(const Cpu *cpu, const TriggerCapture &capture)
+{
+    QDir().mkpath(m_captureDirectory);
+    QString fileName = QString("%1/capture-cpu%2-%3.csv").arg(m_captureDirectory).arg(cpu->id()).arg(++m_captures, 4, 10, QChar('0'));
+    QFile captureFile(fileName);
+    if (!captureFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QTextStream(stderr) << "Could not write capture " << fileName << endl;
+        return;
+    }
+
+    QTextStream stream(&captureFile);
+    stream << "# trigger time " << capture.triggerTime << (capture.forced ? ", forced" : "") << "\n";
+    stream << "register,time,value\n";
+    for (int channel = 0; channel < capture.registers.size(); channel++)
+    {
+        QString name = capture.registers.at(channel)->name();
+        for (int i = 0; i < capture.times.at(channel).size(); i++)
+        {
+            stream << name << "," << capture.times.at(channel).at(i) << "," << capture.values.at(channel).at(i) << "\n";
+        }
+    }
+    QTextStream(stdout) << "Trigger captured to " << fileName << endl;
+}
+
+void HeadlessRecorder::printStatus()
+{
+    double seconds = m_statusClock.restart() / 1000.0;
+    quint64 receivedBytes = 0;
+    quint64 invalidFrames = 0;
+    quint64 retransmittedFrames = 0;
+    if (m_medium->transportLayer() != nullptr)
+    {
+        receivedBytes = m_medium->transportLayer()->receivedBytes();
+        invalidFrames = m_medium->transportLayer()->invalidFrames();
+        retransmittedFrames = m_medium->transportLayer()->retransmittedFrames();
+    }
+    qint64 backpressureTime = m_medium->commandQueue() != nullptr ? m_medium->commandQueue()->backpressureTime() : 0;
+
+    int invalidMessages = 0;
+    for (int row = 0; row < m_medium->cpuListModel().rowCount(QModelIndex()); row++)
+    {
+        auto cpuId = static_cast<uint8_t>(m_medium->cpuListModel().index(row, 0).data().toUInt());
+        Cpu* cpu = m_medium->cpuListModel().getCpuNodeById(cpuId);
+        if (cpu != nullptr)
+        {
+            invalidMessages += cpu->invalidMessageCounter();
+        }
+    }
+
+    QString status = QString("rx %1 kB/s, recorded %2 frames/s (%3 total, %4 MB), crc errors %5, invalid %6, dropped %7, retransmitted %8, backpressure %9 ms, reconnects %10, downtime %11 s")
+                           .arg((receivedBytes - m_lastReceivedBytes) / 1024.0 / seconds, 0, 'f', 1)
+                           .arg((m_recorder.recordedFrames() - m_lastRecordedFrames) / seconds, 0, 'f', 0)
+                           .arg(m_recorder.recordedFrames())
+                           .arg(m_recorder.recordedBytes() / 1048576.0, 0, 'f', 1)
+                           .arg(invalidFrames)
+                           .arg(invalidMessages)
+                           .arg(m_recorder.droppedFrames())
+                           .arg(retransmittedFrames)
+                           .arg(backpressureTime)
+                           .arg(m_medium->reconnectScheduler().reconnectCount())
+                           .arg(m_medium->reconnectScheduler().downtime() / 1000.0, 0, 'f', 1);
+    if (m_medium == &m_udp)
+    {
+        status += QString(", datagram loss %1 %, reordered %2").arg(m_udp.lossRate() * 100.0, 0, 'f', 2).arg(m_udp.reorderedFrames());
+    }
+    else if (m_medium == &m_loopback)
+    {
+        status += QString(", link lost %1 up, %2 down").arg(m_loopback.uplink().lostFrames()).arg(m_loopback.downlink().lostFrames());
+    }
+    else if (m_medium == &m_serial && m_serial.readBlocks() > 0)
+    {
+        status += QString(", read blocks %1, average %2 B").arg(m_serial.readBlocks()).arg(m_serial.readBytes() / m_serial.readBlocks());
+    }
+    if (m_cpuByteLimit > 0.0 || m_cpuFrameLimit > 0.0)
+    {
+        status += QString(", throttled %1 ms").arg(m_medium->throttledTime());
+    }
+    if (m_medium->writeCoalescer().elidedWrites() > 0)
+    {
+        status += QString(", elided writes %1").arg(m_medium->writeCoalescer().elidedWrites());
+    }
+    if (m_trigger.enabled)
+    {
+        status += QString(", captures %1").arg(m_captures);
+    }
+    QTextStream(stdout) << status << endl;
+    m_lastReceivedBytes = receivedBytes;
+    m_lastRecordedFrames = m_recorder.recordedFrames();
+}
+
+void HeadlessRecorder::checkShutdown()
+{
+    if (shutdownRequested != 0)
+    {
+        shutdown(0);
+    }
+}
+
+bool HeadlessRecorder::readConfigurationFile(const QString &fileName, QString &errorMessage)
+{
+    QFile configurationFile(fileName);
+    if (!configurationFile.open(QIODevice::ReadOnly))
+    {
+        errorMessage = "Could not open configuration file " + fileName;
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonObject configuration = QJsonDocument::fromJson(configurationFile.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        errorMessage = "Invalid configuration file: " + parseError.errorString();
+        return false;
+    }
+
+    m_hostName = configuration["host"].toString(m_hostName);
+    m_port = static_cast<quint16>(configuration["port"].toInt(m_port));
+    m_device = configuration["device"].toString(m_device);
+    m_baudRate = configuration["baud"].toInt(m_baudRate);
+    m_simulatedCpus = configuration["cpus"].toInt(m_simulatedCpus);
+    m_sampleRate = configuration["rate"].toInt(m_sampleRate);
+    m_latency = configuration["latency"].toInt(m_latency);
+    m_bandwidth = configuration["bandwidth"].toDouble(m_bandwidth);
+    m_loss = configuration["loss"].toDouble(m_loss);
+    m_decimation = configuration["decimation"].toInt(m_decimation);
+    m_decodeWorkers = configuration["decodeWorkers"].toInt(m_decodeWorkers);
+    m_linkBudget = configuration["linkBudget"].toDouble(m_linkBudget);
+    m_writeInterval = configuration["writeInterval"].toInt(m_writeInterval);
+    m_cpuByteLimit = configuration["cpuByteLimit"].toDouble(m_cpuByteLimit);
+    m_cpuFrameLimit = configuration["cpuFrameLimit"].toDouble(m_cpuFrameLimit);
+    m_outputFile = configuration["output"].toString(m_outputFile);
+    m_transport = configuration["transport"].toString(m_transport);
+    m_reconnect = configuration["reconnect"].toBool(m_reconnect);
+    m_captureDirectory = configuration["captureDirectory"].toString(m_captureDirectory);
+    if (configuration.contains("trigger"))
+    {
+        QJsonObject triggerObject = configuration["trigger"].toObject();
+        m_trigger.enabled = true;
+        m_trigger.cpuId = static_cast<uint8_t>(triggerObject["cpu"].toInt());
+        m_trigger.registerName = triggerObject["register"].toString();
+        m_trigger.threshold = triggerObject["threshold"].toDouble();
+        m_trigger.preTriggerSamples = triggerObject["preTrigger"].toInt(m_trigger.preTriggerSamples);
+        m_trigger.postTriggerSamples = triggerObject["postTrigger"].toInt(m_trigger.postTriggerSamples);
+        if (!triggerConditionFromString(triggerObject["condition"].toString("rising"), m_trigger.condition) ||
+            !triggerModeFromString(triggerObject["mode"].toString("single"), m_trigger.mode))
+        {
+            errorMessage = "Invalid trigger condition or mode";
+            return false;
+        }
+    }
+    for (auto channelRef : configuration["channels"].toArray())
+    {
+        QJsonObject channelObject = channelRef.toObject();
+        ChannelConfiguration channel;
+        channel.cpuId = static_cast<uint8_t>(channelObject["cpu"].toInt());
+        channel.registerName = channelObject["register"].toString();
+        if (!channelModeFromString(channelObject["mode"].toString("OnChange"), channel.channelMode))
+        {
+            errorMessage = "Invalid channel mode for register " + channel.registerName;
+            return false;
+        }
+        m_channels.append(channel);
+    }
+    return true;
+}
+
+bool HeadlessRecorder::addChannel(const QString &channelArgument, QString &errorMessage)
+{
+    //<cpu id>:<register name>[:<channel mode>]
+    QStringList parts = channelArgument.split(':');
+    bool idValid = false;
+    ChannelConfiguration channel;
+    channel.channelMode = Register::ChannelMode::OnChange;
+    if (parts.size() >= 2)
+    {
+        channel.cpuId = static_cast<uint8_t>(parts.at(0).toUInt(&idValid));
+        channel.registerName = parts.at(1);
+    }
+    if (!idValid ||
+        parts.size() > 3 ||
+        (parts.size() == 3 && !channelModeFromString(parts.at(2), channel.channelMode)))
+    {
+        errorMessage = "Invalid channel: " + channelArgument;
+        return false;
+    }
+    m_channels.append(channel);
+    return true;
+}
+
+bool HeadlessRecorder::setTrigger(const QString &triggerArgument, QString &errorMessage)
+{
+    //<cpu id>:<register name>:<condition>:<threshold>
+    QStringList parts = triggerArgument.split(':');
+    bool idValid = false;
+    bool thresholdValid = false;
+    if (parts.size() == 4)
+    {
+        m_trigger.cpuId = static_cast<uint8_t>(parts.at(0).toUInt(&idValid));
+        m_trigger.registerName = parts.at(1);
+        m_trigger.threshold = parts.at(3).toDouble(&thresholdValid);
+    }
+    if (!idValid || !thresholdValid || !triggerConditionFromString(parts.at(2), m_trigger.condition))
+    {
+        errorMessage = "Invalid trigger: " + triggerArgument;
+        return false;
+    }
+    m_trigger.enabled = true;
+    return true;
+}
+
+bool HeadlessRecorder::triggerConditionFromString(const QString &conditionString, TriggerEngine::Condition &condition)
+{
+    if (conditionString == "rising"){ condition = TriggerEngine::Condition::RisingEdge; return true;}
+    if (conditionString == "falling"){ condition = TriggerEngine::Condition::FallingEdge; return true;}
+    if (conditionString == "above"){ condition = TriggerEngine::Condition::Above; return true;}
+    if (conditionString == "below"){ condition = TriggerEngine::Condition::Below; return true;}
+    return false;
+}
+
+bool HeadlessRecorder::triggerModeFromString(const QString &modeString, TriggerEngine::Mode &mode)
+{
+    if (modeString == "single"){ mode = TriggerEngine::Mode::Single; return true;}
+    if (modeString == "normal"){ mode = TriggerEngine::Mode::Normal; return true;}
+    if (modeString == "auto"){ mode = TriggerEngine::Mode::Auto; return true;}
+    return false;
+}
+
+bool HeadlessRecorder::channelModeFromString(const QString &modeString, Register::ChannelMode &channelMode)
+{
+    if (modeString == "Off"){ channelMode = Register::ChannelMode::Off; return true;}
+    if (modeString == "OnChange"){ channelMode = Register::ChannelMode::OnChange; return true;}
+    if (modeString == "LowSpeed"){ channelMode = Register::ChannelMode::LowSpeed; return true;}
+    if (modeString == "Once"){ channelMode = Register::ChannelMode::Once; return true;}
+    return false;
+}
+
+void HeadlessRecorder::shutdown(int exitCode)
+{
+    m_shutdownTimer.stop();
+    m_statusTimer.stop();
+    printStatus();
+    m_recorder.stop();
+    m_medium->disconnect();
+    QTextStream(stdout) << "Recorded " << m_recorder.recordedFrames() << " frames to " << m_outputFile << endl;
+    QCoreApplication::exit(exitCode);
+}
@@ -0,0 +1,132 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADLESSRECORDER_H
+#define HEADLESSRECORDER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include "../Connectors/TCP/TCP.h"
+#include "../Connectors/UDP/UdpMedium.h"
+#include "../Connectors/Serial/SerialMedium.h"
+#include "../Connectors/Loopback/LoopbackMedium.h"
+#include "Medium/Recorder/DataRecorder.h"
+#include "Medium/CPU/TriggerEngine.h"
+class QCommandLineParser;
+
+/**
+ * @brief Connects to a target without any widgets and records its debug channels to disk.
+ */
+class HeadlessRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HeadlessRecorder(QObject* parent = nullptr);
+
+    /**
+     * @brief Read the configuration from a JSON file and the command line, arguments override the file.
+     * @return false and an error message if the configuration is invalid.
+     */
+    bool configure(const QCommandLineParser& parser, QString& errorMessage);
+
+    /**
+     * @brief Open the recording and connect to the target.
+     */
+    bool start();
+
+    /**
+     * @brief Request a clean shutdown, safe to call from a signal handler.
+     */
+    static void requestShutdown();
+
+private slots:
+    void cpusInserted(const QModelIndex& parent, int first, int last);
+    void configureCpu(Cpu* cpu);
+    void printStatus();
+    void checkShutdown();
+
+private:
+    struct ChannelConfiguration
+    {
+        uint8_t cpuId;
+        QString registerName;
+        Register::ChannelMode channelMode;
+    };
+
+    struct TriggerConfiguration
+    {
+        bool enabled = false;
+        uint8_t cpuId = 0;
+        QString registerName;
+        TriggerEngine::Condition condition = TriggerEngine::Condition::RisingEdge;
+        double threshold = 0.0;
+        TriggerEngine::Mode mode = TriggerEngine::Mode::Single;
+        int preTriggerSamples = 1000;
+        int postTriggerSamples = 1000;
+    };
+
+    void connectMedium();
+    bool readConfigurationFile(const QString& fileName, QString& errorMessage);
+    bool addChannel(const QString& channelArgument, QString& errorMessage);
+    bool setTrigger(const QString& triggerArgument, QString& errorMessage);
+    void armTrigger(Cpu* cpu, Register* triggerRegister);
+    void writeCapture(const Cpu* cpu, const TriggerCapture& capture);
+    static bool triggerConditionFromString(const QString& conditionString, TriggerEngine::Condition& condition);
+    static bool triggerModeFromString(const QString& modeString, TriggerEngine::Mode& mode);
+    static bool channelModeFromString(const QString& modeString, Register::ChannelMode& channelMode);
+    void shutdown(int exitCode);
+
+private:
+    TCP m_tcp;
+    UdpMedium m_udp;
+    SerialMedium m_serial;
+    LoopbackMedium m_loopback;
+    ProtocolMedium* m_medium = &m_tcp;  /**< The medium of the selected transport */
+    DataRecorder m_recorder;
+    QTimer m_statusTimer;
+    QTimer m_shutdownTimer;
+    QElapsedTimer m_statusClock;
+    QVector<ChannelConfiguration> m_channels;
+    TriggerConfiguration m_trigger;
+    QString m_captureDirectory = "captures";
+    int m_captures = 0;
+    QString m_transport = "tcp";
+    QString m_hostName;
+    quint16 m_port = 0;
+    QString m_device;
+    qint32 m_baudRate = 115200;
+    int m_simulatedCpus = 1;            /**< Loopback only */
+    int m_sampleRate = 1000;
+    int m_latency = 0;                  /**< us */
+    double m_bandwidth = 0.0;           /**< kB/s, 0 for no limit */
+    double m_loss = 0.0;                /**< % of the frames */
+    int m_decimation = 0;
+    int m_decodeWorkers = -1;           /**< Threads decoding the channel data, 0 for the main thread, -1 for the default of the medium */
+    double m_linkBudget = 0.0;          /**< kB/s, 0 for a fixed decimation */
+    int m_writeInterval = -1;           /**< ms between two writes to a Register, -1 for the default of the medium */
+    double m_cpuByteLimit = 0.0;        /**< kB/s of the commands to each Cpu, 0 for no limit */
+    double m_cpuFrameLimit = 0.0;       /**< Commands/s to each Cpu, 0 for no limit */
+    QString m_outputFile = "recording.edr";
+    bool m_reconnect = true;
+    quint64 m_lastReceivedBytes = 0;
+    quint64 m_lastRecordedFrames = 0;
+};
+
+#endif // HEADLESSRECORDER_H
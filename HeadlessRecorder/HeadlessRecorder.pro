@@ -0,0 +1,45 @@
+#-------------------------------------------------
+#
+# Command line recorder without widgets
+#
+#-------------------------------------------------
+
+QT       += core network serialport
+QT       -= gui
+
+TARGET = DebuggerRecorder
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# The media are built without their settings dialogs, the settings come from the command line and
+# the configuration file. The protocol layers and models are linked once from ProtocolCore.
+DEFINES += EMBEDDEDDEBUGGER_NO_WIDGETS
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds
+win32:CONFIG(debug, debug|release): LIBS += -L../plugins -lProtocolCored
+else: LIBS += -L../plugins -lProtocolCore
+
+INCLUDEPATH += ../EmbeddedDebugger/
+
+SOURCES += \
+    main.cpp \
+    HeadlessRecorder.cpp \
+    ../Connectors/TCP/TCP.cpp \
+    ../Connectors/UDP/UdpMedium.cpp \
+    ../Connectors/Serial/SerialMedium.cpp \
+    ../Connectors/Loopback/LoopbackMedium.cpp \
+    ../Connectors/Loopback/LoopbackLink.cpp \
+    ../Tools/TargetSimulator/TargetSimulator.cpp
+
+HEADERS += \
+    HeadlessRecorder.h \
+    ../Connectors/TCP/TCP.h \
+    ../Connectors/UDP/UdpMedium.h \
+    ../Connectors/Serial/SerialMedium.h \
+    ../Connectors/Loopback/LoopbackMedium.h \
+    ../Connectors/Loopback/LoopbackLink.h \
+    ../Tools/TargetSimulator/TargetSimulator.h
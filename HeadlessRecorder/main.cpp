@@ -0,0 +1,77 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "HeadlessRecorder.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("DEMCON");
+    QCoreApplication::setOrganizationDomain("www.demcon.nl");
+    QCoreApplication::setApplicationName("Embedded Debugger Recorder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records the debug channels of an embedded target to disk.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"config", "JSON configuration file with transport, host, port, device, baud, cpus, rate, latency, bandwidth, loss, decimation, decodeWorkers, linkBudget, writeInterval, cpuByteLimit, cpuFrameLimit, output, reconnect, channels, trigger and captureDirectory.", "file"},
+        {"host", "Host name or IP address of the target.", "host"},
+        {"transport", "Medium to the target, tcp, udp, serial or loopback to an in-process simulator, default tcp.", "transport"},
+        {"port", "TCP or UDP port of the target.", "port"},
+        {"device", "Serial port of the target, for the serial transport.", "device"},
+        {"baud", "Baud rate of the serial port, default 115200.", "baud"},
+        {"cpus", "Number of simulated cpus for the loopback transport, default 1.", "count"},
+        {"rate", "Samples per second of the loopback simulator, default 1000.", "samples/s"},
+        {"latency", "Latency of the loopback link in us.", "us"},
+        {"bandwidth", "Bandwidth of the loopback link in kB/s, default unlimited.", "kB/s"},
+        {"loss", "Percentage of the frames the loopback link loses.", "percentage"},
+        {"decimation", "Decimation that is set on every cpu.", "decimation"},
+        {"decode-workers", "Number of threads that decode the channel data, sharded by cpu, 0 for the main thread, by default half of the cores up to 4.", "count"},
+        {"link-budget", "Link budget in kB/s, the decimation of every cpu is then tuned to fit it.", "kB/s"},
+        {"cpu-byte-limit", "Maximum kB/s of the commands sent to each cpu, for targets that drop frames they receive too fast.", "kB/s"},
+        {"cpu-frame-limit", "Maximum commands per second sent to each cpu.", "frames/s"},
+        {"write-interval", "Minimum time between two writes to the same register, only the latest value is written, default 50.", "ms"},
+        {"output", "Recording file.", "file"},
+        {"no-reconnect", "Stop when the connection is lost instead of reconnecting with backoff."},
+        {"channel", "Register to record, may be repeated. Mode is Off, OnChange, LowSpeed or Once.", "cpu:register[:mode]"},
+        {"trigger", "Capture a window around the moment a register meets a condition. Condition is rising, falling, above or below.", "cpu:register:condition:threshold"},
+        {"trigger-mode", "single captures once, normal re-arms after every capture, auto also captures when the trigger does not fire, default single.", "mode"},
+        {"pre-trigger", "Samples of the trigger register kept before the trigger, default 1000.", "samples"},
+        {"post-trigger", "Samples of the trigger register recorded after the trigger, default 1000.", "samples"},
+        {"capture-dir", "Directory the captures are written to as CSV, default captures.", "directory"},
+    });
+    parser.process(a);
+
+    HeadlessRecorder recorder;
+    QString errorMessage;
+    if (!recorder.configure(parser, errorMessage))
+    {
+        QTextStream(stderr) << errorMessage << endl;
+        parser.showHelp(1);
+    }
+    if (!recorder.start())
+    {
+        return 1;
+    }
+
+    return a.exec();
+}
@@ -54,6 +54,8 @@ public:
      * @brief addMedium to m_mediumList.
      * Adds cpuList from newMedium to m_combinedCpuList.
      * Adds registerList from newMedium to m_combinedRegisterList.
+     * Profiles are used by the user interface, which only polls and streams the Registers it shows,
+     * so the SubscriptionManager of newMedium is enabled.
      * @param newMedium to append. If nullptr medium will not be appended.
      */
     void addMedium(Medium* newMedium)
@@ -63,6 +65,7 @@ public:
             m_mediumList.append(newMedium);
             m_combinedCpuList.addSourceModel(&newMedium->cpuListModel());
             m_combinedRegisterList.addSourceModel(&newMedium->registerListModel());
+            newMedium->subscriptionManager().setEnabled(true);
         }
     }
 
@@ -0,0 +1,21 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+QT              += network widgets
+TARGET          = $$qtLibraryTarget(GenericLoopbackProfile)
+DESTDIR         = ../../plugins
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lLoopbackd -lProtocolCored
+else: LIBS += -L../../plugins -lLoopback -lProtocolCore
+
+
+HEADERS += \
+    GenericLoopbackProfile.h \
+    ../BaseProfile.h \
+    ../kconcatenaterowsproxymodel.h
+
+SOURCES += \
+    GenericLoopbackProfile.cpp \
+    ../kconcatenaterowsproxymodel.cpp
+
+INCLUDEPATH += ../../EmbeddedDebugger/
@@ -0,0 +1,41 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "GenericMultiTargetProfile.h"
+#include "../../Connectors/MultiTarget/MultiTargetMedium.h"
+
+/**
+ * @brief genericMultiTargetProfile constructor
+ * The targets, the threads and the sample file are read from the settings once. Without targets there is one medium that shows the settings on connect.
+ * @param parent of this QObject
+ */
+genericMultiTargetProfile::genericMultiTargetProfile(QObject *parent) :
+    BaseProfile(parent),
+    m_multiTargetMedium(new MultiTargetMedium(MultiTargetMedium::configuredIoThreads(), MultiTargetMedium::configuredDecodeWorkers(), this))
+{
+    if (m_multiTargetMedium->addConfiguredTargets() == 0)
+    {
+        m_multiTargetMedium->addTarget(QString(), 0);
+    }
+    m_multiTargetMedium->setSampleFile(MultiTargetMedium::configuredSampleFile());
+    for (auto target : m_multiTargetMedium->targets())
+    {
+        addMedium(target); //Owned by m_multiTargetMedium, which is deleted after the BaseProfile deconstructor scheduled their deletion.
+    }
+}
@@ -0,0 +1,20 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+QT              += network widgets
+TARGET          = $$qtLibraryTarget(GenericMultiTargetProfile)
+DESTDIR         = ../../plugins
+
+# qtLibraryTarget() only adds the d suffix on Windows, the multi target medium is built on Linux only
+LIBS += -L../../plugins -lMultiTarget -lProtocolCore
+
+
+HEADERS += \
+    GenericMultiTargetProfile.h \
+    ../BaseProfile.h \
+    ../kconcatenaterowsproxymodel.h
+
+SOURCES += \
+    GenericMultiTargetProfile.cpp \
+    ../kconcatenaterowsproxymodel.cpp
+
+INCLUDEPATH += ../../EmbeddedDebugger/
@@ -0,0 +1,37 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENERICSERIALPROFILE_H
+#define GENERICSERIALPROFILE_H
+
+#include <QObject>
+#include "../BaseProfile.h"
+
+/**
+ * @brief creates a generic serial Profile
+ */
+class genericSerialProfile : public BaseProfile
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "DEMCON.EmbeddedDebugger.BaseProfile" FILE "GenericSerialProfile.json")
+    Q_INTERFACES(BaseProfile)
+public:
+    explicit genericSerialProfile(QObject *parent = nullptr);
+};
+
+#endif // GENERICSERIALPROFILE_H
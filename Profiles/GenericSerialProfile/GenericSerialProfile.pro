@@ -0,0 +1,21 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+QT              += network widgets serialport
+TARGET          = $$qtLibraryTarget(GenericSerialProfile)
+DESTDIR         = ../../plugins
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lSeriald -lProtocolCored
+else: LIBS += -L../../plugins -lSerial -lProtocolCore
+
+
+HEADERS += \
+    GenericSerialProfile.h \
+    ../BaseProfile.h \
+    ../kconcatenaterowsproxymodel.h
+
+SOURCES += \
+    GenericSerialProfile.cpp \
+    ../kconcatenaterowsproxymodel.cpp
+
+INCLUDEPATH += ../../EmbeddedDebugger/
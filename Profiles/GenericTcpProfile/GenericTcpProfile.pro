@@ -4,7 +4,9 @@ QT              += network widgets
 TARGET          = $$qtLibraryTarget(GenericTcpProfile)
 DESTDIR         = ../../plugins
 
-LIBS += -L../../plugins -lTcpd
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lTcpd -lProtocolCored
+else: LIBS += -L../../plugins -lTcp -lProtocolCore
 
 
 HEADERS += \
@@ -0,0 +1,21 @@
+TEMPLATE        = lib
+CONFIG         += plugin
+QT              += network widgets
+TARGET          = $$qtLibraryTarget(GenericUdpProfile)
+DESTDIR         = ../../plugins
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lUdpd -lProtocolCored
+else: LIBS += -L../../plugins -lUdp -lProtocolCore
+
+
+HEADERS += \
+    GenericUdpProfile.h \
+    ../BaseProfile.h \
+    ../kconcatenaterowsproxymodel.h
+
+SOURCES += \
+    GenericUdpProfile.cpp \
+    ../kconcatenaterowsproxymodel.cpp
+
+INCLUDEPATH += ../../EmbeddedDebugger/
@@ -1,2 +1,8 @@
 TEMPLATE    = subdirs
-SUBDIRS	= GenericTcpProfile
+SUBDIRS	= GenericTcpProfile \
+    GenericUdpProfile \
+    GenericSerialProfile \
+    GenericLoopbackProfile
+
+# The multi target medium uses epoll
+linux: SUBDIRS += GenericMultiTargetProfile
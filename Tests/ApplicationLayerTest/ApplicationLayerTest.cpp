@@ -0,0 +1,123 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include "Medium/CPU/Cpu.h"
+#include "Medium/Register/Register.h"
+#include "../../Connectors/Loopback/LoopbackMedium.h"
+#include "../../Connectors/BaseInterface/ApplicationLayerBase.h"
+
+static const int timeout = 5000;    /**< ms */
+
+/**
+ * @brief Runs the asynchronous requests of the application layer against the LoopbackMedium.
+ *
+ * A query must resolve with the value in its response and be canceled when that value can not be
+ * decoded, the Register then holds an invalid value as well.
+ */
+class ApplicationLayerTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+    void writeAndQuery();
+    void queryFailsForUndecodableValue();
+    void pendingRequestsAreCanceledOnDisconnect();
+
+private:
+    Register* addRegister(Register::VariableType variableType, uint offset);
+
+private:
+    LoopbackMedium* m_medium = nullptr;
+    Cpu* m_cpu = nullptr;
+};
+
+void ApplicationLayerTest::init()
+{
+    m_medium = new LoopbackMedium();
+    m_medium->open(1, 1000);
+    QTRY_COMPARE_WITH_TIMEOUT(m_medium->cpuListModel().rowCount(QModelIndex()), 1, timeout);
+    m_cpu = m_medium->cpuListModel().getCpuNodeById(1);
+    QVERIFY(m_cpu != nullptr);
+    QTRY_VERIFY_WITH_TIMEOUT(m_cpu->hasInfo(), timeout);
+    QVERIFY(m_medium->applicationLayer() != nullptr);
+}
+
+void ApplicationLayerTest::cleanup()
+{
+    delete m_medium;
+    m_medium = nullptr;
+    m_cpu = nullptr;
+}
+
+Register* ApplicationLayerTest::addRegister(Register::VariableType variableType, uint offset)
+{
+    auto newRegister = new Register(offset, QString("Register %1").arg(offset), Register::ReadWrite::ReadWrite,
+                                    variableType, Register::Source::AbsoluteAddress, 0, offset, *m_cpu);
+    //As if it was loaded from the configuration, the medium connects it and adds it to its model
+    emit m_cpu->newRegistersFound({newRegister});
+    return newRegister;
+}
+
+void ApplicationLayerTest::writeAndQuery()
+{
+    Register* intRegister = addRegister(Register::VariableType::Int, 0x100);
+
+    QFuture<bool> write = m_medium->applicationLayer()->writeRegisterAsync(*intRegister, 1234);
+    QTRY_VERIFY_WITH_TIMEOUT(write.isFinished(), timeout);
+    QVERIFY(!write.isCanceled());
+    QVERIFY(write.result());
+
+    QFuture<QVariant> query = m_medium->applicationLayer()->queryRegisterAsync(*intRegister);
+    QTRY_VERIFY_WITH_TIMEOUT(query.isFinished(), timeout);
+    QVERIFY(!query.isCanceled());
+    QCOMPARE(query.result().toInt(), 1234);
+    QCOMPARE(intRegister->value().toInt(), 1234);
+}
+
+void ApplicationLayerTest::queryFailsForUndecodableValue()
+{
+    //A float of 3 bytes is neither a float nor a double, the simulator still answers with 3 bytes
+    m_cpu->setVariableTypeSize(Register::VariableType::Float, 3);
+    Register* floatRegister = addRegister(Register::VariableType::Float, 0x200);
+
+    QFuture<QVariant> query = m_medium->applicationLayer()->queryRegisterAsync(*floatRegister);
+    QTRY_VERIFY_WITH_TIMEOUT(query.isFinished(), timeout);
+    QVERIFY(query.isCanceled());
+    QVERIFY(!floatRegister->value().isValid());
+    QCOMPARE(m_medium->transportLayer()->invalidFrames(), 0ull);
+}
+
+void ApplicationLayerTest::pendingRequestsAreCanceledOnDisconnect()
+{
+    Register* intRegister = addRegister(Register::VariableType::Int, 0x300);
+
+    //The link is slow enough that the responses are still on their way
+    m_medium->setLink(1000000, 0.0, 0.0);
+    QFuture<QVariant> query = m_medium->applicationLayer()->queryRegisterAsync(*intRegister);
+    QFuture<bool> write = m_medium->applicationLayer()->writeRegisterAsync(*intRegister, 1);
+    m_medium->disconnect();
+    QTRY_VERIFY_WITH_TIMEOUT(query.isFinished() && write.isFinished(), timeout);
+    QVERIFY(query.isCanceled());
+    QVERIFY(write.isCanceled());
+}
+
+QTEST_GUILESS_MAIN(ApplicationLayerTest)
+
+#include "ApplicationLayerTest.moc"
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Asynchronous requests of the application layer against the loopback medium
+#
+#-------------------------------------------------
+
+QT       += core network widgets testlib
+
+TARGET = ApplicationLayerTest
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lLoopbackd -lProtocolCored
+else: LIBS += -L../../plugins -lLoopback -lProtocolCore
+
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+SOURCES += \
+    ApplicationLayerTest.cpp
@@ -0,0 +1,243 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include "Medium/CPU/Cpu.h"
+#include "Medium/CPU/CpuListModel.h"
+#include "Medium/Register/Register.h"
+#include "Medium/Register/RegisterListModel.h"
+#include "../../Connectors/DebugProtocolV0/TransportLayerV0.h"
+#include "../../Connectors/DebugProtocolV0/PresentationLayerV0.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../../Connectors/BaseInterface/SampleSink.h"
+#include "../../Tools/TargetSimulator/TargetSimulator.h"
+
+static const int cpuCount = 8;
+static const int framesPerCpu = 20000;
+static const int blockSize = 4096;      /**< Bytes per receivedData(), like a read of the medium */
+static const int timeout = 60000;       /**< ms */
+
+/**
+ * @brief Measures the ReadChannelData frames per second through the transport and presentation
+ * layer, decoded on the receiving thread or on decode workers.
+ *
+ * Every Cpu streams all 16 debug channels, with Registers of every variable type. Two rates are
+ * reported: the frames per second that the receiving thread takes in, which is what limits the
+ * link a medium can keep up with, and the frames per second until every frame is applied to its
+ * Registers. Every run is compared with a run on the receiving thread: the decoded samples per
+ * channel, the values of the Registers and their histories must be the same. Run it in a release build with
+ *     DecodeBenchmark -o -,txt
+ */
+class DecodeBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void framesPerSecond_data();
+    void framesPerSecond();
+
+private:
+    struct ChannelType
+    {
+        Register::VariableType type;
+        int size;
+        bool isSigned;
+    };
+
+    struct Result
+    {
+        qint64 receiveTime = 0;     /**< ns */
+        qint64 totalTime = 0;       /**< ns */
+        QHash<int, QVector<QPair<uint, double>>> samples;     /**< Per Cpu id * 16 + channel, in order */
+        QVector<QVariant> values;
+        QVector<quint64> streamedSamples;
+        QVector<int> historySizes;
+        QVector<double> historyLastValues;
+    };
+
+    Result decodeStream(int workers);
+
+private:
+    QVector<ChannelType> m_channelTypes;
+    QByteArray m_stream;
+    Result m_reference;
+};
+
+void DecodeBenchmark::initTestCase()
+{
+    m_channelTypes = {
+        {Register::VariableType::Bool, 1, false},
+        {Register::VariableType::Char, 1, true},
+        {Register::VariableType::Short, 2, true},
+        {Register::VariableType::Int, 4, false},
+        {Register::VariableType::Float, 4, true},
+        {Register::VariableType::Double, 8, true},
+    };
+
+    //The stream of all Cpu`s interleaved, as a medium reads it
+    for (int i = 0; i < framesPerCpu; i++)
+    {
+        for (int uCId = 1; uCId <= cpuCount; uCId++)
+        {
+            QVector<uint8_t> command;
+            command.append(DebugProtocolV0Enums::ReadChannelData);
+            command.append(static_cast<uint8_t>(i));
+            command.append(static_cast<uint8_t>(i >> 8));
+            command.append(static_cast<uint8_t>(i >> 16));
+            command.append(0xFF);
+            command.append(0xFF);
+            for (int channel = 0; channel < TargetSimulator::DebugChannels; channel++)
+            {
+                for (int byte = 0; byte < m_channelTypes.at(channel % m_channelTypes.size()).size; byte++)
+                {
+                    command.append(static_cast<uint8_t>(i * 31 + channel * 7 + byte));
+                }
+            }
+            m_stream.append(TargetSimulator::frame(static_cast<uint8_t>(uCId), static_cast<uint8_t>(i | 1), command));
+        }
+    }
+
+    //What the receiving thread decodes is what every run with workers must decode
+    m_reference = decodeStream(0);
+}
+
+void DecodeBenchmark::framesPerSecond_data()
+{
+    QTest::addColumn<int>("workers");
+    QTest::newRow("receiving thread") << 0;
+    QTest::newRow("1 worker") << 1;
+    QTest::newRow("2 workers") << 2;
+    QTest::newRow("4 workers") << 4;
+}
+
+void DecodeBenchmark::framesPerSecond()
+{
+    QFETCH(int, workers);
+    Result result = decodeStream(workers);
+    if (QTest::currentTestFailed())
+    {
+        return;
+    }
+    int totalFrames = cpuCount * framesPerCpu;
+    qInfo() << workers << "workers:" << qRound64(totalFrames * 1e9 / result.receiveTime) << "frames/s on the receiving thread,"
+            << qRound64(totalFrames * 1e9 / result.totalTime) << "frames/s until applied";
+
+    QCOMPARE(result.samples.size(), m_reference.samples.size());
+    for (auto channel = m_reference.samples.constBegin(); channel != m_reference.samples.constEnd(); ++channel)
+    {
+        QVERIFY2(result.samples.value(channel.key()) == channel.value(), qPrintable(QString("samples of cpu %1 channel %2 differ").arg(channel.key() / 16).arg(channel.key() % 16)));
+    }
+    QCOMPARE(result.values, m_reference.values);
+    QCOMPARE(result.streamedSamples, m_reference.streamedSamples);
+    QCOMPARE(result.historySizes, m_reference.historySizes);
+    QCOMPARE(result.historyLastValues, m_reference.historyLastValues);
+}
+
+DecodeBenchmark::Result DecodeBenchmark::decodeStream(int workers)
+{
+    Result result;
+    CpuListModel cpuListModel;
+    RegisterListModel registerListModel;
+    TransportLayerV0 transport;
+    PresentationLayerV0 presentation(cpuListModel, registerListModel);
+    QScopedPointer<ChannelDataDecoder> decoder(workers > 0 ? new ChannelDataDecoder(workers) : nullptr);
+    presentation.setChannelDataDecoder(decoder.data());
+    transport.setChannelDataUnchecked(workers > 0);
+    int totalFrames = cpuCount * framesPerCpu;
+    SampleSink sink(totalFrames * TargetSimulator::DebugChannels);
+    presentation.setSampleSink(&sink, 0);
+    connect(&transport, &TransportLayerBase::receivedDebugProtocolCommand, &presentation, &PresentationLayerBase::receivedDebugProtocolCommand);
+    connect(&transport, &TransportLayerBase::receivedChannelDataFrame, &presentation, &PresentationLayerBase::receivedChannelDataFrame);
+
+    //Cpu`s with a Register on every debug channel, all with a history
+    QVector<Register*> registers;
+    int appliedFrames = 0;
+    for (uint8_t uCId = 1; uCId <= cpuCount; uCId++)
+    {
+        auto cpu = new Cpu(uCId, "DecodeBenchmark", QString::number(uCId), "0", "0");
+        cpu->setVariableTypeSize(Register::VariableType::TimeStamp, 1);
+        for (const auto& channelType : qAsConst(m_channelTypes))
+        {
+            cpu->setVariableTypeSize(channelType.type, channelType.size);
+        }
+        for (int channel = 0; channel < cpu->debugChannels().size(); channel++)
+        {
+            const ChannelType& channelType = m_channelTypes.at(channel % m_channelTypes.size());
+            auto reg = new Register(static_cast<uint>(registers.size()), QString("Channel %1").arg(channel), Register::ReadWrite::Read,
+                                    channelType.type, Register::Source::AbsoluteAddress, 0, static_cast<uint>(channel * 8), *cpu, channelType.isSigned);
+            reg->subscribeHistory();
+            cpu->debugChannels()[channel] = reg;
+            registers.append(reg);
+        }
+        connect(cpu, &Cpu::channelDataReceived, this, [&appliedFrames]()
+        {
+            appliedFrames++;
+        });
+        cpuListModel.append(cpu);
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    for (int position = 0; position < m_stream.size(); position += blockSize)
+    {
+        transport.receivedData(m_stream.mid(position, blockSize));
+    }
+    result.receiveTime = clock.nsecsElapsed();
+    [&]()
+    {
+        QTRY_COMPARE_WITH_TIMEOUT(appliedFrames, totalFrames, timeout);
+    }();
+    result.totalTime = clock.nsecsElapsed();
+
+    [&]()
+    {
+        QCOMPARE(transport.invalidFrames(), 0ull);
+        QCOMPARE(sink.droppedSamples(), 0ull);
+        for (int row = 0; row < cpuListModel.rowCount(QModelIndex()); row++)
+        {
+            QCOMPARE(cpuListModel.getCpuNodeById(static_cast<uint8_t>(row + 1))->invalidMessageCounter(), 0);
+        }
+    }();
+
+    for (const auto& sample : sink.takeSamples())
+    {
+        result.samples[sample.cpuId * 16 + sample.channel].append(qMakePair(sample.timeStamp, sample.value));
+    }
+    for (auto reg : qAsConst(registers))
+    {
+        result.values.append(reg->value());
+        result.streamedSamples.append(reg->streamedSamples());
+        result.historySizes.append(reg->history().size());
+        result.historyLastValues.append(reg->history().lastValue());
+        reg->unsubscribeHistory();
+    }
+
+    presentation.setChannelDataDecoder(nullptr);
+    for (uint8_t uCId = 1; uCId <= cpuCount; uCId++)
+    {
+        cpuListModel.getCpuNodeById(uCId)->debugChannels().fill(nullptr);
+    }
+    qDeleteAll(registers);
+    return result;
+}
+
+QTEST_GUILESS_MAIN(DecodeBenchmark)
+
+#include "DecodeBenchmark.moc"
@@ -0,0 +1,196 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include "../../Connectors/Serial/SerialMedium.h"
+#include "../../Connectors/BaseInterface/CommandQueue.h"
+#include "../../Connectors/DebugProtocolV0/TransportLayerV0.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../../Tools/TargetSimulator/SimulatorServer.h"
+
+static const int timeout = 5000;        /**< ms */
+static const int measureTime = 2000;    /**< ms per baud rate */
+static const int ptyBaudRate = 115200;  /**< The medium opens the pseudo terminal at this rate, a pty ignores it */
+
+/**
+ * @brief Runs the SerialMedium against a SimulatorServer on a pseudo terminal, and against a real
+ * serial adapter when one is given.
+ *
+ * A pseudo terminal has no baud rate, the simulator paces its output like a UART with 10 bits per
+ * byte. For each rate the windows are kept full of QueryRegister requests, and the received bytes and
+ * responses per second are reported next to the ceiling the rate allows. On the pseudo terminal the
+ * medium must take in everything without invalid or dropped frames.
+ *
+ * The adapter test runs when EDA_SERIAL_DEVICE names a serial port with a target, or a TargetSimulator
+ * on a second port, behind it. EDA_SERIAL_BAUDS lists the baud rates to measure, separated by commas,
+ * by default up to 12 Mbaud. There the baud rate is real, so the received bytes/s may not exceed it.
+ */
+class SerialMediumTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void ptyThroughput_data();
+    void ptyThroughput();
+    void adapterThroughput_data();
+    void adapterThroughput();
+
+private:
+    struct Measurement
+    {
+        double bytesPerSecond = 0.0;
+        double responsesPerSecond = 0.0;
+    };
+
+    static QVector<uint8_t> queryCommand(quint32 offset);
+    Measurement measure(SerialMedium& medium);
+    static void report(int baudRate, const Measurement& measurement);
+};
+
+QVector<uint8_t> SerialMediumTest::queryCommand(quint32 offset)
+{
+    QVector<uint8_t> command;
+    command.append(DebugProtocolV0Enums::QueryRegister);
+    command.append(static_cast<uint8_t>(offset));
+    command.append(static_cast<uint8_t>(offset >> 8));
+    command.append(static_cast<uint8_t>(offset >> 16));
+    command.append(static_cast<uint8_t>(offset >> 24));
+    command.append(0);
+    command.append(4);
+    return command;
+}
+
+SerialMediumTest::Measurement SerialMediumTest::measure(SerialMedium &medium)
+{
+    auto transport = static_cast<TransportLayerV0*>(medium.transportLayer());
+    CommandQueue* commandQueue = medium.commandQueue();
+    bool running = true;
+    quint64 responses = 0;
+    quint32 nextOffset = 0;
+    QMetaObject::Connection responseConnection = connect(transport, &TransportLayerBase::receivedDebugProtocolCommand, this, [&](uint8_t uCId, QVector<uint8_t> messageVector)
+    {
+        if (running && !messageVector.isEmpty() && messageVector.first() == DebugProtocolV0Enums::QueryRegister)
+        {
+            responses++;
+            commandQueue->enqueue(uCId, queryCommand(nextOffset++ * 4 % 256), CommandLane::Poll, 0);
+        }
+    });
+
+    uint8_t uCId = static_cast<uint8_t>(medium.cpuListModel().index(0, 0).data().toUInt());
+    quint64 receivedBytes = transport->receivedBytes();
+    QElapsedTimer clock;
+    clock.start();
+    for (int i = 0; i < transport->maxInFlight(); i++)
+    {
+        commandQueue->enqueue(uCId, queryCommand(nextOffset++ * 4 % 256), CommandLane::Poll, 0);
+    }
+    QTest::qWait(measureTime);
+    running = false;
+    qint64 elapsed = clock.elapsed();
+    disconnect(responseConnection);
+
+    Measurement measurement;
+    measurement.bytesPerSecond = (transport->receivedBytes() - receivedBytes) * 1000.0 / elapsed;
+    measurement.responsesPerSecond = responses * 1000.0 / elapsed;
+    return measurement;
+}
+
+void SerialMediumTest::report(int baudRate, const Measurement &measurement)
+{
+    double ceiling = baudRate / 10.0;
+    qInfo() << baudRate << "baud:" << qRound(measurement.bytesPerSecond) << "bytes/s of" << qRound(ceiling)
+            << "(" << qRound(measurement.bytesPerSecond * 100.0 / ceiling) << "% ),"
+            << qRound(measurement.responsesPerSecond) << "QueryRegister responses/s";
+}
+
+void SerialMediumTest::ptyThroughput_data()
+{
+    QTest::addColumn<int>("baudRate");
+    QTest::newRow("115200") << 115200;
+    QTest::newRow("460800") << 460800;
+    QTest::newRow("921600") << 921600;
+    QTest::newRow("3000000") << 3000000;
+    QTest::newRow("12000000") << 12000000;
+}
+
+void SerialMediumTest::ptyThroughput()
+{
+    QFETCH(int, baudRate);
+    SimulatorServer server(1, 1000);
+    QString portName = server.openPty(baudRate);
+    QVERIFY(!portName.isEmpty());
+
+    //Only the simulator paces, so every rate is tested, also those a pty may not accept
+    SerialMedium medium;
+    medium.setDeviceLatency(0);
+    medium.openPort(portName, ptyBaudRate);
+    QTRY_COMPARE_WITH_TIMEOUT(medium.cpuListModel().rowCount(QModelIndex()), 1, timeout);
+
+    Measurement measurement = measure(medium);
+    report(baudRate, measurement);
+    QVERIFY(measurement.responsesPerSecond > 0.0);
+    QCOMPARE(medium.transportLayer()->invalidFrames(), 0ull);
+    QCOMPARE(server.droppedPtyFrames(), 0ull);
+}
+
+void SerialMediumTest::adapterThroughput_data()
+{
+    QTest::addColumn<QString>("device");
+    QTest::addColumn<int>("baudRate");
+
+    QString device = qEnvironmentVariable("EDA_SERIAL_DEVICE");
+    QString baudRates = qEnvironmentVariable("EDA_SERIAL_BAUDS", "115200,460800,921600,3000000,12000000");
+    if (device.isEmpty())
+    {
+        QTest::newRow("no adapter") << QString() << 0;
+        return;
+    }
+    for (const auto& baudRate : baudRates.split(',', QString::SkipEmptyParts))
+    {
+        QTest::newRow(qPrintable(baudRate.trimmed())) << device << baudRate.trimmed().toInt();
+    }
+}
+
+void SerialMediumTest::adapterThroughput()
+{
+    QFETCH(QString, device);
+    QFETCH(int, baudRate);
+    if (device.isEmpty())
+    {
+        QSKIP("Set EDA_SERIAL_DEVICE to measure on a serial adapter");
+    }
+
+    SerialMedium medium;
+    QString error;
+    connect(&medium, &Medium::errorOccured, this, [&error](const QString& message){error = message;});
+    medium.openPort(device, baudRate);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QTRY_VERIFY2_WITH_TIMEOUT(medium.cpuListModel().rowCount(QModelIndex()) > 0, "No target answers on the adapter", timeout);
+
+    Measurement measurement = measure(medium);
+    report(baudRate, measurement);
+    QVERIFY(measurement.responsesPerSecond > 0.0);
+    //A real UART can not go faster than its baud rate, more means the bytes were counted wrong
+    QVERIFY(measurement.bytesPerSecond <= baudRate / 10.0 * 1.05);
+    QCOMPARE(medium.transportLayer()->invalidFrames(), 0ull);
+}
+
+QTEST_GUILESS_MAIN(SerialMediumTest)
+
+#include "SerialMediumTest.moc"
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Serial medium against the target simulator on a pseudo terminal
+#
+#-------------------------------------------------
+
+QT       += core network serialport widgets testlib
+
+TARGET = SerialMediumTest
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lSeriald -lProtocolCored
+else: LIBS += -L../../plugins -lSerial -lProtocolCore
+
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+SOURCES += \
+    SerialMediumTest.cpp \
+    ../../Tools/TargetSimulator/TargetSimulator.cpp \
+    ../../Tools/TargetSimulator/SimulatorServer.cpp
+
+HEADERS += \
+    ../../Tools/TargetSimulator/TargetSimulator.h \
+    ../../Tools/TargetSimulator/SimulatorServer.h
@@ -0,0 +1,8 @@
+TEMPLATE    = subdirs
+SUBDIRS	= TransportBenchmark \
+    DecodeBenchmark \
+    UdpMediumTest \
+    ApplicationLayerTest
+
+# The simulator serves the serial medium on a pseudo terminal
+unix: SUBDIRS += SerialMediumTest
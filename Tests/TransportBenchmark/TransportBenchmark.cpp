@@ -0,0 +1,147 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include "../../Connectors/Loopback/LoopbackMedium.h"
+#include "../../Connectors/BaseInterface/CommandQueue.h"
+#include "../../Connectors/DebugProtocolV0/TransportLayerV0.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../../Tools/TargetSimulator/TargetSimulator.h"
+
+static const int cpuCount = 4;
+static const int measureTime = 2000;    /**< ms per measurement */
+static const int registerCount = 64;    /**< Different QueryRegister commands per Cpu, cycled */
+
+/**
+ * @brief Measures the QueryRegister requests per second that the protocol stack completes over the
+ * LoopbackMedium, with and without the FrameTemplates of the transport layer.
+ *
+ * The windows of all Cpu`s are kept full and the link has no latency or bandwidth limit, so the
+ * result is the cost of the host side and the TargetSimulator. Run it in a release build with
+ *     TransportBenchmark -o -,txt
+ */
+class TransportBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void framing_data();
+    void framing();
+    void framesPerSecond_data();
+    void framesPerSecond();
+
+private:
+    static QVector<uint8_t> queryCommand(quint32 offset);
+};
+
+QVector<uint8_t> TransportBenchmark::queryCommand(quint32 offset)
+{
+    QVector<uint8_t> command;
+    command.append(DebugProtocolV0Enums::QueryRegister);
+    command.append(static_cast<uint8_t>(offset));
+    command.append(static_cast<uint8_t>(offset >> 8));
+    command.append(static_cast<uint8_t>(offset >> 16));
+    command.append(static_cast<uint8_t>(offset >> 24));
+    command.append(0);
+    command.append(4);
+    return command;
+}
+
+void TransportBenchmark::framing_data()
+{
+    QTest::addColumn<bool>("templates");
+    QTest::newRow("templates") << true;
+    QTest::newRow("no templates") << false;
+}
+
+void TransportBenchmark::framing()
+{
+    //Both paths write the raw frame bytes, the same as the frames of the simulator
+    QFETCH(bool, templates);
+    for (quint32 offset : {0x00000100u, 0x0055AA66u})
+    {
+        TransportLayerV0 transport;
+        transport.setFrameTemplatesEnabled(templates);
+        QByteArray written;
+        connect(&transport, &TransportLayerBase::write, [&written](const QByteArray& frame)
+        {
+            written.append(frame);
+        });
+
+        transport.sendDebugProtocolCommand(1, queryCommand(offset));
+        QCOMPARE(written, TargetSimulator::frame(1, 1, queryCommand(offset)));
+    }
+}
+
+void TransportBenchmark::framesPerSecond_data()
+{
+    framing_data();
+}
+
+void TransportBenchmark::framesPerSecond()
+{
+    QFETCH(bool, templates);
+    LoopbackMedium medium;
+    medium.open(cpuCount, 1000);
+    QTRY_COMPARE_WITH_TIMEOUT(medium.cpuListModel().rowCount(QModelIndex()), cpuCount, 5000);
+
+    auto transport = static_cast<TransportLayerV0*>(medium.transportLayer());
+    transport->setFrameTemplatesEnabled(templates);
+    CommandQueue* commandQueue = medium.commandQueue();
+
+    bool running = true;
+    quint64 responses = 0;
+    QHash<uint8_t, quint32> nextRegister;
+    auto sendNext = [&](uint8_t uCId)
+    {
+        quint32 index = nextRegister[uCId]++ % registerCount;
+        commandQueue->enqueue(uCId, queryCommand(index * 4), CommandLane::Poll, 0);
+    };
+    connect(transport, &TransportLayerBase::receivedDebugProtocolCommand, this, [&](uint8_t uCId, QVector<uint8_t> messageVector)
+    {
+        if (running && !messageVector.isEmpty() && messageVector.first() == DebugProtocolV0Enums::QueryRegister)
+        {
+            responses++;
+            sendNext(uCId);
+        }
+    });
+
+    QElapsedTimer clock;
+    clock.start();
+    for (uint8_t uCId = 1; uCId <= cpuCount; uCId++)
+    {
+        for (int i = 0; i < transport->maxInFlight(); i++)
+        {
+            sendNext(uCId);
+        }
+    }
+    QTest::qWait(measureTime);
+    running = false;
+    qint64 elapsed = clock.elapsed();
+
+    qInfo() << (templates ? "With" : "Without") << "frame templates:"
+            << qRound(responses * 1000.0 / elapsed) << "QueryRegister requests/s";
+    QVERIFY(responses > 0);
+    QCOMPARE(medium.simulator()->invalidFrames(), 0ull);
+    QCOMPARE(transport->invalidFrames(), 0ull);
+}
+
+QTEST_GUILESS_MAIN(TransportBenchmark)
+
+#include "TransportBenchmark.moc"
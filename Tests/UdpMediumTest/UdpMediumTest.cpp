@@ -0,0 +1,205 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtTest>
+#include "../../Connectors/UDP/UdpMedium.h"
+#include "../../Connectors/BaseInterface/CommandQueue.h"
+#include "../../Connectors/BaseInterface/TransportLayerBase.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include "../../Tools/TargetSimulator/SimulatorServer.h"
+
+static const int cpuCount = 2;
+static const int timeout = 5000;    /**< ms */
+static const uint8_t scriptedCpu = cpuCount + 1;    /**< Not simulated, only its scripted channel data arrives */
+
+/**
+ * @brief Runs the UdpMedium against a SimulatorServer on the loopback interface.
+ *
+ * Every frame of a batch must leave in its own datagram and be answered, whatever bytes the frames
+ * hold, so the requests use offsets with the ETX, STX and ESC characters in them.
+ *
+ * The server sends channel data with scripted msgIds to check the sequence counters of the medium:
+ * gaps are lost frames, a msgId that goes back is a reordered frame and a repeated msgId a duplicate,
+ * also where the counter wraps around.
+ */
+class UdpMediumTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+    void findsCpus();
+    void batchIsSentPerFrame();
+    void droppedFramesAreLost();
+    void reorderedFrameIsNotLost();
+    void duplicateFrameIsDropped();
+    void wrapSkippingZeroIsNoLoss();
+    void wrapWithZeroIsNoLoss();
+    void lossAcrossWrap();
+
+private:
+    static QVector<uint8_t> queryCommand(quint32 offset);
+    void sendSequence(uint8_t uCId, const QVector<uint8_t>& msgIds);
+
+private:
+    SimulatorServer* m_server = nullptr;
+    UdpMedium* m_medium = nullptr;
+};
+
+QVector<uint8_t> UdpMediumTest::queryCommand(quint32 offset)
+{
+    QVector<uint8_t> command;
+    command.append(DebugProtocolV0Enums::QueryRegister);
+    command.append(static_cast<uint8_t>(offset));
+    command.append(static_cast<uint8_t>(offset >> 8));
+    command.append(static_cast<uint8_t>(offset >> 16));
+    command.append(static_cast<uint8_t>(offset >> 24));
+    command.append(0);
+    command.append(4);
+    return command;
+}
+
+void UdpMediumTest::sendSequence(uint8_t uCId, const QVector<uint8_t> &msgIds)
+{
+    quint64 receivedDatagrams = m_medium->receivedDatagrams();
+    m_server->sendChannelDataSequence(uCId, msgIds);
+    QTRY_COMPARE_WITH_TIMEOUT(m_medium->receivedDatagrams() - receivedDatagrams, static_cast<quint64>(msgIds.size()), timeout);
+}
+
+void UdpMediumTest::init()
+{
+    m_server = new SimulatorServer(cpuCount, 1000);
+    QVERIFY(m_server->listenUdp(QHostAddress::LocalHost, 0));
+    m_medium = new UdpMedium();
+    m_medium->connectToHost("127.0.0.1", m_server->udpPort());
+    QTRY_COMPARE_WITH_TIMEOUT(m_medium->cpuListModel().rowCount(QModelIndex()), cpuCount, timeout);
+}
+
+void UdpMediumTest::cleanup()
+{
+    delete m_medium;
+    m_medium = nullptr;
+    delete m_server;
+    m_server = nullptr;
+}
+
+void UdpMediumTest::findsCpus()
+{
+    QCOMPARE(m_medium->invalidDatagrams(), 0ull);
+    QCOMPARE(m_medium->transportLayer()->invalidFrames(), 0ull);
+}
+
+void UdpMediumTest::batchIsSentPerFrame()
+{
+    TransportLayerBase* transport = m_medium->transportLayer();
+    CommandQueue* commandQueue = m_medium->commandQueue();
+    int responses = 0;
+    connect(transport, &TransportLayerBase::receivedDebugProtocolCommand, this, [&responses](uint8_t uCId, QVector<uint8_t> messageVector)
+    {
+        Q_UNUSED(uCId)
+        if (!messageVector.isEmpty() && messageVector.first() == DebugProtocolV0Enums::QueryRegister)
+        {
+            responses++;
+        }
+    });
+
+    const QVector<quint32> offsets = {0x00000010, 0x000000AA, 0x00005500, 0x00660000, 0xAA55AA66};
+    quint64 sentFrames = transport->sentFrames();
+    quint64 sentDatagrams = m_medium->sentDatagrams();
+    commandQueue->beginBatch();
+    for (uint8_t uCId = 1; uCId <= cpuCount; uCId++)
+    {
+        for (quint32 offset : offsets)
+        {
+            commandQueue->enqueue(uCId, queryCommand(offset), CommandLane::Interactive, 0);
+        }
+    }
+    commandQueue->endBatch();
+
+    int requests = cpuCount * offsets.size();
+    QCOMPARE(transport->sentFrames() - sentFrames, static_cast<quint64>(requests));
+    QCOMPARE(m_medium->sentDatagrams() - sentDatagrams, static_cast<quint64>(requests));
+    QTRY_COMPARE_WITH_TIMEOUT(responses, requests, timeout);
+    QCOMPARE(m_medium->invalidDatagrams(), 0ull);
+    QCOMPARE(transport->invalidFrames(), 0ull);
+    QCOMPARE(transport->retransmittedFrames(), 0ull);
+}
+
+void UdpMediumTest::droppedFramesAreLost()
+{
+    sendSequence(scriptedCpu, {1, 2, 5, 6});
+    QCOMPARE(m_medium->lostFrames(), 2ull);
+    QCOMPARE(m_medium->reorderedFrames(), 0ull);
+    QCOMPARE(m_medium->duplicateFrames(), 0ull);
+    QCOMPARE(m_medium->invalidDatagrams(), 0ull);
+    //4 frames arrived out of 6
+    QCOMPARE(m_medium->lossRate(), 2.0 / 6.0);
+}
+
+void UdpMediumTest::reorderedFrameIsNotLost()
+{
+    //3 is first counted as lost, and no longer when it arrives after 4
+    sendSequence(scriptedCpu, {1, 2, 4, 3, 5});
+    QCOMPARE(m_medium->lostFrames(), 0ull);
+    QCOMPARE(m_medium->reorderedFrames(), 1ull);
+    QCOMPARE(m_medium->duplicateFrames(), 0ull);
+    QCOMPARE(m_medium->lossRate(), 0.0);
+}
+
+void UdpMediumTest::duplicateFrameIsDropped()
+{
+    sendSequence(scriptedCpu, {1, 2, 2, 3});
+    QCOMPARE(m_medium->lostFrames(), 0ull);
+    QCOMPARE(m_medium->reorderedFrames(), 0ull);
+    QCOMPARE(m_medium->duplicateFrames(), 1ull);
+    QCOMPARE(m_medium->lossRate(), 0.0);
+}
+
+void UdpMediumTest::wrapSkippingZeroIsNoLoss()
+{
+    //The simulator skips msgId 0, 255 is followed by 1
+    sendSequence(scriptedCpu, {253, 254, 255, 1, 2});
+    QCOMPARE(m_medium->lostFrames(), 0ull);
+    QCOMPARE(m_medium->reorderedFrames(), 0ull);
+    QCOMPARE(m_medium->lossRate(), 0.0);
+}
+
+void UdpMediumTest::wrapWithZeroIsNoLoss()
+{
+    //A Cpu that sends msgId 0 does not skip it
+    sendSequence(scriptedCpu, {254, 255, 0, 1, 2});
+    QCOMPARE(m_medium->lostFrames(), 0ull);
+    QCOMPARE(m_medium->reorderedFrames(), 0ull);
+    QCOMPARE(m_medium->lossRate(), 0.0);
+}
+
+void UdpMediumTest::lossAcrossWrap()
+{
+    //2 and 255 of one Cpu are lost, the other Cpu loses nothing
+    sendSequence(scriptedCpu, {253, 254, 1, 3});
+    sendSequence(scriptedCpu + 1, {254, 255, 1, 2});
+    QCOMPARE(m_medium->lostFrames(), 2ull);
+    QCOMPARE(m_medium->reorderedFrames(), 0ull);
+    QCOMPARE(m_medium->duplicateFrames(), 0ull);
+    QCOMPARE(m_medium->lossRate(), 2.0 / 10.0);
+}
+
+QTEST_GUILESS_MAIN(UdpMediumTest)
+
+#include "UdpMediumTest.moc"
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# UDP medium against the target simulator on the loopback interface
+#
+#-------------------------------------------------
+
+QT       += core network widgets testlib
+
+TARGET = UdpMediumTest
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# qtLibraryTarget() only adds the d suffix on Windows debug builds, the connector goes before the shared code it uses
+win32:CONFIG(debug, debug|release): LIBS += -L../../plugins -lUdpd -lProtocolCored
+else: LIBS += -L../../plugins -lUdp -lProtocolCore
+
+INCLUDEPATH += ../../EmbeddedDebugger/
+
+SOURCES += \
+    UdpMediumTest.cpp \
+    ../../Tools/TargetSimulator/TargetSimulator.cpp \
+    ../../Tools/TargetSimulator/SimulatorServer.cpp
+
+HEADERS += \
+    ../../Tools/TargetSimulator/TargetSimulator.h \
+    ../../Tools/TargetSimulator/SimulatorServer.h
@@ -0,0 +1,292 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LinkEmulator.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QTextStream>
+#include <algorithm>
+
+static const int maximumPending = 4096;    /**< Bytes without an ETX that are passed on as one block */
+
+LinkEmulator::LinkEmulator(const QString &targetHostName, quint16 targetPort, QObject *parent) :
+    QObject(parent),
+    m_targetHostName(targetHostName),
+    m_targetPort(targetPort)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &LinkEmulator::newConnection);
+    connect(&m_upstream, &LoopbackLink::delivered, this, [this](const QByteArray& data)
+    {
+        m_target.write(data);
+    });
+    connect(&m_downstream, &LoopbackLink::delivered, this, [this](const QByteArray& data)
+    {
+        if (m_client != nullptr)
+        {
+            m_client->write(data);
+        }
+    });
+    connect(&m_target, &QTcpSocket::connected, this, [this]()
+    {
+        //The client is read from now on, so nothing is sent before the target can take it
+        if (m_client != nullptr)
+        {
+            connect(m_client, &QTcpSocket::readyRead, this, [this]()
+            {
+                forward(m_upstreamPending, m_client->readAll(), m_upstream);
+            });
+            forward(m_upstreamPending, m_client->readAll(), m_upstream);
+        }
+    });
+    connect(&m_target, &QTcpSocket::readyRead, this, [this]()
+    {
+        forward(m_downstreamPending, m_target.readAll(), m_downstream);
+    });
+    connect(&m_target, &QTcpSocket::disconnected, this, &LinkEmulator::closeConnection);
+    connect(&m_target, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, [this]()
+    {
+        QTextStream(stderr) << "Target " << m_targetHostName << ":" << m_targetPort << ": " << m_target.errorString() << endl;
+        closeConnection();
+    });
+
+    m_stepTimer.setSingleShot(true);
+    m_stepTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_stepTimer, &QTimer::timeout, this, &LinkEmulator::runSteps);
+    connect(&m_statusTimer, &QTimer::timeout, this, &LinkEmulator::printStatus);
+}
+
+bool LinkEmulator::listen(const QHostAddress &address, quint16 port)
+{
+    if (!m_server.listen(address, port))
+    {
+        QTextStream(stderr) << "Could not listen on TCP port " << port << ": " << m_server.errorString() << endl;
+        return false;
+    }
+    m_statusTimer.start(1000);
+    return true;
+}
+
+void LinkEmulator::setSeed(quint32 seed)
+{
+    m_upstream.setSeed(seed);
+    m_downstream.setSeed(seed + 1);
+}
+
+bool LinkEmulator::applyImpairment(const QJsonObject &impairment, LoopbackLink &link, QString &errorMessage)
+{
+    for (auto key : impairment.keys())
+    {
+        QJsonValue value = impairment[key];
+        if (key == "delay")
+        {
+            link.setLatency(static_cast<int>(value.toDouble() * 1000.0));
+        }
+        else if (key == "jitter")
+        {
+            link.setJitter(static_cast<int>(value.toDouble() * 1000.0), link.distribution());
+        }
+        else if (key == "distribution")
+        {
+            QString name = value.toString();
+            LoopbackLink::Distribution distribution;
+            if (name == "uniform")
+            {
+                distribution = LoopbackLink::Distribution::Uniform;
+            }
+            else if (name == "normal")
+            {
+                distribution = LoopbackLink::Distribution::Normal;
+            }
+            else if (name == "exponential")
+            {
+                distribution = LoopbackLink::Distribution::Exponential;
+            }
+            else
+            {
+                errorMessage = "Unknown delay distribution " + name;
+                return false;
+            }
+            link.setJitter(link.jitter(), distribution);
+        }
+        else if (key == "bandwidth")
+        {
+            link.setBandwidth(value.toDouble() * 1024.0);
+        }
+        else if (key == "loss")
+        {
+            link.setLossRate(value.toDouble() / 100.0);
+        }
+        else if (key == "corrupt")
+        {
+            link.setCorruptionRate(value.toDouble() / 100.0);
+        }
+        else
+        {
+            errorMessage = "Unknown impairment " + key;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LinkEmulator::loadScenario(const QString &fileName, QString &errorMessage)
+{
+    QFile scenarioFile(fileName);
+    if (!scenarioFile.open(QIODevice::ReadOnly))
+    {
+        errorMessage = "Could not open scenario " + fileName;
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonObject scenario = QJsonDocument::fromJson(scenarioFile.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        errorMessage = "Invalid scenario: " + parseError.errorString();
+        return false;
+    }
+
+    if (scenario.contains("seed"))
+    {
+        setSeed(static_cast<quint32>(scenario["seed"].toInt()));
+    }
+    m_steps.clear();
+    for (auto stepRef : scenario["steps"].toArray())
+    {
+        QJsonObject step = stepRef.toObject();
+        m_steps.append({static_cast<qint64>(step["at"].toDouble() * 1000.0), step});
+    }
+    std::stable_sort(m_steps.begin(), m_steps.end(), [](const Step& first, const Step& second)
+    {
+        return first.at < second.at;
+    });
+    m_nextStep = 0;
+    return true;
+}
+
+void LinkEmulator::newConnection()
+{
+    QTcpSocket* client = m_server.nextPendingConnection();
+    if (m_client != nullptr)
+    {
+        //One application at a time, like the target
+        client->abort();
+        client->deleteLater();
+        return;
+    }
+
+    m_client = client;
+    m_connections++;
+    connect(m_client, &QTcpSocket::disconnected, this, &LinkEmulator::closeConnection);
+    m_target.connectToHost(m_targetHostName, m_targetPort);
+    if (m_connections == 1 && !m_steps.isEmpty())
+    {
+        m_scenarioClock.start();
+        runSteps();
+    }
+}
+
+void LinkEmulator::runSteps()
+{
+    qint64 now = m_scenarioClock.elapsed();
+    while (m_nextStep < m_steps.size() && m_steps.at(m_nextStep).at <= now)
+    {
+        const QJsonObject& step = m_steps.at(m_nextStep++).step;
+        QString errorMessage;
+        if (!applyImpairment(step["both"].toObject(), m_upstream, errorMessage) ||
+            !applyImpairment(step["both"].toObject(), m_downstream, errorMessage) ||
+            !applyImpairment(step["up"].toObject(), m_upstream, errorMessage) ||
+            !applyImpairment(step["down"].toObject(), m_downstream, errorMessage))
+        {
+            QTextStream(stderr) << "Scenario step at " << step["at"].toDouble() << " s: " << errorMessage << endl;
+        }
+        QTextStream(stdout) << "Scenario step at " << step["at"].toDouble() << " s" << endl;
+        if (step["disconnect"].toBool())
+        {
+            closeConnection();
+        }
+        if (step["end"].toBool())
+        {
+            emit finished();
+            return;
+        }
+    }
+    if (m_nextStep < m_steps.size())
+    {
+        m_stepTimer.start(static_cast<int>(m_steps.at(m_nextStep).at - now));
+    }
+}
+
+void LinkEmulator::forward(QByteArray &pending, const QByteArray &data, LoopbackLink &link)
+{
+    pending.append(data);
+    int start = 0;
+    while (true)
+    {
+        int end = pending.indexOf(static_cast<char>(DebugProtocolV0Enums::ETX), start);
+        if (end < 0)
+        {
+            break;
+        }
+        link.send(pending.mid(start, end - start + 1));
+        start = end + 1;
+    }
+    pending.remove(0, start);
+    if (pending.size() > maximumPending)
+    {
+        link.send(pending);
+        pending.clear();
+    }
+}
+
+void LinkEmulator::closeConnection()
+{
+    //Both sides see the connection drop, frames on the way are lost
+    m_upstream.clear();
+    m_downstream.clear();
+    m_upstreamPending.clear();
+    m_downstreamPending.clear();
+    m_target.abort();
+    if (m_client != nullptr)
+    {
+        QTcpSocket* client = m_client;
+        m_client = nullptr;
+        client->disconnect(this);
+        client->abort();
+        client->deleteLater();
+    }
+}
+
+void LinkEmulator::printStatus()
+{
+    quint64 upstreamBytes = m_upstream.deliveredBytes();
+    quint64 downstreamBytes = m_downstream.deliveredBytes();
+    QTextStream(stdout) << QString("up %1 kB/s, lost %2, corrupted %3; down %4 kB/s, lost %5, corrupted %6; connections %7")
+                           .arg((upstreamBytes - m_lastUpstreamBytes) / 1024.0, 0, 'f', 1)
+                           .arg(m_upstream.lostFrames())
+                           .arg(m_upstream.corruptedFrames())
+                           .arg((downstreamBytes - m_lastDownstreamBytes) / 1024.0, 0, 'f', 1)
+                           .arg(m_downstream.lostFrames())
+                           .arg(m_downstream.corruptedFrames())
+                           .arg(m_connections)
+                        << endl;
+    m_lastUpstreamBytes = upstreamBytes;
+    m_lastDownstreamBytes = downstreamBytes;
+}
@@ -0,0 +1,125 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LINKEMULATOR_H
+#define LINKEMULATOR_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVector>
+#include "../../Connectors/Loopback/LoopbackLink.h"
+
+/**
+ * @brief TCP proxy that passes the traffic between the application and a target over emulated bad links.
+ *
+ * The byte stream is cut into DebugProtocol V0 frames at the ETX, so delays, losses and corruption
+ * apply to whole frames. Data without an ETX is passed on in blocks. Each direction has its own
+ * LoopbackLink, which keeps the frames in order like TCP would.
+ *
+ * A scenario changes the impairments over time. It is a JSON file with a seed and a list of steps:
+ * @code
+ * {
+ *     "seed": 1,
+ *     "steps": [
+ *         {"at": 0, "both": {"delay": 5, "jitter": 2, "distribution": "normal"}},
+ *         {"at": 10, "down": {"bandwidth": 20, "loss": 5}},
+ *         {"at": 20, "up": {"corrupt": 1}},
+ *         {"at": 30, "disconnect": true},
+ *         {"at": 60, "end": true}
+ *     ]
+ * }
+ * @endcode
+ * "at" is in s after the first client connected. "up" is from the application to the target, "down" the
+ * other way. The impairment keys are delay and jitter in ms, distribution uniform, normal or exponential,
+ * bandwidth in kB/s with 0 for no limit, and loss and corrupt in % of the frames. Keys that are not given
+ * keep their value.
+ */
+class LinkEmulator : public QObject
+{
+    Q_OBJECT
+public:
+    LinkEmulator(const QString& targetHostName, quint16 targetPort, QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+
+    /**
+     * @brief Seed the generators of both directions, for a repeatable run
+     */
+    void setSeed(quint32 seed);
+
+    /**
+     * @brief Apply impairment keys to one direction
+     * @return false and an error message for an unknown key or value.
+     */
+    static bool applyImpairment(const QJsonObject& impairment, LoopbackLink& link, QString& errorMessage);
+
+    /**
+     * @brief Load a scenario, it starts when the first client connects
+     */
+    bool loadScenario(const QString& fileName, QString& errorMessage);
+
+    LoopbackLink& upstream() {return m_upstream;}       /**< From the application to the target */
+    LoopbackLink& downstream() {return m_downstream;}   /**< From the target to the application */
+
+signals:
+    /**
+     * @brief The scenario reached its end step
+     */
+    void finished();
+
+private slots:
+    void newConnection();
+    void runSteps();
+    void printStatus();
+
+private:
+    struct Step
+    {
+        qint64 at;      /**< ms after the start of the scenario */
+        QJsonObject step;
+    };
+
+    void forward(QByteArray& pending, const QByteArray& data, LoopbackLink& link);
+    void closeConnection();
+
+private:
+    QTcpServer m_server;
+    QTcpSocket* m_client = nullptr;
+    QTcpSocket m_target;
+    QString m_targetHostName;
+    quint16 m_targetPort;
+    LoopbackLink m_upstream;
+    LoopbackLink m_downstream;
+    QByteArray m_upstreamPending;   /**< Bytes of a frame of which the ETX did not arrive yet */
+    QByteArray m_downstreamPending;
+    QVector<Step> m_steps;
+    int m_nextStep = 0;
+    QTimer m_stepTimer;
+    QElapsedTimer m_scenarioClock;
+    QTimer m_statusTimer;
+    quint64 m_connections = 0;
+    quint64 m_lastUpstreamBytes = 0;
+    quint64 m_lastDownstreamBytes = 0;
+};
+
+#endif // LINKEMULATOR_H
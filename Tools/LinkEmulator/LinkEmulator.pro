@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# TCP proxy that emulates bad links between the application and a target
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = LinkEmulator
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    main.cpp \
+    LinkEmulator.cpp \
+    ../../Connectors/Loopback/LoopbackLink.cpp
+
+HEADERS += \
+    LinkEmulator.h \
+    ../../Connectors/Loopback/LoopbackLink.h \
+    ../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h
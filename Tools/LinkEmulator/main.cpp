@@ -0,0 +1,89 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonObject>
+#include <QTextStream>
+#include "LinkEmulator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("DEMCON");
+    QCoreApplication::setOrganizationDomain("www.demcon.nl");
+    QCoreApplication::setApplicationName("Embedded Debugger Link Emulator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TCP proxy between the application and a target that emulates a bad link.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"address", "Address to listen on, default 127.0.0.1.", "address", "127.0.0.1"},
+        {"listen", "TCP port the application connects to.", "port"},
+        {"target-host", "Host of the target or simulator, default 127.0.0.1.", "host", "127.0.0.1"},
+        {"target-port", "TCP port of the target or simulator.", "port"},
+        {"delay", "Delay of each frame in ms, both directions.", "ms"},
+        {"jitter", "Variation on the delay in ms.", "ms"},
+        {"distribution", "Distribution of the jitter, uniform, normal or exponential.", "distribution"},
+        {"bandwidth", "Bandwidth of each direction in kB/s, default unlimited.", "kB/s"},
+        {"loss", "Percentage of the frames that is dropped.", "percentage"},
+        {"corrupt", "Percentage of the frames that gets a bit flipped.", "percentage"},
+        {"scenario", "JSON file with the impairments over time, applied after the options.", "file"},
+        {"seed", "Seed for the jitter, losses and corruption, default 1.", "seed", "1"},
+    });
+    parser.process(a);
+
+    if (!parser.isSet("listen") || !parser.isSet("target-port"))
+    {
+        QTextStream(stderr) << "A listen port and a target port are required" << endl;
+        parser.showHelp(1);
+    }
+
+    LinkEmulator emulator(parser.value("target-host"), static_cast<quint16>(parser.value("target-port").toUInt()));
+    emulator.setSeed(parser.value("seed").toUInt());
+
+    QJsonObject impairment;
+    for (auto key : {"delay", "jitter", "bandwidth", "loss", "corrupt"})
+    {
+        if (parser.isSet(key))
+        {
+            impairment[key] = parser.value(key).toDouble();
+        }
+    }
+    if (parser.isSet("distribution"))
+    {
+        impairment["distribution"] = parser.value("distribution");
+    }
+    QString errorMessage;
+    if (!LinkEmulator::applyImpairment(impairment, emulator.upstream(), errorMessage) ||
+        !LinkEmulator::applyImpairment(impairment, emulator.downstream(), errorMessage) ||
+        (parser.isSet("scenario") && !emulator.loadScenario(parser.value("scenario"), errorMessage)))
+    {
+        QTextStream(stderr) << errorMessage << endl;
+        return 1;
+    }
+
+    QObject::connect(&emulator, &LinkEmulator::finished, &a, &QCoreApplication::quit);
+    if (!emulator.listen(QHostAddress(parser.value("address")), static_cast<quint16>(parser.value("listen").toUInt())))
+    {
+        return 1;
+    }
+    return a.exec();
+}
@@ -0,0 +1,266 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SimulatorServer.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include <QNetworkDatagram>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+static const int maximumPtyOutput = 1024 * 1024;   /**< Output bytes buffered for the pseudo terminal, like a UART FIFO that overflows */
+static const int maximumPtyBurst = 4096;
+
+SimulatorServer::SimulatorServer(int cpuCount, int sampleRate, QObject *parent) :
+    QObject(parent),
+    m_tcpSimulator(cpuCount),
+    m_udpSimulator(cpuCount),
+    m_ptySimulator(cpuCount)
+{
+    m_tcpSimulator.setSampleRate(sampleRate);
+    m_udpSimulator.setSampleRate(sampleRate);
+    m_ptySimulator.setSampleRate(sampleRate);
+    connect(&m_tcpServer, &QTcpServer::newConnection, this, &SimulatorServer::newTcpConnection);
+    connect(&m_tcpSimulator, &TargetSimulator::write, this, [this](const QByteArray& frame)
+    {
+        if (m_tcpClient != nullptr)
+        {
+            m_tcpClient->write(frame);
+        }
+    });
+    connect(&m_udpSocket, &QUdpSocket::readyRead, this, &SimulatorServer::readDatagrams);
+    connect(&m_udpSimulator, &TargetSimulator::write, this, &SimulatorServer::sendDatagram);
+    connect(&m_ptySimulator, &TargetSimulator::write, this, [this](const QByteArray& frame)
+    {
+        if (m_ptyOutput.size() + frame.size() > maximumPtyOutput)
+        {
+            m_droppedPtyFrames++;
+            return;
+        }
+        m_ptyOutput.append(frame);
+        writePty();
+    });
+    m_ptyTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_ptyTimer, &QTimer::timeout, this, &SimulatorServer::writePty);
+}
+
+bool SimulatorServer::listenTcp(const QHostAddress &address, quint16 port)
+{
+    if (!m_tcpServer.listen(address, port))
+    {
+        QTextStream(stderr) << "Could not listen on TCP port " << port << ": " << m_tcpServer.errorString() << endl;
+        return false;
+    }
+    m_tcpSimulator.start();
+    return true;
+}
+
+bool SimulatorServer::listenUdp(const QHostAddress &address, quint16 port)
+{
+    if (!m_udpSocket.bind(address, port))
+    {
+        QTextStream(stderr) << "Could not bind UDP port " << port << ": " << m_udpSocket.errorString() << endl;
+        return false;
+    }
+    m_udpSimulator.start();
+    return true;
+}
+
+SimulatorServer::~SimulatorServer()
+{
+    if (m_ptySlave >= 0)
+    {
+        close(m_ptySlave);
+    }
+    if (m_ptyMaster >= 0)
+    {
+        close(m_ptyMaster);
+    }
+}
+
+QString SimulatorServer::openPty(int baudRate)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        QTextStream(stderr) << "Could not open a pseudo terminal: " << strerror(errno) << endl;
+        if (master >= 0)
+        {
+            close(master);
+        }
+        return QString();
+    }
+    QString slavePath = QString::fromLocal8Bit(ptsname(master));
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    //Raw, the line discipline must not touch the frames
+    struct termios attributes;
+    if (tcgetattr(master, &attributes) == 0)
+    {
+        cfmakeraw(&attributes);
+        tcsetattr(master, TCSANOW, &attributes);
+    }
+
+    m_ptyMaster = master;
+    m_ptySlave = open(slavePath.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+    m_ptyBytesPerUs = baudRate > 0 ? baudRate / 10.0 / 1e6 : 0.0;
+    m_ptyNotifier = new QSocketNotifier(master, QSocketNotifier::Read, this);
+    connect(m_ptyNotifier, &QSocketNotifier::activated, this, &SimulatorServer::readPty);
+    m_ptyClock.start();
+    m_ptyTimer.start(1);
+    m_ptySimulator.start();
+    return slavePath;
+}
+
+void SimulatorServer::setDatagramFaults(double dropPercentage, double reorderPercentage)
+{
+    m_dropPercentage = qBound(0.0, dropPercentage, 100.0);
+    m_reorderPercentage = qBound(0.0, reorderPercentage, 100.0);
+}
+
+void SimulatorServer::newTcpConnection()
+{
+    QTcpSocket* client = m_tcpServer.nextPendingConnection();
+    if (m_tcpClient != nullptr)
+    {
+        //Only the newest client is served
+        m_tcpClient->abort();
+        m_tcpClient->deleteLater();
+    }
+    m_tcpClient = client;
+    m_tcpClient->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_tcpSimulator.reset();
+    QTextStream(stdout) << "TCP client " << client->peerAddress().toString() << ":" << client->peerPort() << endl;
+
+    connect(client, &QTcpSocket::readyRead, this, [this, client]()
+    {
+        m_tcpSimulator.receivedData(client->readAll());
+    });
+    connect(client, &QTcpSocket::disconnected, this, [this, client]()
+    {
+        if (m_tcpClient == client)
+        {
+            m_tcpClient = nullptr;
+        }
+        client->deleteLater();
+    });
+}
+
+void SimulatorServer::readDatagrams()
+{
+    while (m_udpSocket.hasPendingDatagrams())
+    {
+        QNetworkDatagram datagram = m_udpSocket.receiveDatagram();
+        if (datagram.senderAddress() != m_udpPeer || datagram.senderPort() != m_udpPeerPort)
+        {
+            m_udpPeer = datagram.senderAddress();
+            m_udpPeerPort = static_cast<quint16>(datagram.senderPort());
+            m_heldDatagram.clear();
+            QTextStream(stdout) << "UDP peer " << m_udpPeer.toString() << ":" << m_udpPeerPort << endl;
+        }
+        //Every datagram holds whole frames
+        m_udpSimulator.reset();
+        m_udpSimulator.receivedData(datagram.data());
+    }
+}
+
+void SimulatorServer::sendDatagram(const QByteArray &frame)
+{
+    if (m_udpPeerPort == 0)
+    {
+        return;
+    }
+
+    double chance = QRandomGenerator::global()->generateDouble() * 100.0;
+    if (chance < m_dropPercentage)
+    {
+        m_droppedDatagrams++;
+        return;
+    }
+    if (m_heldDatagram.isEmpty() && chance < m_dropPercentage + m_reorderPercentage)
+    {
+        m_reorderedDatagrams++;
+        m_heldDatagram = frame;
+        return;
+    }
+
+    m_udpSocket.writeDatagram(frame, m_udpPeer, m_udpPeerPort);
+    if (!m_heldDatagram.isEmpty())
+    {
+        m_udpSocket.writeDatagram(m_heldDatagram, m_udpPeer, m_udpPeerPort);
+        m_heldDatagram.clear();
+    }
+}
+
+void SimulatorServer::sendChannelDataSequence(uint8_t uCId, const QVector<uint8_t> &msgIds)
+{
+    if (m_udpPeerPort == 0)
+    {
+        return;
+    }
+
+    //Time stamp and an empty channel mask
+    const QVector<uint8_t> channelData = {DebugProtocolV0Enums::ReadChannelData, 0, 0, 0, 0, 0};
+    for (uint8_t msgId : msgIds)
+    {
+        m_udpSocket.writeDatagram(TargetSimulator::frame(uCId, msgId, channelData), m_udpPeer, m_udpPeerPort);
+    }
+}
+
+void SimulatorServer::readPty()
+{
+    char buffer[4096];
+    while (true)
+    {
+        ssize_t size = read(m_ptyMaster, buffer, sizeof(buffer));
+        if (size <= 0)
+        {
+            return;
+        }
+        m_ptySimulator.receivedData(QByteArray(buffer, static_cast<int>(size)));
+    }
+}
+
+void SimulatorServer::writePty()
+{
+    qint64 now = m_ptyClock.nsecsElapsed() / 1000;
+    int budget = m_ptyOutput.size();
+    if (m_ptyBytesPerUs > 0.0)
+    {
+        m_ptyCredit = qMin<double>(maximumPtyBurst, m_ptyCredit + (now - m_ptyLastWrite) * m_ptyBytesPerUs);
+        budget = qMin(budget, static_cast<int>(m_ptyCredit));
+    }
+    m_ptyLastWrite = now;
+    if (budget <= 0)
+    {
+        return;
+    }
+
+    ssize_t written = write(m_ptyMaster, m_ptyOutput.constData(), static_cast<size_t>(budget));
+    if (written > 0)
+    {
+        m_ptyOutput.remove(0, static_cast<int>(written));
+        m_ptyCredit -= written;
+    }
+}
@@ -0,0 +1,110 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SIMULATORSERVER_H
+#define SIMULATORSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QSocketNotifier>
+#include <QElapsedTimer>
+#include <QTimer>
+#include "TargetSimulator.h"
+
+/**
+ * @brief Serves a TargetSimulator on the network.
+ *
+ * Over TCP one client at a time is served as a byte stream. Over UDP every frame is sent in its own
+ * datagram to the host that sent the last datagram. Outgoing datagrams can be dropped and reordered
+ * on purpose, to exercise the loss and reorder detection of the UDP medium.
+ *
+ * On a pseudo terminal the simulator behaves like a target on a UART: its output is paced to the
+ * configured baud rate, with 10 bits per byte, and what does not fit in the output buffer is dropped.
+ * The serial medium opens the slave side like any other serial port.
+ */
+class SimulatorServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SimulatorServer(int cpuCount, int sampleRate, QObject* parent = nullptr);
+    virtual ~SimulatorServer();
+
+    bool listenTcp(const QHostAddress& address, quint16 port);
+    bool listenUdp(const QHostAddress& address, quint16 port);
+    quint16 udpPort() const {return m_udpSocket.localPort();}     /**< The port that was bound, also when listenUdp() was given port 0 */
+
+    /**
+     * @brief Open a pseudo terminal
+     * @param baudRate that the output is paced to, 0 to send as fast as possible.
+     * @return the path of the slave side, empty if it could not be opened.
+     */
+    QString openPty(int baudRate);
+
+    /**
+     * @brief Set the chance in percent that an outgoing datagram is dropped or swapped with the next one
+     */
+    void setDatagramFaults(double dropPercentage, double reorderPercentage);
+
+    /**
+     * @brief Send empty channel data of a Cpu with the given msgIds, in that order and without faults
+     * Gaps, repeats and msgIds that go back script the losses, duplicates and reorders exactly.
+     */
+    void sendChannelDataSequence(uint8_t uCId, const QVector<uint8_t>& msgIds);
+
+    quint64 droppedDatagrams() const {return m_droppedDatagrams;}
+    quint64 reorderedDatagrams() const {return m_reorderedDatagrams;}
+    quint64 droppedPtyFrames() const {return m_droppedPtyFrames;}
+
+private slots:
+    void newTcpConnection();
+    void readDatagrams();
+    void sendDatagram(const QByteArray& frame);
+    void readPty();
+    void writePty();
+
+private:
+    TargetSimulator m_tcpSimulator;
+    TargetSimulator m_udpSimulator;
+    TargetSimulator m_ptySimulator;
+    QTcpServer m_tcpServer;
+    QTcpSocket* m_tcpClient = nullptr;
+    QUdpSocket m_udpSocket;
+    QHostAddress m_udpPeer;
+    quint16 m_udpPeerPort = 0;
+    QByteArray m_heldDatagram;      /**< Datagram that is sent after the next one */
+    double m_dropPercentage = 0.0;
+    double m_reorderPercentage = 0.0;
+    quint64 m_droppedDatagrams = 0;
+    quint64 m_reorderedDatagrams = 0;
+    int m_ptyMaster = -1;
+    int m_ptySlave = -1;            /**< Kept open, so the master does not fail while the medium has the port closed */
+    QSocketNotifier* m_ptyNotifier = nullptr;
+    QTimer m_ptyTimer;
+    QElapsedTimer m_ptyClock;
+    QByteArray m_ptyOutput;         /**< Frames waiting for the baud rate */
+    double m_ptyBytesPerUs = 0.0;
+    double m_ptyCredit = 0.0;       /**< Bytes that may be written now */
+    qint64 m_ptyLastWrite = 0;
+    quint64 m_droppedPtyFrames = 0;
+};
+
+#endif // SIMULATORSERVER_H
@@ -0,0 +1,367 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TargetSimulator.h"
+#include "../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h"
+#include <QDebug>
+
+static const qint64 maximumLag = 100000;   /**< us behind after which samples are skipped instead of caught up */
+
+TargetSimulator::TargetSimulator(int cpuCount, QObject *parent) :
+    QObject(parent)
+{
+    for (int i = 1; i <= qBound(1, cpuCount, 0xFE); i++)
+    {
+        SimulatedCpu cpu;
+        cpu.id = static_cast<uint8_t>(i);
+        cpu.channels.resize(DebugChannels);
+        m_cpus.append(cpu);
+    }
+    m_clock.start();
+    m_sampleTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &TargetSimulator::generateSamples);
+}
+
+void TargetSimulator::setSampleRate(int samplesPerSecond)
+{
+    m_sampleRate = qBound(1, samplesPerSecond, 1000000);
+}
+
+QByteArray TargetSimulator::frame(uint8_t uCId, uint8_t msgId, const QVector<uint8_t> &protocolCommand)
+{
+    QVector<uint8_t> content;
+    content.reserve(protocolCommand.size() + 3);
+    content.append(uCId);
+    content.append(msgId);
+    content.append(protocolCommand);
+    content.append(crc(content));
+
+    QByteArray newFrame;
+    newFrame.reserve(content.size() * 2 + 2);
+    newFrame.append(static_cast<char>(DebugProtocolV0Enums::STX));
+    for (auto value : content)
+    {
+        if (value == DebugProtocolV0Enums::STX || value == DebugProtocolV0Enums::ETX || value == DebugProtocolV0Enums::ESC)
+        {
+            newFrame.append(static_cast<char>(DebugProtocolV0Enums::ESC));
+            value ^= DebugProtocolV0Enums::ESC;
+        }
+        newFrame.append(static_cast<char>(value));
+    }
+    newFrame.append(static_cast<char>(DebugProtocolV0Enums::ETX));
+    return newFrame;
+}
+
+uint8_t TargetSimulator::crc(const QVector<uint8_t> &data)
+{
+    //CRC-8 with the reflected polynomial 0x8C, the same table as the transport layer
+    static uint8_t table[256];
+    static bool tableValid = false;
+    if (!tableValid)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint8_t value = static_cast<uint8_t>(i);
+            for (int bit = 0; bit < 8; bit++)
+            {
+                value = (value & 0x01) ? static_cast<uint8_t>((value >> 1) ^ 0x8C) : static_cast<uint8_t>(value >> 1);
+            }
+            table[i] = value;
+        }
+        tableValid = true;
+    }
+
+    uint8_t result = 0;
+    for (auto value : data)
+    {
+        result = table[result ^ value];
+    }
+    return result;
+}
+
+void TargetSimulator::receivedData(const QByteArray &data)
+{
+    m_buffer.append(data);
+    while (true)
+    {
+        int start = m_buffer.indexOf(static_cast<char>(DebugProtocolV0Enums::STX));
+        if (start < 0)
+        {
+            m_buffer.clear();
+            return;
+        }
+        int end = m_buffer.indexOf(static_cast<char>(DebugProtocolV0Enums::ETX), start);
+        if (end < 0)
+        {
+            //Wait for the rest of the frame
+            m_buffer.remove(0, start);
+            return;
+        }
+
+        QVector<uint8_t> frameData;
+        frameData.reserve(end - start);
+        for (int i = start + 1; i < end; i++)
+        {
+            auto value = static_cast<uint8_t>(m_buffer.at(i));
+            if (value == DebugProtocolV0Enums::ESC && i + 1 < end)
+            {
+                value = static_cast<uint8_t>(m_buffer.at(++i)) ^ DebugProtocolV0Enums::ESC;
+            }
+            frameData.append(value);
+        }
+        m_buffer.remove(0, end + 1);
+        receivedFrame(frameData);
+    }
+}
+
+void TargetSimulator::start()
+{
+    m_nextSample = m_clock.nsecsElapsed() / 1000;
+    m_sampleTimer.start(1);
+}
+
+void TargetSimulator::stop()
+{
+    m_sampleTimer.stop();
+}
+
+void TargetSimulator::reset()
+{
+    m_buffer.clear();
+}
+
+void TargetSimulator::generateSamples()
+{
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    if (now - m_nextSample > maximumLag)
+    {
+        m_nextSample = now;
+    }
+
+    qint64 interval = qMax<qint64>(1, 1000000 / m_sampleRate);
+    while (m_nextSample <= now)
+    {
+        for (auto& cpu : m_cpus)
+        {
+            cpu.samples++;
+            if (cpu.samples % cpu.decimation == 0)
+            {
+                sendChannelData(cpu, m_nextSample);
+            }
+        }
+        m_nextSample += interval;
+    }
+}
+
+void TargetSimulator::receivedFrame(const QVector<uint8_t> &frameData)
+{
+    //uC id, msgId, command and CRC
+    if (frameData.size() < 4 || crc(frameData.mid(0, frameData.size() - 1)) != frameData.last())
+    {
+        m_invalidFrames++;
+        return;
+    }
+    m_receivedFrames++;
+
+    uint8_t uCId = frameData.at(0);
+    uint8_t msgId = frameData.at(1);
+    QVector<uint8_t> command = frameData.mid(2, frameData.size() - 3);
+    for (auto& cpu : m_cpus)
+    {
+        if (uCId == 0xFF || uCId == cpu.id)
+        {
+            handleCommand(cpu, msgId, command);
+        }
+    }
+}
+
+void TargetSimulator::handleCommand(TargetSimulator::SimulatedCpu &cpu, uint8_t msgId, const QVector<uint8_t> &command)
+{
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    QVector<uint8_t> reply;
+    reply.append(command.first());
+
+    switch (command.first())
+    {
+    case DebugProtocolV0Enums::GetVersion:
+    {
+        QByteArray name = QByteArray("Simulator");
+        QByteArray serial = QByteArray("SIM-") + QByteArray::number(cpu.id);
+        reply << 0 << 0 << 0 << 0;      //Protocol version
+        reply << 1 << 0 << 0 << 0;      //Application version
+        reply.append(static_cast<uint8_t>(name.size()));
+        for (char c : name)
+        {
+            reply.append(static_cast<uint8_t>(c));
+        }
+        reply.append(static_cast<uint8_t>(serial.size()));
+        for (char c : serial)
+        {
+            reply.append(static_cast<uint8_t>(c));
+        }
+        break;
+    }
+    case DebugProtocolV0Enums::GetInfo:
+    {
+        //Variable type sizes separated by RS, the time stamp unit is 1 us
+        static const uint8_t sizes[][2] = {{0x0, 4}, {0x1, 4}, {0x2, 1}, {0x3, 1}, {0x4, 2}, {0x5, 4},
+                                           {0x6, 4}, {0x7, 4}, {0x8, 8}, {0x9, 8}};
+        for (const auto& size : sizes)
+        {
+            reply << size[0] << size[1] << DebugProtocolV0Enums::RS;
+        }
+        reply << 0xA << 1 << 0 << 0 << 0;
+        break;
+    }
+    case DebugProtocolV0Enums::QueryRegister:
+    {
+        if (command.size() < 7)
+        {
+            return;
+        }
+        quint32 offset = command[1] | command[2] << 8 | command[3] << 16 | static_cast<quint32>(command[4]) << 24;
+        reply.append(command.mid(1, 6));
+        for (char c : registerValue(cpu, offset, command[6], now))
+        {
+            reply.append(static_cast<uint8_t>(c));
+        }
+        break;
+    }
+    case DebugProtocolV0Enums::WriteRegister:
+    {
+        if (command.size() < 7)
+        {
+            return;
+        }
+        quint32 offset = command[1] | command[2] << 8 | command[3] << 16 | static_cast<quint32>(command[4]) << 24;
+        QByteArray value;
+        for (int i = 7; i < command.size(); i++)
+        {
+            value.append(static_cast<char>(command[i]));
+        }
+        cpu.memory.insert(offset, value);
+        reply.append(0x00);
+        break;
+    }
+    case DebugProtocolV0Enums::ConfigChannel:
+    {
+        if (command.size() < 3 || command[1] >= DebugChannels)
+        {
+            return;
+        }
+        Channel& channel = cpu.channels[command[1]];
+        channel.mode = command[2];
+        if (command.size() >= 9)
+        {
+            channel.offset = command[3] | command[4] << 8 | command[5] << 16 | static_cast<quint32>(command[6]) << 24;
+            channel.size = command[8];
+        }
+        if (channel.size == 0)
+        {
+            channel.mode = 0;
+        }
+        reply << command[1] << channel.mode;
+        break;
+    }
+    case DebugProtocolV0Enums::Decimation:
+    {
+        if (command.size() >= 2 && command[1] > 0)
+        {
+            cpu.decimation = command[1];
+        }
+        reply.append(cpu.decimation);
+        break;
+    }
+    case DebugProtocolV0Enums::ResetTime:
+    {
+        cpu.timeOffset = now;
+        reply.append(0x00);
+        break;
+    }
+    default:
+    {
+        return;
+    }
+    }
+    send(cpu.id, msgId, reply);
+}
+
+void TargetSimulator::sendChannelData(TargetSimulator::SimulatedCpu &cpu, qint64 now)
+{
+    QVector<uint8_t> channelData;
+    uint16_t mask = 0;
+    QVector<uint8_t> values;
+    for (int i = 0; i < cpu.channels.size(); i++)
+    {
+        Channel& channel = cpu.channels[i];
+        if (channel.mode == 0)
+        {
+            continue;
+        }
+        mask |= static_cast<uint16_t>(1 << i);
+        for (char c : registerValue(cpu, channel.offset, channel.size, now))
+        {
+            values.append(static_cast<uint8_t>(c));
+        }
+        if (channel.mode == static_cast<uint8_t>(DebugProtocolV0Enums::ChannelMode::Once))
+        {
+            channel.mode = 0;
+        }
+    }
+    if (mask == 0)
+    {
+        return;
+    }
+
+    auto time = static_cast<quint32>((now - cpu.timeOffset) & 0xFFFFFF);
+    channelData << DebugProtocolV0Enums::ReadChannelData
+                << static_cast<uint8_t>(time) << static_cast<uint8_t>(time >> 8) << static_cast<uint8_t>(time >> 16)
+                << static_cast<uint8_t>(mask) << static_cast<uint8_t>(mask >> 8);
+    channelData.append(values);
+
+    cpu.msgId++;
+    if (cpu.msgId == 0)
+    {
+        cpu.msgId++;
+    }
+    send(cpu.id, cpu.msgId, channelData);
+}
+
+QByteArray TargetSimulator::registerValue(const TargetSimulator::SimulatedCpu &cpu, quint32 offset, int size, qint64 now) const
+{
+    QByteArray value = cpu.memory.value(offset);
+    if (value.isEmpty())
+    {
+        //Triangle with a period of one second, shifted by the offset
+        qint64 phase = (now / 1000 + offset * 37) % 1000;
+        quint32 level = static_cast<quint32>((phase < 500 ? phase : 1000 - phase) * 255 / 500);
+        for (int i = 0; i < size; i++)
+        {
+            value.append(static_cast<char>(i == 0 ? level : 0));
+        }
+    }
+    value.resize(size);
+    return value;
+}
+
+void TargetSimulator::send(uint8_t uCId, uint8_t msgId, const QVector<uint8_t> &protocolCommand)
+{
+    m_sentFrames++;
+    emit write(frame(uCId, msgId, protocolCommand));
+}
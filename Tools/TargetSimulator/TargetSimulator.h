@@ -0,0 +1,129 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TARGETSIMULATOR_H
+#define TARGETSIMULATOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * @brief Simulates embedded targets that speak DebugProtocol V0.
+ *
+ * Each simulated Cpu answers GetVersion, GetInfo, QueryRegister, WriteRegister, ConfigChannel,
+ * Decimation and ResetTime, and streams ReadChannelData for its configured debug channels at the
+ * sample rate divided by its decimation. Registers that were never written return a waveform based on
+ * their offset, so plots show something moving.
+ *
+ * The simulator does not know the medium: frames are put in with receivedData() and every frame
+ * it sends is emitted on its own with write(), so a datagram medium can send one frame per datagram.
+ * Responses carry the msgId of the request, channel data carries a counter per Cpu that skips 0.
+ */
+class TargetSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    static const int DebugChannels = 16;
+
+    /**
+     * @param cpuCount number of simulated Cpu`s, with ids 1 up to cpuCount.
+     */
+    explicit TargetSimulator(int cpuCount = 1, QObject* parent = nullptr);
+
+    /**
+     * @brief Set the number of channel data samples per second before decimation
+     */
+    void setSampleRate(int samplesPerSecond);
+    int sampleRate() const {return m_sampleRate;}
+
+    quint64 receivedFrames() const {return m_receivedFrames;}
+    quint64 invalidFrames() const {return m_invalidFrames;}
+    quint64 sentFrames() const {return m_sentFrames;}
+
+    /**
+     * @brief Build a V0 frame, also used by tools that inject frames
+     */
+    static QByteArray frame(uint8_t uCId, uint8_t msgId, const QVector<uint8_t>& protocolCommand);
+    static uint8_t crc(const QVector<uint8_t>& data);
+
+public slots:
+    /**
+     * @brief Bytes from the host, frames may be split or combined in any way
+     */
+    void receivedData(const QByteArray& data);
+
+    /**
+     * @brief Start streaming the channel data
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief Forget the partly received frame, for instance when the host reconnects
+     */
+    void reset();
+
+signals:
+    void write(const QByteArray& frame);
+
+private slots:
+    void generateSamples();
+
+private:
+    struct Channel
+    {
+        uint8_t mode = 0;       /**< Off, OnChange, LowSpeed or Once */
+        quint32 offset = 0;
+        uint8_t size = 0;
+    };
+
+    struct SimulatedCpu
+    {
+        uint8_t id = 0;
+        uint8_t decimation = 1;
+        uint8_t msgId = 0;                      /**< Counter for the frames the Cpu sends on its own */
+        QVector<Channel> channels;
+        QHash<quint32, QByteArray> memory;      /**< Written Register values by offset */
+        qint64 timeOffset = 0;                  /**< us on m_clock at the last ResetTime */
+        quint64 samples = 0;
+    };
+
+    void receivedFrame(const QVector<uint8_t>& frameData);
+    void handleCommand(SimulatedCpu& cpu, uint8_t msgId, const QVector<uint8_t>& command);
+    void sendChannelData(SimulatedCpu& cpu, qint64 now);
+    QByteArray registerValue(const SimulatedCpu& cpu, quint32 offset, int size, qint64 now) const;
+    void send(uint8_t uCId, uint8_t msgId, const QVector<uint8_t>& protocolCommand);
+
+private:
+    QVector<SimulatedCpu> m_cpus;
+    QByteArray m_buffer;
+    QTimer m_sampleTimer;
+    QElapsedTimer m_clock;
+    int m_sampleRate = 1000;
+    qint64 m_nextSample = 0;    /**< us on m_clock of the next sample */
+    quint64 m_receivedFrames = 0;
+    quint64 m_invalidFrames = 0;
+    quint64 m_sentFrames = 0;
+};
+
+#endif // TARGETSIMULATOR_H
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Simulated DebugProtocol V0 targets for testing the media
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = TargetSimulator
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    main.cpp \
+    TargetSimulator.cpp \
+    SimulatorServer.cpp
+
+HEADERS += \
+    TargetSimulator.h \
+    SimulatorServer.h \
+    ../../Connectors/DebugProtocolV0/DebugProtocolV0Enums.h
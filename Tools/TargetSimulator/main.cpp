@@ -0,0 +1,77 @@
+/*
+Embedded Debugger PC Application which can be used to debug embedded systems at a high level.
+Copyright (C) 2019 DEMCON advanced mechatronics B.V.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "SimulatorServer.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("DEMCON");
+    QCoreApplication::setOrganizationDomain("www.demcon.nl");
+    QCoreApplication::setApplicationName("Embedded Debugger Target Simulator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulates embedded targets that speak DebugProtocol V0.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"address", "Address to listen on, default 127.0.0.1.", "address", "127.0.0.1"},
+        {"tcp", "TCP port to serve the simulator on.", "port"},
+        {"udp", "UDP port to serve the simulator on, one frame per datagram.", "port"},
+        {"pty", "Serve the simulator on a pseudo terminal, its path is printed."},
+        {"baud", "Baud rate the pseudo terminal output is paced to, 0 for no limit.", "baud", "0"},
+        {"cpus", "Number of simulated cpus, default 1.", "count", "1"},
+        {"rate", "Channel data samples per second before decimation, default 1000.", "samples/s", "1000"},
+        {"drop", "Percentage of outgoing UDP datagrams that is dropped.", "percentage", "0"},
+        {"reorder", "Percentage of outgoing UDP datagrams that is swapped with the next one.", "percentage", "0"},
+    });
+    parser.process(a);
+
+    if (!parser.isSet("tcp") && !parser.isSet("udp") && !parser.isSet("pty"))
+    {
+        QTextStream(stderr) << "A TCP or UDP port or a pseudo terminal is required" << endl;
+        parser.showHelp(1);
+    }
+
+    QHostAddress address(parser.value("address"));
+    SimulatorServer server(parser.value("cpus").toInt(), parser.value("rate").toInt());
+    server.setDatagramFaults(parser.value("drop").toDouble(), parser.value("reorder").toDouble());
+    if (parser.isSet("tcp") && !server.listenTcp(address, static_cast<quint16>(parser.value("tcp").toUInt())))
+    {
+        return 1;
+    }
+    if (parser.isSet("udp") && !server.listenUdp(address, static_cast<quint16>(parser.value("udp").toUInt())))
+    {
+        return 1;
+    }
+    if (parser.isSet("pty"))
+    {
+        QString slavePath = server.openPty(parser.value("baud").toInt());
+        if (slavePath.isEmpty())
+        {
+            return 1;
+        }
+        QTextStream(stdout) << "Pseudo terminal " << slavePath << endl;
+    }
+
+    return a.exec();
+}